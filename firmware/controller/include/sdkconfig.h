@@ -27,3 +27,11 @@
 // larger value to cover both variants.
 #undef CONFIG_MAIN_TASK_STACK_SIZE
 #define CONFIG_MAIN_TASK_STACK_SIZE 20480
+
+// Pin the Arduino loop task (the control loop) to the app core and keep the
+// Wi-Fi event task on the protocol core with the radio, so ESP-NOW traffic
+// and callbacks never preempt a control pass.
+#undef CONFIG_ARDUINO_RUNNING_CORE
+#define CONFIG_ARDUINO_RUNNING_CORE 1
+#undef CONFIG_ARDUINO_EVENT_RUNNING_CORE
+#define CONFIG_ARDUINO_EVENT_RUNNING_CORE 0
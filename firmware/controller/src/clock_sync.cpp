@@ -0,0 +1,65 @@
+/**
+ * @file clock_sync.cpp
+ * @brief Offset/RTT sampling, burst filtering and drift tracking.
+ */
+#include "clock_sync.h"
+
+namespace gag {
+
+bool ClockSync::makeSample(int64_t t1, int64_t t2, int64_t t3, int64_t t4, int64_t maxRttUs,
+                           Sample& out) {
+    int64_t rtt = (t4 - t1) - (t3 - t2);
+    if (t4 < t1 || t3 < t2 || rtt < 0 || rtt > maxRttUs) return false;
+    // Symmetric-path assumption: the display clock read (t2 + t3) / 2 at the
+    // local midpoint (t1 + t4) / 2.
+    out.offsetUs = ((t2 - t1) + (t3 - t4)) / 2;
+    out.rttUs = rtt;
+    out.localUs = t1 + (t4 - t1) / 2;
+    return true;
+}
+
+void ClockSync::addSample(const Sample& s) {
+    if (!haveBest_ || s.rttUs < best_.rttUs) {
+        best_ = s;
+        haveBest_ = true;
+    }
+}
+
+bool ClockSync::commitBurst() {
+    if (!haveBest_) return false;
+    haveBest_ = false;
+    const Sample& s = best_;
+    lastRttUs_ = s.rttUs;
+
+    if (!synced_) {
+        refLocalUs_ = driftLocalUs_ = s.localUs;
+        refOffsetUs_ = driftOffsetUs_ = s.offsetUs;
+        lastCorrectionUs_ = 0;
+        synced_ = true;
+        return true;
+    }
+
+    lastCorrectionUs_ = s.offsetUs - (utcUs(s.localUs) - s.localUs);
+    refLocalUs_ = s.localUs;
+    refOffsetUs_ = s.offsetUs;
+
+    // Rate from a separate, older anchor so bursts taken close together
+    // (retries, start-up) do not turn offset noise into drift.
+    int64_t span = s.localUs - driftLocalUs_;
+    if (span < MIN_DRIFT_SPAN_US) return true;
+    double measured = static_cast<double>(s.offsetUs - driftOffsetUs_) * 1e6 / span;
+    if (measured > MAX_DRIFT_PPM) measured = MAX_DRIFT_PPM;
+    if (measured < -MAX_DRIFT_PPM) measured = -MAX_DRIFT_PPM;
+    driftPpm_ = haveDrift_ ? driftPpm_ + (measured - driftPpm_) * DRIFT_GAIN : measured;
+    haveDrift_ = true;
+    driftLocalUs_ = s.localUs;
+    driftOffsetUs_ = s.offsetUs;
+    return true;
+}
+
+int64_t ClockSync::utcUs(int64_t localUs) const {
+    int64_t elapsed = localUs - refLocalUs_;
+    return localUs + refOffsetUs_ + static_cast<int64_t>(elapsed * driftPpm_ * 1e-6);
+}
+
+}  // namespace gag
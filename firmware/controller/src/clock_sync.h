@@ -0,0 +1,73 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file clock_sync.h
+ * @brief Wall-clock estimate from NTP-style exchanges with the display.
+ *
+ * Each exchange yields the offset between the display's UTC clock and the
+ * local monotonic clock, plus the round-trip time. Exchanges are taken in
+ * short bursts and only the lowest-RTT sample of a burst is kept, since
+ * queueing delay on the radio only ever adds to it. Successive accepted
+ * offsets further apart than a minute give the local oscillator's drift,
+ * which is tracked so the estimate stays good between bursts or while the
+ * display is away.
+ */
+
+namespace gag {
+
+class ClockSync {
+   public:
+    struct Sample {
+        int64_t offsetUs;  // UTC minus local monotonic time
+        int64_t rttUs;
+        int64_t localUs;   // local time the offset refers to (midpoint)
+    };
+
+    /**
+     * @brief Build a sample from the four exchange timestamps.
+     * @return false when the timestamps are inconsistent or the RTT exceeds
+     *         @p maxRttUs.
+     */
+    static bool makeSample(int64_t t1, int64_t t2, int64_t t3, int64_t t4, int64_t maxRttUs,
+                           Sample& out);
+
+    /** Offer a sample to the current burst. */
+    void addSample(const Sample& s);
+
+    /**
+     * @brief Close the burst and fold its best sample into the clock model.
+     * @return true when a sample was applied.
+     */
+    bool commitBurst();
+
+    bool synced() const { return synced_; }
+
+    /** @return Estimated UTC in microseconds at local monotonic @p localUs. */
+    int64_t utcUs(int64_t localUs) const;
+
+    double driftPpm() const { return driftPpm_; }
+    int64_t lastRttUs() const { return lastRttUs_; }
+    /** Step between the model's prediction and the last applied sample. */
+    int64_t lastCorrectionUs() const { return lastCorrectionUs_; }
+
+   private:
+    static constexpr int64_t MIN_DRIFT_SPAN_US = 60LL * 1000000;
+    static constexpr double MAX_DRIFT_PPM = 200.0;
+    static constexpr double DRIFT_GAIN = 0.3;
+
+    bool synced_ = false;
+    bool haveDrift_ = false;
+    int64_t refLocalUs_ = 0;
+    int64_t refOffsetUs_ = 0;
+    int64_t driftLocalUs_ = 0;
+    int64_t driftOffsetUs_ = 0;
+    double driftPpm_ = 0.0;
+    int64_t lastRttUs_ = 0;
+    int64_t lastCorrectionUs_ = 0;
+
+    bool haveBest_ = false;
+    Sample best_{};
+};
+
+}  // namespace gag
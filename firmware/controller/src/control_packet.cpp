@@ -0,0 +1,43 @@
+/**
+ * @file control_packet.cpp
+ * @brief Control packet range checks.
+ */
+#include "control_packet.h"
+
+#include "param_registry.h"
+
+namespace gag {
+namespace {
+
+float clampTo(float v, float lo, float hi) {
+    if (!(v >= lo)) return lo;  // also NaN
+    if (v > hi) return hi;
+    return v;
+}
+
+float clampParam(float v, int index) {
+    return clampTo(v, PARAM_DEFS[index].min, PARAM_DEFS[index].max);
+}
+
+}  // namespace
+
+ControlTargets decodeControl(const EspNowControlPacket& pkt, float ecoMinC, float ecoMaxC) {
+    ControlTargets t;
+    t.heater = (pkt.flags & ESPNOW_CONTROL_FLAG_HEATER) != 0;
+    t.steam = (pkt.flags & ESPNOW_CONTROL_FLAG_STEAM) != 0;
+    t.pressureMode = (pkt.flags & ESPNOW_CONTROL_FLAG_PUMP_PRESSURE) != 0;
+    t.pumpMode = pkt.pumpMode;
+    t.brewC = clampParam(pkt.brewSetpointC, PARAM_INDEX_BREW_SETPOINT);
+    t.steamC = clampParam(pkt.steamSetpointC, PARAM_INDEX_STEAM_SETPOINT);
+    t.ecoC = pkt.ecoSetpointC ? clampTo(pkt.ecoSetpointC, ecoMinC, ecoMaxC) : 0.0f;
+    t.pidP = clampParam(pkt.pidP, PARAM_INDEX_HEATER_KP);
+    t.pidI = clampParam(pkt.pidI, PARAM_INDEX_HEATER_KI);
+    t.pidGuard = clampParam(pkt.pidGuard, PARAM_INDEX_HEATER_I_GUARD);
+    t.pidD = clampParam(pkt.pidD, PARAM_INDEX_HEATER_KD);
+    t.dTau = clampParam(pkt.dTau, PARAM_INDEX_HEATER_DTAU);
+    t.pumpPct = clampParam(pkt.pumpPowerPercent, PARAM_INDEX_PUMP_POWER);
+    t.pressureBar = clampParam(pkt.pressureSetpointBar, PARAM_INDEX_PRESSURE_SETPOINT);
+    return t;
+}
+
+}  // namespace gag
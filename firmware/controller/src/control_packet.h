@@ -0,0 +1,44 @@
+#pragma once
+#include <stdint.h>
+
+#include "espnow_protocol.h"
+
+/**
+ * @file control_packet.h
+ * @brief Range checks on the display's control packet.
+ *
+ * decodeControl() turns an EspNowControlPacket into targets the controller
+ * can apply as they are: every value is clamped to the parameter registry
+ * range of the setting it drives, and a NaN (a corrupt or half-initialised
+ * packet) takes the lower bound, i.e. less heat and less pump.
+ */
+
+namespace gag {
+
+struct ControlTargets {
+    bool heater;
+    bool steam;
+    bool pressureMode;
+    uint8_t pumpMode;  // EspNowPumpMode
+    float brewC;
+    float steamC;
+    float ecoC;  // 0 = no eco hold
+    float pidP, pidI, pidGuard, pidD, dTau;
+    float pumpPct;
+    float pressureBar;
+};
+
+/** @p ecoMinC / @p ecoMaxC bound a non-zero eco hold. */
+ControlTargets decodeControl(const EspNowControlPacket& pkt, float ecoMinC, float ecoMaxC);
+
+/**
+ * @brief True when a packet with @p revision should be applied after @p last.
+ *
+ * Revision 0 is always applied (older displays do not number packets);
+ * otherwise only newer revisions, compared by serial-number arithmetic.
+ */
+inline bool controlRevisionNewer(uint32_t revision, uint32_t last) {
+    return revision == 0 || static_cast<int32_t>(revision - last) > 0;
+}
+
+}  // namespace gag
@@ -0,0 +1,158 @@
+/**
+ * @file curve_cal.cpp
+ * @brief Piecewise curve evaluation and Kaczmarz fit over calibration runs.
+ */
+#include "curve_cal.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "hot_path.h"
+
+namespace gag {
+namespace {
+
+constexpr int FIT_SWEEPS = 50;
+constexpr float FIT_RELAX = 0.5f;  // < 1 lets inconsistent runs settle on a compromise
+
+}  // namespace
+
+bool calCurveValid(const CalCurve& c, float yMin, float yMax) {
+    for (int i = 0; i < CAL_POINTS; ++i) {
+        if (!isfinite(c.x[i]) || !isfinite(c.y[i])) return false;
+        if (c.y[i] < yMin || c.y[i] > yMax) return false;
+        if (i > 0 && !(c.x[i] > c.x[i - 1])) return false;
+    }
+    return true;
+}
+
+float CONTROL_HOT calCurveEval(const CalCurve& c, float x) {
+    if (x <= c.x[0]) return c.y[0];
+    if (x >= c.x[CAL_POINTS - 1]) return c.y[CAL_POINTS - 1];
+    int lo = 0;
+    while (x >= c.x[lo + 1]) ++lo;
+    float frac = (x - c.x[lo]) / (c.x[lo + 1] - c.x[lo]);
+    return c.y[lo] + (c.y[lo + 1] - c.y[lo]) * frac;
+}
+
+CalCurveQ calCurveToFixed(const CalCurve& c) {
+    CalCurveQ q;
+    for (int i = 0; i < CAL_POINTS; ++i) {
+        q.x[i] = Q16_16(c.x[i]);
+        q.y[i] = Q16_16(c.y[i]);
+    }
+    return q;
+}
+
+Q16_16 CONTROL_HOT calCurveEvalQ(const CalCurveQ& c, Q16_16 x) {
+    if (x <= c.x[0]) return c.y[0];
+    if (x >= c.x[CAL_POINTS - 1]) return c.y[CAL_POINTS - 1];
+    int lo = 0;
+    while (x >= c.x[lo + 1]) ++lo;
+    Q16_16 frac = (x - c.x[lo]) / (c.x[lo + 1] - c.x[lo]);
+    return c.y[lo] + (c.y[lo + 1] - c.y[lo]) * frac;
+}
+
+void CONTROL_HOT CurveCalibrator::weights(float x, int& lo, float& frac) const {
+    const float* bx = curve_.x;
+    if (!(x > bx[0])) {  // also catches NaN
+        lo = 0;
+        frac = 0.0f;
+        return;
+    }
+    if (x >= bx[CAL_POINTS - 1]) {
+        lo = CAL_POINTS - 2;
+        frac = 1.0f;
+        return;
+    }
+    lo = 0;
+    while (x >= bx[lo + 1]) ++lo;
+    frac = (x - bx[lo]) / (bx[lo + 1] - bx[lo]);
+}
+
+float CONTROL_HOT CurveCalibrator::addSample(float x) {
+    int lo;
+    float frac;
+    weights(x, lo, frac);
+    if (running_) {
+        w_[lo] += 1.0f - frac;
+        w_[lo + 1] += frac;
+        ++runSamples_;
+    }
+    return curve_.y[lo] + (curve_.y[lo + 1] - curve_.y[lo]) * frac;
+}
+
+Q16_16 CONTROL_HOT CurveCalibrator::addSampleQ(Q16_16 x) {
+    if (running_) addSample(x.toFloat());
+    return calCurveEvalQ(curveQ_, x);
+}
+
+void CurveCalibrator::startRun() {
+    memset(w_, 0, sizeof(w_));
+    runSamples_ = 0;
+    running_ = true;
+}
+
+float CurveCalibrator::predict(const Run& r) const {
+    float v = 0.0f;
+    for (int i = 0; i < CAL_POINTS; ++i) v += r.w[i] * curve_.y[i];
+    return v;
+}
+
+float CurveCalibrator::errorPct(float measured, float reference) const {
+    float scale = fabsf(reference) > limits_.errorScale ? fabsf(reference) : limits_.errorScale;
+    return scale > 0.0f ? (measured - reference) / scale * 100.0f : 0.0f;
+}
+
+CurveCalibrator::Result CurveCalibrator::finishRun(float reference, bool average) {
+    Result res{};
+    res.reference = reference;
+    res.samples = runSamples_;
+    res.runs = runCount_;
+    if (!running_) return res;
+    running_ = false;
+    if (runSamples_ < limits_.minSamples || !(reference >= limits_.minReference)) return res;
+
+    Run run;
+    float scale = average ? 1.0f / static_cast<float>(runSamples_) : 1.0f;
+    for (int i = 0; i < CAL_POINTS; ++i) run.w[i] = w_[i] * scale;
+    run.reference = reference;
+    res.measured = predict(run);
+    res.errorPct = errorPct(res.measured, reference);
+    if (fabsf(res.errorPct) > limits_.maxErrorPct) return res;
+
+    runs_[runNext_] = run;
+    runNext_ = (runNext_ + 1) % MAX_RUNS;
+    if (runCount_ < MAX_RUNS) ++runCount_;
+
+    // Each run constrains w . y = reference; project onto each constraint in turn.
+    float* y = curve_.y;
+    for (int sweep = 0; sweep < FIT_SWEEPS; ++sweep) {
+        for (int k = 0; k < runCount_; ++k) {
+            const Run& r = runs_[k];
+            float ww = 0.0f;
+            for (int i = 0; i < CAL_POINTS; ++i) ww += r.w[i] * r.w[i];
+            if (ww <= 0.0f) continue;
+            float step = FIT_RELAX * (r.reference - predict(r)) / ww;
+            for (int i = 0; i < CAL_POINTS; ++i) {
+                y[i] += step * r.w[i];
+                if (y[i] < limits_.yMin) y[i] = limits_.yMin;
+                if (y[i] > limits_.yMax) y[i] = limits_.yMax;
+            }
+        }
+    }
+
+    curveQ_ = calCurveToFixed(curve_);
+
+    float sq = 0.0f;
+    for (int k = 0; k < runCount_; ++k) {
+        float e = errorPct(predict(runs_[k]), runs_[k].reference);
+        sq += e * e;
+    }
+    res.residualPct = sqrtf(sq / runCount_);
+    res.runs = runCount_;
+    res.ok = true;
+    return res;
+}
+
+}  // namespace gag
@@ -0,0 +1,130 @@
+#pragma once
+#include <stdint.h>
+
+#include "fixed_point.h"
+
+/**
+ * @file curve_cal.h
+ * @brief Piecewise-linear sensor curves and their calibration from reference runs.
+ *
+ * A curve maps a sensor quantity x (flow pulse rate, pressure ADC millivolts)
+ * to an engineering value y at a handful of fixed breakpoints, with linear
+ * interpolation between them and clamping outside.
+ *
+ * A calibration run records how much every sample leaned on each breakpoint.
+ * Finishing the run against a reference gives one linear equation in the
+ * breakpoint values; the last few runs are fitted together with relaxed
+ * Kaczmarz projections, so a run that only exercised part of the range only
+ * moves the breakpoints around it.
+ */
+
+namespace gag {
+
+constexpr int CAL_POINTS = 6;
+
+struct CalCurve {
+    float x[CAL_POINTS];  // ascending breakpoints
+    float y[CAL_POINTS];  // values at the breakpoints
+};
+
+/** @return true when @p c has ascending finite breakpoints and y within [yMin, yMax]. */
+bool calCurveValid(const CalCurve& c, float yMin, float yMax);
+
+/** Linear interpolation on @p c, clamped to the end values. */
+float calCurveEval(const CalCurve& c, float x);
+
+/** @p CalCurve in Q16.16, for evaluation without the FPU (ISRs). */
+struct CalCurveQ {
+    Q16_16 x[CAL_POINTS];
+    Q16_16 y[CAL_POINTS];
+};
+
+/** Convert @p c for calCurveEvalQ(); values beyond +-32768 saturate. */
+CalCurveQ calCurveToFixed(const CalCurve& c);
+
+/** calCurveEval() in integer arithmetic only. */
+Q16_16 calCurveEvalQ(const CalCurveQ& c, Q16_16 x);
+
+class CurveCalibrator {
+   public:
+    /** Plausibility limits applied to runs and to the fitted values. */
+    struct Limits {
+        float yMin, yMax;      // clamp for fitted breakpoint values
+        uint32_t minSamples;   // shorter runs are rejected
+        float minReference;    // smaller references are rejected
+        float errorScale;      // error % is relative to max(|reference|, errorScale)
+        float maxErrorPct;     // runs further off than this are rejected as typos
+    };
+
+    struct Result {
+        bool ok;
+        float reference;
+        float measured;     // what the curve reported for the run before the fit
+        float errorPct;     // (measured - reference), see Limits::errorScale
+        float residualPct;  // RMS error over retained runs after the fit
+        uint32_t samples;
+        uint8_t runs;
+    };
+
+    CurveCalibrator(const CalCurve& curve, const Limits& limits)
+        : curve_(curve), curveQ_(calCurveToFixed(curve)), limits_(limits) {}
+
+    void setCurve(const CalCurve& c) {
+        curve_ = c;
+        curveQ_ = calCurveToFixed(c);
+    }
+    const CalCurve& curve() const { return curve_; }
+    const Limits& limits() const { return limits_; }
+
+    float eval(float x) const { return calCurveEval(curve_, x); }
+
+    /** Evaluate one sample and feed it to a running calibration. */
+    float addSample(float x);
+
+    /**
+     * @brief addSample() on the Q16.16 copy of the curve.
+     *
+     * Integer-only unless a calibration run is open; the run's weights are
+     * kept in float.
+     */
+    Q16_16 addSampleQ(Q16_16 x);
+
+    void startRun();
+    void cancelRun() { running_ = false; }
+    bool running() const { return running_; }
+    uint32_t runSamples() const { return runSamples_; }
+
+    /**
+     * @brief Close the run against @p reference and refit the curve.
+     * @param average true when the reference is the mean of the samples
+     *        (pressure), false when it is their sum (flow volume).
+     */
+    Result finishRun(float reference, bool average);
+
+    /** Forget retained runs (e.g. after restoring the factory curve). */
+    void clearRuns() { runCount_ = 0; }
+    uint8_t runCount() const { return runCount_; }
+
+   private:
+    static constexpr int MAX_RUNS = 4;
+    struct Run {
+        float w[CAL_POINTS];  // samples attributed to each breakpoint
+        float reference;
+    };
+
+    void weights(float x, int& lo, float& frac) const;
+    float predict(const Run& r) const;
+    float errorPct(float measured, float reference) const;
+
+    CalCurve curve_;
+    CalCurveQ curveQ_;  // follows curve_
+    Limits limits_;
+    bool running_ = false;
+    float w_[CAL_POINTS] = {0};
+    uint32_t runSamples_ = 0;
+    Run runs_[MAX_RUNS];
+    uint8_t runCount_ = 0;
+    uint8_t runNext_ = 0;
+};
+
+}  // namespace gag
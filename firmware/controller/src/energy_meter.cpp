@@ -0,0 +1,35 @@
+/**
+ * @file energy_meter.cpp
+ * @brief On-time integration and cycle counting.
+ */
+#include "energy_meter.h"
+
+namespace gag {
+namespace {
+
+constexpr float DUTY_TAU_MS = 60000.0f;
+
+}  // namespace
+
+void EnergyMeter::update(uint32_t nowMs, EnergyState state, bool heaterOn, bool pumpOn) {
+    if (started_) {
+        uint32_t dt = nowMs - lastMs_;
+        if (state_ < ENERGY_STATES) {
+            t_.stateMs[state_] += dt;
+            if (heaterOn_) t_.heaterOnMs[state_] += dt;
+        }
+        if (pumpOn_) t_.pumpOnMs += dt;
+        float a = dt / (DUTY_TAU_MS + dt);
+        duty_ += ((heaterOn_ ? 100.0f : 0.0f) - duty_) * a;
+
+        if (heaterOn && !heaterOn_) ++t_.heaterCycles;
+        if (pumpOn && !pumpOn_) ++t_.pumpCycles;
+    }
+    started_ = true;
+    lastMs_ = nowMs;
+    state_ = state;
+    heaterOn_ = heaterOn;
+    pumpOn_ = pumpOn;
+}
+
+}  // namespace gag
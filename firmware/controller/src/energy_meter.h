@@ -0,0 +1,77 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file energy_meter.h
+ * @brief Heater and pump usage accounting.
+ *
+ * Integrates the SSR and pump on-times from their sampled levels, split by
+ * machine state, and counts switch-on cycles. Heater energy is on-time times
+ * the element rating, which is exact for a resistive element on a zero-cross
+ * SSR. State time only accrues while the heater is enabled, so on-time over
+ * state time is the duty needed to hold that state: the idle share is the
+ * machine's standing loss. The totals are a plain struct so the caller can
+ * persist and restore them.
+ */
+
+namespace gag {
+
+enum EnergyState : uint8_t {
+    ENERGY_IDLE = 0,  // heater enabled, holding temperature
+    ENERGY_SHOT,      // shot running, until the shot resets after the pump stops
+    ENERGY_STEAM,
+    ENERGY_STATES,
+    ENERGY_OFF = ENERGY_STATES,  // heater disabled: only the pump is metered
+};
+
+/**
+ * @brief Lifetime counters; persisted as is.
+ *
+ * Append-only: new fields go at the end and bump ENERGY_TOTALS_VERSION.
+ */
+struct EnergyTotals {
+    uint64_t stateMs[ENERGY_STATES];
+    uint64_t heaterOnMs[ENERGY_STATES];
+    uint64_t pumpOnMs;
+    uint32_t heaterCycles;  // SSR off -> on
+    uint32_t pumpCycles;    // pump starts
+    uint32_t shots;
+    uint32_t boots;
+};
+
+constexpr uint16_t ENERGY_TOTALS_VERSION = 1;
+
+class EnergyMeter {
+   public:
+    /** Continue from previously persisted totals. */
+    void restore(const EnergyTotals& t) { t_ = t; }
+
+    /**
+     * @brief Account the time since the previous call to the levels sampled then.
+     *
+     * Call every loop pass; the heater PWM window is 250 ms, so the sampling
+     * must be much faster than that for the on-time to be accurate.
+     */
+    void update(uint32_t nowMs, EnergyState state, bool heaterOn, bool pumpOn);
+
+    void countShot() { ++t_.shots; }
+    void countBoot() { ++t_.boots; }
+
+    const EnergyTotals& totals() const { return t_; }
+    /** Heater duty (0..100) over roughly the last minute. */
+    float dutyPct() const { return duty_; }
+
+    static float wattHours(uint64_t onMs, float elementW) {
+        return static_cast<float>(onMs) * elementW / 3.6e6f;
+    }
+
+   private:
+    EnergyTotals t_{};
+    bool started_ = false;
+    uint32_t lastMs_ = 0;
+    EnergyState state_ = ENERGY_OFF;
+    bool heaterOn_ = false, pumpOn_ = false;
+    float duty_ = 0.0f;
+};
+
+}  // namespace gag
@@ -0,0 +1,112 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file fixed_point.h
+ * @brief Saturating fixed-point arithmetic for FPU-free control math.
+ *
+ * The ESP32 does not save FPU registers on interrupt entry, so float code is
+ * off limits in ISRs. Fixed<F> is a signed 32-bit value with F fraction bits;
+ * + - * / use integer instructions only and saturate instead of wrapping.
+ * Conversion from float is constexpr, so coefficients are converted by the
+ * compiler; converting at run time does use the FPU and belongs in task code.
+ *
+ * Q16_16 (range +-32768, resolution 1.5e-5) carries the pressure path from
+ * the phase sampler's millivolts through the sensor curve and the auto-zero
+ * filter; gag::Pid also instantiates on it.
+ */
+
+namespace gag {
+
+template <int F>
+class Fixed {
+    static_assert(F > 0 && F < 31, "fraction bits must leave a sign and an integer bit");
+
+   public:
+    static constexpr int32_t ONE = static_cast<int32_t>(1) << F;
+
+    constexpr Fixed() : raw_(0) {}
+    /** Round @p v to the nearest step; out-of-range values saturate, NaN becomes 0. */
+    explicit constexpr Fixed(float v) : raw_(fromFloatRaw(v)) {}
+
+    static constexpr Fixed fromRaw(int32_t raw) { return Fixed(raw, RawTag()); }
+    static constexpr Fixed fromInt(int32_t v) {
+        return fromRaw(sat(static_cast<int64_t>(v) * ONE));
+    }
+    static constexpr Fixed max() { return fromRaw(INT32_MAX); }
+    static constexpr Fixed min() { return fromRaw(INT32_MIN); }
+
+    constexpr int32_t raw() const { return raw_; }
+    constexpr float toFloat() const { return raw_ * (1.0f / ONE); }
+    /** Nearest integer, halves rounded up. */
+    constexpr int32_t roundToInt() const {
+        return static_cast<int32_t>((static_cast<int64_t>(raw_) + ONE / 2) >> F);
+    }
+
+    constexpr Fixed operator+(Fixed o) const {
+        return fromRaw(sat(static_cast<int64_t>(raw_) + o.raw_));
+    }
+    constexpr Fixed operator-(Fixed o) const {
+        return fromRaw(sat(static_cast<int64_t>(raw_) - o.raw_));
+    }
+    constexpr Fixed operator-() const { return fromRaw(raw_ == INT32_MIN ? INT32_MAX : -raw_); }
+    /** Product rounded to nearest. */
+    constexpr Fixed operator*(Fixed o) const {
+        return fromRaw(sat((static_cast<int64_t>(raw_) * o.raw_ + (ONE >> 1)) >> F));
+    }
+    /** Quotient rounded to nearest; division by zero saturates towards the dividend's sign. */
+    constexpr Fixed operator/(Fixed o) const {
+        return o.raw_ == 0 ? (raw_ < 0 ? min() : max())
+                           : fromRaw(sat(divRound(static_cast<int64_t>(raw_) * ONE, o.raw_)));
+    }
+
+    Fixed& operator+=(Fixed o) { return *this = *this + o; }
+    Fixed& operator-=(Fixed o) { return *this = *this - o; }
+    Fixed& operator*=(Fixed o) { return *this = *this * o; }
+    Fixed& operator/=(Fixed o) { return *this = *this / o; }
+
+    constexpr bool operator==(Fixed o) const { return raw_ == o.raw_; }
+    constexpr bool operator!=(Fixed o) const { return raw_ != o.raw_; }
+    constexpr bool operator<(Fixed o) const { return raw_ < o.raw_; }
+    constexpr bool operator<=(Fixed o) const { return raw_ <= o.raw_; }
+    constexpr bool operator>(Fixed o) const { return raw_ > o.raw_; }
+    constexpr bool operator>=(Fixed o) const { return raw_ >= o.raw_; }
+
+   private:
+    struct RawTag {};
+    constexpr Fixed(int32_t raw, RawTag) : raw_(raw) {}
+
+    static constexpr int32_t sat(int64_t v) {
+        return v > INT32_MAX ? INT32_MAX : v < INT32_MIN ? INT32_MIN : static_cast<int32_t>(v);
+    }
+    static constexpr int64_t divRound(int64_t n, int64_t d) {
+        return ((n < 0) == (d < 0) ? n + d / 2 : n - d / 2) / d;
+    }
+    static constexpr int32_t fromFloatRaw(float v) {
+        return v != v                      ? 0
+               : v * ONE >= 2147483647.0f  ? INT32_MAX
+               : v * ONE <= -2147483648.0f ? INT32_MIN
+                                           : static_cast<int32_t>(v * ONE + (v < 0 ? -0.5f : 0.5f));
+    }
+
+    int32_t raw_;
+};
+
+template <int F>
+constexpr int32_t Fixed<F>::ONE;
+
+using Q16_16 = Fixed<16>;
+
+/** First-order low-pass step, y += (x - y) * alpha. */
+template <typename T>
+inline T lowPassStep(T y, T x, T alpha) {
+    return y + (x - y) * alpha;
+}
+
+/** Low-pass coefficient for a step of @p dt with time constant @p tau (same units). */
+template <typename T>
+inline T lowPassAlpha(T dt, T tau) {
+    return dt / (tau + dt);
+}
+
+}  // namespace gag
@@ -0,0 +1,65 @@
+/**
+ * @file flight_recorder.cpp
+ * @brief Reset-surviving sample ring.
+ */
+#include "flight_recorder.h"
+
+namespace gag {
+namespace {
+
+constexpr uint32_t FLIGHT_MAGIC = 0x67464C54;  // "gFLT"
+
+}  // namespace
+
+bool FlightRecorder::adopt(uint32_t runId, FlightRecord& prev) {
+    bool valid = log_.magic == FLIGHT_MAGIC && log_.head < FLIGHT_CAPACITY &&
+                 log_.count <= FLIGHT_CAPACITY && log_.count > 0;
+    if (valid) {
+        prev.runId = log_.runId;
+        prev.endStage = log_.stage;
+        prev.count = log_.count;
+        uint16_t start = (log_.head + FLIGHT_CAPACITY - log_.count) % FLIGHT_CAPACITY;
+        for (uint16_t i = 0; i < log_.count; ++i) {
+            prev.samples[i] = log_.samples[(start + i) % FLIGHT_CAPACITY];
+        }
+    }
+    log_.magic = FLIGHT_MAGIC;
+    log_.runId = runId;
+    log_.head = 0;
+    log_.count = 0;
+    log_.stage = 0;
+    return valid;
+}
+
+void FlightRecorder::notePass(uint32_t passUs, uint8_t slowestStage, bool overran, bool tripped) {
+    if (passUs >= worstPassUs_) {
+        worstPassUs_ = passUs;
+        worstStage_ = slowestStage;
+    }
+    if (overran) passFlags_ |= ESPNOW_FLIGHT_FLAG_OVERRUN;
+    if (tripped) passFlags_ |= ESPNOW_FLIGHT_FLAG_TRIP;
+}
+
+void FlightRecorder::record(uint32_t nowMs, EspNowFlightSample s) {
+    uint32_t pass100us = (worstPassUs_ + 50) / 100;
+    s.ms = nowMs;
+    const uint8_t passMask = ESPNOW_FLIGHT_FLAG_OVERRUN | ESPNOW_FLIGHT_FLAG_TRIP;
+    s.flags = static_cast<uint8_t>((s.flags & ~passMask) | passFlags_);
+    s.worstStage = worstStage_;
+    s.worstPass100us = static_cast<uint16_t>(pass100us > 0xFFFF ? 0xFFFF : pass100us);
+
+    uint16_t head = log_.head;
+    log_.samples[head] = s;
+    // Advance only after the sample is complete, so a reset mid-write leaves
+    // the older samples intact.
+    log_.head = static_cast<uint16_t>((head + 1) % FLIGHT_CAPACITY);
+    if (log_.count < FLIGHT_CAPACITY) log_.count = log_.count + 1;
+
+    started_ = true;
+    lastMs_ = nowMs;
+    worstPassUs_ = 0;
+    worstStage_ = 0;
+    passFlags_ = 0;
+}
+
+}  // namespace gag
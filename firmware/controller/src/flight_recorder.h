@@ -0,0 +1,78 @@
+#pragma once
+#include <stdint.h>
+
+#include "espnow_protocol.h"
+
+/**
+ * @file flight_recorder.h
+ * @brief Ring of recent control state that outlives a reset.
+ *
+ * The caller places a FlightLog in memory the boot code leaves alone
+ * (RTC_NOINIT) and records a sample every few tens of milliseconds, so the
+ * steady-state cost is a 16-byte store. At the next boot adopt() checks what
+ * the previous run left there, copies it out oldest-first as the post-mortem
+ * record and restarts the ring for the new run. The header's magic and index
+ * ranges reject the random contents found after a power-up; samples carry no
+ * checksum.
+ */
+
+namespace gag {
+
+constexpr uint16_t FLIGHT_CAPACITY = ESPNOW_FLIGHT_MAX_SAMPLES;
+
+struct FlightLog {
+    uint32_t magic;
+    uint32_t runId;          // boot number of the run writing the ring
+    uint16_t head;           // next slot to write
+    uint16_t count;
+    volatile uint8_t stage;  // loop stage last entered: where a hung run stopped
+    EspNowFlightSample samples[FLIGHT_CAPACITY];
+};
+
+/** The previous run's samples, oldest first. */
+struct FlightRecord {
+    uint32_t runId;
+    uint8_t endStage;
+    uint16_t count;
+    EspNowFlightSample samples[FLIGHT_CAPACITY];
+};
+
+class FlightRecorder {
+   public:
+    FlightRecorder(FlightLog& log, uint16_t samplePeriodMs)
+        : log_(log), periodMs_(samplePeriodMs) {}
+
+    /**
+     * @brief At boot: move the previous run's ring into @p prev and restart it for @p runId.
+     * @return false when the ring held nothing valid (power-up, first flash).
+     */
+    bool adopt(uint32_t runId, FlightRecord& prev);
+
+    void enterStage(uint8_t stage) { log_.stage = stage; }
+
+    /** Fold one finished loop pass into the next sample. */
+    void notePass(uint32_t passUs, uint8_t slowestStage, bool overran, bool tripped);
+
+    bool due(uint32_t nowMs) const { return !started_ || nowMs - lastMs_ >= periodMs_; }
+
+    /**
+     * @brief Store @p s at @p nowMs.
+     *
+     * Fills in the time, the pass fields and the overrun/trip flags gathered
+     * by notePass() since the previous sample.
+     */
+    void record(uint32_t nowMs, EspNowFlightSample s);
+
+    uint16_t samplePeriodMs() const { return periodMs_; }
+
+   private:
+    FlightLog& log_;
+    uint16_t periodMs_;
+    bool started_ = false;
+    uint32_t lastMs_ = 0;
+    uint32_t worstPassUs_ = 0;
+    uint8_t worstStage_ = 0;
+    uint8_t passFlags_ = 0;
+};
+
+}  // namespace gag
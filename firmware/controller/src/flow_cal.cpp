@@ -0,0 +1,47 @@
+/**
+ * @file flow_cal.cpp
+ * @brief Flow curve defaults and limits over the generic curve calibrator.
+ */
+#include "flow_cal.h"
+
+namespace gag {
+namespace {
+
+// Pulse rates spanning pre-infusion dribble (~0.25 mL/s) to a full pump (~8 mL/s).
+constexpr float DEFAULT_HZ[FLOW_CAL_POINTS] = {1.0f, 2.0f, 4.0f, 8.0f, 16.0f, 32.0f};
+// mL per pulse bounds, at least 20 pulses and 5 mL; a run reading more than
+// twice the reference points at a typo, not slip.
+const CurveCalibrator::Limits LIMITS = {0.02f, 2.0f, 20, 5.0f, 0.0f, 100.0f};
+
+}  // namespace
+
+FlowCalTable flowCalDefault(float mlPerPulse) {
+    FlowCalTable t;
+    for (int i = 0; i < FLOW_CAL_POINTS; ++i) {
+        t.x[i] = DEFAULT_HZ[i];
+        t.y[i] = mlPerPulse;
+    }
+    return t;
+}
+
+bool flowCalValid(const FlowCalTable& t) {
+    return calCurveValid(t, LIMITS.yMin, LIMITS.yMax) && t.x[0] > 0.0f;
+}
+
+FlowCalibrator::FlowCalibrator(float mlPerPulse) : cal_(flowCalDefault(mlPerPulse), LIMITS) {}
+
+FlowCalibrator::Result FlowCalibrator::finishRun(float referenceMl) {
+    // Flow runs sum the pulse volumes.
+    CurveCalibrator::Result r = cal_.finishRun(referenceMl, false);
+    Result res;
+    res.ok = r.ok;
+    res.referenceMl = r.reference;
+    res.measuredMl = r.measured;
+    res.errorPct = r.errorPct;
+    res.residualPct = r.residualPct;
+    res.pulses = r.samples;
+    res.runs = r.runs;
+    return res;
+}
+
+}  // namespace gag
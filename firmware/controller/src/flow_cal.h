@@ -0,0 +1,77 @@
+#pragma once
+#include <stdint.h>
+
+#include "curve_cal.h"
+
+/**
+ * @file flow_cal.h
+ * @brief Rate-dependent flow meter calibration.
+ *
+ * Gear flow meters slip at low flow, so the volume per pulse depends on how
+ * fast the gear turns. The flow curve is a CalCurve from pulse rate (Hz) to
+ * mL per pulse; FlowCalibrator wraps a CurveCalibrator so the flow path can
+ * work in pulse intervals and millilitres, while the fit and the calibration
+ * session code stay shared with the pressure curve.
+ */
+
+namespace gag {
+
+constexpr int FLOW_CAL_POINTS = CAL_POINTS;
+
+/** x: pulse rate (Hz), y: mL per pulse. */
+typedef CalCurve FlowCalTable;
+
+/** Flat curve at @p mlPerPulse over the breakpoints used for espresso flows. */
+FlowCalTable flowCalDefault(float mlPerPulse);
+
+/** @return true when @p t has ascending breakpoints and plausible values. */
+bool flowCalValid(const FlowCalTable& t);
+
+class FlowCalibrator {
+   public:
+    struct Result {
+        bool ok;
+        float referenceMl;
+        float measuredMl;   // volume the curve reported before the fit
+        float errorPct;     // (measured - reference) / reference
+        float residualPct;  // RMS error over retained runs after the fit
+        uint32_t pulses;
+        uint8_t runs;
+    };
+
+    explicit FlowCalibrator(float mlPerPulse);
+
+    void setTable(const FlowCalTable& t) { cal_.setCurve(t); }
+    const FlowCalTable& table() const { return cal_.curve(); }
+
+    /** Volume of one pulse that followed the previous one by @p intervalUs. */
+    float mlPerPulse(uint32_t intervalUs) const { return cal_.eval(rateHz(intervalUs)); }
+
+    /** Account one pulse: returns its volume and feeds a running calibration. */
+    float addPulse(uint32_t intervalUs) { return cal_.addSample(rateHz(intervalUs)); }
+
+    void startRun() { cal_.startRun(); }
+    void cancelRun() { cal_.cancelRun(); }
+    bool running() const { return cal_.running(); }
+    uint32_t runPulses() const { return cal_.runSamples(); }
+
+    /** Close the run against @p referenceMl and refit the curve. */
+    Result finishRun(float referenceMl);
+
+    /** Forget retained runs (e.g. after restoring the factory curve). */
+    void clearRuns() { cal_.clearRuns(); }
+    uint8_t runCount() const { return cal_.runCount(); }
+
+    /** The generic calibrator, for code shared with the other sensor curves. */
+    CurveCalibrator& calibrator() { return cal_; }
+
+   private:
+    /** An interval of 0 (two edges in one tick) reads as the fastest breakpoint. */
+    static float rateHz(uint32_t intervalUs) {
+        return intervalUs ? 1e6f / static_cast<float>(intervalUs) : 1e6f;
+    }
+
+    CurveCalibrator cal_;
+};
+
+}  // namespace gag
@@ -7,6 +7,7 @@
  * - Heater PWM drive.
  * - Flow, pressure and shot timing measurement with debounced ISR counters.
  * - ESP-NOW link to the display for control/telemetry.
+ * - Firmware updates relayed by the display over ESP-NOW (see ota_update.h).
  * - Brief Wi-Fi use to synchronize time over NTP.
  *
  * Hardware pins (ESP32 default board mapping):
@@ -26,8 +27,12 @@
 #include <WiFi.h>
 #include <ctype.h>
 #include <esp_now.h>
+#include <esp_system.h>
+#include <esp_task_wdt.h>
 #include <esp_timer.h>
 #include <esp_wifi.h>
+#include <freertos/queue.h>
+#include <freertos/ringbuf.h>
 #include <math.h>
 #include <string.h>
 #include <sys/time.h>
@@ -36,27 +41,64 @@
 #include <cstdarg>
 
 #include "espnow_protocol.h"
-#include "secrets.h"  // WIFI_*
+#include "curve_cal.h"
+#include "clock_sync.h"
+#include "control_packet.h"
+#include "energy_meter.h"
+#include "flight_recorder.h"
+#include "flow_cal.h"
+#include "heater_modes.h"
+#include "hot_path.h"
+#include "loop_supervisor.h"
+#include "ota_update.h"
+#include "param_store.h"
+#include "param_table.h"
+#include "phase_sampler.h"
+#include "pid.h"
+#include "puck_monitor.h"
+#include "pump_ramp.h"
+#include "record_journal.h"
+#include "shot_analytics.h"
+#include "shot_detector.h"
+#include "steam_sense.h"
+#include "stream_stats.h"
+#include "thermal_observer.h"
 #include "version.h"
 #define STARTUP_WAIT 1000
 #define SERIAL_BAUD 115200
 
+// Serial output is written by logTask() on core 0; LOG() only queues the line,
+// so a full UART never blocks the control loop. Until the task runs (early
+// boot, or if it could not be created) lines go straight to the port.
+static RingbufHandle_t g_logRing = nullptr;
+static volatile uint32_t g_logDropped = 0;       // since logTask() last reported
+static volatile uint32_t g_logDroppedTotal = 0;  // since boot, for the health report
+
 /**
  * @brief Lightweight printf-style logger to the serial console.
  */
-static inline void LOG(const char* fmt, ...) {
-    static char buf[192];
-    va_list args;
-    va_start(args, fmt);
-    vsnprintf(buf, sizeof(buf), fmt, args);
-    va_end(args);
+static void LOG(const char* fmt, ...) {
+    char line[224];
     struct timeval tv;
     gettimeofday(&tv, nullptr);
     struct tm tm;
     localtime_r(&tv.tv_sec, &tm);
-    char tbuf[32];
-    strftime(tbuf, sizeof(tbuf), "%Y-%m-%d %H:%M:%S", &tm);
-    Serial.printf("[%s.%03ld] %s\n", tbuf, tv.tv_usec / 1000, buf);
+    size_t n = strftime(line, sizeof(line), "[%Y-%m-%d %H:%M:%S", &tm);
+    n += snprintf(line + n, sizeof(line) - n, ".%03ld] ", tv.tv_usec / 1000);
+    size_t room = sizeof(line) - n - 1;  // keep a byte for the newline
+    va_list args;
+    va_start(args, fmt);
+    int m = vsnprintf(line + n, room, fmt, args);
+    va_end(args);
+    if (m > 0) n += static_cast<size_t>(m) < room ? m : room - 1;
+    line[n++] = '\n';
+
+    if (!g_logRing) {
+        Serial.write(reinterpret_cast<const uint8_t*>(line), n);
+    } else if (xRingbufferSend(g_logRing, line, n, 0) != pdTRUE) {
+        g_logDropped = g_logDropped + 1;
+        g_logDroppedTotal = g_logDroppedTotal + 1;
+    }
 }
 
 /**
@@ -87,12 +129,17 @@ constexpr uint8_t ESPNOW_FIRST_CHANNEL = 1;
 constexpr uint8_t ESPNOW_LAST_CHANNEL = 13;
 constexpr uint8_t ESPNOW_BROADCAST_ADDR[ESP_NOW_ETH_ALEN] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
 
-// Brew & Steam setpoint limits
-constexpr float BREW_MIN = 87.0f, BREW_MAX = 97.0f;
-constexpr float STEAM_MIN_C = 145.0f, STEAM_MAX_C = 155.0f;
+// Brew & Steam setpoint limits (tunables, their defaults and ranges live in param_registry.h)
+constexpr float BREW_MIN = PARAM_DEFS[PARAM_INDEX_BREW_SETPOINT].min,
+                BREW_MAX = PARAM_DEFS[PARAM_INDEX_BREW_SETPOINT].max;
+constexpr float STEAM_MIN_C = PARAM_DEFS[PARAM_INDEX_STEAM_SETPOINT].min,
+                STEAM_MAX_C = PARAM_DEFS[PARAM_INDEX_STEAM_SETPOINT].max;
+// Eco hold requested by the display's warm-up scheduler (whole degC, 0 = off)
+constexpr float ECO_MIN_C = 50.0f, ECO_MAX_C = BREW_MIN;
 
 // Default steam setpoint (within limits)
-constexpr float STEAM_DEFAULT = 152.0f;
+constexpr float BREW_DEFAULT = PARAM_DEFS[PARAM_INDEX_BREW_SETPOINT].def;
+constexpr float STEAM_DEFAULT = PARAM_DEFS[PARAM_INDEX_STEAM_SETPOINT].def;
 
 constexpr float RREF = 430.0f, RNOMINAL = 100.0f;
 // Default PID params (overridable via ESP-NOW control packets)
@@ -101,8 +148,18 @@ constexpr float RREF = 430.0f, RNOMINAL = 100.0f;
 // Ki: 0.3-0.5 [out/(degC*s)] -> start at 0.35
 // Kd: 50-70 [out*s/degC] -> start at 60
 // guard: +/-8-+/-12% integral clamp on 0-100% heater
-constexpr float P_GAIN_TEMP = 8.0f, I_GAIN_TEMP = 0.40f, D_GAIN_TEMP = 17.0, DTAU_TEMP = 0.8f,
-                WINDUP_GUARD_TEMP = 25.0f;
+constexpr float P_GAIN_TEMP = PARAM_DEFS[PARAM_INDEX_HEATER_KP].def,
+                I_GAIN_TEMP = PARAM_DEFS[PARAM_INDEX_HEATER_KI].def,
+                D_GAIN_TEMP = PARAM_DEFS[PARAM_INDEX_HEATER_KD].def,
+                DTAU_TEMP = PARAM_DEFS[PARAM_INDEX_HEATER_DTAU].def,
+                WINDUP_GUARD_TEMP = PARAM_DEFS[PARAM_INDEX_HEATER_I_GUARD].def;
+// Brew/steam gain sets and transition timing (see heater_modes.h)
+constexpr gag::HeaterModes::Config HEATER_MODES_CFG = {
+    2.0f,   // readyBandC
+    1.0f,   // holdBandC
+    60.0f,  // holdTauS
+};
+constexpr uint8_t HEATER_MODES_REPEATS = 3;  // sends per transition, ESP_CYCLE apart
 
 // Derivative filter time constant (seconds), exposed to HA
 
@@ -110,34 +167,146 @@ dimmerLamp pumpDimmer(PUMP_PIN, ZC_PIN);
 
 // Pressure calibration constants
 constexpr float PRESSURE_TOL = 1.0f, PRESS_GRAD = 0.00903f, PRESS_INT_0 = -4.0f;
-constexpr int PRESS_BUFF_SIZE = 14;
+// The legacy fit above is per raw 12-bit count. The transducer curve works on
+// eFuse-calibrated millivolts, so the default curve converts it with the
+// nominal 11 dB full scale until a calibration run replaces it.
+constexpr float PRESS_NOMINAL_MV_PER_COUNT = 3300.0f / 4095.0f;
+constexpr float PRESS_CURVE_MIN_BAR = -0.5f, PRESS_CURVE_MAX_BAR = 13.0f;
+constexpr unsigned long PRESS_ZERO_IDLE_MS = 15000;  // pump quiet this long before auto-zero
+constexpr gag::Q16_16 PRESS_ZERO_TAU_S(5.0f);        // auto-zero time constant
+constexpr gag::Q16_16 PRESS_ZERO_TOL(PRESSURE_TOL);  // largest offset auto-zero absorbs
+// Each sample is already a ripple-free mains-cycle mean (or a 20 ms idle
+// read), so a short buffer is enough for the pre-flow threshold.
+constexpr int PRESS_BUFF_SIZE = 4;
+constexpr unsigned long PRESS_IDLE_SAMPLE_MS = 20;  // cadence while no zero-crosses arrive
 constexpr float PRESS_THRESHOLD = 9.0f;
 
-// FLOW_CAL in mL per pulse (1 cc == 1 mL)
+// FLOW_CAL in mL per pulse (1 cc == 1 mL); nominal value of the flow curve
 constexpr float FLOW_CAL = 0.246f;
 constexpr unsigned long PULSE_MIN = 3;  // ms debounce (bounce + double-edges)
+constexpr uint32_t FLOW_RING_SIZE = 64;  // pulse intervals buffered between loop() passes
+
+// Shot analytics
+constexpr float SHOT_DRIP_VOLUME_ML = 20.0f;  // basket headspace + puck absorption (~18 g dose)
+constexpr float PUMP_RATED_W = 48.0f;         // Ulka EX5 vibratory pump
+constexpr unsigned long SHOT_SUMMARY_MIN_MS = 5000;  // shorter pump runs are flushes
+constexpr uint8_t SHOT_SUMMARY_REPEATS = 3;          // sends per summary, ESP_CYCLE apart
+
+// Puck resistance / channeling detection (see puck_monitor.h)
+constexpr gag::PuckMonitor::Config PUCK_CFG = {
+    4.0f,   // armBar
+    0.3f,   // minFlowMlS
+    3.0f,   // armDelayS
+    0.5f,   // filterTauS
+    8.0f,   // baselineTauS
+    25.0f,  // dropPct
+    20.0f,  // slopePctS
+    2.0f,   // holdS
+};
+// In pressure mode, lower the pressure target by puckEaseBar (PARAM_ID_PUCK_EASE)
+// while a channeling event is held so the pump stops driving water through the channel.
+constexpr bool PUCK_EASE_ENABLED = true;
+
+// Heater/pump usage metering (see energy_meter.h). The element rating is the
+// heaterElementW parameter (PARAM_ID_HEATER_ELEMENT_W).
+constexpr int64_t PUMP_ON_ZC_GAP_US = 100000;  // pump counts as running within this of a zero-cross
+constexpr unsigned long ENERGY_SAVE_MS = 600000;  // persist at most this much unsaved usage
+constexpr unsigned long ENERGY_SEND_MS = 5000;
+
+// Control-loop supervision (see loop_supervisor.h). The MAX31865 one-shot
+// conversion holds the PID pass for ~75 ms, which sets the floor for the
+// deadline; a stall of one heater PWM window forces the outputs off.
+constexpr uint32_t LOOP_DEADLINE_US = 100000;
+constexpr uint32_t LOOP_TRIP_US = 250000;
+constexpr uint64_t LOOP_SUPERVISOR_PERIOD_US = 10000;
+constexpr uint32_t LOOP_WDT_TIMEOUT_S = 3;  // task watchdog: reboot if loop() stops returning
+constexpr unsigned long LOOP_STATS_SEND_MS = 5000;
+constexpr unsigned long HEALTH_SEND_MS = 10000;
+constexpr unsigned long LOOP_OVERRUN_LOG_MS = 10000;  // rate limit for overrun log lines
+// Flight recorder: 128 samples at 50 ms keep the last 6.4 s before a reset.
+constexpr uint16_t FLIGHT_SAMPLE_MS = 50;
+constexpr unsigned long FLIGHT_SEND_GAP_MS = 50;  // between chunks after a link-up
+// Subscribed parameters are pushed to the display at most this often.
+constexpr unsigned long PARAM_REPORT_MS = 100;
+// Follow each telemetry packet with min/max/mean/last of every sample taken
+// since the previous one (EspNowTelemetryStats).
+constexpr bool TELEMETRY_STATS_ENABLED = true;
+
+// Boiler/group thermal observer (see thermal_observer.h). Rough Gaggia Classic
+// figures; replace with the output of tools/thermal_fit.py for a given machine.
+constexpr gag::ThermalObserver::Params THERMAL_PARAMS = {
+    PARAM_DEFS[PARAM_INDEX_HEATER_ELEMENT_W].def,  // heaterW, tracks heaterElementW
+    900.0f,   // boilerJK
+    350.0f,   // groupJK
+    2.0f,     // boilerGroupWK
+    0.25f,    // boilerAmbWK
+    0.15f,    // groupAmbWK
+    25.0f,    // ambientC
+    22.0f,    // inletC
+    0.2f,     // gainBoiler
+    0.05f,    // gainGroup
+};
+// Run the brew PID on the estimated brew-water temperature instead of the
+// boiler sensor; the brew setpoint then means water at the group. Steam
+// always regulates on the sensor.
+constexpr bool THERMAL_PID_ON_ESTIMATE = false;
+constexpr float WATER_G_PER_ML = 0.997f;  // reference mass -> volume for flow calibration
+// {yMin, yMax, minSamples, minReference, errorScale, maxErrorPct}; errors are
+// relative to 12 bar full scale so a 0 bar point is usable.
+const gag::CurveCalibrator::Limits PRESS_CAL_LIMITS = {-2.0f, 20.0f, 10, -0.5f, 12.0f, 25.0f};
+
+/**
+ * @brief Pressure curve (mV -> bar) equivalent to a linear per-count fit.
+ */
+gag::CalCurve pressureCurveDefault(float barPerCount, float interceptBar) {
+    gag::CalCurve c;
+    const float barPerMv = barPerCount / PRESS_NOMINAL_MV_PER_COUNT;
+    const float step = (PRESS_CURVE_MAX_BAR - PRESS_CURVE_MIN_BAR) / (gag::CAL_POINTS - 1);
+    for (int i = 0; i < gag::CAL_POINTS; ++i) {
+        c.y[i] = PRESS_CURVE_MIN_BAR + step * i;
+        c.x[i] = (c.y[i] - interceptBar) / barPerMv;
+    }
+    return c;
+}
 
 constexpr unsigned ZC_MIN = 4;
 // Duration thresholds for zero-cross (pump) activity
 constexpr unsigned long ZC_WAIT = 2000, ZC_OFF = 1000, SHOT_RESET = 60000;
-constexpr unsigned long AC_WAIT = 100;
-constexpr int STEAM_MIN = 20;
-constexpr float PUMP_POWER_DEFAULT = 95.0f;
-constexpr float PRESSURE_SETPOINT_DEFAULT = 9.0f;
-constexpr float PRESSURE_SETPOINT_MIN = 0.0f;
-constexpr float PRESSURE_SETPOINT_MAX = 12.0f;
-constexpr float PUMP_PRESSURE_RAMP_RATE = 20.0f;   // % per second when ramping up in pressure mode
+// Steam switch sensing on AC_SENS edges. The opto pulses at mains rate (or
+// sits low when filtered), so AC counts as present while the input is low or
+// an edge arrived within AC_HOLD_MS. Steam is declared once AC has been
+// present for STEAM_DETECT_MS with the pump idle for ZC_OFF; a periodic timer
+// evaluates this so detection latency does not depend on loop() throughput.
+constexpr unsigned long AC_HOLD_MS = 30;  // > one 50 Hz cycle
+constexpr unsigned long STEAM_DETECT_MS = 200;
+constexpr unsigned long STEAM_SENSE_TICK_MS = 10;
+constexpr float PUMP_POWER_DEFAULT = PARAM_DEFS[PARAM_INDEX_PUMP_POWER].def;
+constexpr float PRESSURE_SETPOINT_DEFAULT = PARAM_DEFS[PARAM_INDEX_PRESSURE_SETPOINT].def;
+constexpr float PRESSURE_SETPOINT_MIN = PARAM_DEFS[PARAM_INDEX_PRESSURE_SETPOINT].min;
+constexpr float PRESSURE_SETPOINT_MAX = PARAM_DEFS[PARAM_INDEX_PRESSURE_SETPOINT].max;
 constexpr float PUMP_PRESSURE_RAMP_MAX_DT = 0.2f;  // Max dt (s) considered for ramp calculations
-constexpr float PUMP_PRESSURE_INITIAL_CLAMP = 40.0f;  // Max % for first second when pump engages
-constexpr unsigned long PUMP_PRESSURE_CLAMP_DURATION_MS = 1000;
-constexpr float PUMP_PRESSURE_KP = 5.0f;
-constexpr float PUMP_PRESSURE_KI = 1.0f;
-constexpr float PUMP_PRESSURE_KD = 10.0f;
-constexpr float PUMP_PRESSURE_I_GUARD = 25.0f;
-constexpr float PUMP_PRESSURE_OUTPUT_SCALE = 0.6f;
-constexpr float PUMP_PRESSURE_OUTPUT_OFFSET = 35.0f;
+// The pressure loop's gains, ramp and start clamp are live-tunable (pGainPump etc. below).
+
+// The SSR can only add heat: above the setpoint only D acts, and the integral
+// restarts from zero. Gain changes from the display are bumpless.
+struct HeaterPidConfig {
+    static constexpr float OUT_MIN = 0.0f, OUT_MAX = 100.0f;
+    static constexpr bool DERIVATIVE_FILTER = true, CONDITIONAL_INTEGRATION = true,
+                          SETPOINT_WEIGHTING = false, BUMPLESS = true, RESET_I_AT_SETPOINT = true,
+                          P_BELOW_SETPOINT_ONLY = true;
+};
+// The pump loop keeps P above the setpoint so overshoot backs the pump off.
+struct PumpPidConfig {
+    static constexpr float OUT_MIN = 0.0f, OUT_MAX = 100.0f;
+    static constexpr bool DERIVATIVE_FILTER = true, CONDITIONAL_INTEGRATION = true,
+                          SETPOINT_WEIGHTING = false, BUMPLESS = false, RESET_I_AT_SETPOINT = true,
+                          P_BELOW_SETPOINT_ONLY = false;
+};
+using HeaterPid = gag::Pid<float, HeaterPidConfig>;
+using PumpPid = gag::Pid<float, PumpPidConfig>;
 
 const bool debugPrint = true;
+const bool thermalTrace = false;  // TRACE lines for tools/thermal_fit.py, every PID pass
 }  // namespace
 
 // ---------- Devices / globals ----------
@@ -145,26 +314,25 @@ namespace {
 Adafruit_MAX31865 max31865(MAX_CS);
 // Rolling buffer of recent significant error messages
 static String g_errorLog;
-// Tracks whether the RTC has successfully synchronized with NTP
+// Tracks whether the RTC has been set from the display's clock
 static bool g_clockSynced = false;
-static bool g_wifiNtpConnecting = false;
+// Boot phase timestamps (esp_timer us since start-up, 0 = not reached yet).
+// Control comes up in setup(); radio, link and clock arrive from netTask().
+struct BootTimeline {
+    int64_t setupUs, controlUs, firstPidUs, radioUs, linkUs, clockUs;
+};
+BootTimeline g_boot{};
 
 /**
  * @brief Log a significant error and persist it in memory.
  */
-static inline void LOG_ERROR(const char* fmt, ...) {
-    static char buf[192];
+static void LOG_ERROR(const char* fmt, ...) {
+    char buf[192];
     va_list args;
     va_start(args, fmt);
     vsnprintf(buf, sizeof(buf), fmt, args);
     va_end(args);
-    struct timeval tv;
-    gettimeofday(&tv, nullptr);
-    struct tm tm;
-    localtime_r(&tv.tv_sec, &tm);
-    char tbuf[32];
-    strftime(tbuf, sizeof(tbuf), "%Y-%m-%d %H:%M:%S", &tm);
-    Serial.printf("[%s.%03ld] %s\n", tbuf, tv.tv_usec / 1000, buf);
+    LOG("%s", buf);
 
     if (!g_errorLog.isEmpty()) g_errorLog += '\n';
     g_errorLog += buf;
@@ -177,28 +345,59 @@ static inline void LOG_ERROR(const char* fmt, ...) {
     }
 }
 
-static void syncClock() {
-    configTime(0, 0, "pool.ntp.org");
-    struct tm tm;
-    if (getLocalTime(&tm, 5000)) {
-        LOG("RTC: %04d-%02d-%02d %02d:%02d:%02d", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
-            tm.tm_hour, tm.tm_min, tm.tm_sec);
-        g_clockSynced = true;
-    } else {
-        LOG_ERROR("RTC: sync failed");
-    }
-}
-
 // Temps / PID
-float currentTemp = 0.0f, lastTemp = 0.0f, pvFiltTemp = 0.0f;
-float brewSetpoint = 92.0f;           // HA-controllable (90?99)
+float currentTemp = 0.0f, lastTemp = 0.0f;
+float brewSetpoint = BREW_DEFAULT;    // HA-controllable (90?99)
 float steamSetpoint = STEAM_DEFAULT;  // HA-controllable (145?155)
-float setTemp = brewSetpoint;         // active target (brew or steam)
-float iStateTemp = 0.0f, heatPower = 0.0f;
+float setTemp = brewSetpoint;         // active target (brew, eco or steam)
+float ecoSetpoint = 0.0f;             // display-requested eco hold, 0 = off; never persisted
+float heatPower = 0.0f;
 // Live-tunable PID parameters (default to constexprs above)
 float pGainTemp = P_GAIN_TEMP, iGainTemp = I_GAIN_TEMP, dGainTemp = D_GAIN_TEMP,
       dTauTemp = DTAU_TEMP, windupGuardTemp = WINDUP_GUARD_TEMP;
-float pidPTerm = 0.0f, pidITerm = 0.0f, pidDTerm = 0.0f;
+// Steam-mode gain set, live-tunable through the parameter registry
+float pGainSteam = PARAM_DEFS[PARAM_INDEX_STEAM_KP].def,
+      iGainSteam = PARAM_DEFS[PARAM_INDEX_STEAM_KI].def,
+      dGainSteam = PARAM_DEFS[PARAM_INDEX_STEAM_KD].def,
+      windupGuardSteam = PARAM_DEFS[PARAM_INDEX_STEAM_I_GUARD].def,
+      dTauSteam = PARAM_DEFS[PARAM_INDEX_STEAM_DTAU].def;
+// Persisted tuning/calibration (loaded in setup(), saved from loop() when it changes)
+gag::ParamStore g_paramStore;
+gag::PersistentParams g_params{brewSetpoint,
+                               steamSetpoint,
+                               P_GAIN_TEMP,
+                               I_GAIN_TEMP,
+                               D_GAIN_TEMP,
+                               DTAU_TEMP,
+                               WINDUP_GUARD_TEMP,
+                               PRESS_GRAD,
+                               PRESS_INT_0,
+                               FLOW_CAL,
+                               gag::flowCalDefault(FLOW_CAL),
+                               pressureCurveDefault(PRESS_GRAD, PRESS_INT_0),
+                               PARAM_DEFS[PARAM_INDEX_PUMP_KP].def,
+                               PARAM_DEFS[PARAM_INDEX_PUMP_KI].def,
+                               PARAM_DEFS[PARAM_INDEX_PUMP_KD].def,
+                               PARAM_DEFS[PARAM_INDEX_PUMP_I_GUARD].def,
+                               PARAM_DEFS[PARAM_INDEX_PUMP_DTAU].def,
+                               PARAM_DEFS[PARAM_INDEX_PUMP_OUTPUT_SCALE].def,
+                               PARAM_DEFS[PARAM_INDEX_PUMP_OUTPUT_OFFSET].def,
+                               PARAM_DEFS[PARAM_INDEX_PUMP_RAMP_RATE].def,
+                               PARAM_DEFS[PARAM_INDEX_PUMP_START_CLAMP].def,
+                               PARAM_DEFS[PARAM_INDEX_PUMP_START_CLAMP_MS].def,
+                               PARAM_DEFS[PARAM_INDEX_PUCK_EASE].def,
+                               PARAM_DEFS[PARAM_INDEX_STEAM_KP].def,
+                               PARAM_DEFS[PARAM_INDEX_STEAM_KI].def,
+                               PARAM_DEFS[PARAM_INDEX_STEAM_KD].def,
+                               PARAM_DEFS[PARAM_INDEX_STEAM_I_GUARD].def,
+                               PARAM_DEFS[PARAM_INDEX_STEAM_DTAU].def,
+                               PARAM_DEFS[PARAM_INDEX_HEATER_ELEMENT_W].def};
+HeaterPid g_heaterPid({P_GAIN_TEMP, I_GAIN_TEMP, D_GAIN_TEMP, WINDUP_GUARD_TEMP, DTAU_TEMP, 1.0f});
+gag::HeaterModes g_heaterModes(HEATER_MODES_CFG);
+EspNowHeaterModes g_heaterModesMsg{};
+uint16_t g_heaterModesSeq = 0;
+uint8_t g_heaterModesRepeats = 0;
+unsigned long g_lastHeaterModesSendMs = 0;
 int heatCycles = 0;
 bool heaterState = false;
 bool heaterEnabled = true;             // HA switch default ON at boot
@@ -206,20 +405,90 @@ float pumpPowerCommand = PUMP_POWER_DEFAULT;  // Requested pump power (%), overr
 float pumpPower = PUMP_POWER_DEFAULT;         // Last applied pump power (%) reported to sensors
 float pressureSetpointBar = PRESSURE_SETPOINT_DEFAULT;  // Target brew pressure in bar
 bool pumpPressureModeEnabled = false;  // When true limit pump power to pressure setpoint
-float lastPumpApplied = 0.0f;          // Actual power sent to dimmer after ramp/limits
-float lastPumpRequested = 0.0f;        // Last requested pump power
-unsigned long pumpPressureClampUntilMs = 0;
-unsigned long lastPumpApplyMs = 0;       // Timestamp of last pump power application
-float pumpPressurePvFilt = 0.0f;
-float pumpPressureISum = 0.0f;
-bool pumpPressurePidInitialized = false;
+// Pressure-mode pump loop, live-tunable through the parameter registry
+float pGainPump = PARAM_DEFS[PARAM_INDEX_PUMP_KP].def,
+      iGainPump = PARAM_DEFS[PARAM_INDEX_PUMP_KI].def,
+      dGainPump = PARAM_DEFS[PARAM_INDEX_PUMP_KD].def,
+      windupGuardPump = PARAM_DEFS[PARAM_INDEX_PUMP_I_GUARD].def,
+      dTauPump = PARAM_DEFS[PARAM_INDEX_PUMP_DTAU].def;
+float pumpOutputScale = PARAM_DEFS[PARAM_INDEX_PUMP_OUTPUT_SCALE].def;    // PID output -> % power
+float pumpOutputOffset = PARAM_DEFS[PARAM_INDEX_PUMP_OUTPUT_OFFSET].def;  // % power at PID output 0
+float pumpRampRate = PARAM_DEFS[PARAM_INDEX_PUMP_RAMP_RATE].def;  // % per second when ramping up
+float pumpStartClamp = PARAM_DEFS[PARAM_INDEX_PUMP_START_CLAMP].def;  // max % right after engaging
+float pumpStartClampMs = PARAM_DEFS[PARAM_INDEX_PUMP_START_CLAMP_MS].def;  // ... for this long
+float puckEaseBar = PARAM_DEFS[PARAM_INDEX_PUCK_EASE].def;
+float heaterElementW = PARAM_DEFS[PARAM_INDEX_HEATER_ELEMENT_W].def;  // boiler element rating
+PumpPid g_pumpPid({pGainPump, iGainPump, dGainPump, windupGuardPump, dTauPump, 1.0f});
+gag::PumpRamp g_pumpRamp({pumpRampRate, pumpStartClamp, static_cast<uint32_t>(pumpStartClampMs),
+                          PUMP_PRESSURE_RAMP_MAX_DT, PRESS_CYCLE / 1000.0f});
+// Registry parameters (param_registry.h) and the variables behind them
+const gag::ParamBinding PARAM_BINDINGS[] = {
+    {PARAM_ID_BREW_SETPOINT, &brewSetpoint},
+    {PARAM_ID_STEAM_SETPOINT, &steamSetpoint},
+    {PARAM_ID_HEATER_KP, &pGainTemp},
+    {PARAM_ID_HEATER_KI, &iGainTemp},
+    {PARAM_ID_HEATER_KD, &dGainTemp},
+    {PARAM_ID_HEATER_I_GUARD, &windupGuardTemp},
+    {PARAM_ID_HEATER_DTAU, &dTauTemp},
+    {PARAM_ID_STEAM_KP, &pGainSteam},
+    {PARAM_ID_STEAM_KI, &iGainSteam},
+    {PARAM_ID_STEAM_KD, &dGainSteam},
+    {PARAM_ID_STEAM_I_GUARD, &windupGuardSteam},
+    {PARAM_ID_STEAM_DTAU, &dTauSteam},
+    {PARAM_ID_PUMP_POWER, &pumpPowerCommand},
+    {PARAM_ID_PRESSURE_SETPOINT, &pressureSetpointBar},
+    {PARAM_ID_PUMP_KP, &pGainPump},
+    {PARAM_ID_PUMP_KI, &iGainPump},
+    {PARAM_ID_PUMP_KD, &dGainPump},
+    {PARAM_ID_PUMP_I_GUARD, &windupGuardPump},
+    {PARAM_ID_PUMP_DTAU, &dTauPump},
+    {PARAM_ID_PUMP_OUTPUT_SCALE, &pumpOutputScale},
+    {PARAM_ID_PUMP_OUTPUT_OFFSET, &pumpOutputOffset},
+    {PARAM_ID_PUMP_RAMP_RATE, &pumpRampRate},
+    {PARAM_ID_PUMP_START_CLAMP, &pumpStartClamp},
+    {PARAM_ID_PUMP_START_CLAMP_MS, &pumpStartClampMs},
+    {PARAM_ID_PUCK_EASE, &puckEaseBar},
+    {PARAM_ID_HEATER_ELEMENT_W, &heaterElementW},
+};
+gag::ParamTable g_paramTable(PARAM_BINDINGS, sizeof(PARAM_BINDINGS) / sizeof(PARAM_BINDINGS[0]));
 
 // Pressure
-int rawPress = 0;
-float lastPress = 0.0f, pressNow = 0.0f, pressSum = 0.0f, pressGrad = PRESS_GRAD,
-      pressInt = PRESS_INT_0;
+int pressMv = 0;           // eFuse-calibrated ADC reading
+gag::Q16_16 pressZeroBar;  // auto-zero offset added to the curve output
+int64_t lastPressSampleUs = 0;
+float lastPress = 0.0f, pressNow = 0.0f, pressSum = 0.0f;
+gag::CurveCalibrator pressCalibrator(pressureCurveDefault(PRESS_GRAD, PRESS_INT_0),
+                                     PRESS_CAL_LIMITS);
 float pressBuff[PRESS_BUFF_SIZE] = {0};
 uint8_t pressBuffIdx = 0;
+// Zero-cross locked sampling: the ZC hook arms the timer, its callback reads
+// the ADC at fixed phase offsets and loop() picks up one mean per mains cycle.
+gag::PhaseSampler g_phaseSampler;
+portMUX_TYPE g_phaseMux = portMUX_INITIALIZER_UNLOCKED;
+esp_timer_handle_t g_pressSampleTimer = nullptr;
+
+volatile bool g_netReady = false;  // ESP-NOW and OTA receiver initialised
+constexpr uint32_t NET_TASK_STACK = 6144;
+constexpr UBaseType_t NET_TASK_PRIO = 1;
+constexpr BaseType_t NET_TASK_CORE = 0;  // with the Wi-Fi stack, away from loop()
+constexpr unsigned long NET_TASK_PERIOD_MS = 10;
+// loop() is the control task: Arduino runs it on the app core (CONFIG_ARDUINO_RUNNING_CORE,
+// pinned in include/sdkconfig.h). Radio, clock sync, logging and the supervisor stay on core 0.
+constexpr BaseType_t CONTROL_CORE = 1;
+constexpr uint32_t LOG_TASK_STACK = 3072;
+constexpr UBaseType_t LOG_TASK_PRIO = 1;
+constexpr size_t LOG_RING_BYTES = 4096;
+
+// Clock sync against the display: a burst of exchanges, keep the fastest.
+constexpr int TIME_BURST_SAMPLES = 4;
+constexpr int64_t TIME_BURST_GAP_US = 250LL * 1000;
+constexpr int64_t TIME_POLL_US = 64LL * 1000000;    // once synced
+constexpr int64_t TIME_RETRY_US = 2LL * 1000000;    // until synced / after a failed burst
+constexpr int64_t TIME_MAX_RTT_US = 30LL * 1000;    // slower exchanges are discarded
+constexpr int64_t TIME_DISCIPLINE_US = 10LL * 1000000;  // re-set the RTC from the model
+gag::ClockSync g_clockSync;  // samples from espNowRecv(), bursts committed by netTask()
+portMUX_TYPE g_timeMux = portMUX_INITIALIZER_UNLOCKED;
+uint8_t g_timeSeq = 0;
 
 // Time/shot
 unsigned long nLoop = 0, currentTime = 0, lastPidTime = 0, lastPwmTime = 0, lastEspNowTime = 0,
@@ -231,12 +500,98 @@ float shotTime = 0;  //
 
 // Flow / flags
 volatile unsigned long pulseCount = 0;
+volatile uint32_t flowIsrs = 0;  // every flow edge, including ones the debounce rejects
+// Debounced pulse intervals (us) from the ISR; loop() converts each through the flow curve
+volatile uint32_t flowIntervals[FLOW_RING_SIZE] = {0};
+volatile uint32_t flowRingHead = 0;
+uint32_t flowRingTail = 0;
+float flowVolMl = 0.0f;
+gag::FlowCalibrator flowCalibrator(FLOW_CAL);
+// Calibration command handed from the ESP-NOW callback to loop()
+EspNowCalCommand g_calCommand{};
+volatile bool g_calCommandPending = false;
+// Parameter get/set/subscribe frames handed from the ESP-NOW callback to loop()
+struct ParamRequest {
+    uint8_t len;
+    uint8_t data[ESPNOW_PARAM_VALUES_SIZE];
+};
+constexpr unsigned PARAM_QUEUE_DEPTH = 8;  // a burst of web UI posts between two passes
+QueueHandle_t g_paramQueue = nullptr;
+unsigned long g_lastParamReportMs = 0;
+struct CalSession {
+    const char* name;
+    gag::CurveCalibrator* cal;
+    EspNowCalState state;
+    gag::CurveCalibrator::Result result;
+};
+// Indexed by EspNowCalTarget
+CalSession g_calSessions[] = {
+    {"flow", &flowCalibrator.calibrator(), ESPNOW_CAL_STATE_IDLE, {}},
+    {"pressure", &pressCalibrator, ESPNOW_CAL_STATE_IDLE, {}},
+};
+constexpr size_t CAL_SESSION_COUNT = sizeof(g_calSessions) / sizeof(g_calSessions[0]);
+unsigned long g_lastCalReportMs = 0;
+gag::ShotAnalytics g_shotAnalytics({SHOT_DRIP_VOLUME_ML, PUMP_RATED_W});
+EspNowShotSummary g_shotSummaryMsg{};
+uint8_t g_shotSummaryRepeats = 0;
+uint16_t g_shotId = 0;
+gag::PuckMonitor g_puck(PUCK_CFG);
+bool g_puckEventPending = false;  // set on the hot path, logged by loop()
+gag::ThermalObserver g_thermal(THERMAL_PARAMS);
+float g_thermalLastVol = 0.0f;
+gag::EnergyMeter g_energy;
+gag::RecordJournal g_energyJournal("energy");
+unsigned long g_lastEnergySaveMs = 0;
+bool g_energyBootUnsaved = false;  // this boot is counted but not yet in NVS
+unsigned long g_lastEnergySendMs = 0;
+bool g_energyHeaterWasEnabled = true;
+gag::LoopSupervisor g_loopSup({LOOP_DEADLINE_US, LOOP_TRIP_US});
+esp_timer_handle_t g_loopSupTimer = nullptr;
+bool g_wdtReset = false;  // this boot follows a watchdog reset
+unsigned long g_lastLoopStatsSendMs = 0;
+unsigned long g_lastHealthSendMs = 0;
+uint32_t g_healthLoopTicks = 0;  // loop passes at the last health report
+unsigned long g_lastOverrunLogMs = 0;
+// CPU cycles per hot-path section, indexed by EspNowLoopHotSection
+gag::CycleStats g_hotCycles[ESPNOW_LOOP_HOT_SECTIONS];
+// Samples since the last telemetry send, indexed by EspNowStatsChannel
+gag::StreamStats g_windowStats[ESPNOW_STATS_CHANNELS];
+unsigned long g_statsWindowStartMs = 0;
+// Not cleared by the boot code, so the previous run's samples are still there.
+RTC_NOINIT_ATTR gag::FlightLog g_flightLog;
+gag::FlightRecorder g_flight(g_flightLog, FLIGHT_SAMPLE_MS);
+gag::FlightRecord g_flightPrev;  // previous run, sent after each link-up
+bool g_flightHavePrev = false;
+uint8_t g_flightResetReason = 0;
+uint16_t g_flightSendNext = 0;  // next sample of g_flightPrev to send
+bool g_flightLinked = false;
+unsigned long g_lastFlightSendMs = 0;
+// Indexed by EspNowLoopStage
+const char* const LOOP_STAGE_NAMES[ESPNOW_LOOP_STAGE_COUNT] = {
+    "other", "link", "shot", "pid", "pwm", "pressure", "flow",
+    "steam", "analytics", "cal", "params", "ota", "telemetry", "log",
+};
+unsigned long g_lastShotSummarySendMs = 0;
 volatile unsigned long zcCount = 0;
 volatile unsigned long lastZcCount = 0;
 volatile int64_t lastZcTime = 0;  // microsecond timestamp
+gag::ShotDetector g_shotDetector({ZC_MIN, ZC_WAIT, SHOT_RESET});
 float vol = 0.0f, preFlowVol = 0.0f, shotVol = 0.0f;
-bool prevSteamFlag = false, ac = false;
-int acCount = 0;
+bool prevSteamFlag = false;
+volatile bool ac = false;  // AC present on AC_SENS, as last seen by steamSenseTimerCb()
+uint32_t acCount = 0;      // AC_SENS edges in the current AC run
+// AC_SENS edge timestamps from acSenseInt(), guarded by g_acMux
+int64_t acLastEdgeUs = 0, acRunStartUs = 0;
+uint32_t acEdges = 0;
+volatile uint32_t acIsrs = 0;  // AC_SENS edges since boot
+portMUX_TYPE g_acMux = portMUX_INITIALIZER_UNLOCKED;
+esp_timer_handle_t g_steamSenseTimer = nullptr;
+// Written by steamSenseTimerCb(), applied to the steam flags by loop()
+volatile bool steamHwDetected = false;
+volatile uint32_t steamDetectMs = 0;  // switch-on to detection of the last steam entry
+gag::SteamSense g_steamSense({static_cast<int64_t>(AC_HOLD_MS) * 1000,
+                              static_cast<int64_t>(ZC_OFF) * 1000,
+                              static_cast<int64_t>(STEAM_DETECT_MS) * 1000});
 bool shotFlag = false, preFlow = false, steamFlag = false, steamDispFlag = false,
      steamHwFlag = false, steamResetPending = false, setupComplete = false, debugData = false;
 
@@ -247,6 +602,10 @@ static String g_espnowMac;
 static bool g_espnowHandshake = false;
 static uint8_t g_displayMac[ESP_NOW_ETH_ALEN] = {0};
 static bool g_haveDisplayPeer = false;
+// Link counters for the health report. Delivery results and received frames
+// come from the Wi-Fi task only; driver errors from any sender, so atomically.
+static volatile uint32_t g_espnowSendOk = 0, g_espnowSendNoAck = 0, g_espnowRecvFrames = 0;
+static uint32_t g_espnowSendErrors = 0;
 static uint32_t g_lastControlRevision = 0;
 static unsigned long g_lastDisplayAckMs = 0;
 static EspNowPumpMode pumpMode = ESPNOW_PUMP_MODE_NORMAL;
@@ -259,104 +618,110 @@ static unsigned long g_lastChannelHopMs = 0;
 
 static bool applyEspNowChannel(uint8_t channel, bool forceSetWifiChannel, bool silent);
 
-// ---------- helpers ----------
 /**
- * @brief Convert Wi-Fi status to a readable string.
+ * @brief esp_now_send() that counts frames the driver refuses.
  */
-static inline const char* wifiStatusName(wl_status_t s) {
-    switch (s) {
-        case WL_IDLE_STATUS:
-            return "IDLE";
-        case WL_NO_SSID_AVAIL:
-            return "NO_SSID";
-        case WL_SCAN_COMPLETED:
-            return "SCAN_DONE";
-        case WL_CONNECTED:
-            return "CONNECTED";
-        case WL_CONNECT_FAILED:
-            return "CONNECT_FAILED";
-        case WL_CONNECTION_LOST:
-            return "CONNECTION_LOST";
-        case WL_DISCONNECTED:
-            return "DISCONNECTED";
-        default:
-            return "UNKNOWN";
-    }
-}
-// ------------------------------------------------------------------------------
-//  PID: dt-scaled I & D, iTerm clamp, derivative LPF, conditional integration
-// ------------------------------------------------------------------------------
-static float calcPID(float Kp, float Ki, float Kd, float sp, float pv,
-                     float dt,       // seconds (0.5 at 2 Hz)
-                     float& pvFilt,  // filtered PV (state)
-                     float& iSum,    // ?err dt  (state)
-                     float guard,    // clamp on iTerm (output units)
-                     float dTau = 0.8f) {
-    // 1) Error
-    ;                     // derivative LPF time const (s)
-    float outMin = 0.0f;  // actuator limits (for cond. integration)
-    float outMax = 100.0f;
-
-    float err = sp - pv;
-
-    // 2) Integral
-    if (err > 0) {
-        iSum += err * dt;
-    } else {
-        iSum = 0;
-    }
-
-    // 3) Derivative on measurement with 1st-order filter (dirty derivative)
-    //    LPF on pv: pvFilt' = (pv - pvFilt)/dTau
-    float alpha = dt / (dTau + dt);  // 0<alpha<1
-    float prevPvFilt = pvFilt;
-    pvFilt += alpha * (pv - pvFilt);           // low-pass the measurement
-    float dMeas = (pvFilt - prevPvFilt) / dt;  // derivative of filtered pv
+static esp_err_t espNowSend(const uint8_t* mac, const uint8_t* data, size_t len) {
+    esp_err_t err = esp_now_send(mac, data, len);
+    if (err != ESP_OK) __atomic_add_fetch(&g_espnowSendErrors, 1, __ATOMIC_RELAXED);
+    return err;
+}
 
-    // 4) Terms
-    float pTerm = Kp * err;
-    float iTerm = Ki * iSum;
-    // clamp the CONTRIBUTION of I (anti-windup)
-    if (iTerm > guard) iTerm = guard;
-    if (iTerm < -guard) iTerm = -guard;
+// --------------- espresso logic ---------------
+/**
+ * @brief Setpoint the heater should track: steam, else an eco hold, else brew.
+ */
+static float activeSetpoint() {
+    if (steamFlag) return steamSetpoint;
+    return ecoSetpoint > 0.0f ? ecoSetpoint : brewSetpoint;
+}
 
-    float dTerm = -Kd * dMeas;  // derivative on measurement
+/**
+ * @brief Zero the pulse counter and accumulated volume, dropping queued intervals.
+ */
+static void resetFlowVolume() {
+    pulseCount = 0;
+    flowRingTail = flowRingHead;
+    flowVolMl = 0.0f;
+}
 
-    // 5) Output (pre-clamp)
-    float u = pTerm + iTerm + dTerm;
+/**
+ * @brief Close the running shot analytics and queue the summary for the display.
+ */
+static void finishShotAnalytics(unsigned long endMs) {
+    gag::ShotSummary s = g_shotAnalytics.finish(endMs);
+    if (s.durationMs < SHOT_SUMMARY_MIN_MS) return;
+    g_energy.countShot();
+
+    EspNowShotSummary& m = g_shotSummaryMsg;
+    m = EspNowShotSummary{};
+    m.type = ESPNOW_SHOT_SUMMARY;
+    m.shotId = ++g_shotId;
+    m.durationMs = s.durationMs;
+    m.preinfusionMs = s.preinfusionMs;
+    m.firstDripMs = s.firstDripMs;
+    m.volumeMl = s.volumeMl;
+    m.preinfusionMl = s.preinfusionMl;
+    m.peakBar = s.peakBar;
+    m.meanBar = s.meanBar;
+    m.meanFlowMlS = s.meanFlowMlS;
+    m.tempDevCs = s.tempDevCs;
+    m.maxTempDevC = s.maxTempDevC;
+    m.pumpEnergyJ = s.pumpEnergyJ;
+    m.channelEvents = g_puck.events();
+    m.meanResistance = g_puck.meanResistance();
+    m.meanBrewC = s.meanBrewC;
+    if (m.channelEvents) m.flags |= ESPNOW_SHOT_FLAG_CHANNELING;
+    g_shotSummaryRepeats = SHOT_SUMMARY_REPEATS;
+    g_lastShotSummarySendMs = currentTime - ESP_CYCLE;
+
+    LOG("Shot %u: %.1fs %.1fmL, PI %.1fs/%.1fmL, drip %.1fs, P peak %.1f mean %.1f bar, "
+        "flow %.2fmL/s, dT %.1fC*s (max %.1f), pump %.0fJ",
+        m.shotId, s.durationMs / 1000.0f, s.volumeMl, s.preinfusionMs / 1000.0f, s.preinfusionMl,
+        s.firstDripMs / 1000.0f, s.peakBar, s.meanBar, s.meanFlowMlS, s.tempDevCs, s.maxTempDevC,
+        s.pumpEnergyJ);
+    if (m.channelEvents || m.meanResistance > 0.0f) {
+        LOG("Shot %u: puck R mean %.2f bar/(mL/s), %u channeling event(s)", m.shotId,
+            m.meanResistance, m.channelEvents);
+    }
+    if (s.meanBrewC > 0.0f) LOG("Shot %u: brew water est. mean %.1fC", m.shotId, s.meanBrewC);
+}
 
-    // 6) Conditional integration: don't integrate when pushing into saturation
-    if ((u >= outMax && err > 0.0f) || (u <= outMin && err < 0.0f)) {
-        iSum -= err * dt;  // undo this step?s integral
-        iTerm = Ki * iSum;
-        if (iTerm > guard) iTerm = guard;
-        if (iTerm < -guard) iTerm = -guard;
-        u = pTerm + iTerm + dTerm;
+/**
+ * @brief Feed the shot analytics; the shot is summarised once the pump stops.
+ */
+static void updateShotAnalytics() {
+    if (!g_shotAnalytics.active()) return;
+    int64_t lastZc = lastZcTime;
+    if (esp_timer_get_time() - lastZc > static_cast<int64_t>(ZC_OFF) * 1000) {
+        finishShotAnalytics(static_cast<unsigned long>(lastZc / 1000));
+        return;
     }
-    pidPTerm = pTerm;
-    pidITerm = iTerm;
-    pidDTerm = dTerm;
-    return u;
+    g_shotAnalytics.update(currentTime, pressNow, vol, currentTemp, setTemp, pumpPower,
+                           g_thermal.ready() ? g_thermal.brewC() : 0.0f);
 }
 
-// --------------- espresso logic ---------------
 /**
  * @brief Detect shot start/stop based on zero-cross events and steam transitions.
  */
 static void checkShotStartStop() {
-    if ((zcCount >= ZC_MIN) && !shotFlag && setupComplete &&
-        ((currentTime - startTime) > ZC_WAIT)) {
+    uint32_t zc = zcCount;
+    if (!shotFlag && setupComplete && g_shotDetector.shouldStart(zc, currentTime, startTime)) {
         shotStart = currentTime;
         shotTime = 0;
         shotFlag = true;
-        pulseCount = 0;
+        resetFlowVolume();
         preFlow = true;
         preFlowVol = 0.0f;
+        g_shotAnalytics.start(currentTime);
+        g_puck.reset(currentTime, vol);
     }
     unsigned long lastZcTimeMs = lastZcTime / 1000;
     if ((steamFlag && !prevSteamFlag) ||
-        (currentTime - lastZcTimeMs >= SHOT_RESET && shotFlag && currentTime > lastZcTimeMs)) {
-        pulseCount = 0;
+        (shotFlag && g_shotDetector.pumpIdle(currentTime, lastZcTimeMs))) {
+        if (g_shotAnalytics.active()) finishShotAnalytics(lastZcTimeMs);
+        g_shotDetector.stop(zc);
+        resetFlowVolume();
         shotVol = 0.0f;
         shotTime = 0;
         lastPulseTime = esp_timer_get_time();
@@ -365,42 +730,109 @@ static void checkShotStartStop() {
     }
 }
 
+/**
+ * @brief Step the thermal observer over the heater duty and flow of the last PID period.
+ */
+static void updateThermalObserver(float dt) {
+    float dv = vol - g_thermalLastVol;  // vol restarts at each shot
+    g_thermalLastVol = vol;
+    float flow = (dt > 0.0f && dv > 0.0f) ? dv / dt : 0.0f;
+    if (g_thermal.params().heaterW != heaterElementW) {
+        gag::ThermalObserver::Params tp = g_thermal.params();
+        tp.heaterW = heaterElementW;
+        g_thermal.setParams(tp);
+    }
+    g_thermal.update(dt, heatPower, flow, currentTemp);
+    if (thermalTrace) {
+        // heatPower is still the duty that was applied over this period
+        LOG("TRACE,%lu,%.2f,%.1f,%.2f,%.2f,%.2f", currentTime, currentTemp, heatPower, flow,
+            g_thermal.boilerC(), g_thermal.brewC());
+    }
+}
+
+/**
+ * @brief Gain set for heater @p mode; eco holds use the brew set.
+ */
+static HeaterPid::Gains heaterGains(gag::HeaterMode mode) {
+    if (mode == gag::HEATER_MODE_STEAM) {
+        return {pGainSteam, iGainSteam, dGainSteam, windupGuardSteam, dTauSteam, 1.0f};
+    }
+    return {pGainTemp, iGainTemp, dGainTemp, windupGuardTemp, dTauTemp, 1.0f};
+}
+
+/**
+ * @brief Log a completed steam/brew transition and queue the report for the display.
+ */
+static void reportHeaterTransition(gag::HeaterModes::Event ev) {
+    if (ev == gag::HeaterModes::EVENT_STEAM_READY) {
+        LOG("Steam: ready after %.1f s from %.1f C", g_heaterModes.steamReadyMs() / 1000.0f,
+            g_heaterModes.steamStartC());
+    } else {
+        LOG("Brew: recovered after %.1f s from %.1f C", g_heaterModes.brewRecoveryMs() / 1000.0f,
+            g_heaterModes.brewStartC());
+    }
+    EspNowHeaterModes& m = g_heaterModesMsg;
+    m = EspNowHeaterModes{};
+    m.type = ESPNOW_HEATER_MODES;
+    m.mode = g_heaterModes.mode();
+    m.seq = ++g_heaterModesSeq;
+    m.steamReadyMs = g_heaterModes.steamReadyMs();
+    m.brewRecoveryMs = g_heaterModes.brewRecoveryMs();
+    m.steamStartC = g_heaterModes.steamStartC();
+    m.brewStartC = g_heaterModes.brewStartC();
+    m.brewHoldPct = g_heaterModes.holdingPct(gag::HEATER_MODE_BREW);
+    m.steamHoldPct = g_heaterModes.holdingPct(gag::HEATER_MODE_STEAM);
+    g_heaterModesRepeats = HEATER_MODES_REPEATS;
+    g_lastHeaterModesSendMs = currentTime - ESP_CYCLE;
+}
+
 /**
  * @brief Read temperature and update heater PID and window length.
+ *
+ * A brew/steam change swaps the gain set and hands over bumplessly: the
+ * derivative filter restarts on the new measurement (steam runs on the boiler
+ * sensor, brew on the brew-water estimate) and the integrator is preloaded
+ * with the duty that last held the new mode's setpoint. Back from steam the
+ * preload is held until the boiler cools below the brew setpoint.
  */
 static void updateTempPID() {
     currentTemp = max31865.temperature(RNOMINAL, RREF);
     if (currentTemp < 0) currentTemp = lastTemp;
+    g_windowStats[ESPNOW_STATS_TEMP].add(currentTemp);
+    // heatPower is still the duty applied since the previous pass
+    g_windowStats[ESPNOW_STATS_HEATER_POWER].add(heaterEnabled ? heatPower : 0.0f);
     float dt = (currentTime - lastPidTime) / 1000.0f;
     lastPidTime = currentTime;
+    updateThermalObserver(dt);
+    gag::HeaterMode mode = steamFlag ? gag::HEATER_MODE_STEAM : gag::HEATER_MODE_BREW;
+    bool modeChanged = g_heaterModes.enter(mode, currentTime, currentTemp);
     if (!heaterEnabled) {
         // Pause PID calculations when heater is disabled
         heatPower = 0.0f;
         heatCycles = PWM_CYCLE;
-        pidPTerm = 0.0f;
-        pidITerm = 0.0f;
-        pidDTerm = 0.0f;
+        g_heaterPid.reset(currentTemp);
+        g_heaterModes.cancel();
         return;
     }
 
-    // Active target picks between brew and steam setpoints
-    setTemp = steamFlag ? steamSetpoint : brewSetpoint;
+    // Active target picks between brew, eco and steam setpoints
+    setTemp = activeSetpoint();
 
-    float effectivePGain = pGainTemp;
-    float effectiveIGain = iGainTemp;
-    float effectiveDGain = dGainTemp;
+    float pv = (THERMAL_PID_ON_ESTIMATE && !steamFlag && g_thermal.ready()) ? g_thermal.brewC()
+                                                                             : currentTemp;
+    g_heaterPid.setGains(heaterGains(mode));
+    if (modeChanged) g_heaterPid.preload(pv, g_heaterModes.holdingPct(mode));
 
-    if (currentTemp > setTemp) {
-        effectivePGain = 0.0f;
-        effectiveIGain = 0.0f;
-        // effectiveDGain = 0.0f;
-    }
+    uint32_t c0 = ESP.getCycleCount();
+    heatPower = g_heaterPid.step(setTemp, pv, dt);
+    g_hotCycles[ESPNOW_LOOP_HOT_PID].add(ESP.getCycleCount() - c0);
 
-    heatPower = calcPID(effectivePGain, effectiveIGain, effectiveDGain, setTemp, currentTemp, dt,
-                        pvFiltTemp, iStateTemp, windupGuardTemp, dTauTemp);
+    // An eco hold runs on the brew gains but must not teach them its holding duty.
+    bool learn = steamFlag || ecoSetpoint <= 0.0f;
+    gag::HeaterModes::Event ev =
+        g_heaterModes.update(currentTime, dt, setTemp, currentTemp, heatPower, learn);
+    if (ev != gag::HeaterModes::EVENT_NONE) reportHeaterTransition(ev);
 
-    if (heatPower > 100.0f) heatPower = 100.0f;
-    if (heatPower < 0.0f) heatPower = 0.0f;
     heatCycles = (int)((100.0f - heatPower) / 100.0f * PWM_CYCLE);
     lastTemp = currentTemp;
 }
@@ -408,7 +840,7 @@ static void updateTempPID() {
 /**
  * @brief Apply time-proportioning control to the heater output.
  */
-static void updateTempPWM() {
+static void CONTROL_HOT updateTempPWM() {
     if (!heaterEnabled) {
         digitalWrite(HEAT_PIN, LOW);
         heaterState = false;
@@ -445,93 +877,115 @@ static inline float clampf(float v, float lo, float hi) {
 /**
  * @brief Apply PWM to the pump triac dimmer based on the requested pump power.
  */
-static void applyPumpPower() {
+static void CONTROL_HOT applyPumpPower() {
     float requested = clampf(pumpPowerCommand, 0.0f, 100.0f);
     float applied = requested;
-
-    unsigned long nowMs = millis();
-    float dtSec = 0.0f;
+    uint32_t nowMs = millis();
 
     if (!pumpPressureModeEnabled) {
-        pumpPressureClampUntilMs = 0;
-        pumpPressurePidInitialized = false;
-        pumpPressureISum = 0.0f;
+        g_pumpRamp.disarm();
+        g_pumpPid.release();
     } else {
-        if (requested > 0.0f && lastPumpRequested <= 0.0f) {
-            pumpPressureClampUntilMs = nowMs + PUMP_PRESSURE_CLAMP_DURATION_MS;
-        } else if (requested <= 0.0f) {
-            pumpPressureClampUntilMs = 0;
-            pumpPressurePidInitialized = false;
-            pumpPressureISum = 0.0f;
-        }
-        if (lastPumpApplyMs == 0) {
-            dtSec = PRESS_CYCLE / 1000.0f;
-        } else {
-            dtSec = (nowMs - lastPumpApplyMs) / 1000.0f;
-        }
-        dtSec = clampf(dtSec, 0.0f, PUMP_PRESSURE_RAMP_MAX_DT);
-    }
+        g_pumpRamp.setConfig({pumpRampRate, pumpStartClamp, static_cast<uint32_t>(pumpStartClampMs),
+                              PUMP_PRESSURE_RAMP_MAX_DT, PRESS_CYCLE / 1000.0f});
+        float dtSec = g_pumpRamp.begin(nowMs, requested);
 
-    if (pumpPressureModeEnabled) {
         float limit = clampf(pressureSetpointBar, PRESSURE_SETPOINT_MIN, PRESSURE_SETPOINT_MAX);
-        float sensed = pressNow;
-        if (!pumpPressurePidInitialized) {
-            pumpPressurePvFilt = sensed;
-            pumpPressureISum = 0.0f;
-            pumpPressurePidInitialized = true;
+        if (PUCK_EASE_ENABLED && g_puck.channeling(nowMs) && limit > puckEaseBar) {
+            limit -= puckEaseBar;
         }
+        float sensed = pressNow;
+        if (!g_pumpPid.primed()) g_pumpPid.reset(sensed);
 
         if (limit <= 0.0f || requested <= 0.0f) {
             applied = 0.0f;
-            pumpPressureISum = 0.0f;
-            pumpPressurePidInitialized = false;
+            g_pumpPid.release();
         } else if (dtSec > 0.0f) {
-            float pidOut =
-                calcPID(PUMP_PRESSURE_KP, PUMP_PRESSURE_KI, PUMP_PRESSURE_KD, limit, sensed, dtSec,
-                        pumpPressurePvFilt, pumpPressureISum, PUMP_PRESSURE_I_GUARD);
-            if (pidOut > 100.0f) pidOut = 100.0f;
-            if (pidOut < 0.0f) pidOut = 0.0f;
-            applied = pidOut * PUMP_PRESSURE_OUTPUT_SCALE + PUMP_PRESSURE_OUTPUT_OFFSET;
-        } else {
-            applied = lastPumpApplied;
-        }
-
-        float maxIncrease = PUMP_PRESSURE_RAMP_RATE * dtSec;
-        float allowed = lastPumpApplied + maxIncrease;
-        if (applied > allowed) {
-            applied = allowed;
-        }
-    }
-
-    applied = clampf(applied, 0.0f, 100.0f);
-
-    if (pumpPressureModeEnabled && pumpPressureClampUntilMs != 0) {
-        if (nowMs < pumpPressureClampUntilMs) {
-            if (applied > PUMP_PRESSURE_INITIAL_CLAMP) {
-                applied = PUMP_PRESSURE_INITIAL_CLAMP;
-            }
+            g_pumpPid.setGains({pGainPump, iGainPump, dGainPump, windupGuardPump, dTauPump, 1.0f});
+            float pidOut = g_pumpPid.step(limit, sensed, dtSec);
+            applied = pidOut * pumpOutputScale + pumpOutputOffset;
         } else {
-            pumpPressureClampUntilMs = 0;
+            applied = g_pumpRamp.lastApplied();
         }
+        applied = g_pumpRamp.limit(nowMs, applied, dtSec);
     }
 
-    lastPumpApplyMs = nowMs;
-    lastPumpApplied = applied;
-    lastPumpRequested = requested;
+    g_pumpRamp.commit(nowMs, requested, applied);
     // Surface the PID-derived power when pressure control is active so the HA sensor follows the actual output.
     pumpPower = pumpPressureModeEnabled ? applied : requested;
 
-    int percent = static_cast<int>(lroundf(applied));
+    // applied is clamped to 0..100, so this rounds without a libm call
+    int percent = static_cast<int>(applied + 0.5f);
     pumpDimmer.setPower(percent);
     pumpDimmer.setState(percent > 0 ? ON : OFF);
 }
 
 /**
- * @brief Sample pressure ADC and maintain a moving average buffer.
+ * @brief Track the pressure zero while the pump has been idle for a while.
+ *
+ * Only small offsets are absorbed, and never during a shot, in steam mode
+ * (boiler pressure is real) or while a pressure calibration run is open.
  */
-static void updatePressure() {
-    rawPress = analogRead(PRESS_PIN);
-    pressNow = rawPress * pressGrad + pressInt;
+static void CONTROL_HOT updatePressureZero(gag::Q16_16 uncorrectedBar, gag::Q16_16 dtSec) {
+    if (dtSec <= gag::Q16_16() || shotFlag || steamFlag || pressCalibrator.running()) return;
+    if (esp_timer_get_time() - lastZcTime < static_cast<int64_t>(PRESS_ZERO_IDLE_MS) * 1000) return;
+    if (uncorrectedBar > PRESS_ZERO_TOL || uncorrectedBar < -PRESS_ZERO_TOL) return;
+    gag::Q16_16 alpha = gag::lowPassAlpha(dtSec, PRESS_ZERO_TAU_S);
+    pressZeroBar = gag::lowPassStep(pressZeroBar, -uncorrectedBar, alpha);
+}
+
+/**
+ * @brief esp_timer callback taking one phase-locked pressure sample.
+ *
+ * Runs in the esp_timer task; re-arms itself for the remaining slots of the
+ * half-cycle and goes quiet until the next zero-cross arms it again.
+ */
+static void pressSampleTimerCb(void*) {
+    // analogReadMilliVolts() applies the chip's eFuse ADC characterisation,
+    // which removes most of the 11 dB attenuation nonlinearity.
+    int32_t mv = analogReadMilliVolts(PRESS_PIN);
+    portENTER_CRITICAL(&g_phaseMux);
+    uint32_t nextUs = g_phaseSampler.onSample(mv, esp_timer_get_time());
+    portEXIT_CRITICAL(&g_phaseMux);
+    // Fails harmlessly if a zero-cross re-armed the timer meanwhile.
+    if (nextUs) esp_timer_start_once(g_pressSampleTimer, nextUs);
+}
+
+/**
+ * @brief Take the next pressure sample and maintain a moving average buffer.
+ *
+ * While the pump runs, samples are mains-cycle means from the phase sampler,
+ * so the pump stroke ripple never reaches the pressure PID. With the pump off
+ * there is no ripple and no zero-cross, and the ADC is read directly.
+ */
+static void CONTROL_HOT updatePressure() {
+    int64_t nowUs = esp_timer_get_time();
+    gag::Q16_16 mv;
+    portENTER_CRITICAL(&g_phaseMux);
+    bool synced = g_phaseSampler.active(nowUs);
+    bool fresh = g_phaseSampler.takeCycle(mv);
+    portEXIT_CRITICAL(&g_phaseMux);
+    if (!fresh) {
+        if (synced) return;
+        if (nowUs - lastPressSampleUs < static_cast<int64_t>(PRESS_IDLE_SAMPLE_MS) * 1000) return;
+        mv = gag::Q16_16::fromInt(analogReadMilliVolts(PRESS_PIN));
+    }
+    uint32_t c0 = ESP.getCycleCount();
+    // Curve and auto-zero run in Q16.16; only the result enters the float PID.
+    int64_t gapUs = lastPressSampleUs ? nowUs - lastPressSampleUs : 0;
+    if (gapUs > 1000000) gapUs = 1000000;  // caps one auto-zero step after a stall
+    gag::Q16_16 dtSec =
+        gag::Q16_16::fromRaw(static_cast<int32_t>(gapUs * gag::Q16_16::ONE / 1000000));
+    lastPressSampleUs = nowUs;
+
+    pressMv = mv.roundToInt();
+    gag::Q16_16 bar = pressCalibrator.addSampleQ(mv);
+    updatePressureZero(bar, dtSec);
+    pressNow = (bar + pressZeroBar).toFloat();
+    if (g_shotAnalytics.active()) {
+        uint32_t nowMs = static_cast<uint32_t>(nowUs / 1000);
+        if (g_puck.update(nowMs, pressNow, vol)) g_puckEventPending = true;
+    }
     uint8_t idx = pressBuffIdx;
     pressSum -= pressBuff[idx];
     pressBuff[idx] = pressNow;
@@ -543,30 +997,62 @@ static void updatePressure() {
     if (pumpPressureModeEnabled) {
         applyPumpPower();
     }
+    g_windowStats[ESPNOW_STATS_PRESSURE].add(pressNow);
+    g_windowStats[ESPNOW_STATS_PUMP_POWER].add(pumpPower);
+    g_hotCycles[ESPNOW_LOOP_HOT_PRESSURE].add(ESP.getCycleCount() - c0);
+}
+
+/**
+ * @brief Log a channeling event flagged by updatePressure().
+ *
+ * Formatting runs from flash, so it is kept off the hot path.
+ */
+static void reportPuckEvent() {
+    g_puckEventPending = false;
+    LOG("Puck: channeling, R=%.2f (baseline %.2f) bar/(mL/s)", g_puck.resistance(),
+        g_puck.baseline());
+}
+
+/**
+ * @brief Periodic esp_timer callback evaluating the steam switch window.
+ *
+ * Works purely on edge timestamps, so detection lands within
+ * STEAM_DETECT_MS + STEAM_SENSE_TICK_MS of the switch (once the pump is idle)
+ * however slowly loop() is running.
+ */
+static void steamSenseTimerCb(void*) {
+    int64_t now = esp_timer_get_time();
+    bool low = !digitalRead(AC_SENS);
+    portENTER_CRITICAL(&g_acMux);
+    int64_t lastEdge = acLastEdgeUs, runStart = acRunStartUs;
+    portEXIT_CRITICAL(&g_acMux);
+
+    bool detected = g_steamSense.update(now, low, lastEdge, runStart, lastZcTime);
+    ac = g_steamSense.ac();
+    steamDetectMs = g_steamSense.detectMs();
+    steamHwDetected = detected;
 }
 
 /**
- * @brief Infer steam mode based on AC sense and recent zero-cross activity.
+ * @brief Apply the steam switch state detected by steamSenseTimerCb().
  */
 static void updateSteamFlag() {
-    ac = !digitalRead(AC_SENS);
     prevSteamFlag = steamFlag;
-    int64_t now = esp_timer_get_time();
-    if ((now - lastZcTime) > ZC_OFF * 1000 && ac) {
-        acCount++;
-        if (acCount > STEAM_MIN) {
-            if (!steamHwFlag && steamDispFlag) steamResetPending = true;
-            steamHwFlag = true;
+    portENTER_CRITICAL(&g_acMux);
+    acCount = acEdges;
+    portEXIT_CRITICAL(&g_acMux);
+    if (steamHwDetected) {
+        if (!steamHwFlag) {
+            if (steamDispFlag) steamResetPending = true;
+            LOG("Steam: switch detected after %lu ms", (unsigned long)steamDetectMs);
         }
-    } else {
-        if (steamHwFlag) {
-            if (steamDispFlag && steamResetPending) {
-                steamDispFlag = false;
-                steamResetPending = false;
-            }
-            steamHwFlag = false;
+        steamHwFlag = true;
+    } else if (steamHwFlag) {
+        if (steamDispFlag && steamResetPending) {
+            steamDispFlag = false;
+            steamResetPending = false;
         }
-        acCount = 0;
+        steamHwFlag = false;
     }
     steamFlag = steamDispFlag || steamHwFlag;
 }
@@ -578,27 +1064,65 @@ static void updatePreFlow() {
     if (preFlow && lastPress > PRESS_THRESHOLD) {
         preFlow = false;
         preFlowVol = vol;
+        g_shotAnalytics.endPreinfusion(currentTime, vol);
     }
 }
 
 /**
  * @brief Convert pulse counts to volumes and maintain shot volume.
  */
-static void updateVols() {
-    unsigned long pulses = pulseCount;
-    vol = pulses * FLOW_CAL;
+static void CONTROL_HOT updateVols() {
+    uint32_t c0 = ESP.getCycleCount();
+    uint32_t head = flowRingHead;
+    bool pulses = head != flowRingTail;
+    if (head - flowRingTail > FLOW_RING_SIZE) {
+        // loop() stalled long enough to overrun the ring; book the lost pulses
+        // at the rate of the oldest interval still buffered.
+        uint32_t lost = head - flowRingTail - FLOW_RING_SIZE;
+        flowRingTail = head - FLOW_RING_SIZE;
+        uint32_t intervalUs = flowIntervals[flowRingTail % FLOW_RING_SIZE];
+        for (uint32_t i = 0; i < lost; ++i) flowVolMl += flowCalibrator.addPulse(intervalUs);
+    }
+    while (flowRingTail != head) {
+        flowVolMl += flowCalibrator.addPulse(flowIntervals[flowRingTail % FLOW_RING_SIZE]);
+        ++flowRingTail;
+    }
+    vol = flowVolMl;
     shotVol = (preFlow || !shotFlag) ? 0.0f : (vol - preFlowVol);
+    if (pulses) g_hotCycles[ESPNOW_LOOP_HOT_FLOW].add(ESP.getCycleCount() - c0);
 }
 
 // ISRs
+/**
+ * @brief AC_SENS edge ISR: timestamps edges and the start of each AC run.
+ */
+static void IRAM_ATTR acSenseInt() {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL_ISR(&g_acMux);
+    if (now - acLastEdgeUs > static_cast<int64_t>(AC_HOLD_MS) * 1000) {
+        acRunStartUs = now;
+        acEdges = 0;
+    }
+    acLastEdgeUs = now;
+    acEdges++;
+    portEXIT_CRITICAL_ISR(&g_acMux);
+    acIsrs = acIsrs + 1;
+}
+
 /**
  * @brief Flow sensor ISR with simple debounce using `PULSE_MIN`.
  */
 static void IRAM_ATTR flowInt() {
     int64_t now = esp_timer_get_time();
-    if (now - lastPulseTime >= PULSE_MIN * 1000) {
+    int64_t interval = now - lastPulseTime;
+    flowIsrs = flowIsrs + 1;
+    if (interval >= PULSE_MIN * 1000) {
         pulseCount++;
         lastPulseTime = now;
+        uint32_t head = flowRingHead;
+        flowIntervals[head % FLOW_RING_SIZE] =
+            interval > static_cast<int64_t>(UINT32_MAX) ? UINT32_MAX : static_cast<uint32_t>(interval);
+        flowRingHead = head + 1;
     }
 }
 // Helper: immediately disable the heater output and prevent PID updates.
@@ -615,6 +1139,156 @@ static void forceHeaterOff() {
     }
 }
 
+/**
+ * @brief Copy persisted parameters into the live control variables.
+ */
+static void applyParams(const gag::PersistentParams& p) {
+    brewSetpoint = clampf(p.brewSetpoint, BREW_MIN, BREW_MAX);
+    steamSetpoint = clampf(p.steamSetpoint, STEAM_MIN_C, STEAM_MAX_C);
+    setTemp = activeSetpoint();
+    pGainTemp = clampf(p.pGain, 0.0f, 100.0f);
+    iGainTemp = clampf(p.iGain, 0.0f, 2.0f);
+    dGainTemp = clampf(p.dGain, 0.0f, 500.0f);
+    dTauTemp = clampf(p.dTau, 0.0f, 2.0f);
+    windupGuardTemp = clampf(p.windupGuard, 0.0f, 100.0f);
+    const struct {
+        uint16_t id;
+        float value;
+    } registry[] = {
+        {PARAM_ID_PUMP_KP, p.pumpKp},
+        {PARAM_ID_PUMP_KI, p.pumpKi},
+        {PARAM_ID_PUMP_KD, p.pumpKd},
+        {PARAM_ID_PUMP_I_GUARD, p.pumpIGuard},
+        {PARAM_ID_PUMP_DTAU, p.pumpDTau},
+        {PARAM_ID_PUMP_OUTPUT_SCALE, p.pumpOutputScale},
+        {PARAM_ID_PUMP_OUTPUT_OFFSET, p.pumpOutputOffset},
+        {PARAM_ID_PUMP_RAMP_RATE, p.pumpRampRate},
+        {PARAM_ID_PUMP_START_CLAMP, p.pumpStartClamp},
+        {PARAM_ID_PUMP_START_CLAMP_MS, p.pumpStartClampMs},
+        {PARAM_ID_PUCK_EASE, p.puckEaseBar},
+        {PARAM_ID_STEAM_KP, p.steamKp},
+        {PARAM_ID_STEAM_KI, p.steamKi},
+        {PARAM_ID_STEAM_KD, p.steamKd},
+        {PARAM_ID_STEAM_I_GUARD, p.steamIGuard},
+        {PARAM_ID_STEAM_DTAU, p.steamDTau},
+        {PARAM_ID_HEATER_ELEMENT_W, p.heaterElementW},
+    };
+    float applied;
+    for (const auto& e : registry) g_paramTable.set(e.id, e.value, &applied);
+    flowCalibrator.setTable(gag::flowCalValid(p.flowCurve) ? p.flowCurve
+                                                           : gag::flowCalDefault(p.flowCal));
+    pressCalibrator.setCurve(
+        gag::calCurveValid(p.pressCurve, PRESS_CAL_LIMITS.yMin, PRESS_CAL_LIMITS.yMax)
+            ? p.pressCurve
+            : pressureCurveDefault(p.pressGrad, p.pressInt));
+}
+
+/**
+ * @brief Snapshot the live tunables that should survive a power cycle.
+ *
+ * Calibration fields are owned by the calibration routines and written to
+ * g_params directly, so the boot-time pressure auto-zero is not persisted.
+ */
+static gag::PersistentParams captureParams() {
+    gag::PersistentParams p = g_params;
+    p.brewSetpoint = brewSetpoint;
+    p.steamSetpoint = steamSetpoint;
+    p.pGain = pGainTemp;
+    p.iGain = iGainTemp;
+    p.dGain = dGainTemp;
+    p.dTau = dTauTemp;
+    p.windupGuard = windupGuardTemp;
+    p.pumpKp = pGainPump;
+    p.pumpKi = iGainPump;
+    p.pumpKd = dGainPump;
+    p.pumpIGuard = windupGuardPump;
+    p.pumpDTau = dTauPump;
+    p.pumpOutputScale = pumpOutputScale;
+    p.pumpOutputOffset = pumpOutputOffset;
+    p.pumpRampRate = pumpRampRate;
+    p.pumpStartClamp = pumpStartClamp;
+    p.pumpStartClampMs = pumpStartClampMs;
+    p.puckEaseBar = puckEaseBar;
+    p.steamKp = pGainSteam;
+    p.steamKi = iGainSteam;
+    p.steamKd = dGainSteam;
+    p.steamIGuard = windupGuardSteam;
+    p.steamDTau = dTauSteam;
+    p.heaterElementW = heaterElementW;
+    return p;
+}
+
+static void sendCalReport(uint8_t target) {
+    if (!g_haveDisplayPeer || target >= CAL_SESSION_COUNT) return;
+    const CalSession& session = g_calSessions[target];
+    EspNowCalReport rpt{};
+    rpt.type = ESPNOW_CAL_REPORT;
+    rpt.target = target;
+    rpt.state = session.state;
+    rpt.runs = session.cal->runCount();
+    rpt.reference = session.result.reference;
+    rpt.measured = session.result.measured;
+    rpt.errorPct = session.result.errorPct;
+    rpt.residualPct = session.result.residualPct;
+    rpt.samples = session.cal->running() ? session.cal->runSamples() : session.result.samples;
+    static_assert(gag::CAL_POINTS == ESPNOW_CAL_POINTS, "calibration curve size mismatch");
+    memcpy(rpt.x, session.cal->curve().x, sizeof(rpt.x));
+    memcpy(rpt.y, session.cal->curve().y, sizeof(rpt.y));
+    esp_err_t err = espNowSend(g_displayMac, reinterpret_cast<uint8_t*>(&rpt), sizeof(rpt));
+    if (err != ESP_OK) LOG_ERROR("ESP-NOW: calibration report send failed (%d)", (int)err);
+}
+
+/**
+ * @brief Run a calibration command received from the display (loop context).
+ */
+static void handleCalCommand(const EspNowCalCommand& cmd) {
+    if (cmd.target >= CAL_SESSION_COUNT) return;
+    CalSession& session = g_calSessions[cmd.target];
+    const bool isFlow = cmd.target == ESPNOW_CAL_TARGET_FLOW;
+    gag::CalCurve& stored = isFlow ? g_params.flowCurve : g_params.pressCurve;
+    switch (cmd.action) {
+        case ESPNOW_CAL_ACTION_START:
+            session.cal->startRun();
+            session.result = gag::CurveCalibrator::Result{};
+            session.state = ESPNOW_CAL_STATE_RUNNING;
+            // Fit the curve in absolute terms; auto-zero resumes afterwards.
+            if (!isFlow) pressZeroBar = gag::Q16_16();
+            LOG("Cal[%s]: run started", session.name);
+            break;
+        case ESPNOW_CAL_ACTION_FINISH: {
+            float ref = cmd.reference;
+            if (isFlow && cmd.unit == ESPNOW_CAL_UNIT_GRAM) ref /= WATER_G_PER_ML;
+            // Flow runs sum pulse volumes; pressure runs average the held pressure.
+            session.result = session.cal->finishRun(ref, !isFlow);
+            session.state = session.result.ok ? ESPNOW_CAL_STATE_DONE : ESPNOW_CAL_STATE_FAILED;
+            LOG("Cal[%s]: ref=%.2f measured=%.2f err=%.1f%% residual=%.2f%% samples=%u runs=%u %s",
+                session.name, session.result.reference, session.result.measured,
+                session.result.errorPct, session.result.residualPct,
+                (unsigned)session.result.samples, (unsigned)session.result.runs,
+                session.result.ok ? "fitted" : "rejected");
+            if (session.result.ok) stored = session.cal->curve();
+            break;
+        }
+        case ESPNOW_CAL_ACTION_CANCEL:
+            session.cal->cancelRun();
+            session.state = ESPNOW_CAL_STATE_IDLE;
+            break;
+        case ESPNOW_CAL_ACTION_RESET:
+            session.cal->cancelRun();
+            session.cal->clearRuns();
+            session.cal->setCurve(isFlow ? gag::flowCalDefault(g_params.flowCal)
+                                         : pressureCurveDefault(g_params.pressGrad, g_params.pressInt));
+            stored = session.cal->curve();
+            session.result = gag::CurveCalibrator::Result{};
+            session.state = ESPNOW_CAL_STATE_IDLE;
+            LOG("Cal[%s]: reset to factory curve", session.name);
+            break;
+        default:
+            break;
+    }
+    sendCalReport(cmd.target);
+}
+
 static void revertToSafeDefaults() {
     if (!heaterEnabled) {
         heaterEnabled = true;
@@ -624,14 +1298,13 @@ static void revertToSafeDefaults() {
     pressureSetpointBar = PRESSURE_SETPOINT_DEFAULT;
     pumpPressureModeEnabled = false;
     applyPumpPower();
-    pumpPressurePidInitialized = false;
-    pumpPressureISum = 0.0f;
-    pumpPressurePvFilt = 0.0f;
+    g_pumpPid.release();
     pumpMode = ESPNOW_PUMP_MODE_NORMAL;
     steamDispFlag = false;
     steamResetPending = false;
     steamFlag = steamDispFlag || steamHwFlag;
-    setTemp = steamFlag ? steamSetpoint : brewSetpoint;
+    ecoSetpoint = 0.0f;
+    setTemp = activeSetpoint();
 }
 
 static void sendEspNowPacket() {
@@ -649,14 +1322,19 @@ static void sendEspNowPacket() {
     pkt.pressureSetpointBar = pressureSetpointBar;
     pkt.pumpPressureMode = pumpPressureModeEnabled ? 1 : 0;
     pkt.pumpPowerPercent = pumpPower;
-    pkt.pidPTerm = pidPTerm;
-    pkt.pidITerm = pidITerm;
-    pkt.pidDTerm = pidDTerm;
+    const HeaterPid::Terms& heaterTerms = g_heaterPid.terms();
+    pkt.pidPTerm = heaterTerms.p;
+    pkt.pidITerm = heaterTerms.i;
+    pkt.pidDTerm = heaterTerms.d;
     pkt.zcCount = zcCount;
     pkt.pulseCount = pulseCount;
-    pkt.acCount = static_cast<uint32_t>(acCount);
+    pkt.acCount = acCount;
+    pkt.puckFlags = 0;
+    if (g_shotAnalytics.active() && g_puck.valid()) pkt.puckFlags |= ESPNOW_PUCK_FLAG_VALID;
+    if (g_puck.channeling(currentTime)) pkt.puckFlags |= ESPNOW_PUCK_FLAG_CHANNELING;
+    pkt.steamDetectMs = static_cast<uint16_t>(steamDetectMs > UINT16_MAX ? UINT16_MAX : steamDetectMs);
     const uint8_t* dest = g_haveDisplayPeer ? g_displayMac : nullptr;
-    esp_err_t err = esp_now_send(dest, reinterpret_cast<uint8_t*>(&pkt), sizeof(pkt));
+    esp_err_t err = espNowSend(dest, reinterpret_cast<uint8_t*>(&pkt), sizeof(pkt));
     if (err != ESP_OK) {
         LOG_ERROR("ESP-NOW: telemetry send failed (%d)", (int)err);
     }
@@ -664,96 +1342,88 @@ static void sendEspNowPacket() {
 
 static void applyControlPacket(const EspNowControlPacket& pkt, const uint8_t* mac) {
     if (pkt.type != ESPNOW_CONTROL_PACKET) return;
-    if (pkt.revision && pkt.revision <= g_lastControlRevision) return;
+    if (!gag::controlRevisionNewer(pkt.revision, g_lastControlRevision)) return;
     g_lastControlRevision = pkt.revision;
 
     LOG("ESP-NOW: Control received rev %u: heater=%d steam=%d brew=%.1f steamSet=%.1f "
         "pidP=%.2f pidI=%.2f pidGuard=%.2f "
-        "pidD=%.2f pump=%.1f mode=%u pressSet=%.1f pressMode=%d",
+        "pidD=%.2f dTau=%.2f pump=%.1f mode=%u pressSet=%.1f pressMode=%d",
         static_cast<unsigned>(pkt.revision), (pkt.flags & ESPNOW_CONTROL_FLAG_HEATER) != 0 ? 1 : 0,
         (pkt.flags & ESPNOW_CONTROL_FLAG_STEAM) != 0 ? 1 : 0, pkt.brewSetpointC, pkt.steamSetpointC,
         pkt.pidP, pkt.pidI, pkt.pidGuard, pkt.pidD, pkt.dTau, pkt.pumpPowerPercent,
         static_cast<unsigned>(pkt.pumpMode), pkt.pressureSetpointBar,
         (pkt.flags & ESPNOW_CONTROL_FLAG_PUMP_PRESSURE) ? 1 : 0);
 
-    bool hv = (pkt.flags & ESPNOW_CONTROL_FLAG_HEATER) != 0;
-    if (hv != heaterEnabled) {
-        heaterEnabled = hv;
+    const gag::ControlTargets t = gag::decodeControl(pkt, ECO_MIN_C, ECO_MAX_C);
+
+    if (t.heater != heaterEnabled) {
+        heaterEnabled = t.heater;
         if (!heaterEnabled) forceHeaterOff();
         LOG("ESP-NOW: Heater -> %s", heaterEnabled ? "ON" : "OFF");
     }
 
-    bool sv = (pkt.flags & ESPNOW_CONTROL_FLAG_STEAM) != 0;
-    if (sv != steamDispFlag) {
-        steamDispFlag = sv;
+    if (t.steam != steamDispFlag) {
+        steamDispFlag = t.steam;
         steamResetPending = false;
         steamFlag = steamDispFlag || steamHwFlag;
-        setTemp = steamFlag ? steamSetpoint : brewSetpoint;
+        setTemp = activeSetpoint();
         LOG("ESP-NOW: Steam -> %s", steamFlag ? "ON" : "OFF");
     }
 
-    float newBrew = clampf(pkt.brewSetpointC, BREW_MIN, BREW_MAX);
-    float newSteam = clampf(pkt.steamSetpointC, STEAM_MIN_C, STEAM_MAX_C);
     bool setChanged = false;
-    if (fabsf(newBrew - brewSetpoint) > 0.01f) {
-        brewSetpoint = newBrew;
+    if (fabsf(t.brewC - brewSetpoint) > 0.01f) {
+        brewSetpoint = t.brewC;
+        setChanged = true;
+    }
+    if (fabsf(t.steamC - steamSetpoint) > 0.01f) {
+        steamSetpoint = t.steamC;
         setChanged = true;
     }
-    if (fabsf(newSteam - steamSetpoint) > 0.01f) {
-        steamSetpoint = newSteam;
+    if (t.ecoC != ecoSetpoint) {
+        ecoSetpoint = t.ecoC;
         setChanged = true;
+        if (ecoSetpoint > 0.0f) {
+            LOG("ESP-NOW: Eco hold at %.0f", ecoSetpoint);
+        } else {
+            LOG("ESP-NOW: Eco hold off");
+        }
     }
     if (setChanged) {
-        setTemp = steamFlag ? steamSetpoint : brewSetpoint;
+        setTemp = activeSetpoint();
         LOG("ESP-NOW: Setpoints Brew=%.1f Steam=%.1f", brewSetpoint, steamSetpoint);
     }
 
-    float newP = clampf(pkt.pidP, 0.0f, 100.0f);
-    float newI = clampf(pkt.pidI, 0.0f, 2.0f);
-    float newGuard = clampf(pkt.pidGuard, 0.0f, 100.0f);
-    float newD = clampf(pkt.pidD, 0.0f, 500.0f);
-    float newDTau = clampf(pkt.dTau, 0.0f, 2.0f);
-
-    if (fabsf(newP - pGainTemp) > 0.01f) {
-        pGainTemp = newP;
+    if (fabsf(t.pidP - pGainTemp) > 0.01f) {
+        pGainTemp = t.pidP;
     }
-    if (fabsf(newI - iGainTemp) > 0.01f) {
-        iGainTemp = newI;
+    if (fabsf(t.pidI - iGainTemp) > 0.01f) {
+        iGainTemp = t.pidI;
     }
-    if (fabsf(newGuard - windupGuardTemp) > 0.01f) {
-        windupGuardTemp = newGuard;
+    if (fabsf(t.pidGuard - windupGuardTemp) > 0.01f) {
+        windupGuardTemp = t.pidGuard;
     }
-    if (fabsf(newD - dGainTemp) > 0.1f) {
-        dGainTemp = newD;
+    if (fabsf(t.pidD - dGainTemp) > 0.1f) {
+        dGainTemp = t.pidD;
     }
-    if (fabs(newDTau - dTauTemp) > 0.01f) {
-        dTauTemp = newDTau;
+    if (fabsf(t.dTau - dTauTemp) > 0.01f) {
+        dTauTemp = t.dTau;
     }
 
-    float newPump = clampf(pkt.pumpPowerPercent, 0.0f, 100.0f);
-    if (fabsf(newPump - pumpPowerCommand) > 0.1f) {
-        pumpPowerCommand = newPump;
+    if (fabsf(t.pumpPct - pumpPowerCommand) > 0.1f) {
+        pumpPowerCommand = t.pumpPct;
         applyPumpPower();
     }
 
-    float newPressureSetpoint = clampf(pkt.pressureSetpointBar, 0.0f, 15.0f);
-    if (fabsf(newPressureSetpoint - pressureSetpointBar) > 0.1f) {
-        pressureSetpointBar = newPressureSetpoint;
-    }
-
-    pumpMode = static_cast<EspNowPumpMode>(pkt.pumpMode);
+    pumpMode = static_cast<EspNowPumpMode>(t.pumpMode);
 
-    float newPressureSet =
-        clampf(pkt.pressureSetpointBar, PRESSURE_SETPOINT_MIN, PRESSURE_SETPOINT_MAX);
-    if (fabsf(newPressureSet - pressureSetpointBar) > 0.01f) {
-        pressureSetpointBar = newPressureSet;
+    if (fabsf(t.pressureBar - pressureSetpointBar) > 0.01f) {
+        pressureSetpointBar = t.pressureBar;
         LOG("ESP-NOW: Pressure setpoint -> %.1f bar", pressureSetpointBar);
         if (pumpPressureModeEnabled) applyPumpPower();
     }
 
-    bool newPressureMode = (pkt.flags & ESPNOW_CONTROL_FLAG_PUMP_PRESSURE) != 0;
-    if (newPressureMode != pumpPressureModeEnabled) {
-        pumpPressureModeEnabled = newPressureMode;
+    if (t.pressureMode != pumpPressureModeEnabled) {
+        pumpPressureModeEnabled = t.pressureMode;
         LOG("ESP-NOW: Pump pressure mode -> %s", pumpPressureModeEnabled ? "ON" : "OFF");
         applyPumpPower();
     }
@@ -764,8 +1434,425 @@ static void applyControlPacket(const EspNowControlPacket& pkt, const uint8_t* ma
     }
 }
 
+static bool sendToDisplay(const uint8_t* data, size_t len) {
+    if (!g_haveDisplayPeer) return false;
+    return espNowSend(g_displayMac, data, len) == ESP_OK;
+}
+
+static bool sendParamReport(EspNowParamValues& rpt) {
+    rpt.type = ESPNOW_PARAM_REPORT;
+    return sendToDisplay(reinterpret_cast<const uint8_t*>(&rpt),
+                         ESPNOW_PARAM_VALUES_LEN(rpt.count));
+}
+
+/**
+ * @brief Answer a parameter get/set/subscribe from the display (loop context).
+ *
+ * Sets go through the registry ranges; the report echoes what was applied,
+ * entry by entry, so the display sees clamping.
+ */
+static void handleParamRequest(const uint8_t* data, int len) {
+    EspNowParamValues rpt{};
+    rpt.seq = data[1];
+
+    if (data[0] == ESPNOW_PARAM_SET) {
+        EspNowParamValues req{};
+        if (len > static_cast<int>(sizeof(req))) return;
+        memcpy(&req, data, len);
+        if (req.count > ESPNOW_PARAM_MAX_ENTRIES || len != ESPNOW_PARAM_VALUES_LEN(req.count)) {
+            return;
+        }
+        for (uint8_t i = 0; i < req.count; ++i) {
+            EspNowParamValue& out = rpt.values[i];
+            out.id = req.values[i].id;
+            float applied;
+            out.status = g_paramTable.set(out.id, req.values[i].value, &applied);
+            out.value = applied;
+            LOG("Params: set %u -> %.3f (status %u)", (unsigned)out.id, out.value,
+                (unsigned)out.status);
+        }
+        rpt.count = req.count;
+        // Setpoints and pump settings take effect now rather than at the next cycle.
+        setTemp = activeSetpoint();
+        applyPumpPower();
+        sendParamReport(rpt);
+        return;
+    }
+
+    EspNowParamIds req{};
+    if (len > static_cast<int>(sizeof(req))) return;
+    memcpy(&req, data, len);
+    if (req.count > ESPNOW_PARAM_MAX_ENTRIES || len != ESPNOW_PARAM_IDS_LEN(req.count)) return;
+    if (data[0] == ESPNOW_PARAM_SUBSCRIBE) {
+        uint16_t ids[ESPNOW_PARAM_MAX_ENTRIES];
+        for (uint8_t i = 0; i < req.count; ++i) ids[i] = req.ids[i];
+        g_paramTable.subscribe(ids, req.count);
+        LOG("Params: display subscribed to %u parameters",
+            req.count ? (unsigned)req.count : (unsigned)PARAM_COUNT);
+        while ((rpt.count = g_paramTable.takeChanges(rpt.values, ESPNOW_PARAM_MAX_ENTRIES)) > 0) {
+            sendParamReport(rpt);
+        }
+        g_lastParamReportMs = currentTime;
+        return;
+    }
+
+    // Get: the listed ids, or every parameter, in as many reports as needed.
+    int total = req.count ? static_cast<int>(req.count) : static_cast<int>(PARAM_COUNT);
+    for (int i = 0; i < total; ++i) {
+        EspNowParamValue& out = rpt.values[rpt.count++];
+        out.id = req.count ? req.ids[i] : PARAM_DEFS[i].id;
+        float value = 0.0f;
+        out.status = g_paramTable.get(out.id, &value) ? ESPNOW_PARAM_STATUS_OK
+                                                      : ESPNOW_PARAM_STATUS_UNKNOWN;
+        out.value = value;
+        if (rpt.count == ESPNOW_PARAM_MAX_ENTRIES || i == total - 1) {
+            sendParamReport(rpt);
+            rpt.count = 0;
+        }
+    }
+}
+
+/**
+ * @brief Answer a pending parameter request, then push subscribed parameters
+ * that changed, whatever changed them.
+ */
+static void serviceParamReports() {
+    ParamRequest req;
+    while (g_paramQueue && xQueueReceive(g_paramQueue, &req, 0) == pdTRUE) {
+        handleParamRequest(req.data, req.len);
+    }
+    if (!g_espnowHandshake || !g_haveDisplayPeer || !g_paramTable.subscribed()) return;
+    if (currentTime - g_lastParamReportMs < PARAM_REPORT_MS) return;
+    g_lastParamReportMs = currentTime;
+    EspNowParamValues rpt{};
+    rpt.count = g_paramTable.takeChanges(rpt.values, ESPNOW_PARAM_MAX_ENTRIES);
+    if (rpt.count) sendParamReport(rpt);
+}
+
+static void saveEnergyTotals() {
+    const gag::EnergyTotals& t = g_energy.totals();
+    if (!g_energyJournal.save(&t, sizeof(t), gag::ENERGY_TOTALS_VERSION)) {
+        LOG_ERROR("Energy: counter save failed");
+    }
+    g_lastEnergySaveMs = currentTime;
+    g_energyBootUnsaved = false;
+}
+
+/**
+ * @brief Restore the lifetime usage counters and count this boot.
+ *
+ * The boot count is written with the first regular save, not here: an NVS
+ * write would hold up the first PID pass, and a reset loop would wear the
+ * journal.
+ */
+static void setupEnergyMeter() {
+    gag::EnergyTotals t{};
+    uint16_t version = 0;
+    if (g_energyJournal.load(&t, sizeof(t), &version)) g_energy.restore(t);
+    g_energy.countBoot();
+    g_energyBootUnsaved = true;
+    const gag::EnergyTotals& e = g_energy.totals();
+    uint64_t onMs = e.heaterOnMs[gag::ENERGY_IDLE] + e.heaterOnMs[gag::ENERGY_SHOT] +
+                    e.heaterOnMs[gag::ENERGY_STEAM];
+    LOG("Energy: boot %u, %u shots, heater %.2f kWh over %u cycles", (unsigned)e.boots,
+        (unsigned)e.shots, gag::EnergyMeter::wattHours(onMs, heaterElementW) / 1000.0f,
+        (unsigned)e.heaterCycles);
+}
+
+/**
+ * @brief Meter the heater and pump levels of this loop pass; persist periodically
+ *        and whenever the heater is switched off.
+ */
+static void updateEnergyMeter() {
+    gag::EnergyState state = !heaterEnabled ? gag::ENERGY_OFF
+                             : steamFlag    ? gag::ENERGY_STEAM
+                             : shotFlag     ? gag::ENERGY_SHOT
+                                            : gag::ENERGY_IDLE;
+    bool pumpOn = esp_timer_get_time() - lastZcTime < PUMP_ON_ZC_GAP_US;
+    g_energy.update(currentTime, state, heaterState, pumpOn);
+
+    bool switchedOff = g_energyHeaterWasEnabled && !heaterEnabled;
+    g_energyHeaterWasEnabled = heaterEnabled;
+    // Idle standby accrues nothing but the boot count, so only write when in use
+    // or when this boot has not been stored yet.
+    bool due = currentTime - g_lastEnergySaveMs >= ENERGY_SAVE_MS;
+    if (switchedOff || (due && (heaterEnabled || g_energyBootUnsaved))) {
+        saveEnergyTotals();
+    }
+}
+
+static void sendEnergyReport() {
+    const gag::EnergyTotals& t = g_energy.totals();
+    EspNowEnergy m{};
+    m.type = ESPNOW_ENERGY;
+    m.elementW = static_cast<uint16_t>(heaterElementW);
+    for (int i = 0; i < gag::ENERGY_STATES; ++i) {
+        m.stateS[i] = static_cast<uint32_t>(t.stateMs[i] / 1000);
+        m.heaterOnS[i] = static_cast<uint32_t>(t.heaterOnMs[i] / 1000);
+    }
+    m.pumpOnS = static_cast<uint32_t>(t.pumpOnMs / 1000);
+    m.heaterCycles = t.heaterCycles;
+    m.pumpCycles = t.pumpCycles;
+    m.shots = t.shots;
+    m.boots = t.boots;
+    m.dutyPct = g_energy.dutyPct();
+    sendToDisplay(reinterpret_cast<const uint8_t*>(&m), sizeof(m));
+}
+
+static inline void loopStage(EspNowLoopStage stage) {
+    g_loopSup.enter(stage, static_cast<uint32_t>(esp_timer_get_time()));
+    g_flight.enterStage(stage);
+}
+
+static const char* loopStageName(uint8_t stage) {
+    return stage < ESPNOW_LOOP_STAGE_COUNT ? LOOP_STAGE_NAMES[stage] : "?";
+}
+
+/**
+ * @brief Supervisor timer: force the heater and pump off while loop() is stuck.
+ *
+ * Runs in the esp_timer task on core 0, so it keeps running when loop() blocks
+ * on core 1. loop() rewrites both outputs on its first pass after recovering.
+ */
+static void loopSupervisorCb(void*) {
+    if (!g_loopSup.stalled(static_cast<uint32_t>(esp_timer_get_time()))) return;
+    digitalWrite(HEAT_PIN, LOW);
+    pumpDimmer.setState(OFF);
+}
+
+/**
+ * @brief Arm the stall supervisor and the task watchdog on the loop task.
+ */
+static void setupLoopSupervisor() {
+    esp_reset_reason_t reason = esp_reset_reason();
+    g_wdtReset = reason == ESP_RST_TASK_WDT || reason == ESP_RST_INT_WDT || reason == ESP_RST_WDT;
+    if (g_wdtReset) LOG_ERROR("Boot: restarted by watchdog (reason %d)", (int)reason);
+
+    const esp_timer_create_args_t args = {
+        .callback = loopSupervisorCb,
+        .arg = nullptr,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "loop_sup",
+        .skip_unhandled_events = true,
+    };
+    if (esp_timer_create(&args, &g_loopSupTimer) == ESP_OK) {
+        esp_timer_start_periodic(g_loopSupTimer, LOOP_SUPERVISOR_PERIOD_US);
+    } else {
+        LOG_ERROR("Loop: supervisor timer unavailable, stalls are not caught");
+    }
+
+    // setup() runs in the loop task, so this subscribes loop() itself.
+    esp_task_wdt_init(LOOP_WDT_TIMEOUT_S, true);
+    if (esp_task_wdt_add(nullptr) != ESP_OK) LOG_ERROR("Loop: task watchdog unavailable");
+}
+
+static int16_t toI16(float v) {
+    return static_cast<int16_t>(lroundf(clampf(v, -32768.0f, 32767.0f)));
+}
+
+static uint8_t toPct(float v) { return static_cast<uint8_t>(lroundf(clampf(v, 0.0f, 100.0f))); }
+
+/**
+ * @brief Append the current control state to the flight recorder.
+ */
+static void recordFlightSample() {
+    EspNowFlightSample s{};
+    s.tempC100 = toI16(currentTemp * 100.0f);
+    s.setC10 = toI16(setTemp * 10.0f);
+    s.pressBar100 = toI16(pressNow * 100.0f);
+    s.heatPct = toPct(heatPower);
+    s.pumpPct = toPct(g_pumpRamp.lastApplied());
+    if (heaterState) s.flags |= ESPNOW_FLIGHT_FLAG_HEATER_ON;
+    if (heaterEnabled) s.flags |= ESPNOW_FLIGHT_FLAG_HEATER_ENABLED;
+    if (shotFlag) s.flags |= ESPNOW_FLIGHT_FLAG_SHOT;
+    if (steamFlag) s.flags |= ESPNOW_FLIGHT_FLAG_STEAM;
+    if (pumpPressureModeEnabled) s.flags |= ESPNOW_FLIGHT_FLAG_PRESSURE_MODE;
+    if (g_espnowHandshake) s.flags |= ESPNOW_FLIGHT_FLAG_LINKED;
+    g_flight.record(currentTime, s);
+}
+
+/**
+ * @brief Take over the ring the previous run left in RTC memory and start recording.
+ *
+ * Runs after setupEnergyMeter() so the boot counter names the runs.
+ */
+static void setupFlightRecorder() {
+    g_flightResetReason = static_cast<uint8_t>(esp_reset_reason());
+    g_flightHavePrev = g_flight.adopt(g_energy.totals().boots, g_flightPrev);
+    if (g_flightHavePrev) {
+        LOG("Flight: %u samples kept from run %lu, reset reason %u in stage %s",
+            (unsigned)g_flightPrev.count, (unsigned long)g_flightPrev.runId,
+            (unsigned)g_flightResetReason, loopStageName(g_flightPrev.endStage));
+    }
+}
+
+/**
+ * @brief Send the previous run's record in chunks, from the start after every link-up.
+ */
+static void serviceFlightRecord() {
+    if (!g_espnowHandshake) {
+        g_flightLinked = false;
+        return;
+    }
+    if (!g_flightLinked) {
+        g_flightLinked = true;
+        g_flightSendNext = 0;
+    }
+    if (!g_flightHavePrev || g_flightSendNext >= g_flightPrev.count) return;
+    if (currentTime - g_lastFlightSendMs < FLIGHT_SEND_GAP_MS) return;
+
+    EspNowFlightChunk m{};
+    m.type = ESPNOW_FLIGHT_CHUNK;
+    m.resetReason = g_flightResetReason;
+    m.endStage = g_flightPrev.endStage;
+    m.recordId = g_flightPrev.runId;
+    m.first = g_flightSendNext;
+    m.total = g_flightPrev.count;
+    m.samplePeriodMs = g_flight.samplePeriodMs();
+    uint16_t n = g_flightPrev.count - g_flightSendNext;
+    if (n > ESPNOW_FLIGHT_CHUNK_SAMPLES) n = ESPNOW_FLIGHT_CHUNK_SAMPLES;
+    m.count = static_cast<uint8_t>(n);
+    memcpy(m.samples, &g_flightPrev.samples[g_flightSendNext], n * sizeof(EspNowFlightSample));
+    sendToDisplay(reinterpret_cast<const uint8_t*>(&m), sizeof(m));
+    g_flightSendNext += n;
+    g_lastFlightSendMs = currentTime;
+}
+
+/**
+ * @brief Close the loop pass: feed the watchdog, report trips and overruns.
+ */
+static void endLoopTick() {
+    bool overran = g_loopSup.endTick(static_cast<uint32_t>(esp_timer_get_time()));
+    esp_task_wdt_reset();
+    g_flight.enterStage(ESPNOW_LOOP_STAGE_OTHER);
+    bool tripped = g_loopSup.takeTrip();
+    g_flight.notePass(g_loopSup.lastTickUs(), g_loopSup.lastTickStage(), overran, tripped);
+    if (g_flight.due(currentTime)) recordFlightSample();
+    if (tripped) {
+        LOG_ERROR("Loop: stalled in %s for %lu ms, heater and pump forced off",
+                  loopStageName(g_loopSup.lastTripStage()),
+                  (unsigned long)(g_loopSup.lastTickUs() / 1000));
+    } else if (overran && currentTime - g_lastOverrunLogMs >= LOOP_OVERRUN_LOG_MS) {
+        LOG("Loop: %lu us pass over the %lu us deadline, mostly %s (%lu overruns)",
+            (unsigned long)g_loopSup.lastTickUs(), (unsigned long)LOOP_DEADLINE_US,
+            loopStageName(g_loopSup.lastOverrunStage()), (unsigned long)g_loopSup.overruns());
+        g_lastOverrunLogMs = currentTime;
+    }
+}
+
+static void sendLoopStats() {
+    EspNowLoopStats m{};
+    m.type = ESPNOW_LOOP_STATS;
+    m.flags = g_wdtReset ? ESPNOW_LOOP_FLAG_WDT_RESET : 0;
+    if (GAG_CONTROL_IRAM) m.flags |= ESPNOW_LOOP_FLAG_IRAM;
+    m.lastOverrunStage = g_loopSup.lastOverrunStage();
+    m.lastTripStage = g_loopSup.lastTripStage();
+    m.deadlineUs = LOOP_DEADLINE_US;
+    m.tripUs = LOOP_TRIP_US;
+    m.ticks = g_loopSup.ticks();
+    m.overruns = g_loopSup.overruns();
+    m.trips = g_loopSup.trips();
+    m.worstTickUs = g_loopSup.worstTickUs();
+    for (uint8_t i = 0; i < ESPNOW_LOOP_STAGE_COUNT; ++i) {
+        m.stageMaxUs[i] = g_loopSup.stageMaxUs(i);
+        uint32_t n = g_loopSup.stageOverruns(i);
+        m.stageOverruns[i] = static_cast<uint16_t>(n > 0xFFFF ? 0xFFFF : n);
+    }
+    for (uint8_t i = 0; i < ESPNOW_LOOP_HOT_SECTIONS; ++i) {
+        m.hotMinCycles[i] = g_hotCycles[i].min();
+        m.hotMaxCycles[i] = g_hotCycles[i].maxCycles;
+        m.hotMeanCycles[i] = g_hotCycles[i].mean();
+    }
+    m.cpuMhz = static_cast<uint16_t>(ESP.getCpuFreqMHz());
+    m.controlCore = static_cast<uint8_t>(xPortGetCoreID());
+    sendToDisplay(reinterpret_cast<const uint8_t*>(&m), sizeof(m));
+}
+
+/**
+ * @brief Send uptime, heap, interrupt and link counters to the display.
+ */
+static void sendHealth() {
+    EspNowHealth m{};
+    m.type = ESPNOW_HEALTH;
+    m.resetReason = g_flightResetReason;
+    m.channel = g_espnowChannel;
+    m.uptimeS = static_cast<uint32_t>(esp_timer_get_time() / 1000000);
+    m.boots = g_energy.totals().boots;
+    uint32_t ticks = g_loopSup.ticks();
+    unsigned long spanMs = currentTime - g_lastHealthSendMs;
+    m.loopHz = spanMs ? (ticks - g_healthLoopTicks) * 1000.0f / spanMs : 0.0f;
+    g_healthLoopTicks = ticks;
+    m.freeHeap = ESP.getFreeHeap();
+    m.minFreeHeap = ESP.getMinFreeHeap();
+    m.maxAllocHeap = ESP.getMaxAllocHeap();
+    m.loopStackFree = uxTaskGetStackHighWaterMark(nullptr);  // bytes on ESP-IDF
+    m.zcIsrs = zcCount;
+    m.flowIsrs = flowIsrs;
+    m.acIsrs = acIsrs;
+    m.phaseCyclesDropped = g_phaseSampler.cyclesDropped();
+    m.sendOk = g_espnowSendOk;
+    m.sendNoAck = g_espnowSendNoAck;
+    m.sendErrors = __atomic_load_n(&g_espnowSendErrors, __ATOMIC_RELAXED);
+    m.recvFrames = g_espnowRecvFrames;
+    m.logDropped = g_logDroppedTotal;
+    sendToDisplay(reinterpret_cast<const uint8_t*>(&m), sizeof(m));
+}
+
+/**
+ * @brief Send the statistics of the window since the last telemetry packet.
+ */
+static void sendTelemetryStats(unsigned long windowMs) {
+    EspNowTelemetryStats m{};
+    m.type = ESPNOW_TELEMETRY_STATS;
+    m.channels = ESPNOW_STATS_CHANNELS;
+    m.windowMs = static_cast<uint32_t>(windowMs);
+    for (uint8_t i = 0; i < ESPNOW_STATS_CHANNELS; ++i) {
+        const gag::StreamStats& st = g_windowStats[i];
+        m.stats[i].min = st.min();
+        m.stats[i].max = st.max();
+        m.stats[i].mean = st.mean();
+        m.stats[i].last = st.last();
+        m.stats[i].count = static_cast<uint16_t>(st.count() > 0xFFFF ? 0xFFFF : st.count());
+    }
+    sendToDisplay(reinterpret_cast<const uint8_t*>(&m), sizeof(m));
+}
+
+/**
+ * @brief Fold a display time response into the current sync burst.
+ */
+static void handleTimeResponse(const EspNowTimeResponse& resp, int64_t rxUs) {
+    if (!(resp.flags & ESPNOW_TIME_FLAG_VALID)) return;
+    gag::ClockSync::Sample sample;
+    if (!gag::ClockSync::makeSample(static_cast<int64_t>(resp.originUs), resp.receiveUs,
+                                    resp.transmitUs, rxUs, TIME_MAX_RTT_US, sample)) {
+        return;
+    }
+    portENTER_CRITICAL(&g_timeMux);
+    g_clockSync.addSample(sample);
+    portEXIT_CRITICAL(&g_timeMux);
+}
+
 static void espNowRecv(const uint8_t* mac, const uint8_t* data, int len) {
+    int64_t rxUs = esp_timer_get_time();
     if (!data || len <= 0) return;
+    g_espnowRecvFrames = g_espnowRecvFrames + 1;
+
+    if (len == sizeof(EspNowTimeResponse) && data[0] == ESPNOW_TIME_RESPONSE) {
+        EspNowTimeResponse resp;
+        memcpy(&resp, data, sizeof(resp));
+        handleTimeResponse(resp, rxUs);
+        g_lastDisplayAckMs = millis();
+        return;
+    }
+
+    if (gag::ota::isFrame(data, len)) {
+        // Only the paired display may write the inactive app partition.
+        if (g_espnowHandshake && mac && memcmp(mac, g_displayMac, ESP_NOW_ETH_ALEN) == 0) {
+            gag::ota::handleFrame(data, len);
+            g_lastDisplayAckMs = millis();
+        }
+        return;
+    }
 
     if (len >= 2 && data[0] == ESPNOW_HANDSHAKE_REQ) {
         uint8_t requestedChannel = data[1];
@@ -795,9 +1882,10 @@ static void espNowRecv(const uint8_t* mac, const uint8_t* data, int len) {
         g_lastChannelHopMs = nowMs;
         g_espnowScanning = false;
         g_nextScanChannel = requestedChannel;
-        uint8_t ack[2] = {ESPNOW_HANDSHAKE_ACK, g_espnowChannel};
+        uint8_t flags = g_paramTable.subscribed() ? ESPNOW_HANDSHAKE_FLAG_PARAMS : 0;
+        uint8_t ack[3] = {ESPNOW_HANDSHAKE_ACK, g_espnowChannel, flags};
         if (mac) {
-            esp_err_t ackErr = esp_now_send(mac, ack, sizeof(ack));
+            esp_err_t ackErr = espNowSend(mac, ack, sizeof(ack));
             if (ackErr != ESP_OK) {
                 LOG_ERROR("ESP-NOW: handshake ack send failed (%d)", static_cast<int>(ackErr));
             }
@@ -813,12 +1901,47 @@ static void espNowRecv(const uint8_t* mac, const uint8_t* data, int len) {
         return;
     }
 
+    if (len >= ESPNOW_PARAM_HEADER_LEN &&
+        (data[0] == ESPNOW_PARAM_GET || data[0] == ESPNOW_PARAM_SUBSCRIBE ||
+         data[0] == ESPNOW_PARAM_SET)) {
+        // Queued in arrival order; each is answered with a report.
+        if (g_paramQueue && len <= static_cast<int>(sizeof(ParamRequest::data))) {
+            ParamRequest req;
+            req.len = static_cast<uint8_t>(len);
+            memcpy(req.data, data, len);
+            if (xQueueSend(g_paramQueue, &req, 0) != pdTRUE) {
+                LOG_ERROR("Params: request queue full, dropped 0x%02x", data[0]);
+            }
+        }
+        g_lastDisplayAckMs = millis();
+        return;
+    }
+
+    if (len == sizeof(EspNowCalCommand) && data[0] == ESPNOW_CAL_COMMAND) {
+        memcpy(&g_calCommand, data, sizeof(g_calCommand));
+        g_calCommandPending = true;
+        g_lastDisplayAckMs = millis();
+        return;
+    }
+
     if (len == 1 && data[0] == ESPNOW_SENSOR_ACK) {
         g_lastDisplayAckMs = millis();
         return;
     }
 }
 
+/**
+ * @brief Delivery result of a sent frame (Wi-Fi task); broadcasts are never acknowledged.
+ */
+static void espNowSent(const uint8_t* mac, esp_now_send_status_t status) {
+    if (!mac || (mac[0] & 0x01)) return;
+    if (status == ESP_NOW_SEND_SUCCESS) {
+        g_espnowSendOk = g_espnowSendOk + 1;
+    } else {
+        g_espnowSendNoAck = g_espnowSendNoAck + 1;
+    }
+}
+
 static bool ensureEspNowCore(bool silent = false) {
     if (g_espnowCoreInit) return true;
 
@@ -835,6 +1958,7 @@ static bool ensureEspNowCore(bool silent = false) {
     g_broadcastPeerInfo.encrypt = false;
 
     esp_now_register_recv_cb(espNowRecv);
+    esp_now_register_send_cb(espNowSent);
     g_espnowHandshake = false;
     g_haveDisplayPeer = false;
     g_lastDisplayAckMs = 0;
@@ -931,12 +2055,6 @@ static void maybeHopEspNowChannel() {
         return;
     }
 
-    if (g_wifiNtpConnecting) return;
-
-    if (WiFi.status() == WL_CONNECTED) {
-        return;
-    }
-
     unsigned long now = millis();
     if ((now - g_lastChannelHopMs) < ESPNOW_CHANNEL_HOLD_MS) return;
 
@@ -956,69 +2074,152 @@ static void maybeHopEspNowChannel() {
         g_espnowStatus = "scanning";
     }
 }
-static void syncClockFromWifi() {
-    static bool attempted = false;
-    static bool connecting = false;
-    static unsigned long lastTry = 0;
-    static unsigned long connectStart = 0;
-    static bool loggedConnected = false;
 
-    wl_status_t status = WiFi.status();
+static void logBootTimeline() {
+    auto ms = [](int64_t us) { return us ? static_cast<long>(us / 1000) : -1L; };
+    LOG("Boot: setup=%ldms control=%ldms pid=%ldms radio=%ldms link=%ldms clock=%ldms",
+        ms(g_boot.setupUs), ms(g_boot.controlUs), ms(g_boot.firstPidUs), ms(g_boot.radioUs),
+        ms(g_boot.linkUs), ms(g_boot.clockUs));
+}
+
+static void setClockFromModel(int64_t localUs) {
+    int64_t utc = g_clockSync.utcUs(localUs);
+    struct timeval tv;
+    tv.tv_sec = static_cast<time_t>(utc / 1000000);
+    tv.tv_usec = static_cast<suseconds_t>(utc % 1000000);
+    settimeofday(&tv, nullptr);
+}
 
-    if (g_clockSynced) {
-        if (status == WL_CONNECTED) {
-            LOG("WiFi: disconnecting after NTP sync");
-            WiFi.disconnect(false, true);
-        }
-        connecting = false;
-        g_wifiNtpConnecting = false;
+/**
+ * @brief Keep the RTC on the display's NTP time; runs in netTask().
+ *
+ * Sends a burst of TIME_BURST_SAMPLES requests, then commits the lowest-RTT
+ * answer to the clock model. Between bursts the RTC is re-set from the
+ * drift-corrected model, so it holds time even if the display goes away.
+ */
+static void serviceTimeSync() {
+    static int burstLeft = 0;
+    static bool burstOpen = false;
+    static int64_t nextUs = 0;
+    static int64_t lastDisciplineUs = 0;
+
+    int64_t now = esp_timer_get_time();
+    if (g_clockSynced && now - lastDisciplineUs >= TIME_DISCIPLINE_US) {
+        setClockFromModel(now);
+        lastDisciplineUs = now;
+    }
+    if (now < nextUs) return;
+    if (!g_espnowHandshake || !g_haveDisplayPeer) {
+        burstOpen = false;
+        nextUs = now + TIME_RETRY_US;
         return;
     }
 
-    if (status == WL_CONNECTED) {
-        if (!loggedConnected) {
-            LOG("WiFi: %s  IP=%s  GW=%s  RSSI=%d dBm", wifiStatusName(status),
-                WiFi.localIP().toString().c_str(), WiFi.gatewayIP().toString().c_str(),
-                WiFi.RSSI());
-            loggedConnected = true;
-        }
-
-        syncClock();
-        if (g_clockSynced) {
-            WiFi.disconnect(false, true);
-            LOG("WiFi: NTP sync complete; Wi-Fi disabled");
-        }
-        g_wifiNtpConnecting = false;
+    if (!burstOpen) {
+        burstOpen = true;
+        burstLeft = TIME_BURST_SAMPLES;
+    }
+    if (burstLeft > 0) {
+        EspNowTimeRequest req{};
+        req.type = ESPNOW_TIME_REQUEST;
+        req.seq = ++g_timeSeq;
+        req.originUs = static_cast<uint64_t>(esp_timer_get_time());
+        sendToDisplay(reinterpret_cast<const uint8_t*>(&req), sizeof(req));
+        --burstLeft;
+        nextUs = now + TIME_BURST_GAP_US;
         return;
     }
 
-    loggedConnected = false;
+    // Last request has had a full gap to come back; close the burst.
+    burstOpen = false;
+    portENTER_CRITICAL(&g_timeMux);
+    bool ok = g_clockSync.commitBurst();
+    portEXIT_CRITICAL(&g_timeMux);
+    nextUs = now + (ok ? TIME_POLL_US : TIME_RETRY_US);
+    if (!ok) return;
+
+    setClockFromModel(now);
+    lastDisciplineUs = now;
+    if (!g_clockSynced) {
+        g_clockSynced = true;
+        g_boot.clockUs = now;
+        time_t t = time(nullptr);
+        struct tm tm;
+        gmtime_r(&t, &tm);
+        LOG("RTC: %04d-%02d-%02d %02d:%02d:%02d from display (rtt %ld us)", tm.tm_year + 1900,
+            tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+            static_cast<long>(g_clockSync.lastRttUs()));
+        logBootTimeline();
+    } else if (debugPrint) {
+        LOG("RTC: step %ld us, rtt %ld us, drift %.2f ppm",
+            static_cast<long>(g_clockSync.lastCorrectionUs()),
+            static_cast<long>(g_clockSync.lastRttUs()), g_clockSync.driftPpm());
+    }
+}
 
-    unsigned long now = millis();
-    if (!connecting && (!attempted || (now - lastTry) >= 10000)) {
-        LOG("WiFi: connecting to '%s' for NTP sync", WIFI_SSID);
-        WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-        connecting = true;
-        attempted = true;
-        connectStart = now;
-        lastTry = now;
-        g_wifiNtpConnecting = true;
-        return;
+/**
+ * @brief Background task owning radio bring-up, channel scanning and clock sync.
+ *
+ * Started at the end of setup() so Wi-Fi initialisation and the ESP-NOW
+ * channel hunt never delay the first heater PID step or stall loop().
+ */
+static void netTask(void*) {
+    WiFi.mode(WIFI_STA);
+#if defined(ARDUINO_ARCH_ESP32)
+    WiFi.setSleep(false);
+    WiFi.setAutoReconnect(false);
+#endif
+
+    initEspNow();
+    if (!gag::ota::begin(sendToDisplay)) {
+        LOG_ERROR("Boot: OTA task create failed; updates disabled");
+    }
+    g_boot.radioUs = esp_timer_get_time();
+    g_netReady = true;
+    logBootTimeline();
+
+    for (;;) {
+        maybeHopEspNowChannel();
+        serviceTimeSync();
+        if (!g_boot.linkUs && g_espnowHandshake) {
+            g_boot.linkUs = esp_timer_get_time();
+            logBootTimeline();
+        }
+        vTaskDelay(pdMS_TO_TICKS(NET_TASK_PERIOD_MS));
     }
+}
 
-    if (connecting) {
-        wl_status_t res = static_cast<wl_status_t>(WiFi.waitForConnectResult(100));
-        if (res == WL_CONNECTED) {
-            connecting = false;
-            g_wifiNtpConnecting = false;
-        } else if ((millis() - connectStart) > 10000) {
-            connecting = false;
-            g_wifiNtpConnecting = false;
-            WiFi.disconnect(false, true);
+/**
+ * @brief Drain queued log lines to the UART on core 0.
+ */
+static void logTask(void*) {
+    for (;;) {
+        size_t len = 0;
+        void* item = xRingbufferReceive(g_logRing, &len, portMAX_DELAY);
+        if (!item) continue;
+        Serial.write(static_cast<const uint8_t*>(item), len);
+        vRingbufferReturnItem(g_logRing, item);
+        uint32_t dropped = g_logDropped;
+        if (dropped) {
+            g_logDropped = 0;
+            Serial.printf("[log] %lu lines dropped\n", (unsigned long)dropped);
         }
-        delay(1);
     }
-    if (!connecting) g_wifiNtpConnecting = false;
+}
+
+/**
+ * @brief Move serial output off the control core; LOG() writes directly until this succeeds.
+ */
+static void setupLogTask() {
+    RingbufHandle_t ring = xRingbufferCreate(LOG_RING_BYTES, RINGBUF_TYPE_NOSPLIT);
+    if (!ring) return;
+    g_logRing = ring;
+    if (xTaskCreatePinnedToCore(logTask, "log", LOG_TASK_STACK, nullptr, LOG_TASK_PRIO, nullptr,
+                                NET_TASK_CORE) != pdPASS) {
+        g_logRing = nullptr;
+        vRingbufferDelete(ring);
+        LOG_ERROR("Boot: log task create failed; logging from the control loop");
+    }
 }
 
 }  // namespace
@@ -1031,6 +2232,13 @@ extern "C" void IRAM_ATTR user_zc_hook() {
     if (now - lastZcTime >= 6000) {
         lastZcTime = now;
         zcCount++;
+        if (g_pressSampleTimer) {
+            portENTER_CRITICAL_ISR(&g_phaseMux);
+            uint32_t firstUs = g_phaseSampler.onZeroCross(now);
+            portEXIT_CRITICAL_ISR(&g_phaseMux);
+            esp_timer_stop(g_pressSampleTimer);
+            esp_timer_start_once(g_pressSampleTimer, firstUs);
+        }
     }
 }
 
@@ -1040,9 +2248,17 @@ namespace gag {
  * @copydoc gag::setup()
  */
 void setup() {
+    g_boot.setupUs = esp_timer_get_time();
+    // Outputs first: heater off and pump idle before anything that can block.
+    pinMode(HEAT_PIN, OUTPUT);
+    digitalWrite(HEAT_PIN, LOW);
+    heaterState = false;
+
     Serial.begin(SERIAL_BAUD);
-    delay(300);
+    setupLogTask();
     LOG("Booting? FW %s", VERSION);
+    LOG("Cores: control on %d (expected %d), radio/log on %d", (int)xPortGetCoreID(),
+        (int)CONTROL_CORE, (int)NET_TASK_CORE);
 #if defined(CONFIG_FREERTOS_TIMER_TASK_STACK_DEPTH)
     LOG("RTOS: Tmr Svc stack depth=%d (words)", (int)CONFIG_FREERTOS_TIMER_TASK_STACK_DEPTH);
 #endif
@@ -1053,34 +2269,43 @@ void setup() {
 #endif
 
     pinMode(MAX_CS, OUTPUT);
-    pinMode(HEAT_PIN, OUTPUT);
     pinMode(PRESS_PIN, INPUT);
     pinMode(FLOW_PIN, INPUT_PULLUP);
     pinMode(ZC_PIN, INPUT);
     pinMode(AC_SENS, INPUT_PULLUP);
     pinMode(PUMP_PIN, OUTPUT);
     pumpDimmer.begin(NORMAL_MODE, OFF);
-    digitalWrite(HEAT_PIN, LOW);
-    heaterState = false;
     applyPumpPower();
     max31865.begin(MAX31865_2WIRE);
 
+    // Restore tuning before the first PID step so the boiler heads for the
+    // tuned setpoint without waiting for the display link.
+    if (g_paramStore.begin(g_params)) {
+        applyParams(g_params);
+        LOG("Params: Brew=%.1f Steam=%.1f P=%.2f I=%.2f D=%.1f", brewSetpoint, steamSetpoint,
+            pGainTemp, iGainTemp, dGainTemp);
+    }
+    if (!g_paramTable.complete()) LOG_ERROR("Params: registry entries without a variable");
+    setupEnergyMeter();
+    setupFlightRecorder();
+
     // Initialize filtered PV & lastTemp to avoid first-step D kick
     currentTemp = max31865.temperature(RNOMINAL, RREF);
     if (currentTemp < 0) currentTemp = 0.0f;
-    pvFiltTemp = currentTemp;
+    g_heaterPid.reset(currentTemp);
     lastTemp = currentTemp;
 
-    // zero pressure using a few samples to average noise
+    // zero pressure using a few samples to average noise; loop() keeps
+    // tracking the zero whenever the pump has been idle for a while
     float startP = 0.0f;
     const int samples = 4;
     for (int i = 0; i < samples; ++i) {
-        startP += analogRead(PRESS_PIN);
+        startP += pressCalibrator.eval(static_cast<float>(analogReadMilliVolts(PRESS_PIN)));
     }
-    startP = startP / samples * pressGrad + pressInt;
+    startP /= samples;
     if (fabsf(startP) <= PRESSURE_TOL) {
-        pressInt -= startP;
-        LOG("Pressure Intercept reset to %f", pressInt);
+        pressZeroBar = gag::Q16_16(-startP);
+        LOG("Pressure zero offset reset to %f", pressZeroBar.toFloat());
     }
 
     // Count both rising and falling edges from the flow sensor to
@@ -1088,31 +2313,61 @@ void setup() {
     // transition and `PULSE_MIN` guards against spurious bounce.
     attachInterrupt(digitalPinToInterrupt(FLOW_PIN), flowInt, CHANGE);
 
-    pulseCount = 0;
+    const esp_timer_create_args_t pressTimerArgs = {
+        .callback = pressSampleTimerCb,
+        .arg = nullptr,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "press_sample",
+        .skip_unhandled_events = false,
+    };
+    if (esp_timer_create(&pressTimerArgs, &g_pressSampleTimer) != ESP_OK) {
+        g_pressSampleTimer = nullptr;
+        LOG_ERROR("Pressure: phase sampler timer unavailable, sampling unsynchronised");
+    }
+
+    attachInterrupt(digitalPinToInterrupt(AC_SENS), acSenseInt, CHANGE);
+    const esp_timer_create_args_t steamTimerArgs = {
+        .callback = steamSenseTimerCb,
+        .arg = nullptr,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "steam_sense",
+        .skip_unhandled_events = true,
+    };
+    if (esp_timer_create(&steamTimerArgs, &g_steamSenseTimer) == ESP_OK) {
+        esp_timer_start_periodic(g_steamSenseTimer, STEAM_SENSE_TICK_MS * 1000);
+    } else {
+        LOG_ERROR("Steam: sense timer unavailable, steam switch ignored");
+    }
+
+    resetFlowVolume();
     startTime = millis();
-    lastPidTime = startTime;
+    // Run the first heater PID step on the first loop() pass.
+    lastPidTime = startTime - PID_CYCLE;
     lastPwmTime = startTime;
     lastPulseTime = esp_timer_get_time();
     setupComplete = true;
-
-    WiFi.mode(WIFI_STA);
-#if defined(ARDUINO_ARCH_ESP32)
-    WiFi.setSleep(false);
-    WiFi.setAutoReconnect(false);
-#endif
-
-    initEspNow();
+    g_boot.controlUs = esp_timer_get_time();
 
     LOG("Pins: FLOW=%d ZC=%d HEAT=%d AC_SENS=%d PRESS=%d  SPI{CS=%d}", FLOW_PIN, ZC_PIN, HEAT_PIN,
         AC_SENS, PRESS_PIN, MAX_CS);
+
+    g_paramQueue = xQueueCreate(PARAM_QUEUE_DEPTH, sizeof(ParamRequest));
+    if (!g_paramQueue) LOG_ERROR("Boot: parameter queue create failed; parameter requests ignored");
+    if (xTaskCreatePinnedToCore(netTask, "net", NET_TASK_STACK, nullptr, NET_TASK_PRIO, nullptr,
+                                NET_TASK_CORE) != pdPASS) {
+        LOG_ERROR("Boot: net task create failed; running without display link");
+    }
+    setupLoopSupervisor();
 }
 
 /**
  * @copydoc gag::loop()
  */
 void loop() {
+    g_loopSup.beginTick(static_cast<uint32_t>(esp_timer_get_time()));
     currentTime = millis();
 
+    loopStage(ESPNOW_LOOP_STAGE_LINK);
     // If the display stops acknowledging, fall back to safe defaults
     if (g_espnowHandshake && g_lastDisplayAckMs &&
         (currentTime - g_lastDisplayAckMs) > DISPLAY_TIMEOUT_MS) {
@@ -1121,44 +2376,139 @@ void loop() {
         g_espnowHandshake = false;
         g_haveDisplayPeer = false;
         g_lastControlRevision = 0;
+        g_paramTable.unsubscribe();
         g_espnowStatus = "timeout";
         revertToSafeDefaults();
     }
 
+    loopStage(ESPNOW_LOOP_STAGE_SHOT);
     checkShotStartStop();
-    if (currentTime - lastPidTime >= PID_CYCLE) updateTempPID();
+    loopStage(ESPNOW_LOOP_STAGE_PID);
+    if (currentTime - lastPidTime >= PID_CYCLE) {
+        updateTempPID();
+        if (!g_boot.firstPidUs) g_boot.firstPidUs = esp_timer_get_time();
+    }
+    loopStage(ESPNOW_LOOP_STAGE_PWM);
     updateTempPWM();
+    loopStage(ESPNOW_LOOP_STAGE_PRESSURE);
     updatePressure();
+    if (g_puckEventPending) reportPuckEvent();
+    loopStage(ESPNOW_LOOP_STAGE_FLOW);
     updatePreFlow();
     updateVols();
+    loopStage(ESPNOW_LOOP_STAGE_STEAM);
     updateSteamFlag();
+    loopStage(ESPNOW_LOOP_STAGE_ANALYTICS);
+    updateShotAnalytics();
+    updateEnergyMeter();
+
+    loopStage(ESPNOW_LOOP_STAGE_CAL);
+    if (g_calCommandPending) {
+        EspNowCalCommand cmd = g_calCommand;
+        g_calCommandPending = false;
+        handleCalCommand(cmd);
+        g_lastCalReportMs = currentTime;
+    } else if (currentTime - g_lastCalReportMs >= ESP_CYCLE) {
+        // live sample count while the user pulls/holds the reference
+        for (size_t t = 0; t < CAL_SESSION_COUNT; ++t) {
+            if (g_calSessions[t].cal->running()) sendCalReport(static_cast<uint8_t>(t));
+        }
+        g_lastCalReportMs = currentTime;
+    }
 
-    syncClockFromWifi();
-    maybeHopEspNowChannel();
+    loopStage(ESPNOW_LOOP_STAGE_PARAMS);
+    serviceParamReports();
+    // Profiles drive setpoints mid-shot; only persist what is left afterwards.
+    if (!shotFlag) g_paramStore.update(captureParams(), currentTime);
+    g_paramStore.service(currentTime);
+
+    loopStage(ESPNOW_LOOP_STAGE_OTA);
+    if (g_netReady) {
+        // Flash work runs in the ota task; the loop only gates and confirms.
+        ota::setBusy(shotFlag);
+        // A freshly flashed image is kept once it has talked to the display and
+        // read a plausible boiler temperature; otherwise the bootloader rolls back.
+        if (g_espnowHandshake && currentTemp > 0.0f) ota::confirmHealthy();
+    }
     // Update shot time continuously while shot is active (seconds)
     if (shotFlag && (zcCount > lastZcCount)) {
         shotTime = (currentTime - shotStart) / 1000.0f;
     }
     lastZcCount = zcCount;
 
+    loopStage(ESPNOW_LOOP_STAGE_TELEMETRY);
+    bool telemetrySent = false;
     if (g_espnowHandshake && (currentTime - lastEspNowTime) >= ESP_CYCLE) {
         sendEspNowPacket();
+        if (TELEMETRY_STATS_ENABLED) sendTelemetryStats(currentTime - g_statsWindowStartMs);
         lastEspNowTime = currentTime;
+        telemetrySent = true;
+    }
+    // Windows close with each send, or every ESP_CYCLE while unlinked so the
+    // first report after a link-up is not stretched over the outage.
+    if (telemetrySent || currentTime - g_statsWindowStartMs >= ESP_CYCLE) {
+        for (gag::StreamStats& st : g_windowStats) st.reset();
+        g_statsWindowStartMs = currentTime;
+    }
+    if (g_shotSummaryRepeats && g_espnowHandshake &&
+        (currentTime - g_lastShotSummarySendMs) >= ESP_CYCLE) {
+        sendToDisplay(reinterpret_cast<const uint8_t*>(&g_shotSummaryMsg), sizeof(g_shotSummaryMsg));
+        g_shotSummaryRepeats--;
+        g_lastShotSummarySendMs = currentTime;
     }
+    if (g_heaterModesRepeats && g_espnowHandshake &&
+        (currentTime - g_lastHeaterModesSendMs) >= ESP_CYCLE) {
+        sendToDisplay(reinterpret_cast<const uint8_t*>(&g_heaterModesMsg), sizeof(g_heaterModesMsg));
+        g_heaterModesRepeats--;
+        g_lastHeaterModesSendMs = currentTime;
+    }
+    if (g_espnowHandshake && (currentTime - g_lastEnergySendMs) >= ENERGY_SEND_MS) {
+        sendEnergyReport();
+        g_lastEnergySendMs = currentTime;
+    }
+    if (g_espnowHandshake && (currentTime - g_lastLoopStatsSendMs) >= LOOP_STATS_SEND_MS) {
+        sendLoopStats();
+        g_lastLoopStatsSendMs = currentTime;
+    }
+    if (g_espnowHandshake && (currentTime - g_lastHealthSendMs) >= HEALTH_SEND_MS) {
+        sendHealth();
+        g_lastHealthSendMs = currentTime;
+    }
+    serviceFlightRecord();
 
+    loopStage(ESPNOW_LOOP_STAGE_LOG);
     if (debugPrint && (currentTime - lastLogTime) > LOG_CYCLE) {
-        LOG("Pressure: Raw=%d, Now=%0.2f Last=%0.2f", rawPress, pressNow, lastPress);
-        LOG("Temp: Set=%0.1f, Current=%0.2f", setTemp, currentTemp);
+        LOG("Pressure: mV=%d, Zero=%0.2f Now=%0.2f Last=%0.2f", pressMv, pressZeroBar.toFloat(),
+            pressNow, lastPress);
+        LOG("Temp: Set=%0.1f, Current=%0.2f, Brew est=%0.2f (resid %0.2f)", setTemp, currentTemp,
+            g_thermal.brewC(), g_thermal.residualC());
         LOG("Heat: Power=%0.1f, Cycles=%d", heatPower, heatCycles);
         LOG("Vol: Pulses=%lu, Vol=%0.2f", pulseCount, vol);
-        LOG("Pump: ZC Count =%lu", zcCount);
+        LOG("Pump: ZC Count =%lu, Half=%luus, Dropped=%lu", zcCount,
+            (unsigned long)g_phaseSampler.halfPeriodUs(),
+            (unsigned long)g_phaseSampler.cyclesDropped());
         LOG("Flags: Steam=%d, Shot=%d", steamFlag, shotFlag);
-        LOG("AC Count=%d", acCount);
+        LOG("AC: Edges=%lu, Present=%d, Steam detect=%lu ms", (unsigned long)acCount, ac,
+            (unsigned long)steamDetectMs);
         LOG("PID: P=%0.1f, I=%0.2f, D=%0.1f, G=%0.1f", pGainTemp, iGainTemp, dGainTemp,
             windupGuardTemp);
+        if (pumpPressureModeEnabled) {
+            const PumpPid::Terms& t = g_pumpPid.terms();
+            LOG("Pump PID: P=%0.1f, I=%0.1f, D=%0.1f, Out=%0.1f", t.p, t.i, t.d, t.out);
+        }
+        LOG("Loop: last %lu us, worst %lu us, %lu overruns, %lu trips",
+            (unsigned long)g_loopSup.lastTickUs(), (unsigned long)g_loopSup.worstTickUs(),
+            (unsigned long)g_loopSup.overruns(), (unsigned long)g_loopSup.trips());
+        const gag::CycleStats& hotPid = g_hotCycles[ESPNOW_LOOP_HOT_PID];
+        LOG("Hot: PID %lu..%lu cycles, pressure max %lu, flow max %lu (%s)",
+            (unsigned long)hotPid.min(), (unsigned long)hotPid.maxCycles,
+            (unsigned long)g_hotCycles[ESPNOW_LOOP_HOT_PRESSURE].maxCycles,
+            (unsigned long)g_hotCycles[ESPNOW_LOOP_HOT_FLOW].maxCycles,
+            GAG_CONTROL_IRAM ? "IRAM" : "flash");
         LOG("");
         lastLogTime = currentTime;
     }
+    endLoopTick();
 }
 
 }  // namespace gag
@@ -20,9 +20,10 @@ namespace gag {
  * @brief Initialize hardware, connectivity and discovery.
  *
  * Responsibilities:
- * - Configure pins and peripherals (MAX31865, ADC, etc.).
- * - Start Wi‑Fi briefly to synchronize NTP time, then establish the ESP-NOW link to the display.
+ * - Force outputs safe, restore persisted tuning and configure peripherals
+ *   (MAX31865, ADC, etc.) so the heater PID can run on the first loop() pass.
  * - Calibrate/zero pressure intercept on boot if near atmospheric.
+ * - Start a background task that brings up the ESP-NOW link and clock sync.
  */
 void setup();
 
@@ -0,0 +1,44 @@
+/**
+ * @file heater_modes.cpp
+ * @brief Per-mode holding duty and steam/brew transition timing.
+ */
+#include "heater_modes.h"
+
+#include <math.h>
+
+namespace gag {
+
+bool HeaterModes::enter(HeaterMode mode, uint32_t nowMs, float tempC) {
+    if (mode == mode_) return false;
+    mode_ = mode;
+    steamPending_ = mode == HEATER_MODE_STEAM;
+    brewPending_ = mode == HEATER_MODE_BREW;
+    pendingSinceMs_ = nowMs;
+    pendingFromC_ = tempC;
+    return true;
+}
+
+HeaterModes::Event HeaterModes::update(uint32_t nowMs, float dtS, float spC, float tempC,
+                                       float outPct, bool learn) {
+    float err = spC - tempC;
+    // Saturated passes say nothing about the holding duty.
+    if (learn && fabsf(err) <= cfg_.holdBandC && outPct > 0.0f && outPct < 100.0f && dtS > 0.0f) {
+        hold_[mode_] += dtS / (cfg_.holdTauS + dtS) * (outPct - hold_[mode_]);
+    }
+
+    if (steamPending_ && err <= cfg_.readyBandC) {
+        steamPending_ = false;
+        steamReadyMs_ = nowMs - pendingSinceMs_;
+        steamStartC_ = pendingFromC_;
+        return EVENT_STEAM_READY;
+    }
+    if (brewPending_ && fabsf(err) <= cfg_.readyBandC) {
+        brewPending_ = false;
+        brewRecoveryMs_ = nowMs - pendingSinceMs_;
+        brewStartC_ = pendingFromC_;
+        return EVENT_BREW_RECOVERED;
+    }
+    return EVENT_NONE;
+}
+
+}  // namespace gag
@@ -0,0 +1,81 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file heater_modes.h
+ * @brief Brew/steam heater regimes: holding duty per mode and transition times.
+ *
+ * The heater runs one PID with a gain set per mode. While the boiler sits
+ * within holdBandC of the setpoint, the output is averaged per mode into the
+ * duty that holds that temperature; on a mode change the PID integrator is
+ * preloaded with it so the new regime does not have to wind up from zero.
+ *
+ * Two transition times are measured on the boiler sensor: steam ready (steam
+ * entry until within readyBandC below the steam setpoint) and brew recovery
+ * (steam exit until within readyBandC of the brew setpoint). A measurement
+ * is dropped when the mode changes again or the heater is switched off first.
+ */
+
+namespace gag {
+
+enum HeaterMode : uint8_t {
+    HEATER_MODE_BREW = 0,  // brew and eco setpoints
+    HEATER_MODE_STEAM = 1,
+    HEATER_MODE_COUNT
+};
+
+class HeaterModes {
+   public:
+    struct Config {
+        float readyBandC;  // transition complete this close to the setpoint
+        float holdBandC;   // holding duty is learned this close to the setpoint
+        float holdTauS;    // holding duty average time constant
+    };
+
+    enum Event : uint8_t { EVENT_NONE = 0, EVENT_STEAM_READY, EVENT_BREW_RECOVERED };
+
+    explicit HeaterModes(const Config& cfg) : cfg_(cfg) {}
+
+    /**
+     * @brief Track the mode at @p nowMs with the boiler at @p tempC.
+     * @return true when the mode changed.
+     */
+    bool enter(HeaterMode mode, uint32_t nowMs, float tempC);
+
+    /**
+     * @brief Feed one PID pass.
+     *
+     * @param dtS    seconds since the previous pass
+     * @param spC    active setpoint
+     * @param tempC  boiler temperature
+     * @param outPct PID output of this pass
+     * @param learn  false keeps @p outPct out of the holding duty (e.g. an eco hold)
+     * @return the transition this pass completed, if any.
+     */
+    Event update(uint32_t nowMs, float dtS, float spC, float tempC, float outPct, bool learn);
+
+    /** The heater is off: pending transitions are not measured. */
+    void cancel() { steamPending_ = brewPending_ = false; }
+
+    HeaterMode mode() const { return mode_; }
+    /** Learned holding duty for @p mode (%), 0 until the mode has settled once. */
+    float holdingPct(HeaterMode mode) const { return hold_[mode]; }
+
+    /** Last completed transitions (ms) and the boiler temperature each started from. */
+    uint32_t steamReadyMs() const { return steamReadyMs_; }
+    float steamStartC() const { return steamStartC_; }
+    uint32_t brewRecoveryMs() const { return brewRecoveryMs_; }
+    float brewStartC() const { return brewStartC_; }
+
+   private:
+    Config cfg_;
+    HeaterMode mode_ = HEATER_MODE_BREW;
+    float hold_[HEATER_MODE_COUNT] = {0.0f, 0.0f};
+    bool steamPending_ = false, brewPending_ = false;
+    uint32_t pendingSinceMs_ = 0;
+    float pendingFromC_ = 0.0f;
+    uint32_t steamReadyMs_ = 0, brewRecoveryMs_ = 0;
+    float steamStartC_ = 0.0f, brewStartC_ = 0.0f;
+};
+
+}  // namespace gag
@@ -0,0 +1,27 @@
+#pragma once
+
+/**
+ * @file hot_path.h
+ * @brief Placement of the per-pass control code.
+ *
+ * The firmware's own per-pass control code is tagged CONTROL_HOT and placed
+ * in IRAM, so its instruction fetches never miss the flash cache while Wi-Fi
+ * or flash access on the other core has evicted it. Only the tagged bodies
+ * move: calls out to the Arduino core, drivers and libraries (ADC read,
+ * MAX31865 over SPI, the dimmer, libm, LOG formatting) still run from flash
+ * and can still stall. Keep those calls few and out of the tagged code where
+ * possible. Build with `-D GAG_CONTROL_IRAM=0` to leave the tagged code in
+ * flash and compare the hot-path figures in the loop report.
+ */
+
+#include <esp_attr.h>
+
+#ifndef GAG_CONTROL_IRAM
+#define GAG_CONTROL_IRAM 1
+#endif
+
+#if GAG_CONTROL_IRAM
+#define CONTROL_HOT IRAM_ATTR
+#else
+#define CONTROL_HOT
+#endif
@@ -0,0 +1,55 @@
+/**
+ * @file loop_supervisor.cpp
+ * @brief Stage timing, deadline overruns and stall trips.
+ */
+#include "loop_supervisor.h"
+
+namespace gag {
+
+void LoopSupervisor::beginTick(uint32_t nowUs) {
+    stage_ = 0;
+    stageStartUs_ = nowUs;
+    tickWorstUs_ = 0;
+    tickWorstStage_ = 0;
+    tripLatched_ = false;
+    tickStartUs_ = nowUs;
+    inTick_ = true;
+}
+
+void LoopSupervisor::enter(uint8_t stage, uint32_t nowUs) {
+    uint8_t prev = stage_;
+    uint32_t us = nowUs - stageStartUs_;
+    if (us > stageMaxUs_[prev]) stageMaxUs_[prev] = us;
+    if (us >= tickWorstUs_) {
+        tickWorstUs_ = us;
+        tickWorstStage_ = prev;
+    }
+    stageStartUs_ = nowUs;
+    stage_ = stage < MAX_STAGES ? stage : MAX_STAGES - 1;
+}
+
+bool LoopSupervisor::endTick(uint32_t nowUs) {
+    enter(0, nowUs);
+    inTick_ = false;
+    uint32_t us = nowUs - tickStartUs_;
+    ++ticks_;
+    lastTickUs_ = us;
+    if (us > worstTickUs_) worstTickUs_ = us;
+    if (us <= cfg_.deadlineUs) return false;
+    ++overruns_;
+    ++stageOverruns_[tickWorstStage_];
+    lastOverrunStage_ = tickWorstStage_;
+    return true;
+}
+
+bool LoopSupervisor::stalled(uint32_t nowUs) {
+    if (!inTick_ || tripLatched_) return false;
+    if (nowUs - tickStartUs_ < cfg_.tripUs) return false;
+    tripLatched_ = true;
+    lastTripStage_ = stage_;
+    trips_ = trips_ + 1;
+    tripPending_ = true;
+    return true;
+}
+
+}  // namespace gag
@@ -0,0 +1,102 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file loop_supervisor.h
+ * @brief Per-tick deadline accounting and stall detection for the control loop.
+ *
+ * The control loop marks the start of each pass and every stage it enters.
+ * At the end of a pass the supervisor checks it against the deadline and
+ * charges an overrun to the stage that took longest. Independently, a
+ * supervisor running in another task polls stalled(): once the current pass
+ * has been running longer than the trip time it latches a trip, records the
+ * stage the loop is stuck in, and the caller forces the outputs safe. The
+ * fields shared with that task are single words, so no lock is needed.
+ */
+
+namespace gag {
+
+class LoopSupervisor {
+   public:
+    static constexpr uint8_t MAX_STAGES = 16;
+
+    struct Config {
+        uint32_t deadlineUs;  // a pass longer than this is an overrun
+        uint32_t tripUs;      // a pass still running after this trips the supervisor
+    };
+
+    explicit LoopSupervisor(const Config& cfg) : cfg_(cfg) {}
+
+    void beginTick(uint32_t nowUs);
+    /** Close the running stage and start @p stage (< MAX_STAGES). */
+    void enter(uint8_t stage, uint32_t nowUs);
+    /** Close the pass; @return true when it overran the deadline. */
+    bool endTick(uint32_t nowUs);
+
+    /**
+     * @brief Supervisor side: true once per stalled pass, when it passes the trip time.
+     *
+     * Safe to call from another task or core while the loop is running.
+     */
+    bool stalled(uint32_t nowUs);
+    /** Loop side: true once after a trip, when the stalled pass has finished. */
+    bool takeTrip() {
+        if (!tripPending_ || inTick_) return false;
+        tripPending_ = false;
+        return true;
+    }
+
+    const Config& config() const { return cfg_; }
+    uint32_t ticks() const { return ticks_; }
+    uint32_t overruns() const { return overruns_; }
+    uint32_t trips() const { return trips_; }
+    uint32_t lastTickUs() const { return lastTickUs_; }
+    uint32_t worstTickUs() const { return worstTickUs_; }
+    /** Slowest stage of the last finished pass. */
+    uint8_t lastTickStage() const { return tickWorstStage_; }
+    uint8_t lastOverrunStage() const { return lastOverrunStage_; }
+    uint8_t lastTripStage() const { return lastTripStage_; }
+    uint32_t stageMaxUs(uint8_t stage) const { return stageMaxUs_[stage]; }
+    uint32_t stageOverruns(uint8_t stage) const { return stageOverruns_[stage]; }
+
+   private:
+    Config cfg_;
+    // Shared with the supervisor task.
+    volatile uint32_t tickStartUs_ = 0;
+    volatile uint8_t stage_ = 0;
+    volatile bool inTick_ = false;
+    volatile bool tripLatched_ = false;  // this pass already tripped
+    volatile bool tripPending_ = false;  // tripped, not yet reported by the loop
+    volatile uint32_t trips_ = 0;
+    volatile uint8_t lastTripStage_ = 0;
+    // Loop only.
+    uint32_t stageStartUs_ = 0;
+    uint32_t tickWorstUs_ = 0;
+    uint8_t tickWorstStage_ = 0;
+    uint32_t ticks_ = 0, overruns_ = 0;
+    uint32_t lastTickUs_ = 0, worstTickUs_ = 0;
+    uint8_t lastOverrunStage_ = 0;
+    uint32_t stageMaxUs_[MAX_STAGES] = {};
+    uint32_t stageOverruns_[MAX_STAGES] = {};
+};
+
+/**
+ * @brief Min/max/mean of a section's CPU cycle count; max - min is its jitter.
+ */
+struct CycleStats {
+    uint32_t minCycles = UINT32_MAX;
+    uint32_t maxCycles = 0;
+    uint64_t sumCycles = 0;
+    uint32_t count = 0;
+
+    void add(uint32_t cycles) {
+        if (cycles < minCycles) minCycles = cycles;
+        if (cycles > maxCycles) maxCycles = cycles;
+        sumCycles += cycles;
+        ++count;
+    }
+    uint32_t min() const { return count ? minCycles : 0; }
+    uint32_t mean() const { return count ? static_cast<uint32_t>(sumCycles / count) : 0; }
+};
+
+}  // namespace gag
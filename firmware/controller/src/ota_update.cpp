@@ -0,0 +1,249 @@
+/**
+ * @file ota_update.cpp
+ * @brief ESP-NOW OTA receiver: flash writer, resume journal and rollback guard.
+ */
+#include "ota_update.h"
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <esp_now.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <string.h>
+
+#include "espnow_ota.h"
+#include "espnow_protocol.h"
+
+// Tell the Arduino core to leave the pending-verify image alone at boot; the
+// firmware confirms it itself once the link and sensors are up.
+extern "C" bool verifyRollbackLater() { return true; }
+
+namespace gag {
+namespace ota {
+namespace {
+
+constexpr uint32_t SECTOR_SIZE = 4096;
+constexpr uint32_t JOURNAL_INTERVAL = 16 * 1024;  // bytes between persisted resume points
+constexpr unsigned QUEUE_DEPTH = 12;              // > sender window so bursts are not dropped
+constexpr unsigned long REBOOT_DELAY_MS = 1000;   // let the RESULT frame go out first
+constexpr unsigned long VERIFY_TIMEOUT_MS = 120000;
+constexpr uint32_t TASK_STACK = 4096;
+constexpr UBaseType_t TASK_PRIO = 1;
+constexpr BaseType_t TASK_CORE = 0;  // with the Wi-Fi stack, away from loop()
+constexpr unsigned long DEADLINE_POLL_MS = 100;  // wake-up while a reboot or rollback is due
+constexpr const char* PREFS_NS = "ota";
+constexpr const char* PREFS_KEY = "resume";
+
+struct Frame {
+    uint8_t len;
+    uint8_t data[ESP_NOW_MAX_DATA_LEN];
+};
+
+struct Journal {
+    uint32_t imageSize;
+    uint32_t imageCrc;
+    uint32_t offset;
+    uint32_t partition;  // address of the target partition
+};
+
+QueueHandle_t g_queue = nullptr;
+SendFn g_send = nullptr;
+EspNowOtaReceiver g_rx;
+const esp_partition_t* g_part = nullptr;
+uint32_t g_erasedEnd = 0;
+uint32_t g_journaled = 0;
+volatile bool g_busy = false;  // set by loop()
+unsigned long g_rebootAtMs = 0;
+volatile bool g_pendingVerify = false;  // cleared by confirmHealthy() from loop()
+unsigned long g_verifyDeadlineMs = 0;
+Preferences g_prefs;
+
+void saveJournal(uint32_t offset) {
+    Journal j{g_rx.imageSize, g_rx.imageCrc, offset, g_part ? g_part->address : 0};
+    if (g_prefs.begin(PREFS_NS, false)) {
+        g_prefs.putBytes(PREFS_KEY, &j, sizeof(j));
+        g_prefs.end();
+    }
+    g_journaled = offset;
+}
+
+void clearJournal() {
+    if (g_prefs.begin(PREFS_NS, false)) {
+        g_prefs.remove(PREFS_KEY);
+        g_prefs.end();
+    }
+    g_journaled = 0;
+}
+
+bool loadJournal(Journal& j) {
+    bool ok = false;
+    if (g_prefs.begin(PREFS_NS, true)) {
+        ok = g_prefs.getBytes(PREFS_KEY, &j, sizeof(j)) == sizeof(j);
+        g_prefs.end();
+    }
+    return ok;
+}
+
+EspNowOtaStatus rxBegin(void*, uint32_t imageSize, uint32_t imageCrc, uint32_t* resume) {
+    if (g_busy || g_rebootAtMs) return ESPNOW_OTA_STATUS_BUSY;
+    g_part = esp_ota_get_next_update_partition(nullptr);
+    if (!g_part) return ESPNOW_OTA_STATUS_WRITE_ERROR;
+    if (imageSize == 0 || imageSize > g_part->size) return ESPNOW_OTA_STATUS_TOO_LARGE;
+
+    Journal j{};
+    *resume = 0;
+    if (loadJournal(j) && j.imageSize == imageSize && j.imageCrc == imageCrc &&
+        j.partition == g_part->address && j.offset <= imageSize) {
+        // Sectors up to the journaled offset were erased and written; anything
+        // past the partially written sector is erased again as it is reached.
+        *resume = j.offset;
+    }
+    g_erasedEnd = (*resume + SECTOR_SIZE - 1) / SECTOR_SIZE * SECTOR_SIZE;
+    g_rx.imageSize = imageSize;
+    g_rx.imageCrc = imageCrc;
+    saveJournal(*resume);
+    Serial.printf("OTA: begin %u bytes crc=%08x into %s, resume at %u\n", (unsigned)imageSize,
+                  (unsigned)imageCrc, g_part->label, (unsigned)*resume);
+    return ESPNOW_OTA_STATUS_OK;
+}
+
+EspNowOtaStatus rxWrite(void*, uint32_t offset, const uint8_t* data, size_t len) {
+    if (!g_part) return ESPNOW_OTA_STATUS_NO_SESSION;
+    while (offset + len > g_erasedEnd) {
+        if (esp_partition_erase_range(g_part, g_erasedEnd, SECTOR_SIZE) != ESP_OK)
+            return ESPNOW_OTA_STATUS_WRITE_ERROR;
+        g_erasedEnd += SECTOR_SIZE;
+    }
+    if (esp_partition_write(g_part, offset, data, len) != ESP_OK)
+        return ESPNOW_OTA_STATUS_WRITE_ERROR;
+    if (offset + len - g_journaled >= JOURNAL_INTERVAL) saveJournal(offset + len);
+    return ESPNOW_OTA_STATUS_OK;
+}
+
+EspNowOtaStatus rxFinish(void*, uint32_t imageSize, uint32_t imageCrc) {
+    if (!g_part) return ESPNOW_OTA_STATUS_NO_SESSION;
+    clearJournal();
+
+    uint8_t buf[256];
+    uint32_t crc = 0;
+    for (uint32_t off = 0; off < imageSize; off += sizeof(buf)) {
+        size_t n = imageSize - off < sizeof(buf) ? imageSize - off : sizeof(buf);
+        if (esp_partition_read(g_part, off, buf, n) != ESP_OK)
+            return ESPNOW_OTA_STATUS_VERIFY_FAILED;
+        crc = espnow_ota_crc32(crc, buf, n);
+    }
+    if (crc != imageCrc) {
+        Serial.printf("OTA: readback crc %08x != %08x\n", (unsigned)crc, (unsigned)imageCrc);
+        return ESPNOW_OTA_STATUS_VERIFY_FAILED;
+    }
+    // Validates the image header/segments before switching otadata.
+    if (esp_ota_set_boot_partition(g_part) != ESP_OK) return ESPNOW_OTA_STATUS_VERIFY_FAILED;
+
+    Serial.printf("OTA: image verified, rebooting into %s\n", g_part->label);
+    g_rebootAtMs = millis() + REBOOT_DELAY_MS;
+    if (!g_rebootAtMs) g_rebootAtMs = 1;
+    return ESPNOW_OTA_STATUS_OK;
+}
+
+void rxAbort(void*) {
+    // Keep the journal: a re-sent BEGIN for the same image resumes from it.
+    Serial.printf("OTA: session aborted at %u\n", (unsigned)g_rx.offset);
+}
+
+bool rxSend(void*, const uint8_t* frame, size_t len) { return g_send && g_send(frame, len); }
+
+/**
+ * @brief Flash writer: handles queued frames, then the reboot and rollback deadlines.
+ *
+ * Sleeps on the queue, waking periodically only while a deadline is pending.
+ */
+void otaTask(void* arg) {
+    QueueHandle_t queue = static_cast<QueueHandle_t>(arg);
+    for (;;) {
+        TickType_t wait =
+            g_rebootAtMs || g_pendingVerify ? pdMS_TO_TICKS(DEADLINE_POLL_MS) : portMAX_DELAY;
+        Frame f;
+        if (xQueueReceive(queue, &f, wait) == pdTRUE) {
+            espnow_ota_receiver_handle(&g_rx, f.data, f.len);
+        }
+
+        unsigned long nowMs = millis();
+        if (g_rebootAtMs && static_cast<long>(nowMs - g_rebootAtMs) >= 0) {
+            esp_restart();
+        }
+
+        if (g_pendingVerify && static_cast<long>(nowMs - g_verifyDeadlineMs) >= 0) {
+            Serial.printf("OTA: image not confirmed within %lu ms, rolling back\n",
+                          VERIFY_TIMEOUT_MS);
+            esp_ota_mark_app_invalid_rollback_and_reboot();
+            g_pendingVerify = false;  // only reached when no valid fallback exists
+        }
+    }
+}
+
+}  // namespace
+
+bool begin(SendFn send) {
+    if (g_queue) return true;
+    g_send = send;
+
+    EspNowOtaReceiverIo io{};
+    io.begin = rxBegin;
+    io.write = rxWrite;
+    io.finish = rxFinish;
+    io.abort = rxAbort;
+    io.send = rxSend;
+    espnow_ota_receiver_init(&g_rx, &io);
+
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    esp_ota_img_states_t state;
+    if (running && esp_ota_get_state_partition(running, &state) == ESP_OK &&
+        state == ESP_OTA_IMG_PENDING_VERIFY) {
+        g_pendingVerify = true;
+        g_verifyDeadlineMs = millis() + VERIFY_TIMEOUT_MS;
+        Serial.printf("OTA: new image on %s pending verification\n", running->label);
+    }
+
+    // The receive callback may already be running: publish the queue only
+    // once the task that drains it exists.
+    QueueHandle_t queue = xQueueCreate(QUEUE_DEPTH, sizeof(Frame));
+    if (!queue) return false;
+    if (xTaskCreatePinnedToCore(otaTask, "ota", TASK_STACK, queue, TASK_PRIO, nullptr,
+                                TASK_CORE) != pdPASS) {
+        vQueueDelete(queue);
+        return false;
+    }
+    g_queue = queue;
+    return true;
+}
+
+bool isFrame(const uint8_t* data, int len) {
+    return data && len > 0 && data[0] >= ESPNOW_OTA_BEGIN && data[0] <= ESPNOW_OTA_ABORT;
+}
+
+void handleFrame(const uint8_t* data, int len) {
+    if (!g_queue || !isFrame(data, len) || len > ESP_NOW_MAX_DATA_LEN) return;
+    Frame f;
+    f.len = static_cast<uint8_t>(len);
+    memcpy(f.data, data, len);
+    // A dropped frame is recovered by the sender's retransmit timeout.
+    xQueueSend(g_queue, &f, 0);
+}
+
+void confirmHealthy() {
+    if (!g_pendingVerify) return;
+    if (esp_ota_mark_app_valid_cancel_rollback() == ESP_OK) {
+        Serial.printf("OTA: image confirmed, rollback cancelled\n");
+    }
+    g_pendingVerify = false;
+}
+
+bool active() { return g_rx.active; }
+
+void setBusy(bool busy) { g_busy = busy; }
+
+}  // namespace ota
+}  // namespace gag
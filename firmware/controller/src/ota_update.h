@@ -0,0 +1,57 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file ota_update.h
+ * @brief Controller side of firmware updates relayed by the display over ESP-NOW.
+ *
+ * The display streams a new application image in chunks (see `espnow_ota.h`).
+ * Frames arrive on the Wi-Fi task, are queued, and are written to the inactive
+ * OTA partition by a low-priority task on core 0. Neither the ESP-NOW receive
+ * callback nor the control loop waits for erases, journal writes or the final
+ * readback; flash operations still pause the other core while they run, one
+ * sector at a time. Progress is persisted so an interrupted transfer
+ * resumes where it left off, and a freshly booted image has to prove itself
+ * before the bootloader's rollback is cancelled.
+ */
+
+namespace gag {
+namespace ota {
+
+/** Transmit hook used for replies; returns true when the frame was queued. */
+typedef bool (*SendFn)(const uint8_t* data, size_t len);
+
+/**
+ * @brief Prepare the receiver, start the flash task and the rollback watchdog
+ *        if this boot is a pending-verify image.
+ * @return false when the flash task could not be started; OTA frames are
+ *         then dropped.
+ */
+bool begin(SendFn send);
+
+/** @return true when @p data is an OTA frame. */
+bool isFrame(const uint8_t* data, int len);
+
+/**
+ * @brief Queue an OTA frame from the ESP-NOW receive callback.
+ *
+ * The caller has checked that it came from the paired display.
+ */
+void handleFrame(const uint8_t* data, int len);
+
+/**
+ * @brief Report that the running image is healthy (link up, sensors sane).
+ *
+ * Cancels the rollback on the first call after an update; no-op otherwise.
+ */
+void confirmHealthy();
+
+/** @return true while an update session is receiving data. */
+bool active();
+
+/** Refuse new sessions while @p busy is set (e.g. during a shot). */
+void setBusy(bool busy);
+
+}  // namespace ota
+}  // namespace gag
@@ -0,0 +1,64 @@
+/**
+ * @file param_store.cpp
+ * @brief Debounced parameter records on top of RecordJournal.
+ */
+#include "param_store.h"
+
+#include <Arduino.h>
+#include <string.h>
+
+namespace gag {
+namespace {
+
+constexpr unsigned long DEBOUNCE_MS = 5000;           // quiet time before a write
+constexpr unsigned long MIN_COMMIT_INTERVAL_MS = 30000;  // upper bound on write rate
+
+}  // namespace
+
+bool ParamStore::begin(PersistentParams& params) {
+    staged_ = committed_ = params;
+
+    uint16_t version = 0;
+    size_t stored = journal_.load(&params, sizeof(params), &version);
+    if (stored == 0) return false;
+
+    staged_ = committed_ = params;
+    size_t n = stored < sizeof(params) ? stored : sizeof(params);
+    Serial.printf("Params: loaded v%u seq %u (%u/%u bytes)\n", (unsigned)version,
+                  (unsigned)journal_.seq(), (unsigned)n, (unsigned)sizeof(params));
+    return true;
+}
+
+void ParamStore::update(const PersistentParams& params, unsigned long nowMs) {
+    if (memcmp(&params, &staged_, sizeof(params)) == 0) return;
+    staged_ = params;
+    dirty_ = memcmp(&staged_, &committed_, sizeof(staged_)) != 0;
+    lastChangeMs_ = nowMs;
+}
+
+void ParamStore::service(unsigned long nowMs) {
+    if (!dirty_) return;
+    if (nowMs - lastChangeMs_ < DEBOUNCE_MS) return;
+    if (writes_ && nowMs - lastCommitMs_ < MIN_COMMIT_INTERVAL_MS) return;
+    if (commit()) lastCommitMs_ = nowMs;
+}
+
+void ParamStore::flush() {
+    if (dirty_ && commit()) lastCommitMs_ = millis();
+}
+
+bool ParamStore::commit() {
+    static_assert(sizeof(PersistentParams) <= RecordJournal::MAX_PAYLOAD,
+                  "PersistentParams too large");
+    if (!journal_.save(&staged_, sizeof(staged_), PARAMS_VERSION)) {
+        Serial.printf("Params: write of seq %u failed\n", (unsigned)(journal_.seq() + 1));
+        return false;
+    }
+    committed_ = staged_;
+    dirty_ = false;
+    ++writes_;
+    Serial.printf("Params: saved seq %u\n", (unsigned)journal_.seq());
+    return true;
+}
+
+}  // namespace gag
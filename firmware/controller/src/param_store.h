@@ -0,0 +1,95 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "curve_cal.h"
+#include "record_journal.h"
+
+/**
+ * @file param_store.h
+ * @brief Versioned, journaled NVS storage for controller tuning and calibration.
+ *
+ * Records go through a RecordJournal, so a write interrupted by a power cut
+ * always leaves the previous record intact. Changes are debounced before they
+ * hit flash so dragging a slider on the display costs one write, not dozens.
+ */
+
+namespace gag {
+
+/**
+ * @brief Everything the controller should remember across power cycles.
+ *
+ * Append-only: new fields go at the end and bump PARAMS_VERSION. Older
+ * records load into the prefix they cover; the rest keeps its defaults.
+ */
+struct PersistentParams {
+    float brewSetpoint;
+    float steamSetpoint;
+    float pGain;
+    float iGain;
+    float dGain;
+    float dTau;
+    float windupGuard;
+    float pressGrad;  // legacy bar per ADC count; seeds the factory pressure curve
+    float pressInt;   // legacy bar at ADC 0; seeds the factory pressure curve
+    float flowCal;    // nominal mL per pulse (flat curve restored by a calibration reset)
+    // v2
+    CalCurve flowCurve;  // pulse rate (Hz) -> mL per pulse
+    // v3
+    CalCurve pressCurve;  // calibrated ADC mV -> bar
+    // v4: pressure-mode pump loop (PARAM_ID_PUMP_* in param_registry.h)
+    float pumpKp;
+    float pumpKi;
+    float pumpKd;
+    float pumpIGuard;
+    float pumpDTau;
+    float pumpOutputScale;
+    float pumpOutputOffset;
+    float pumpRampRate;
+    float pumpStartClamp;
+    float pumpStartClampMs;
+    float puckEaseBar;
+    // v5: steam-mode heater gains (PARAM_ID_STEAM_*)
+    float steamKp;
+    float steamKi;
+    float steamKd;
+    float steamIGuard;
+    float steamDTau;
+    // v6: heater element rating for energy metering (PARAM_ID_HEATER_ELEMENT_W)
+    float heaterElementW;
+};
+
+constexpr uint16_t PARAMS_VERSION = 6;
+
+class ParamStore {
+   public:
+    /**
+     * @brief Load the newest valid record over @p params.
+     * @return true when a stored record was applied, false when defaults were kept.
+     */
+    bool begin(PersistentParams& params);
+
+    /** Stage @p params for writing; commits after they stop changing. */
+    void update(const PersistentParams& params, unsigned long nowMs);
+
+    /** Commit staged changes once the debounce window has elapsed. */
+    void service(unsigned long nowMs);
+
+    /** Write any staged change immediately (e.g. before a planned reboot). */
+    void flush();
+
+    uint32_t writes() const { return writes_; }
+
+   private:
+    bool commit();
+
+    RecordJournal journal_{"params"};
+    PersistentParams staged_{};
+    PersistentParams committed_{};
+    bool dirty_ = false;
+    unsigned long lastChangeMs_ = 0;
+    unsigned long lastCommitMs_ = 0;
+    uint32_t writes_ = 0;
+};
+
+}  // namespace gag
@@ -0,0 +1,89 @@
+/**
+ * @file param_table.cpp
+ * @brief Range checks and change tracking for registry parameters.
+ */
+#include "param_table.h"
+
+#include <math.h>
+
+namespace gag {
+
+ParamTable::ParamTable(const ParamBinding* bindings, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        int idx = param_index(bindings[i].id);
+        if (idx >= 0) values_[idx] = bindings[i].value;
+    }
+}
+
+bool ParamTable::complete() const {
+    for (int i = 0; i < PARAM_COUNT; ++i) {
+        if (!values_[i]) return false;
+    }
+    return true;
+}
+
+uint8_t ParamTable::set(uint16_t id, float value, float* applied) {
+    int idx = param_index(id);
+    if (idx < 0 || !values_[idx]) {
+        *applied = value;
+        return ESPNOW_PARAM_STATUS_UNKNOWN;
+    }
+    const ParamDef& def = PARAM_DEFS[idx];
+    if (isnan(value)) {
+        *applied = *values_[idx];
+        return ESPNOW_PARAM_STATUS_INVALID;
+    }
+    float v = value;
+    if (def.type == PARAM_TYPE_UINT) v = roundf(v);
+    uint8_t status = ESPNOW_PARAM_STATUS_OK;
+    if (v < def.min) {
+        v = def.min;
+        status = ESPNOW_PARAM_STATUS_CLAMPED;
+    } else if (v > def.max) {
+        v = def.max;
+        status = ESPNOW_PARAM_STATUS_CLAMPED;
+    }
+    *values_[idx] = v;
+    reported_[idx] = v;
+    *applied = v;
+    return status;
+}
+
+bool ParamTable::get(uint16_t id, float* value) const {
+    int idx = param_index(id);
+    if (idx < 0 || !values_[idx]) return false;
+    *value = *values_[idx];
+    return true;
+}
+
+void ParamTable::subscribe(const uint16_t* ids, uint8_t count) {
+    uint32_t mask = 0;
+    if (count == 0) {
+        mask = PARAM_COUNT == 32 ? 0xFFFFFFFFu : (1u << PARAM_COUNT) - 1;
+    }
+    for (uint8_t i = 0; i < count; ++i) {
+        int idx = param_index(ids[i]);
+        if (idx >= 0) mask |= 1u << idx;
+    }
+    subscribed_ = pending_ = mask;
+}
+
+uint8_t ParamTable::takeChanges(EspNowParamValue* out, uint8_t max) {
+    uint8_t n = 0;
+    for (int i = 0; i < PARAM_COUNT && n < max; ++i) {
+        uint32_t bit = 1u << i;
+        if (!(subscribed_ & bit) || !values_[i]) continue;
+        float v = *values_[i];
+        if (!(pending_ & bit) && v == reported_[i]) continue;
+        out[n].id = PARAM_DEFS[i].id;
+        out[n].status = ESPNOW_PARAM_STATUS_OK;
+        out[n].reserved = 0;
+        out[n].value = v;
+        ++n;
+        reported_[i] = v;
+        pending_ &= ~bit;
+    }
+    return n;
+}
+
+}  // namespace gag
@@ -0,0 +1,68 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "espnow_protocol.h"
+#include "param_registry.h"
+
+/**
+ * @file param_table.h
+ * @brief Binds the shared parameter registry to the controller's live variables.
+ *
+ * Every registry entry is backed by a float the control code reads directly,
+ * so a parameter costs nothing on the control path. set() clamps to the
+ * registry range and returns what was applied. takeChanges() collects the
+ * subscribed parameters whose value moved since they were last reported,
+ * whoever moved them (a parameter set, the legacy control packet, a stored
+ * record, a fallback to defaults), so the display hears about each change once.
+ */
+
+namespace gag {
+
+struct ParamBinding {
+    uint16_t id;  // ParamId
+    float* value;
+};
+
+class ParamTable {
+    static_assert(PARAM_COUNT <= 32, "subscription mask is 32 bits");
+
+   public:
+    /** Bind each registry id to its variable; ids not listed stay unknown. */
+    ParamTable(const ParamBinding* bindings, size_t count);
+
+    /** True when every registry entry is bound. */
+    bool complete() const;
+
+    /**
+     * @brief Clamp @p value to the range of @p id and store it.
+     *
+     * @p applied receives the stored value (the current one when @p value is
+     * NaN, @p value itself for an unknown id). The caller echoes it in its
+     * reply, so the new value is not reported again as a change.
+     * @return EspNowParamStatus of the request.
+     */
+    uint8_t set(uint16_t id, float value, float* applied);
+    bool get(uint16_t id, float* value) const;
+
+    /** Replace the subscription; @p count 0 subscribes every parameter. */
+    void subscribe(const uint16_t* ids, uint8_t count);
+    void unsubscribe() { subscribed_ = pending_ = 0; }
+    bool subscribed() const { return subscribed_ != 0; }
+
+    /**
+     * @brief Move up to @p max changed subscribed parameters into @p out.
+     *
+     * Right after subscribe() every subscribed parameter counts as changed.
+     * @return entries written.
+     */
+    uint8_t takeChanges(EspNowParamValue* out, uint8_t max);
+
+   private:
+    float* values_[PARAM_COUNT] = {};
+    float reported_[PARAM_COUNT] = {};
+    uint32_t subscribed_ = 0;
+    uint32_t pending_ = 0;  // subscribed, not yet reported since subscribe()
+};
+
+}  // namespace gag
@@ -0,0 +1,85 @@
+/**
+ * @file phase_sampler.cpp
+ * @brief Zero-cross locked sample scheduling and per-cycle averaging.
+ */
+#include "phase_sampler.h"
+
+#include <esp_attr.h>
+
+#include "hot_path.h"
+
+namespace gag {
+
+int64_t IRAM_ATTR PhaseSampler::slotTime(int idx) const {
+    // 32-bit division only: this also runs from the zero-cross ISR.
+    return zcUs_ + static_cast<uint32_t>(2 * idx + 1) * halfUs_ / (2 * SAMPLES_PER_HALF);
+}
+
+uint32_t IRAM_ATTR PhaseSampler::onZeroCross(int64_t nowUs) {
+    if (zcUs_) {
+        int64_t interval = nowUs - zcUs_;
+        if (interval >= HALF_MIN_US && interval <= HALF_MAX_US) {
+            // Slow EMA so a late ZC edge does not shift every slot.
+            halfUs_ += static_cast<int32_t>(interval - halfUs_) / 8;
+        }
+    }
+    if (idx_ < SAMPLES_PER_HALF) {
+        // The previous half-cycle was cut short; an unbalanced cycle would let
+        // the ripple back in, so drop it.
+        cycleSum_ = 0;
+        halves_ = 0;
+        ++dropped_;
+    }
+    zcUs_ = nowUs;
+    idx_ = 0;
+    halfSum_ = 0;
+    int64_t delay = slotTime(0) - nowUs;
+    return delay > MIN_DELAY_US ? static_cast<uint32_t>(delay) : MIN_DELAY_US;
+}
+
+uint32_t PhaseSampler::onSample(int32_t value, int64_t nowUs) {
+    if (idx_ >= SAMPLES_PER_HALF) return 0;
+    int64_t error = nowUs - slotTime(idx_);
+    int64_t tolerance = halfUs_ / (4 * SAMPLES_PER_HALF);
+    if (error < -tolerance || error > tolerance) {
+        if (error > tolerance) {
+            // Missed the slot (timer latency); give up on this half-cycle.
+            idx_ = SAMPLES_PER_HALF;
+            cycleSum_ = 0;
+            halves_ = 0;
+            ++dropped_;
+            return 0;
+        }
+        return static_cast<uint32_t>(-error);
+    }
+
+    halfSum_ += value;
+    if (++idx_ < SAMPLES_PER_HALF) {
+        int64_t delay = slotTime(idx_) - nowUs;
+        return delay > MIN_DELAY_US ? static_cast<uint32_t>(delay) : MIN_DELAY_US;
+    }
+
+    cycleSum_ += halfSum_;
+    if (++halves_ == 2) {
+        lastCycleSum_ = cycleSum_;
+        ++cycleSeq_;
+        cycleSum_ = 0;
+        halves_ = 0;
+    }
+    return 0;
+}
+
+bool CONTROL_HOT PhaseSampler::takeCycle(Q16_16& mean) {
+    if (takenSeq_ == cycleSeq_) return false;
+    takenSeq_ = cycleSeq_;
+    // The sum itself can exceed Q16.16's range, so divide before narrowing.
+    mean = Q16_16::fromRaw(static_cast<int32_t>(static_cast<int64_t>(lastCycleSum_) *
+                                                Q16_16::ONE / (2 * SAMPLES_PER_HALF)));
+    return true;
+}
+
+bool CONTROL_HOT PhaseSampler::active(int64_t nowUs) const {
+    return zcUs_ && nowUs - zcUs_ < static_cast<int64_t>(3 * halfUs_);
+}
+
+}  // namespace gag
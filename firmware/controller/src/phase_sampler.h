@@ -0,0 +1,70 @@
+#pragma once
+#include <stdint.h>
+
+#include "fixed_point.h"
+
+/**
+ * @file phase_sampler.h
+ * @brief Schedules ADC samples at fixed mains-phase offsets after each zero-cross.
+ *
+ * A vibratory pump strokes once per mains cycle, so pressure carries a strong
+ * ripple at the mains frequency. Sampling at arbitrary loop times aliases it
+ * into the average. Instead, every half-cycle is sampled at 1/8, 3/8, 5/8 and
+ * 7/8 of its length, and the eight samples of a full cycle are averaged: the
+ * mean of equally spaced samples over one period cancels the fundamental and
+ * every harmonic below the eighth.
+ *
+ * Pure bookkeeping with integer math only; the caller owns the timer, the ADC
+ * and the locking (onZeroCross() runs in the zero-cross ISR).
+ */
+
+namespace gag {
+
+class PhaseSampler {
+   public:
+    static constexpr int SAMPLES_PER_HALF = 4;
+
+    /**
+     * @brief Register an accepted zero-cross at @p nowUs.
+     * @return Delay in microseconds until the first sample of this half-cycle.
+     */
+    uint32_t onZeroCross(int64_t nowUs);
+
+    /**
+     * @brief Record a sample taken at @p nowUs.
+     * @return Delay until the next sample, or 0 when the half-cycle is complete.
+     *
+     * Samples more than a sixteenth of a half-cycle away from their slot (a
+     * stale timer after a zero-cross) are discarded and the slot is re-armed.
+     */
+    uint32_t onSample(int32_t value, int64_t nowUs);
+
+    /** Fetch the newest full-cycle mean; true only once per completed cycle. */
+    bool takeCycle(Q16_16& mean);
+
+    /** @return true while zero-crosses keep arriving (pump powered). */
+    bool active(int64_t nowUs) const;
+
+    uint32_t halfPeriodUs() const { return halfUs_; }
+    uint32_t cyclesDropped() const { return dropped_; }
+
+   private:
+    int64_t slotTime(int idx) const;
+
+    static constexpr uint32_t HALF_MIN_US = 7000;   // 71 Hz mains
+    static constexpr uint32_t HALF_MAX_US = 12000;  // 42 Hz mains
+    static constexpr uint32_t MIN_DELAY_US = 50;
+
+    int64_t zcUs_ = 0;
+    uint32_t halfUs_ = 10000;  // 50 Hz until measured
+    int idx_ = SAMPLES_PER_HALF;  // no half-cycle in progress
+    int32_t halfSum_ = 0;
+    int32_t cycleSum_ = 0;
+    int halves_ = 0;
+    int32_t lastCycleSum_ = 0;
+    uint32_t cycleSeq_ = 0;
+    uint32_t takenSeq_ = 0;
+    uint32_t dropped_ = 0;
+};
+
+}  // namespace gag
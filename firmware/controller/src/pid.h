@@ -0,0 +1,161 @@
+#pragma once
+
+/**
+ * @file pid.h
+ * @brief PID controller with compile-time limits and feature switches.
+ *
+ * dt-scaled I and D, a clamp on the I contribution, derivative on the
+ * low-passed measurement and conditional integration, as the heater loop has
+ * always run. Each instance owns its state and the terms of its last step, so
+ * several loops can run side by side without overwriting each other's
+ * telemetry. T is the arithmetic type (float, or a fixed-point type that
+ * converts from float and provides + - * / and comparisons).
+ *
+ * Config supplies, as static constexpr members:
+ *  - OUT_MIN, OUT_MAX (float): actuator limits; the output is clamped to them.
+ *  - DERIVATIVE_FILTER: low-pass the measurement with Gains::dTau before
+ *    differentiating; otherwise use the raw measurement.
+ *  - CONDITIONAL_INTEGRATION: undo the step's integration when the output
+ *    saturates in the direction of the error.
+ *  - SETPOINT_WEIGHTING: P acts on spWeight * sp - pv instead of sp - pv.
+ *  - BUMPLESS: setGains() rescales the integral so a new Ki does not step
+ *    the I contribution.
+ *  - RESET_I_AT_SETPOINT: the integral restarts from zero whenever the error
+ *    is not positive (a loop that can only push the measurement up). A
+ *    preloaded integral is held instead, contributing nothing, until the
+ *    error first turns positive.
+ *  - P_BELOW_SETPOINT_ONLY: no P contribution above the setpoint.
+ */
+
+#include "hot_path.h"
+
+namespace gag {
+
+template <typename T, typename Config>
+class Pid {
+   public:
+    struct Gains {
+        T kp, ki, kd;
+        T iGuard;    // clamp on the I contribution (output units)
+        T dTau;      // derivative low-pass time constant (s)
+        T spWeight;  // setpoint weight for P (SETPOINT_WEIGHTING)
+    };
+
+    /** Contributions of the last step; out is after the output clamp. */
+    struct Terms {
+        T p, i, d, out;
+    };
+
+    explicit Pid(const Gains& g) : g_(g) { clearTerms(); }
+
+    const Gains& gains() const { return g_; }
+
+    void setGains(const Gains& g) {
+        if (Config::BUMPLESS && g.ki != g_.ki && g.ki != T(0.0f)) iSum_ = iSum_ * g_.ki / g.ki;
+        g_ = g;
+    }
+
+    /** Start from @p pv with an empty integral, so the first step has no derivative kick. */
+    void reset(T pv) {
+        pvFilt_ = pv;
+        iSum_ = T(0.0f);
+        iHeld_ = false;
+        primed_ = true;
+        clearTerms();
+    }
+    /**
+     * @brief Start from @p pv with the integral set to an I contribution of @p iOut.
+     *
+     * For a switch between gain sets: the derivative filter restarts on the
+     * new measurement and the I term starts where the new regime is expected
+     * to settle (within iGuard) instead of at zero. Call after setGains().
+     * Entering a regime from above its setpoint (steam back to brew), the
+     * preload waits for the measurement to come down to it.
+     */
+    void preload(T pv, T iOut) {
+        reset(pv);
+        if (g_.ki > T(0.0f)) iSum_ = iOut / g_.ki;
+        iHeld_ = true;
+    }
+    /** Forget the state; the caller resets again before the next step. */
+    void release() {
+        primed_ = false;
+        iSum_ = T(0.0f);
+        iHeld_ = false;
+        clearTerms();
+    }
+    bool primed() const { return primed_; }
+
+    /**
+     * @param dt seconds since the previous step. A step with dt <= 0 (a
+     *        repeated or backwards timestamp) leaves the state alone and
+     *        returns the previous output.
+     */
+    T CONTROL_HOT step(T sp, T pv, T dt) {
+        // Constants are converted at compile time, so a fixed-point T stays FPU-free.
+        constexpr T zero = T(0.0f);
+        constexpr T outMin = T(Config::OUT_MIN);
+        constexpr T outMax = T(Config::OUT_MAX);
+        if (!(dt > zero)) return terms_.out;  // also catches a NaN dt
+        T err = sp - pv;
+
+        bool integrate = !Config::RESET_I_AT_SETPOINT || err > zero;
+        if (integrate) {
+            iSum_ = iSum_ + err * dt;
+            iHeld_ = false;
+        } else if (!iHeld_) {
+            iSum_ = zero;
+        }
+
+        T prevPv = pvFilt_;
+        if (Config::DERIVATIVE_FILTER) {
+            pvFilt_ = pvFilt_ + dt / (g_.dTau + dt) * (pv - pvFilt_);
+        } else {
+            pvFilt_ = pv;
+        }
+        T d = zero - g_.kd * ((pvFilt_ - prevPv) / dt);  // derivative on measurement
+
+        T pErr = Config::SETPOINT_WEIGHTING ? g_.spWeight * sp - pv : err;
+        T p = g_.kp * pErr;
+        if (Config::P_BELOW_SETPOINT_ONLY && err < zero) p = zero;
+        T i = iHeld_ ? zero : iTerm();
+        T u = p + i + d;
+
+        if (Config::CONDITIONAL_INTEGRATION && integrate &&
+            ((u >= outMax && err > zero) || (u <= outMin && err < zero))) {
+            iSum_ = iSum_ - err * dt;  // undo this step's integral
+            i = iTerm();
+            u = p + i + d;
+        }
+
+        if (u > outMax) u = outMax;
+        if (u < outMin) u = outMin;
+        terms_.p = p;
+        terms_.i = i;
+        terms_.d = d;
+        terms_.out = u;
+        return u;
+    }
+
+    const Terms& terms() const { return terms_; }
+    T integral() const { return iSum_; }
+
+   private:
+    T CONTROL_HOT iTerm() const {
+        constexpr T zero = T(0.0f);
+        T i = g_.ki * iSum_;
+        if (i > g_.iGuard) i = g_.iGuard;
+        if (i < zero - g_.iGuard) i = zero - g_.iGuard;
+        return i;
+    }
+    void clearTerms() { terms_.p = terms_.i = terms_.d = terms_.out = T(0.0f); }
+
+    Gains g_;
+    Terms terms_;
+    T pvFilt_ = T(0.0f);
+    T iSum_ = T(0.0f);
+    bool iHeld_ = false;  // preloaded integral waiting for a positive error
+    bool primed_ = false;
+};
+
+}  // namespace gag
@@ -0,0 +1,76 @@
+/**
+ * @file puck_monitor.cpp
+ * @brief Resistance estimate, baseline tracking and channeling events.
+ */
+#include "puck_monitor.h"
+
+#include "hot_path.h"
+
+namespace gag {
+
+void PuckMonitor::reset(uint32_t nowMs, float volumeMl) {
+    Config cfg = cfg_;
+    *this = PuckMonitor(cfg);
+    lastMs_ = nowMs;
+    lastVolumeMl_ = volumeMl;
+}
+
+bool CONTROL_HOT PuckMonitor::update(uint32_t nowMs, float pressureBar, float volumeMl) {
+    float dt = (nowMs - lastMs_) / 1000.0f;
+    if (dt <= 0.0f) return false;
+    lastMs_ = nowMs;
+    float q = (volumeMl - lastVolumeMl_) / dt;
+    lastVolumeMl_ = volumeMl;
+
+    // Flow comes from quantised pulses, so it needs the same smoothing as
+    // pressure or the ratio would be mostly pulse jitter.
+    float a = dt / (cfg_.filterTauS + dt);
+    pressure_ += (pressureBar - pressure_) * a;
+    flow_ += (q - flow_) * a;
+
+    bool ok = pressure_ >= cfg_.armBar && flow_ >= cfg_.minFlowMlS;
+    if (!ok) {
+        valid_ = false;
+        validS_ = 0.0f;
+        slope_ = 0.0f;
+        return false;
+    }
+
+    float r = pressure_ / flow_;
+    if (!valid_) {
+        valid_ = true;
+        resistance_ = r;
+        if (baseline_ <= 0.0f) baseline_ = r;
+        return false;
+    }
+    slope_ += ((r - resistance_) / dt - slope_) * a;
+    resistance_ = r;
+    validS_ += dt;
+    resistanceSum_ += r;
+    ++samples_;
+
+    if (inEvent_) {
+        if (static_cast<int32_t>(nowMs - eventUntilMs_) < 0) return false;
+        // Whatever the puck settled to after the event is the new normal.
+        inEvent_ = false;
+        baseline_ = r;
+        return false;
+    }
+    baseline_ += (r - baseline_) * dt / (cfg_.baselineTauS + dt);
+
+    if (validS_ < cfg_.armDelayS || baseline_ <= 0.0f) return false;
+    bool dropped = r < baseline_ * (1.0f - cfg_.dropPct * 0.01f);
+    bool falling = slope_ / baseline_ * 100.0f < -cfg_.slopePctS;
+    if (!dropped || !falling) return false;
+
+    inEvent_ = true;
+    eventUntilMs_ = nowMs + static_cast<uint32_t>(cfg_.holdS * 1000.0f);
+    ++events_;
+    return true;
+}
+
+bool CONTROL_HOT PuckMonitor::channeling(uint32_t nowMs) const {
+    return inEvent_ && static_cast<int32_t>(nowMs - eventUntilMs_) < 0;
+}
+
+}  // namespace gag
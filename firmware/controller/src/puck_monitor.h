@@ -0,0 +1,64 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file puck_monitor.h
+ * @brief Live puck resistance and channeling detection.
+ *
+ * Resistance is taken as filtered pressure over filtered flow (bar per mL/s).
+ * A healthy puck erodes slowly, so a slow baseline follows it; channeling
+ * shows up as resistance falling well below that baseline, and falling fast.
+ * Both conditions are required so a gradual decline never trips it.
+ */
+
+namespace gag {
+
+class PuckMonitor {
+   public:
+    struct Config {
+        float armBar;        // track only above this pressure...
+        float minFlowMlS;    // ...and this flow
+        float armDelayS;     // both must hold this long before detection arms
+        float filterTauS;    // pressure, flow and slope low-pass
+        float baselineTauS;  // slow resistance baseline
+        float dropPct;       // event: resistance this far below the baseline...
+        float slopePctS;     // ...and falling faster than this (% of baseline per s)
+        float holdS;         // event flag (and pump easing) duration
+    };
+
+    explicit PuckMonitor(const Config& cfg) : cfg_(cfg) {}
+
+    /** Start a new shot; @p volumeMl is the current pumped-volume counter. */
+    void reset(uint32_t nowMs, float volumeMl);
+
+    /**
+     * @brief Feed one pressure sample and the pumped volume so far.
+     * @return true when this sample started a channeling event.
+     */
+    bool update(uint32_t nowMs, float pressureBar, float volumeMl);
+
+    bool valid() const { return valid_; }
+    float resistance() const { return resistance_; }   // bar / (mL/s)
+    float baseline() const { return baseline_; }
+    float flowMlS() const { return flow_; }
+    /** @return true while a detected event is being held. */
+    bool channeling(uint32_t nowMs) const;
+    uint16_t events() const { return events_; }
+    float meanResistance() const { return samples_ ? resistanceSum_ / samples_ : 0.0f; }
+
+   private:
+    Config cfg_;
+    uint32_t lastMs_ = 0;
+    float lastVolumeMl_ = 0.0f;
+    float pressure_ = 0.0f, flow_ = 0.0f;
+    bool valid_ = false;
+    float validS_ = 0.0f;
+    float resistance_ = 0.0f, slope_ = 0.0f, baseline_ = 0.0f;
+    bool inEvent_ = false;
+    uint32_t eventUntilMs_ = 0;
+    uint16_t events_ = 0;
+    float resistanceSum_ = 0.0f;
+    uint32_t samples_ = 0;
+};
+
+}  // namespace gag
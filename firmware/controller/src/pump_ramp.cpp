@@ -0,0 +1,48 @@
+/**
+ * @file pump_ramp.cpp
+ * @brief Pump output rate limit and start clamp.
+ */
+#include "pump_ramp.h"
+
+#include "hot_path.h"
+
+namespace gag {
+
+float CONTROL_HOT PumpRamp::begin(uint32_t nowMs, float requestedPct) {
+    if (requestedPct > 0.0f && lastRequested_ <= 0.0f) {
+        clampArmed_ = true;
+        clampStartMs_ = nowMs;
+    } else if (requestedPct <= 0.0f) {
+        clampArmed_ = false;
+    }
+    float dt = haveLast_ ? (nowMs - lastMs_) / 1000.0f : cfg_.firstDtS;
+    if (dt < 0.0f) dt = 0.0f;
+    if (dt > cfg_.maxDtS) dt = cfg_.maxDtS;
+    return dt;
+}
+
+float CONTROL_HOT PumpRamp::limit(uint32_t nowMs, float targetPct, float dtS) {
+    float v = targetPct;
+    float allowed = lastApplied_ + cfg_.ratePctS * dtS;
+    if (v > allowed) v = allowed;
+    // also catches NaN from the controller
+    if (!(v >= 0.0f)) v = 0.0f;
+    if (v > 100.0f) v = 100.0f;
+    if (clampArmed_) {
+        if (nowMs - clampStartMs_ < cfg_.startClampMs) {
+            if (v > cfg_.startClampPct) v = cfg_.startClampPct;
+        } else {
+            clampArmed_ = false;
+        }
+    }
+    return v;
+}
+
+void CONTROL_HOT PumpRamp::commit(uint32_t nowMs, float requestedPct, float appliedPct) {
+    haveLast_ = true;
+    lastMs_ = nowMs;
+    lastApplied_ = appliedPct;
+    lastRequested_ = requestedPct;
+}
+
+}  // namespace gag
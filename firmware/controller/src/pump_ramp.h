@@ -0,0 +1,64 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file pump_ramp.h
+ * @brief Rate limit and start clamp on the pump output in pressure mode.
+ *
+ * The pressure PID decides where the pump output should go; PumpRamp decides
+ * how fast it may get there. The output rises by at most ratePctS per second
+ * and, for startClampMs after the pump engages (request rising from 0), stays
+ * below startClampPct so the puck is not hit with full pressure. Times are
+ * millis() and only ever subtracted, so the 49-day wraparound is harmless.
+ */
+
+namespace gag {
+
+class PumpRamp {
+   public:
+    struct Config {
+        float ratePctS;         // fastest rise of the output (% per second)
+        float startClampPct;    // output ceiling right after the pump engages
+        uint32_t startClampMs;  // ... for this long
+        float maxDtS;           // longest step the ramp credits (a stalled loop gains nothing)
+        float firstDtS;         // step assumed for the very first update
+    };
+
+    explicit PumpRamp(const Config& cfg) : cfg_(cfg) {}
+
+    /** Change the limits; takes effect at the next update. */
+    void setConfig(const Config& cfg) { cfg_ = cfg; }
+    const Config& config() const { return cfg_; }
+
+    /**
+     * @brief Start a pressure-mode update for a request of @p requestedPct.
+     *
+     * Arms the start clamp when the request rises from 0 and drops it when
+     * the request is 0.
+     * @return seconds since the previous update, within [0, maxDtS].
+     */
+    float begin(uint32_t nowMs, float requestedPct);
+
+    /** Rate-limit @p targetPct over @p dtS, clamp it to 0..100 and to the start clamp. */
+    float limit(uint32_t nowMs, float targetPct, float dtS);
+
+    /** Record the output of this update; call in either pump mode. */
+    void commit(uint32_t nowMs, float requestedPct, float appliedPct);
+
+    /** Outside pressure mode there is no start clamp. */
+    void disarm() { clampArmed_ = false; }
+
+    float lastApplied() const { return lastApplied_; }
+    bool clampArmed() const { return clampArmed_; }
+
+   private:
+    Config cfg_;
+    bool haveLast_ = false;
+    uint32_t lastMs_ = 0;
+    float lastApplied_ = 0.0f;
+    float lastRequested_ = 0.0f;
+    bool clampArmed_ = false;
+    uint32_t clampStartMs_ = 0;
+};
+
+}  // namespace gag
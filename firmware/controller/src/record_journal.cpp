@@ -0,0 +1,102 @@
+/**
+ * @file record_journal.cpp
+ * @brief A/B journaled records in NVS.
+ */
+#include "record_journal.h"
+
+#include <Preferences.h>
+#include <string.h>
+
+namespace gag {
+namespace {
+
+constexpr const char* SLOT_KEYS[2] = {"rec0", "rec1"};
+constexpr uint16_t RECORD_MAGIC = 0x6750;  // "gP"
+
+struct RecordHeader {
+    uint16_t magic;
+    uint16_t version;
+    uint16_t size;  // payload bytes following the header
+    uint16_t reserved;
+    uint32_t seq;
+    uint32_t crc;  // over header (crc = 0) and payload
+};
+
+uint32_t crc32(uint32_t crc, const uint8_t* p, size_t len) {
+    crc = ~crc;
+    while (len--) {
+        crc ^= *p++;
+        for (int k = 0; k < 8; ++k) crc = (crc >> 1) ^ (0xEDB88320U & (0U - (crc & 1U)));
+    }
+    return ~crc;
+}
+
+uint32_t recordCrc(RecordHeader hdr, const uint8_t* payload) {
+    hdr.crc = 0;
+    uint32_t crc = crc32(0, reinterpret_cast<const uint8_t*>(&hdr), sizeof(hdr));
+    return crc32(crc, payload, hdr.size);
+}
+
+struct Record {
+    RecordHeader hdr;
+    uint8_t payload[RecordJournal::MAX_PAYLOAD];
+};
+
+bool readSlot(Preferences& prefs, int slot, Record& rec) {
+    size_t len = prefs.getBytesLength(SLOT_KEYS[slot]);
+    if (len < sizeof(RecordHeader) || len > sizeof(Record)) return false;
+    if (prefs.getBytes(SLOT_KEYS[slot], &rec, len) != len) return false;
+    if (rec.hdr.magic != RECORD_MAGIC || sizeof(RecordHeader) + rec.hdr.size != len) return false;
+    return recordCrc(rec.hdr, rec.payload) == rec.hdr.crc;
+}
+
+// Only used from setup()/loop(); static keeps the ~0.5 kB off the loop stack.
+Record s_recs[2];
+
+}  // namespace
+
+size_t RecordJournal::load(void* data, size_t size, uint16_t* version) {
+    Preferences prefs;
+    if (!prefs.begin(ns_, true)) return 0;
+    bool valid[2] = {readSlot(prefs, 0, s_recs[0]), readSlot(prefs, 1, s_recs[1])};
+    prefs.end();
+
+    int best = -1;
+    for (int i = 0; i < 2; ++i) {
+        if (!valid[i]) continue;
+        if (best < 0 || static_cast<int32_t>(s_recs[i].hdr.seq - s_recs[best].hdr.seq) > 0)
+            best = i;
+    }
+    if (best < 0) return 0;
+
+    const Record& rec = s_recs[best];
+    memcpy(data, rec.payload, rec.hdr.size < size ? rec.hdr.size : size);
+    if (version) *version = rec.hdr.version;
+    seq_ = rec.hdr.seq;
+    nextSlot_ = static_cast<uint8_t>(best ^ 1);
+    return rec.hdr.size;
+}
+
+bool RecordJournal::save(const void* data, size_t size, uint16_t version) {
+    if (size > MAX_PAYLOAD) return false;
+    Record& rec = s_recs[0];
+    memset(&rec.hdr, 0, sizeof(rec.hdr));
+    rec.hdr.magic = RECORD_MAGIC;
+    rec.hdr.version = version;
+    rec.hdr.size = static_cast<uint16_t>(size);
+    rec.hdr.seq = seq_ + 1;
+    memcpy(rec.payload, data, size);
+    rec.hdr.crc = recordCrc(rec.hdr, rec.payload);
+
+    Preferences prefs;
+    if (!prefs.begin(ns_, false)) return false;
+    size_t len = sizeof(RecordHeader) + size;
+    bool ok = prefs.putBytes(SLOT_KEYS[nextSlot_], &rec, len) == len;
+    prefs.end();
+    if (!ok) return false;
+    seq_ = rec.hdr.seq;
+    nextSlot_ ^= 1;
+    return true;
+}
+
+}  // namespace gag
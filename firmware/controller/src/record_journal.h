@@ -0,0 +1,40 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file record_journal.h
+ * @brief Power-fail safe A/B record slots in an NVS namespace.
+ *
+ * Each save goes to the slot not holding the newest record, tagged with a
+ * sequence number and CRC, so a write interrupted by a power cut always
+ * leaves the previous record intact. Payloads are versioned blobs; callers
+ * keep them append-only so older records load into the prefix they cover.
+ */
+
+namespace gag {
+
+class RecordJournal {
+   public:
+    static constexpr size_t MAX_PAYLOAD = 256;
+
+    explicit RecordJournal(const char* ns) : ns_(ns) {}
+
+    /**
+     * @brief Copy the newest valid record over @p data (at most @p size bytes).
+     * @return stored payload size, or 0 when no valid record exists.
+     */
+    size_t load(void* data, size_t size, uint16_t* version = nullptr);
+
+    /** Write @p data as the next record. */
+    bool save(const void* data, size_t size, uint16_t version);
+
+    uint32_t seq() const { return seq_; }
+
+   private:
+    const char* ns_;
+    uint32_t seq_ = 0;
+    uint8_t nextSlot_ = 0;
+};
+
+}  // namespace gag
@@ -0,0 +1,72 @@
+/**
+ * @file shot_analytics.cpp
+ * @brief Running sums and milestones behind ShotSummary.
+ */
+#include "shot_analytics.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace gag {
+
+void ShotAnalytics::start(uint32_t nowMs) {
+    Config cfg = cfg_;
+    *this = ShotAnalytics(cfg);
+    active_ = true;
+    preinfusing_ = true;
+    startMs_ = lastMs_ = nowMs;
+}
+
+void ShotAnalytics::update(uint32_t nowMs, float pressureBar, float volumeMl, float tempC,
+                           float setTempC, float pumpPct, float brewC) {
+    if (!active_) return;
+    float dt = (nowMs - lastMs_) / 1000.0f;
+    lastMs_ = nowMs;
+    volumeMl_ = volumeMl;
+
+    if (pressureBar > peakBar_) peakBar_ = pressureBar;
+    if (!firstDripMs_ && volumeMl >= cfg_.dripVolumeMl) firstDripMs_ = nowMs - startMs_;
+    if (dt <= 0.0f) return;
+
+    pressureBarS_ += pressureBar * dt;
+    sampledS_ += dt;
+    float dev = fabsf(tempC - setTempC);
+    tempDevCs_ += dev * dt;
+    if (dev > maxTempDevC_) maxTempDevC_ = dev;
+    pumpEnergyJ_ += pumpPct * 0.01f * cfg_.pumpRatedW * dt;
+    if (brewC > 0.0f) {
+        brewCs_ += brewC * dt;
+        brewS_ += dt;
+    }
+}
+
+void ShotAnalytics::endPreinfusion(uint32_t nowMs, float volumeMl) {
+    if (!active_ || !preinfusing_) return;
+    preinfusing_ = false;
+    preinfusionMs_ = nowMs - startMs_;
+    preinfusionMl_ = volumeMl;
+}
+
+ShotSummary ShotAnalytics::finish(uint32_t endMs) {
+    ShotSummary s;
+    memset(&s, 0, sizeof(s));
+    if (!active_) return s;
+    active_ = false;
+
+    s.durationMs = endMs > startMs_ ? endMs - startMs_ : 0;
+    // Never reached brew pressure: the whole shot was pre-infusion.
+    s.preinfusionMs = preinfusing_ ? s.durationMs : preinfusionMs_;
+    s.preinfusionMl = preinfusing_ ? volumeMl_ : preinfusionMl_;
+    s.firstDripMs = firstDripMs_;
+    s.volumeMl = volumeMl_;
+    s.peakBar = peakBar_;
+    s.meanBar = sampledS_ > 0.0f ? pressureBarS_ / sampledS_ : 0.0f;
+    s.meanFlowMlS = s.durationMs ? volumeMl_ * 1000.0f / s.durationMs : 0.0f;
+    s.tempDevCs = tempDevCs_;
+    s.maxTempDevC = maxTempDevC_;
+    s.pumpEnergyJ = pumpEnergyJ_;
+    s.meanBrewC = brewS_ > 0.0f ? brewCs_ / brewS_ : 0.0f;
+    return s;
+}
+
+}  // namespace gag
@@ -0,0 +1,68 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file shot_analytics.h
+ * @brief Streaming per-shot statistics with constant memory.
+ *
+ * Fed once per control pass while a shot runs; keeps only running sums,
+ * extremes and a few milestone timestamps, and condenses them into a
+ * ShotSummary when the pump stops.
+ */
+
+namespace gag {
+
+struct ShotSummary {
+    uint32_t durationMs;
+    uint32_t preinfusionMs;  // until pressure first crossed the pre-infusion threshold
+    uint32_t firstDripMs;    // estimated, 0 if never reached
+    float volumeMl;          // pumped volume over the whole shot
+    float preinfusionMl;
+    float peakBar;
+    float meanBar;           // time-weighted over the shot
+    float meanFlowMlS;
+    float tempDevCs;         // integral of |T - setpoint| in degC * s
+    float maxTempDevC;
+    float pumpEnergyJ;       // pump power % times rated power, integrated
+    float meanBrewC;         // time-weighted brew-water estimate, 0 if none was given
+};
+
+class ShotAnalytics {
+   public:
+    struct Config {
+        float dripVolumeMl;  // basket headspace + puck absorption before the first drip
+        float pumpRatedW;    // pump electrical power at 100 %
+    };
+
+    explicit ShotAnalytics(const Config& cfg) : cfg_(cfg) {}
+
+    void start(uint32_t nowMs);
+    bool active() const { return active_; }
+
+    /**
+     * @brief Accumulate one sample; @p volumeMl is the pumped volume since start().
+     * @param brewC estimated brew-water temperature, or <= 0 when unavailable
+     */
+    void update(uint32_t nowMs, float pressureBar, float volumeMl, float tempC, float setTempC,
+                float pumpPct, float brewC);
+
+    /** Record the end of pre-infusion (pressure crossed the threshold). */
+    void endPreinfusion(uint32_t nowMs, float volumeMl);
+
+    /** Close the shot at @p endMs (last pump activity) and summarise it. */
+    ShotSummary finish(uint32_t endMs);
+
+   private:
+    Config cfg_;
+    bool active_ = false;
+    uint32_t startMs_ = 0, lastMs_ = 0;
+    bool preinfusing_ = false;
+    uint32_t preinfusionMs_ = 0, firstDripMs_ = 0;
+    float preinfusionMl_ = 0.0f, volumeMl_ = 0.0f;
+    float peakBar_ = 0.0f, pressureBarS_ = 0.0f, sampledS_ = 0.0f;
+    float tempDevCs_ = 0.0f, maxTempDevC_ = 0.0f;
+    float pumpEnergyJ_ = 0.0f;
+    float brewCs_ = 0.0f, brewS_ = 0.0f;
+};
+
+}  // namespace gag
@@ -0,0 +1,51 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file shot_detector.h
+ * @brief Shot start/stop from pump zero-cross activity.
+ *
+ * The zero-cross detector only sees mains while the pump is switched on, so
+ * a burst of zero-crosses means the brew switch was flipped. A shot starts
+ * after minZc zero-crosses since the previous shot ended (and not in the
+ * first bootHoldMs, while inputs settle); it ends once the pump has been
+ * quiet for idleMs. Times are millis(), compared by difference so the
+ * 49-day wraparound is harmless.
+ */
+
+namespace gag {
+
+class ShotDetector {
+   public:
+    struct Config {
+        uint32_t minZc;       // zero-crosses that start a shot
+        uint32_t bootHoldMs;  // no shot starts this soon after boot
+        uint32_t idleMs;      // pump quiet time that ends a shot
+    };
+
+    explicit ShotDetector(const Config& cfg) : cfg_(cfg) {}
+
+    /** True when enough new zero-crosses arrived to start a shot. */
+    bool shouldStart(uint32_t zcCount, uint32_t nowMs, uint32_t bootMs) const {
+        return zcCount - zcAtStop_ >= cfg_.minZc && nowMs - bootMs > cfg_.bootHoldMs;
+    }
+
+    /**
+     * @brief True when the last zero-cross at @p lastZcMs is idleMs or more in the past.
+     *
+     * A zero-cross stamped after @p nowMs (the ISR ran after the caller read
+     * the clock) is recent, not 49 days old.
+     */
+    bool pumpIdle(uint32_t nowMs, uint32_t lastZcMs) const {
+        return static_cast<int32_t>(nowMs - lastZcMs) >= static_cast<int32_t>(cfg_.idleMs);
+    }
+
+    /** The shot (or a steam entry) ended with the counter at @p zcCount. */
+    void stop(uint32_t zcCount) { zcAtStop_ = zcCount; }
+
+   private:
+    Config cfg_;
+    uint32_t zcAtStop_ = 0;
+};
+
+}  // namespace gag
@@ -0,0 +1,26 @@
+/**
+ * @file steam_sense.cpp
+ * @brief Steam switch detection window.
+ */
+#include "steam_sense.h"
+
+namespace gag {
+
+bool SteamSense::update(int64_t nowUs, bool acLow, int64_t lastEdgeUs, int64_t runStartUs,
+                        int64_t lastZcUs) {
+    int64_t pumpIdleFrom = lastZcUs + cfg_.pumpOffUs;
+    ac_ = acLow || (lastEdgeUs && nowUs - lastEdgeUs <= cfg_.holdUs);
+    if (!ac_ || nowUs < pumpIdleFrom) {
+        detected_ = false;
+        return false;
+    }
+    if (detected_) return true;
+    int64_t since = runStartUs > pumpIdleFrom ? runStartUs : pumpIdleFrom;
+    if (nowUs - since >= cfg_.detectUs) {
+        detectMs_ = static_cast<uint32_t>((nowUs - runStartUs) / 1000);
+        detected_ = true;
+    }
+    return detected_;
+}
+
+}  // namespace gag
@@ -0,0 +1,52 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file steam_sense.h
+ * @brief Steam switch detection from AC_SENS edge timestamps.
+ *
+ * The steam switch and the pump share the AC_SENS opto, so AC only means
+ * steam once the pump has been quiet for pumpOffUs. AC counts as present
+ * while the input is held low or an edge arrived within holdUs; it has to
+ * stay present and eligible for detectUs before steam is reported. Works on
+ * timestamps only, so detection latency does not depend on the caller's rate.
+ */
+
+namespace gag {
+
+class SteamSense {
+   public:
+    struct Config {
+        int64_t holdUs;     // an edge keeps AC present this long (> one mains cycle)
+        int64_t pumpOffUs;  // pump quiet time before AC can mean steam
+        int64_t detectUs;   // eligible AC needed before steam is reported
+    };
+
+    explicit SteamSense(const Config& cfg) : cfg_(cfg) {}
+
+    /**
+     * @brief Evaluate the switch at @p nowUs.
+     *
+     * @param acLow     AC_SENS reads low right now
+     * @param lastEdgeUs last AC_SENS edge, 0 if none yet
+     * @param runStartUs first edge of the current AC run
+     * @param lastZcUs  last pump zero-cross
+     * @return true while steam is detected.
+     */
+    bool update(int64_t nowUs, bool acLow, int64_t lastEdgeUs, int64_t runStartUs,
+                int64_t lastZcUs);
+
+    /** AC present at the last update(). */
+    bool ac() const { return ac_; }
+    bool detected() const { return detected_; }
+    /** Switch-on to detection of the last steam entry (ms). */
+    uint32_t detectMs() const { return detectMs_; }
+
+   private:
+    Config cfg_;
+    bool ac_ = false;
+    bool detected_ = false;
+    uint32_t detectMs_ = 0;
+};
+
+}  // namespace gag
@@ -0,0 +1,50 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file stream_stats.h
+ * @brief Constant-memory min/max/mean/last of a window of samples.
+ *
+ * Telemetry reports one snapshot per send interval, so a pressure spike or a
+ * heater burst between sends never reaches the display. A StreamStats per
+ * channel is fed every sample where it is taken and reset after each send;
+ * the report then covers the whole window. add() is a few compares and an
+ * add, cheap enough for the hot control path.
+ */
+
+namespace gag {
+
+class StreamStats {
+   public:
+    void add(float x) {
+        if (count_ == 0) {
+            min_ = max_ = x;
+        } else if (x < min_) {
+            min_ = x;
+        } else if (x > max_) {
+            max_ = x;
+        }
+        sum_ += x;
+        last_ = x;
+        ++count_;
+    }
+
+    /** Start a new window. last() keeps the previous sample until the next add(). */
+    void reset() {
+        count_ = 0;
+        sum_ = 0.0f;
+    }
+
+    uint32_t count() const { return count_; }
+    /** Window extremes and mean; 0 for an empty window. */
+    float min() const { return count_ ? min_ : 0.0f; }
+    float max() const { return count_ ? max_ : 0.0f; }
+    float mean() const { return count_ ? sum_ / count_ : 0.0f; }
+    float last() const { return last_; }
+
+   private:
+    float min_ = 0.0f, max_ = 0.0f, sum_ = 0.0f, last_ = 0.0f;
+    uint32_t count_ = 0;
+};
+
+}  // namespace gag
@@ -0,0 +1,47 @@
+/**
+ * @file thermal_observer.cpp
+ * @brief Euler integration of the two-node model plus sensor correction.
+ */
+#include "thermal_observer.h"
+
+namespace gag {
+namespace {
+
+constexpr float WATER_J_PER_G_K = 4.186f;
+constexpr float MAX_STEP_S = 0.5f;  // keeps explicit Euler well inside stability
+
+}  // namespace
+
+void ThermalObserver::reset(float sensedC) {
+    tb_ = tg_ = sensedC;
+    residual_ = 0.0f;
+    ready_ = true;
+}
+
+void ThermalObserver::update(float dtSec, float heaterPct, float flowMlS, float sensedC) {
+    if (!ready_) {
+        reset(sensedC);
+        return;
+    }
+    if (dtSec <= 0.0f) return;
+    if (flowMlS < 0.0f) flowMlS = 0.0f;
+    float heatW = p_.heaterW * heaterPct * 0.01f;
+    float advect = WATER_J_PER_G_K * flowMlS;  // W/K carried by the flow
+
+    float remaining = dtSec;
+    while (remaining > 0.0f) {
+        float h = remaining > MAX_STEP_S ? MAX_STEP_S : remaining;
+        remaining -= h;
+        float bg = p_.boilerGroupWK * (tb_ - tg_);
+        float dTb = heatW - bg - p_.boilerAmbWK * (tb_ - p_.ambientC) - advect * (tb_ - p_.inletC);
+        float dTg = bg - p_.groupAmbWK * (tg_ - p_.ambientC) + advect * (tb_ - tg_);
+        tb_ += dTb / p_.boilerJK * h;
+        tg_ += dTg / p_.groupJK * h;
+    }
+
+    residual_ = sensedC - tb_;
+    tb_ += p_.gainBoiler * residual_ * dtSec;
+    tg_ += p_.gainGroup * residual_ * dtSec;
+}
+
+}  // namespace gag
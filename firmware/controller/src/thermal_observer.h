@@ -0,0 +1,64 @@
+#pragma once
+
+/**
+ * @file thermal_observer.h
+ * @brief Two-node boiler/group thermal model with a Luenberger correction.
+ *
+ * The PT100 sits on the boiler; the water reaching the puck has passed
+ * through the group, which lags and runs cooler than the boiler, most
+ * visibly right after heating bursts and during a shot. The model keeps
+ * two lumped nodes:
+ *
+ *   Cb dTb/dt = P·u - Gbg (Tb - Tg) - Gba (Tb - Ta) - c·q (Tb - Tin)
+ *   Cg dTg/dt = Gbg (Tb - Tg) - Gga (Tg - Ta) + c·q (Tb - Tg)
+ *
+ * with heater duty u, flow q (mL/s ~ g/s) and c = 4.186 J/(g·K). The sensor
+ * reading corrects both nodes through the boiler residual. Parameters come
+ * from tools/thermal_fit.py run over TRACE lines captured from the serial log.
+ */
+
+namespace gag {
+
+class ThermalObserver {
+   public:
+    struct Params {
+        float heaterW;       // element power at 100 % duty
+        float boilerJK;      // Cb: boiler water + metal around the sensor
+        float groupJK;       // Cg: group head / brew path
+        float boilerGroupWK; // Gbg
+        float boilerAmbWK;   // Gba
+        float groupAmbWK;    // Gga
+        float ambientC;      // Ta
+        float inletC;        // Tin, reservoir water
+        float gainBoiler;    // observer gain on Tb from the residual (1/s)
+        float gainGroup;     // observer gain on Tg from the residual (1/s)
+    };
+
+    explicit ThermalObserver(const Params& p) : p_(p) {}
+
+    void setParams(const Params& p) { p_ = p; }
+    const Params& params() const { return p_; }
+
+    /** Start both nodes at the sensed temperature (machine at equilibrium). */
+    void reset(float sensedC);
+
+    /**
+     * @brief Advance the model by @p dtSec and correct it with the sensor.
+     * @param heaterPct average heater duty over the step (0..100)
+     * @param flowMlS   water drawn through the boiler during the step
+     */
+    void update(float dtSec, float heaterPct, float flowMlS, float sensedC);
+
+    bool ready() const { return ready_; }
+    float boilerC() const { return tb_; }
+    /** Estimated temperature of the water delivered to the puck. */
+    float brewC() const { return tg_; }
+    float residualC() const { return residual_; }
+
+   private:
+    Params p_;
+    bool ready_ = false;
+    float tb_ = 0.0f, tg_ = 0.0f, residual_ = 0.0f;
+};
+
+}  // namespace gag
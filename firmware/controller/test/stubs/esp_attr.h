@@ -0,0 +1,6 @@
+#pragma once
+
+// Host stand-in for the ESP-IDF section attributes used by the pure modules.
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_NOINIT_ATTR
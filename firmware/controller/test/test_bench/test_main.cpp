@@ -0,0 +1,145 @@
+/**
+ * Microbenchmarks of the control steps on the host.
+ *
+ * Host timings only rank the steps against each other; they say nothing
+ * about the ESP32 budget, which the loop supervisor measures on target.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+#include <chrono>
+
+#include "control_packet.h"
+#include "curve_cal.h"
+#include "fixed_point.h"
+#include "pid.h"
+#include "pump_ramp.h"
+#include "shot_detector.h"
+#include "steam_sense.h"
+
+using namespace gag;
+
+namespace {
+
+struct HeaterConfig {
+    static constexpr float OUT_MIN = 0.0f, OUT_MAX = 100.0f;
+    static constexpr bool DERIVATIVE_FILTER = true, CONDITIONAL_INTEGRATION = true,
+                          SETPOINT_WEIGHTING = false, BUMPLESS = true, RESET_I_AT_SETPOINT = true,
+                          P_BELOW_SETPOINT_ONLY = true;
+};
+
+constexpr int ITERATIONS = 1000000;
+const CalCurve PRESSURE = {{150, 500, 1000, 1600, 2300, 3000},
+                          {-0.5f, 1.2f, 3.9f, 7.1f, 10.8f, 14.6f}};
+
+volatile float g_sinkF;
+volatile uint32_t g_sinkU;
+
+// Runs @p step ITERATIONS times and reports ns per call.
+template <typename F>
+void bench(const char* name, F step) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i) step(i);
+    auto t1 = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / ITERATIONS;
+    char msg[80];
+    snprintf(msg, sizeof(msg), "%-24s %8.1f ns/step", name, ns);
+    TEST_MESSAGE(msg);
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_bench_heater_pid_float() {
+    Pid<float, HeaterConfig> pid({8.0f, 0.4f, 17.0f, 25.0f, 0.8f, 1.0f});
+    pid.reset(90.0f);
+    bench("heater PID (float)", [&](int i) {
+        g_sinkF = pid.step(93.0f, 90.0f + (i & 63) * 0.1f, 0.25f);
+    });
+    TEST_ASSERT_TRUE(pid.terms().out >= 0.0f && pid.terms().out <= 100.0f);
+}
+
+void test_bench_heater_pid_q16() {
+    Pid<Q16_16, HeaterConfig> pid(
+        {Q16_16(8.0f), Q16_16(0.4f), Q16_16(17.0f), Q16_16(25.0f), Q16_16(0.8f), Q16_16(1.0f)});
+    pid.reset(Q16_16(90.0f));
+    const Q16_16 sp(93.0f), dt(0.25f), step(0.1f);
+    bench("heater PID (Q16.16)", [&](int i) {
+        Q16_16 pv = Q16_16(90.0f) + step * Q16_16::fromInt(i & 63);
+        g_sinkU = static_cast<uint32_t>(pid.step(sp, pv, dt).raw());
+    });
+    TEST_ASSERT_TRUE(pid.terms().out <= Q16_16(100.0f));
+}
+
+void test_bench_pressure_conversion() {
+    const CalCurveQ q = calCurveToFixed(PRESSURE);
+    bench("pressure curve (float)",
+          [&](int i) { g_sinkF = calCurveEval(PRESSURE, static_cast<float>(i % 3300)); });
+    bench("pressure curve (Q16.16)", [&](int i) {
+        g_sinkU = static_cast<uint32_t>(calCurveEvalQ(q, Q16_16::fromInt(i % 3300)).raw());
+    });
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 7.1f, calCurveEval(PRESSURE, 1600.0f));
+}
+
+void test_bench_pump_ramp() {
+    PumpRamp ramp({50.0f, 40.0f, 1500, 0.2f, 0.1f});
+    bench("pump ramp", [&](int i) {
+        uint32_t now = static_cast<uint32_t>(i) * 50u;
+        float requested = (i & 1023) < 900 ? 100.0f : 0.0f;
+        float dt = ramp.begin(now, requested);
+        float v = ramp.limit(now, requested, dt);
+        ramp.commit(now, requested, v);
+        g_sinkF = v;
+    });
+    TEST_ASSERT_TRUE(ramp.lastApplied() >= 0.0f && ramp.lastApplied() <= 100.0f);
+}
+
+void test_bench_shot_detection() {
+    ShotDetector shot({4, 2000, 60000});
+    bench("shot detection", [&](int i) {
+        uint32_t now = static_cast<uint32_t>(i);
+        g_sinkU = shot.shouldStart(now / 20, now, 0) + shot.pumpIdle(now, now - (i & 4095));
+    });
+    TEST_ASSERT_TRUE(shot.shouldStart(4, 3000, 0));
+}
+
+void test_bench_steam_detection() {
+    SteamSense steam({30000, 1000000, 200000});
+    bench("steam detection", [&](int i) {
+        int64_t now = 10000000 + static_cast<int64_t>(i) * 5000;
+        g_sinkU = steam.update(now, false, now - (i % 10) * 1000, 10000000, 0);
+    });
+    TEST_ASSERT_TRUE(steam.detected());
+}
+
+void test_bench_control_packet() {
+    EspNowControlPacket pkt;
+    memset(&pkt, 0, sizeof(pkt));
+    pkt.type = ESPNOW_CONTROL_PACKET;
+    pkt.flags = ESPNOW_CONTROL_FLAG_HEATER;
+    pkt.steamSetpointC = 150.0f;
+    pkt.pumpPowerPercent = 95.0f;
+    uint32_t last = 0;
+    bench("control packet decode", [&](int i) {
+        pkt.brewSetpointC = 85.0f + (i & 15);
+        pkt.revision = static_cast<uint32_t>(i);
+        if (controlRevisionNewer(pkt.revision, last)) last = pkt.revision;
+        g_sinkF = decodeControl(pkt, 60.0f, 85.0f).brewC;
+    });
+    TEST_ASSERT_EQUAL_UINT32(ITERATIONS - 1, last);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_bench_heater_pid_float);
+    RUN_TEST(test_bench_heater_pid_q16);
+    RUN_TEST(test_bench_pressure_conversion);
+    RUN_TEST(test_bench_pump_ramp);
+    RUN_TEST(test_bench_shot_detection);
+    RUN_TEST(test_bench_steam_detection);
+    RUN_TEST(test_bench_control_packet);
+    return UNITY_END();
+}
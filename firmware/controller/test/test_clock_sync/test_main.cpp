@@ -0,0 +1,126 @@
+#include <unity.h>
+
+#include "clock_sync.h"
+
+using namespace gag;
+
+namespace {
+
+const int64_t MAX_RTT_US = 20000;
+const int64_t UTC_BASE_US = 1700000000LL * 1000000;  // display UTC at local time 0
+const int64_t PROC_US = 300;                         // display turnaround
+
+// The display's UTC clock as seen from a local oscillator that is off by ppm.
+struct Link {
+    double ppm;
+    int64_t utcAt(int64_t localUs) const {
+        return UTC_BASE_US + localUs + static_cast<int64_t>(localUs * ppm * 1e-6);
+    }
+    // One exchange sent at local t1 with the given one-way delays.
+    bool exchange(int64_t t1, int64_t fwdUs, int64_t backUs, ClockSync::Sample& s) const {
+        int64_t t2 = utcAt(t1 + fwdUs);
+        int64_t t3 = t2 + PROC_US;
+        int64_t t4 = t1 + fwdUs + PROC_US + backUs;
+        return ClockSync::makeSample(t1, t2, t3, t4, MAX_RTT_US, s);
+    }
+    // A burst of three exchanges; the middle one sees no queueing.
+    void burst(ClockSync& c, int64_t t1) const {
+        ClockSync::Sample s;
+        if (exchange(t1, 4000, 3000, s)) c.addSample(s);
+        if (exchange(t1 + 50000, 800, 800, s)) c.addSample(s);
+        if (exchange(t1 + 100000, 2500, 6000, s)) c.addSample(s);
+        c.commitBurst();
+    }
+};
+
+const int64_t S = 1000000;
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_asymmetric_rtt_and_min_rtt_selection() {
+    Link link{0.0};
+    ClockSync::Sample s;
+    // 3 ms out, 1 ms back: RTT excludes the turnaround, and half the
+    // asymmetry shows up as offset error.
+    TEST_ASSERT_TRUE(link.exchange(10 * S, 3000, 1000, s));
+    TEST_ASSERT_EQUAL_INT64(4000, s.rttUs);
+    TEST_ASSERT_EQUAL_INT64(UTC_BASE_US + 1000, s.offsetUs);
+    TEST_ASSERT_EQUAL_INT64(10 * S + (3000 + PROC_US + 1000) / 2, s.localUs);
+
+    // The burst keeps its lowest-RTT sample, whatever order they arrive in.
+    ClockSync c;
+    link.burst(c, 10 * S);
+    TEST_ASSERT_TRUE(c.synced());
+    TEST_ASSERT_EQUAL_INT64(1600, c.lastRttUs());
+    TEST_ASSERT_EQUAL_INT64(UTC_BASE_US + 20 * S, c.utcUs(20 * S));
+    // An empty burst changes nothing.
+    TEST_ASSERT_FALSE(c.commitBurst());
+}
+
+void test_inconsistent_timestamps_are_rejected() {
+    ClockSync::Sample s;
+    const int64_t t1 = 10 * S, t2 = UTC_BASE_US + t1 + 1000;
+    TEST_ASSERT_TRUE(ClockSync::makeSample(t1, t2, t2 + 300, t1 + 2300, MAX_RTT_US, s));
+    // Reply before the request left.
+    TEST_ASSERT_FALSE(ClockSync::makeSample(t1, t2, t2 + 300, t1 - 1, MAX_RTT_US, s));
+    // Display answered before it received.
+    TEST_ASSERT_FALSE(ClockSync::makeSample(t1, t2, t2 - 1, t1 + 2300, MAX_RTT_US, s));
+    // Turnaround longer than the whole round trip: negative RTT.
+    TEST_ASSERT_FALSE(ClockSync::makeSample(t1, t2, t2 + 5000, t1 + 2300, MAX_RTT_US, s));
+    // Round trip over the limit.
+    TEST_ASSERT_FALSE(
+        ClockSync::makeSample(t1, t2, t2 + 300, t1 + MAX_RTT_US + 301, MAX_RTT_US, s));
+}
+
+void test_drift_needs_a_minute_between_bursts() {
+    Link link{50.0};
+    ClockSync c;
+    link.burst(c, 10 * S);
+    link.burst(c, 40 * S);
+    link.burst(c, 65 * S);
+    // Bursts under a minute from the drift anchor track offset only.
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, static_cast<float>(c.driftPpm()));
+    TEST_ASSERT_TRUE(c.lastCorrectionUs() > 0);
+    link.burst(c, 70 * S);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 50.0f, static_cast<float>(c.driftPpm()));
+    // The next rate needs another minute from the new anchor.
+    link.burst(c, 100 * S);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 50.0f, static_cast<float>(c.driftPpm()));
+    TEST_ASSERT_TRUE(c.lastCorrectionUs() < 10 && c.lastCorrectionUs() > -10);
+}
+
+void test_drift_is_clamped() {
+    // 400 ppm is beyond any real crystal; the estimate stops at the limit.
+    Link link{400.0};
+    ClockSync c;
+    link.burst(c, 10 * S);
+    link.burst(c, 70 * S);
+    TEST_ASSERT_EQUAL_FLOAT(200.0f, static_cast<float>(c.driftPpm()));
+}
+
+void test_extrapolates_with_drift() {
+    const double ppms[] = {200.0, -200.0};
+    for (double ppm : ppms) {
+        Link link{ppm};
+        ClockSync c;
+        for (int64_t t = 10 * S; t <= 310 * S; t += 60 * S) link.burst(c, t);
+        TEST_ASSERT_FLOAT_WITHIN(0.5f, static_cast<float>(ppm), static_cast<float>(c.driftPpm()));
+        // Ten minutes without the display: 120 ms of drift, predicted to within 1 ms.
+        int64_t later = 910 * S;
+        int64_t err = c.utcUs(later) - link.utcAt(later);
+        TEST_ASSERT_TRUE(err < 1000 && err > -1000);
+    }
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_asymmetric_rtt_and_min_rtt_selection);
+    RUN_TEST(test_inconsistent_timestamps_are_rejected);
+    RUN_TEST(test_drift_needs_a_minute_between_bursts);
+    RUN_TEST(test_drift_is_clamped);
+    RUN_TEST(test_extrapolates_with_drift);
+    return UNITY_END();
+}
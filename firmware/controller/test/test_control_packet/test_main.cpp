@@ -0,0 +1,98 @@
+#include <math.h>
+#include <string.h>
+#include <unity.h>
+
+#include "control_packet.h"
+#include "param_registry.h"
+
+using namespace gag;
+
+namespace {
+
+EspNowControlPacket defaultPacket() {
+    EspNowControlPacket p;
+    memset(&p, 0, sizeof(p));
+    p.type = ESPNOW_CONTROL_PACKET;
+    p.flags = ESPNOW_CONTROL_FLAG_HEATER | ESPNOW_CONTROL_FLAG_PUMP_PRESSURE;
+    p.pumpMode = ESPNOW_PUMP_MODE_PREINFUSE;
+    p.brewSetpointC = 93.0f;
+    p.steamSetpointC = 150.0f;
+    p.pidP = 8.0f;
+    p.pidI = 0.4f;
+    p.pidGuard = 25.0f;
+    p.pidD = 17.0f;
+    p.dTau = 0.8f;
+    p.pumpPowerPercent = 95.0f;
+    p.pressureSetpointBar = 9.0f;
+    return p;
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_in_range_values_pass_through() {
+    ControlTargets t = decodeControl(defaultPacket(), 60.0f, 85.0f);
+    TEST_ASSERT_TRUE(t.heater);
+    TEST_ASSERT_FALSE(t.steam);
+    TEST_ASSERT_TRUE(t.pressureMode);
+    TEST_ASSERT_EQUAL_UINT8(ESPNOW_PUMP_MODE_PREINFUSE, t.pumpMode);
+    TEST_ASSERT_EQUAL_FLOAT(93.0f, t.brewC);
+    TEST_ASSERT_EQUAL_FLOAT(150.0f, t.steamC);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, t.ecoC);
+    TEST_ASSERT_EQUAL_FLOAT(9.0f, t.pressureBar);
+}
+
+void test_out_of_range_values_are_clamped() {
+    EspNowControlPacket p = defaultPacket();
+    p.brewSetpointC = 120.0f;
+    p.steamSetpointC = 20.0f;
+    p.pumpPowerPercent = 250.0f;
+    p.pressureSetpointBar = -3.0f;
+    ControlTargets t = decodeControl(p, 60.0f, 85.0f);
+    TEST_ASSERT_EQUAL_FLOAT(PARAM_DEFS[PARAM_INDEX_BREW_SETPOINT].max, t.brewC);
+    TEST_ASSERT_EQUAL_FLOAT(PARAM_DEFS[PARAM_INDEX_STEAM_SETPOINT].min, t.steamC);
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, t.pumpPct);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, t.pressureBar);
+}
+
+void test_nan_takes_lower_bound() {
+    EspNowControlPacket p = defaultPacket();
+    p.brewSetpointC = NAN;
+    p.pidP = NAN;
+    p.pumpPowerPercent = NAN;
+    ControlTargets t = decodeControl(p, 60.0f, 85.0f);
+    TEST_ASSERT_EQUAL_FLOAT(PARAM_DEFS[PARAM_INDEX_BREW_SETPOINT].min, t.brewC);
+    TEST_ASSERT_EQUAL_FLOAT(PARAM_DEFS[PARAM_INDEX_HEATER_KP].min, t.pidP);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, t.pumpPct);
+}
+
+void test_eco_setpoint_is_bounded() {
+    EspNowControlPacket p = defaultPacket();
+    p.ecoSetpointC = 75;
+    TEST_ASSERT_EQUAL_FLOAT(75.0f, decodeControl(p, 60.0f, 85.0f).ecoC);
+    p.ecoSetpointC = 20;
+    TEST_ASSERT_EQUAL_FLOAT(60.0f, decodeControl(p, 60.0f, 85.0f).ecoC);
+    p.ecoSetpointC = 200;
+    TEST_ASSERT_EQUAL_FLOAT(85.0f, decodeControl(p, 60.0f, 85.0f).ecoC);
+}
+
+void test_revision_ordering() {
+    TEST_ASSERT_TRUE(controlRevisionNewer(6, 5));
+    TEST_ASSERT_FALSE(controlRevisionNewer(5, 5));
+    TEST_ASSERT_FALSE(controlRevisionNewer(4, 5));
+    TEST_ASSERT_TRUE(controlRevisionNewer(0, 5));
+    TEST_ASSERT_TRUE(controlRevisionNewer(2, 0xFFFFFFFEu));
+    TEST_ASSERT_FALSE(controlRevisionNewer(0xFFFFFFFEu, 2));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_in_range_values_pass_through);
+    RUN_TEST(test_out_of_range_values_are_clamped);
+    RUN_TEST(test_nan_takes_lower_bound);
+    RUN_TEST(test_eco_setpoint_is_bounded);
+    RUN_TEST(test_revision_ordering);
+    return UNITY_END();
+}
@@ -0,0 +1,71 @@
+#include <math.h>
+#include <unity.h>
+
+#include "curve_cal.h"
+
+using namespace gag;
+
+namespace {
+
+// Linear 0..3000 mV -> -1..14 bar, as pressureCurveDefault() builds it.
+const CalCurve PRESSURE = {{0, 600, 1200, 1800, 2400, 3000}, {-1, 2, 5, 8, 11, 14}};
+const CurveCalibrator::Limits LIMITS = {-2.0f, 20.0f, 20, 0.5f, 1.0f, 50.0f};
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_eval_interpolates_and_clamps() {
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, calCurveEval(PRESSURE, -50.0f));
+    TEST_ASSERT_EQUAL_FLOAT(14.0f, calCurveEval(PRESSURE, 4000.0f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 3.5f, calCurveEval(PRESSURE, 900.0f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 8.0f, calCurveEval(PRESSURE, 1800.0f));
+}
+
+void test_validity() {
+    TEST_ASSERT_TRUE(calCurveValid(PRESSURE, -2.0f, 20.0f));
+    TEST_ASSERT_FALSE(calCurveValid(PRESSURE, 0.0f, 20.0f));
+    CalCurve bad = PRESSURE;
+    bad.x[3] = bad.x[2];
+    TEST_ASSERT_FALSE(calCurveValid(bad, -2.0f, 20.0f));
+    bad = PRESSURE;
+    bad.y[1] = NAN;
+    TEST_ASSERT_FALSE(calCurveValid(bad, -2.0f, 20.0f));
+}
+
+void test_run_moves_curve_towards_reference() {
+    CurveCalibrator cal(PRESSURE, LIMITS);
+    cal.startRun();
+    // 9 bar measured by a reference gauge where the curve says 8.
+    for (int i = 0; i < 100; ++i) cal.addSample(1800.0f);
+    CurveCalibrator::Result r = cal.finishRun(9.0f, true);
+    TEST_ASSERT_TRUE(r.ok);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 8.0f, r.measured);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 9.0f, cal.eval(1800.0f));
+    // Breakpoints the run never touched stay put.
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, cal.curve().y[0]);
+    TEST_ASSERT_EQUAL_FLOAT(14.0f, cal.curve().y[5]);
+}
+
+void test_implausible_runs_are_rejected() {
+    CurveCalibrator cal(PRESSURE, LIMITS);
+    cal.startRun();
+    for (int i = 0; i < 5; ++i) cal.addSample(1800.0f);
+    TEST_ASSERT_FALSE(cal.finishRun(9.0f, true).ok);
+
+    cal.startRun();
+    for (int i = 0; i < 100; ++i) cal.addSample(1800.0f);
+    TEST_ASSERT_FALSE(cal.finishRun(30.0f, true).ok);  // 275 % off: a typo
+    TEST_ASSERT_EQUAL_UINT8(0, cal.runCount());
+    TEST_ASSERT_EQUAL_FLOAT(8.0f, cal.eval(1800.0f));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_eval_interpolates_and_clamps);
+    RUN_TEST(test_validity);
+    RUN_TEST(test_run_moves_curve_towards_reference);
+    RUN_TEST(test_implausible_runs_are_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,111 @@
+#include <math.h>
+#include <unity.h>
+
+#include "curve_cal.h"
+#include "fixed_point.h"
+
+using namespace gag;
+
+// Conversions of constants happen at compile time.
+static_assert(Q16_16(1.5f).raw() == 98304, "constexpr conversion");
+static_assert((Q16_16(2.0f) * Q16_16(-3.25f)) == Q16_16(-6.5f), "constexpr multiply");
+
+void setUp() {}
+void tearDown() {}
+
+void test_conversion_rounds_and_saturates() {
+    TEST_ASSERT_EQUAL_INT32(Q16_16::ONE, Q16_16(1.0f).raw());
+    TEST_ASSERT_TRUE(Q16_16(1e9f) == Q16_16::max());
+    TEST_ASSERT_TRUE(Q16_16(-1e9f) == Q16_16::min());
+    TEST_ASSERT_EQUAL_INT32(0, Q16_16(NAN).raw());
+    TEST_ASSERT_EQUAL_INT32(3, Q16_16(2.5f).roundToInt());
+    TEST_ASSERT_EQUAL_INT32(-2, Q16_16(-2.25f).roundToInt());
+}
+
+void test_arithmetic_saturates() {
+    TEST_ASSERT_TRUE((Q16_16(30000.0f) + Q16_16(30000.0f)) == Q16_16::max());
+    TEST_ASSERT_TRUE((Q16_16(-30000.0f) - Q16_16(30000.0f)) == Q16_16::min());
+    TEST_ASSERT_TRUE((Q16_16(200.0f) * Q16_16(200.0f)) == Q16_16::max());
+    TEST_ASSERT_TRUE((Q16_16(-200.0f) * Q16_16(200.0f)) == Q16_16::min());
+    TEST_ASSERT_TRUE(-Q16_16::min() == Q16_16::max());
+}
+
+void test_division() {
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 2.5f, (Q16_16(5.0f) / Q16_16(2.0f)).toFloat());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, -0.25f, (Q16_16(1.0f) / Q16_16(-4.0f)).toFloat());
+    TEST_ASSERT_TRUE((Q16_16(1.0f) / Q16_16()) == Q16_16::max());
+    TEST_ASSERT_TRUE((Q16_16(-1.0f) / Q16_16()) == Q16_16::min());
+}
+
+void test_matches_float_arithmetic() {
+    const float values[] = {-1234.5f, -93.25f, -2.0f, -0.75f, 0.6f, 1.0f, 9.0f, 93.0f, 2300.0f};
+    for (float a : values) {
+        for (float b : values) {
+            Q16_16 qa(a), qb(b);
+            float fa = qa.toFloat(), fb = qb.toFloat();
+            TEST_ASSERT_FLOAT_WITHIN(1e-4f, fa + fb, (qa + qb).toFloat());
+            TEST_ASSERT_FLOAT_WITHIN(1e-4f, fa - fb, (qa - qb).toFloat());
+            float prod = fa * fb;
+            if (fabsf(prod) < 30000.0f) {
+                TEST_ASSERT_FLOAT_WITHIN(2e-4f * (1.0f + fabsf(prod)), prod, (qa * qb).toFloat());
+            }
+            float quot = fa / fb;
+            TEST_ASSERT_FLOAT_WITHIN(2e-4f * (1.0f + fabsf(quot)), quot, (qa / qb).toFloat());
+        }
+    }
+}
+
+// The pressure auto-zero filter: 20 ms steps, 5 s time constant.
+void test_low_pass_tracks_float() {
+    float yf = 0.0f;
+    Q16_16 yq;
+    const float af = lowPassAlpha(0.02f, 5.0f);
+    const Q16_16 aq = lowPassAlpha(Q16_16(0.02f), Q16_16(5.0f));
+    for (int k = 0; k < 5000; ++k) {
+        float x = 0.3f * sinf(k * 0.01f);
+        yf = lowPassStep(yf, x, af);
+        yq = lowPassStep(yq, Q16_16(x), aq);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(2e-3f, yf, yq.toFloat());
+}
+
+void test_pressure_curve_fixed_matches_float() {
+    CalCurve c = {{150, 500, 1000, 1600, 2300, 3000}, {-0.5f, 1.2f, 3.9f, 7.1f, 10.8f, 14.6f}};
+    CalCurveQ q = calCurveToFixed(c);
+    for (int mv = 0; mv < 3300; mv += 7) {
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, calCurveEval(c, static_cast<float>(mv)),
+                                 calCurveEvalQ(q, Q16_16::fromInt(mv)).toFloat());
+    }
+}
+
+void test_calibrator_fixed_path_matches_float() {
+    const CalCurve c = {{150, 500, 1000, 1600, 2300, 3000},
+                        {-0.5f, 1.2f, 3.9f, 7.1f, 10.8f, 14.6f}};
+    CurveCalibrator fixedCal(c, {-1.0f, 16.0f, 20, 0.5f, 1.0f, 50.0f});
+    CurveCalibrator floatCal = fixedCal;
+    // The fixed-point copy follows the curve through a refit.
+    fixedCal.startRun();
+    floatCal.startRun();
+    for (int i = 0; i < 100; ++i) {
+        fixedCal.addSampleQ(Q16_16::fromInt(1800));
+        floatCal.addSample(1800.0f);
+    }
+    TEST_ASSERT_TRUE(fixedCal.finishRun(9.0f, true).ok);
+    TEST_ASSERT_TRUE(floatCal.finishRun(9.0f, true).ok);
+    for (int mv = 0; mv < 3300; mv += 7) {
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, floatCal.addSample(static_cast<float>(mv)),
+                                 fixedCal.addSampleQ(Q16_16::fromInt(mv)).toFloat());
+    }
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_conversion_rounds_and_saturates);
+    RUN_TEST(test_arithmetic_saturates);
+    RUN_TEST(test_division);
+    RUN_TEST(test_matches_float_arithmetic);
+    RUN_TEST(test_low_pass_tracks_float);
+    RUN_TEST(test_pressure_curve_fixed_matches_float);
+    RUN_TEST(test_calibrator_fixed_path_matches_float);
+    return UNITY_END();
+}
@@ -0,0 +1,91 @@
+#include <string.h>
+#include <unity.h>
+
+#include "flight_recorder.h"
+
+using namespace gag;
+
+namespace {
+
+FlightLog g_log;
+FlightRecord g_prev;
+
+EspNowFlightSample sample(int16_t tempC100) {
+    EspNowFlightSample s;
+    memset(&s, 0, sizeof(s));
+    s.tempC100 = tempC100;
+    return s;
+}
+
+}  // namespace
+
+void setUp() {
+    // What a power-up leaves in RTC memory.
+    memset(&g_log, 0xA5, sizeof(g_log));
+    memset(&g_prev, 0, sizeof(g_prev));
+}
+void tearDown() {}
+
+void test_power_up_contents_are_rejected() {
+    FlightRecorder rec(g_log, 50);
+    TEST_ASSERT_FALSE(rec.adopt(1, g_prev));
+    TEST_ASSERT_EQUAL_UINT16(0, g_log.count);
+    TEST_ASSERT_EQUAL_UINT32(1, g_log.runId);
+}
+
+void test_previous_run_is_adopted_oldest_first() {
+    FlightRecorder run1(g_log, 50);
+    run1.adopt(1, g_prev);
+    for (int i = 0; i < 3; ++i) run1.record(1000 + i * 50, sample(static_cast<int16_t>(9000 + i)));
+    run1.enterStage(4);
+
+    FlightRecorder run2(g_log, 50);
+    TEST_ASSERT_TRUE(run2.adopt(2, g_prev));
+    TEST_ASSERT_EQUAL_UINT32(1, g_prev.runId);
+    TEST_ASSERT_EQUAL_UINT8(4, g_prev.endStage);
+    TEST_ASSERT_EQUAL_UINT16(3, g_prev.count);
+    TEST_ASSERT_EQUAL_INT(9000, g_prev.samples[0].tempC100);
+    TEST_ASSERT_EQUAL_UINT32(1100, g_prev.samples[2].ms);
+    TEST_ASSERT_EQUAL_UINT16(0, g_log.count);
+}
+
+void test_ring_keeps_newest_samples() {
+    FlightRecorder rec(g_log, 50);
+    rec.adopt(1, g_prev);
+    const int total = FLIGHT_CAPACITY + 5;
+    for (int i = 0; i < total; ++i) rec.record(i * 50, sample(static_cast<int16_t>(i)));
+
+    FlightRecorder next(g_log, 50);
+    TEST_ASSERT_TRUE(next.adopt(2, g_prev));
+    TEST_ASSERT_EQUAL_UINT16(FLIGHT_CAPACITY, g_prev.count);
+    TEST_ASSERT_EQUAL_INT(5, g_prev.samples[0].tempC100);
+    TEST_ASSERT_EQUAL_INT(total - 1, g_prev.samples[FLIGHT_CAPACITY - 1].tempC100);
+}
+
+void test_pass_statistics_fold_into_next_sample() {
+    FlightRecorder rec(g_log, 50);
+    rec.adopt(1, g_prev);
+    TEST_ASSERT_TRUE(rec.due(0));
+    rec.notePass(1200, 2, false, false);
+    rec.notePass(26000, 5, true, false);
+    rec.notePass(900, 1, false, true);
+    rec.record(0, sample(0));
+    const EspNowFlightSample& s = g_log.samples[0];
+    TEST_ASSERT_EQUAL_UINT8(5, s.worstStage);
+    TEST_ASSERT_EQUAL_UINT16(260, s.worstPass100us);
+    TEST_ASSERT_EQUAL_UINT8(ESPNOW_FLIGHT_FLAG_OVERRUN | ESPNOW_FLIGHT_FLAG_TRIP, s.flags);
+
+    TEST_ASSERT_FALSE(rec.due(49));
+    TEST_ASSERT_TRUE(rec.due(50));
+    rec.record(50, sample(0));
+    TEST_ASSERT_EQUAL_UINT8(0, g_log.samples[1].flags);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_power_up_contents_are_rejected);
+    RUN_TEST(test_previous_run_is_adopted_oldest_first);
+    RUN_TEST(test_ring_keeps_newest_samples);
+    RUN_TEST(test_pass_statistics_fold_into_next_sample);
+    return UNITY_END();
+}
@@ -0,0 +1,72 @@
+#include <unity.h>
+
+#include "flow_cal.h"
+
+using namespace gag;
+
+namespace {
+
+// 4 Hz, on the third breakpoint.
+const uint32_t INTERVAL_4HZ_US = 250000;
+// 1.5 Hz, halfway between the first two breakpoints.
+const uint32_t INTERVAL_1HZ5_US = 666667;
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_default_is_flat_and_valid() {
+    FlowCalibrator cal(0.25f);
+    TEST_ASSERT_TRUE(flowCalValid(cal.table()));
+    TEST_ASSERT_EQUAL_FLOAT(0.25f, cal.mlPerPulse(INTERVAL_4HZ_US));
+    TEST_ASSERT_EQUAL_FLOAT(0.25f, cal.mlPerPulse(0));  // fastest breakpoint
+    FlowCalTable t = flowCalDefault(5.0f);              // above 2 mL per pulse
+    TEST_ASSERT_FALSE(flowCalValid(t));
+}
+
+void test_rate_selects_breakpoints() {
+    FlowCalibrator cal(0.25f);
+    FlowCalTable t = cal.table();
+    t.y[0] = 0.3f;
+    t.y[1] = 0.2f;
+    cal.setTable(t);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.25f, cal.mlPerPulse(INTERVAL_1HZ5_US));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.3f, cal.mlPerPulse(2000000));  // 0.5 Hz clamps low
+}
+
+void test_low_flow_run_only_moves_low_breakpoints() {
+    FlowCalibrator cal(0.25f);
+    cal.startRun();
+    float measured = 0.0f;
+    for (int i = 0; i < 100; ++i) measured += cal.addPulse(INTERVAL_1HZ5_US);
+    TEST_ASSERT_EQUAL_UINT32(100, cal.runPulses());
+    // Slip at low flow: the cup holds 20 mL where the curve counted 25.
+    FlowCalibrator::Result r = cal.finishRun(20.0f);
+    TEST_ASSERT_TRUE(r.ok);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, measured, r.measuredMl);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 25.0f, r.errorPct);
+    TEST_ASSERT_EQUAL_UINT32(100, r.pulses);
+    TEST_ASSERT_EQUAL_UINT8(1, r.runs);
+    TEST_ASSERT_FLOAT_WITHIN(0.002f, 0.2f, cal.mlPerPulse(INTERVAL_1HZ5_US));
+    TEST_ASSERT_EQUAL_FLOAT(0.25f, cal.mlPerPulse(INTERVAL_4HZ_US));
+}
+
+void test_typo_reference_is_rejected() {
+    FlowCalibrator cal(0.25f);
+    cal.startRun();
+    for (int i = 0; i < 100; ++i) cal.addPulse(INTERVAL_4HZ_US);
+    TEST_ASSERT_FALSE(cal.finishRun(10.0f).ok);  // 25 mL counted: 150 % over
+    TEST_ASSERT_FALSE(cal.running());
+    TEST_ASSERT_EQUAL_UINT8(0, cal.runCount());
+    TEST_ASSERT_EQUAL_FLOAT(0.25f, cal.mlPerPulse(INTERVAL_4HZ_US));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_default_is_flat_and_valid);
+    RUN_TEST(test_rate_selects_breakpoints);
+    RUN_TEST(test_low_flow_run_only_moves_low_breakpoints);
+    RUN_TEST(test_typo_reference_is_rejected);
+    return UNITY_END();
+}
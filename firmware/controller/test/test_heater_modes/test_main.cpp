@@ -0,0 +1,86 @@
+#include <unity.h>
+
+#include "heater_modes.h"
+
+using namespace gag;
+
+namespace {
+
+// HEATER_MODES_CFG from gagguino.cpp.
+const HeaterModes::Config CFG = {2.0f, 1.0f, 60.0f};
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_starts_in_brew_without_pending_transition() {
+    HeaterModes m(CFG);
+    TEST_ASSERT_EQUAL_UINT8(HEATER_MODE_BREW, m.mode());
+    TEST_ASSERT_FALSE(m.enter(HEATER_MODE_BREW, 0, 20.0f));
+    TEST_ASSERT_EQUAL(HeaterModes::EVENT_NONE, m.update(1000, 1.0f, 93.0f, 93.0f, 20.0f, true));
+}
+
+void test_steam_ready_time() {
+    HeaterModes m(CFG);
+    TEST_ASSERT_TRUE(m.enter(HEATER_MODE_STEAM, 10000, 93.0f));
+    TEST_ASSERT_EQUAL(HeaterModes::EVENT_NONE, m.update(40000, 1.0f, 150.0f, 147.5f, 100.0f, true));
+    TEST_ASSERT_EQUAL(HeaterModes::EVENT_STEAM_READY,
+                      m.update(45000, 1.0f, 150.0f, 148.0f, 100.0f, true));
+    TEST_ASSERT_EQUAL_UINT32(35000, m.steamReadyMs());
+    TEST_ASSERT_EQUAL_FLOAT(93.0f, m.steamStartC());
+    // Reported once per entry.
+    TEST_ASSERT_EQUAL(HeaterModes::EVENT_NONE, m.update(46000, 1.0f, 150.0f, 150.0f, 30.0f, true));
+}
+
+void test_brew_recovery_time() {
+    HeaterModes m(CFG);
+    m.enter(HEATER_MODE_STEAM, 0, 93.0f);
+    m.enter(HEATER_MODE_BREW, 60000, 151.0f);
+    TEST_ASSERT_EQUAL(HeaterModes::EVENT_NONE, m.update(120000, 1.0f, 93.0f, 110.0f, 0.0f, true));
+    TEST_ASSERT_EQUAL(HeaterModes::EVENT_BREW_RECOVERED,
+                      m.update(300000, 1.0f, 93.0f, 94.5f, 0.0f, true));
+    TEST_ASSERT_EQUAL_UINT32(240000, m.brewRecoveryMs());
+    TEST_ASSERT_EQUAL_FLOAT(151.0f, m.brewStartC());
+    // The unfinished steam-ready run was dropped.
+    TEST_ASSERT_EQUAL_UINT32(0, m.steamReadyMs());
+}
+
+void test_heater_off_drops_pending_transition() {
+    HeaterModes m(CFG);
+    m.enter(HEATER_MODE_STEAM, 0, 93.0f);
+    m.cancel();
+    TEST_ASSERT_EQUAL(HeaterModes::EVENT_NONE, m.update(50000, 1.0f, 150.0f, 150.0f, 20.0f, true));
+}
+
+void test_holding_duty_learned_per_mode() {
+    HeaterModes m(CFG);
+    for (int i = 0; i < 600; ++i) m.update(i * 1000, 1.0f, 93.0f, 93.3f, 12.0f, true);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 12.0f, m.holdingPct(HEATER_MODE_BREW));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, m.holdingPct(HEATER_MODE_STEAM));
+
+    m.enter(HEATER_MODE_STEAM, 600000, 93.0f);
+    for (int i = 0; i < 600; ++i) m.update(600000 + i * 1000, 1.0f, 150.0f, 149.5f, 30.0f, true);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 30.0f, m.holdingPct(HEATER_MODE_STEAM));
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 12.0f, m.holdingPct(HEATER_MODE_BREW));
+}
+
+void test_holding_duty_ignores_unsettled_and_saturated_passes() {
+    HeaterModes m(CFG);
+    m.update(1000, 1.0f, 93.0f, 80.0f, 60.0f, true);   // far from the setpoint
+    m.update(2000, 1.0f, 93.0f, 93.0f, 100.0f, true);  // saturated
+    m.update(3000, 1.0f, 93.0f, 93.0f, 40.0f, false);  // eco hold
+    m.update(4000, 0.0f, 93.0f, 93.0f, 40.0f, true);   // no time passed
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, m.holdingPct(HEATER_MODE_BREW));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_starts_in_brew_without_pending_transition);
+    RUN_TEST(test_steam_ready_time);
+    RUN_TEST(test_brew_recovery_time);
+    RUN_TEST(test_heater_off_drops_pending_transition);
+    RUN_TEST(test_holding_duty_learned_per_mode);
+    RUN_TEST(test_holding_duty_ignores_unsettled_and_saturated_passes);
+    return UNITY_END();
+}
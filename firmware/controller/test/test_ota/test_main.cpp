@@ -0,0 +1,249 @@
+#include <string.h>
+#include <unity.h>
+
+#include <deque>
+#include <vector>
+
+#include "espnow_ota.h"
+
+namespace {
+
+const uint32_t IMAGE_SIZE = 6000;
+const uint16_t CHUNK = 200;
+const uint8_t WINDOW = 4;
+const uint32_t STEP_MS = 10;
+
+typedef std::vector<uint8_t> Frame;
+
+// Display and controller joined by in-memory queues. The receiver's "flash"
+// and committed offset survive a receiver restart, like the OTA partition.
+struct Loopback {
+    uint8_t image[IMAGE_SIZE];
+    uint8_t flash[IMAGE_SIZE];
+    uint32_t flashCrc;
+    uint32_t committed;
+    uint32_t lowestWrite;  // since the last begin
+    int aborts;
+    uint32_t readFailAt;   // IMAGE_SIZE = never
+    int chunkFrames;       // chunk frames put on the air
+    int dropChunk;         // index of a chunk frame to lose, -1 = none
+    int corruptChunk;      // index of a chunk frame to damage, -1 = none
+    uint32_t restartAt;    // restart the receiver once this much is committed, 0 = never
+    bool restarted;
+    uint32_t committedAtRestart;
+    std::deque<Frame> toRx, toTx;
+    EspNowOtaSenderIo txIo;
+    EspNowOtaReceiverIo rxIo;
+    EspNowOtaSender tx;
+    EspNowOtaReceiver rx;
+    uint32_t nowMs;
+};
+
+Loopback g_lb;
+
+bool imageRead(void* ctx, uint32_t offset, uint8_t* buf, size_t len) {
+    Loopback* lb = static_cast<Loopback*>(ctx);
+    if (offset + len > lb->readFailAt) return false;
+    memcpy(buf, lb->image + offset, len);
+    return true;
+}
+
+bool senderSend(void* ctx, const uint8_t* frame, size_t len) {
+    Loopback* lb = static_cast<Loopback*>(ctx);
+    Frame f(frame, frame + len);
+    if (frame[0] == ESPNOW_OTA_CHUNK) {
+        int index = lb->chunkFrames++;
+        if (index == lb->dropChunk) return true;
+        if (index == lb->corruptChunk) f[sizeof(EspNowOtaChunkHeader)] ^= 0xFF;
+    }
+    lb->toRx.push_back(f);
+    return true;
+}
+
+EspNowOtaStatus rxBegin(void* ctx, uint32_t imageSize, uint32_t imageCrc, uint32_t* resume) {
+    Loopback* lb = static_cast<Loopback*>(ctx);
+    if (imageSize > IMAGE_SIZE) return ESPNOW_OTA_STATUS_TOO_LARGE;
+    if (lb->flashCrc != imageCrc) {
+        lb->flashCrc = imageCrc;
+        lb->committed = 0;
+    }
+    *resume = lb->committed;
+    lb->lowestWrite = IMAGE_SIZE;
+    return ESPNOW_OTA_STATUS_OK;
+}
+
+EspNowOtaStatus rxWrite(void* ctx, uint32_t offset, const uint8_t* data, size_t len) {
+    Loopback* lb = static_cast<Loopback*>(ctx);
+    memcpy(lb->flash + offset, data, len);
+    lb->committed = offset + static_cast<uint32_t>(len);
+    if (offset < lb->lowestWrite) lb->lowestWrite = offset;
+    return ESPNOW_OTA_STATUS_OK;
+}
+
+EspNowOtaStatus rxFinish(void* ctx, uint32_t imageSize, uint32_t imageCrc) {
+    Loopback* lb = static_cast<Loopback*>(ctx);
+    return espnow_ota_crc32(0, lb->flash, imageSize) == imageCrc ? ESPNOW_OTA_STATUS_OK
+                                                                  : ESPNOW_OTA_STATUS_VERIFY_FAILED;
+}
+
+void rxAbort(void* ctx) { static_cast<Loopback*>(ctx)->aborts++; }
+
+bool receiverSend(void* ctx, const uint8_t* frame, size_t len) {
+    static_cast<Loopback*>(ctx)->toTx.push_back(Frame(frame, frame + len));
+    return true;
+}
+
+void start(Loopback& lb) {
+    uint32_t crc = espnow_ota_crc32(0, lb.image, IMAGE_SIZE);
+    espnow_ota_sender_start(&lb.tx, &lb.txIo, IMAGE_SIZE, crc, CHUNK, WINDOW, lb.nowMs);
+}
+
+// One task pass on each side: the sender polls, then every frame in flight is delivered.
+void step(Loopback& lb) {
+    espnow_ota_sender_poll(&lb.tx, lb.nowMs);
+    if (lb.restartAt && !lb.restarted && lb.committed >= lb.restartAt) {
+        // The controller reboots: its session and the frames on the air are gone.
+        lb.restarted = true;
+        lb.committedAtRestart = lb.committed;
+        espnow_ota_receiver_init(&lb.rx, &lb.rxIo);
+        lb.toRx.clear();
+    }
+    while (!lb.toRx.empty()) {
+        Frame f = lb.toRx.front();
+        lb.toRx.pop_front();
+        espnow_ota_receiver_handle(&lb.rx, f.data(), f.size());
+    }
+    while (!lb.toTx.empty()) {
+        Frame f = lb.toTx.front();
+        lb.toTx.pop_front();
+        espnow_ota_sender_handle(&lb.tx, f.data(), f.size(), lb.nowMs);
+    }
+    lb.nowMs += STEP_MS;
+}
+
+void run(Loopback& lb) {
+    for (int i = 0; i < 10000 && espnow_ota_sender_active(&lb.tx); ++i) step(lb);
+}
+
+bool imageMatches(const Loopback& lb) { return memcmp(lb.image, lb.flash, IMAGE_SIZE) == 0; }
+
+}  // namespace
+
+void setUp() {
+    Loopback& lb = g_lb;
+    for (uint32_t i = 0; i < IMAGE_SIZE; ++i) lb.image[i] = static_cast<uint8_t>(i * 7 + (i >> 8));
+    memset(lb.flash, 0, sizeof(lb.flash));
+    lb.flashCrc = 0;
+    lb.committed = 0;
+    lb.lowestWrite = IMAGE_SIZE;
+    lb.aborts = 0;
+    lb.readFailAt = IMAGE_SIZE;
+    lb.chunkFrames = 0;
+    lb.dropChunk = -1;
+    lb.corruptChunk = -1;
+    lb.restartAt = 0;
+    lb.restarted = false;
+    lb.committedAtRestart = 0;
+    lb.toRx.clear();
+    lb.toTx.clear();
+    lb.txIo.read = imageRead;
+    lb.txIo.send = senderSend;
+    lb.txIo.ctx = &lb;
+    lb.rxIo.begin = rxBegin;
+    lb.rxIo.write = rxWrite;
+    lb.rxIo.finish = rxFinish;
+    lb.rxIo.abort = rxAbort;
+    lb.rxIo.send = receiverSend;
+    lb.rxIo.ctx = &lb;
+    espnow_ota_receiver_init(&lb.rx, &lb.rxIo);
+    lb.nowMs = 1000;
+}
+void tearDown() {}
+
+void test_clean_transfer_and_throughput() {
+    Loopback& lb = g_lb;
+    start(lb);
+    run(lb);
+    TEST_ASSERT_EQUAL(ESPNOW_OTA_SENDER_DONE, lb.tx.state);
+    TEST_ASSERT_TRUE(imageMatches(lb));
+    TEST_ASSERT_EQUAL_UINT32(IMAGE_SIZE / CHUNK, lb.tx.chunksSent);
+    TEST_ASSERT_EQUAL_UINT32(0, lb.tx.chunksResent);
+    // Begin, eight windows of four chunks, end: 6000 bytes in 90 ms.
+    TEST_ASSERT_EQUAL_UINT32(90, lb.tx.finishMs - lb.tx.startMs);
+    TEST_ASSERT_EQUAL_UINT32(66666, espnow_ota_sender_throughput(&lb.tx, lb.nowMs));
+}
+
+void test_lost_and_corrupt_chunks_rewind_to_ack() {
+    Loopback& lb = g_lb;
+    lb.dropChunk = 5;      // chunk 5, second window
+    lb.corruptChunk = 10;  // chunk 7 on the resend of the second window
+    start(lb);
+    run(lb);
+    TEST_ASSERT_EQUAL(ESPNOW_OTA_SENDER_DONE, lb.tx.state);
+    TEST_ASSERT_TRUE(imageMatches(lb));
+    // 6 and 7 behind the gap, then 8 behind the bad CRC and 7 itself.
+    TEST_ASSERT_EQUAL_UINT32(5, lb.tx.chunksResent);
+    TEST_ASSERT_EQUAL_UINT32(IMAGE_SIZE / CHUNK + 5, lb.tx.chunksSent);
+    TEST_ASSERT_EQUAL_UINT32(4, lb.rx.chunksRejected);
+    // Two extra windows: 6000 bytes in 100 ms.
+    TEST_ASSERT_EQUAL_UINT32(60000, espnow_ota_sender_throughput(&lb.tx, lb.nowMs));
+}
+
+void test_receiver_restart_resumes_from_committed_offset() {
+    Loopback& lb = g_lb;
+    lb.restartAt = 2000;
+    start(lb);
+    run(lb);
+    TEST_ASSERT_TRUE(lb.restarted);
+    TEST_ASSERT_EQUAL(ESPNOW_OTA_SENDER_DONE, lb.tx.state);
+    TEST_ASSERT_TRUE(imageMatches(lb));
+    TEST_ASSERT_EQUAL_UINT32(2400, lb.committedAtRestart);
+    TEST_ASSERT_EQUAL_UINT32(lb.committedAtRestart, lb.tx.resumeOffset);
+    // Nothing below the resume point was written again.
+    TEST_ASSERT_EQUAL_UINT32(lb.committedAtRestart, lb.lowestWrite);
+    // The window lost with the reboot is rewound once, on the timeout.
+    TEST_ASSERT_EQUAL_UINT32(WINDOW, lb.tx.chunksResent);
+    // Goodput counts only the bytes sent after the resume.
+    uint32_t elapsed = lb.tx.finishMs - lb.tx.startMs;
+    TEST_ASSERT_TRUE(elapsed > ESPNOW_OTA_TIMEOUT_MS);
+    TEST_ASSERT_EQUAL_UINT32((IMAGE_SIZE - 2400) * 1000 / elapsed,
+                             espnow_ota_sender_throughput(&lb.tx, lb.nowMs));
+}
+
+void test_read_error_is_reported_as_such() {
+    Loopback& lb = g_lb;
+    lb.readFailAt = 1000;
+    start(lb);
+    run(lb);
+    TEST_ASSERT_EQUAL(ESPNOW_OTA_SENDER_FAILED, lb.tx.state);
+    TEST_ASSERT_EQUAL_INT(ESPNOW_OTA_STATUS_READ_ERROR, lb.tx.status);
+    // The controller was told to drop its session.
+    TEST_ASSERT_EQUAL_INT(1, lb.aborts);
+    TEST_ASSERT_FALSE(lb.rx.active);
+    // The chunk before the failed read still went out.
+    TEST_ASSERT_EQUAL_UINT32(1000, lb.committed);
+}
+
+void test_silent_receiver_times_out() {
+    Loopback& lb = g_lb;
+    start(lb);
+    // Deliver nothing: every frame is lost.
+    for (int i = 0; i < 2000 && espnow_ota_sender_active(&lb.tx); ++i) {
+        espnow_ota_sender_poll(&lb.tx, lb.nowMs);
+        lb.toRx.clear();
+        lb.nowMs += STEP_MS;
+    }
+    TEST_ASSERT_EQUAL(ESPNOW_OTA_SENDER_FAILED, lb.tx.state);
+    TEST_ASSERT_EQUAL_INT(ESPNOW_OTA_STATUS_TIMEOUT, lb.tx.status);
+    TEST_ASSERT_EQUAL_UINT32(0, espnow_ota_sender_throughput(&lb.tx, lb.nowMs));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_clean_transfer_and_throughput);
+    RUN_TEST(test_lost_and_corrupt_chunks_rewind_to_ack);
+    RUN_TEST(test_receiver_restart_resumes_from_committed_offset);
+    RUN_TEST(test_read_error_is_reported_as_such);
+    RUN_TEST(test_silent_receiver_times_out);
+    return UNITY_END();
+}
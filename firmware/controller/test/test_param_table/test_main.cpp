@@ -0,0 +1,80 @@
+#include <math.h>
+#include <unity.h>
+
+#include "param_table.h"
+
+using namespace gag;
+
+namespace {
+
+float g_values[PARAM_COUNT];
+ParamBinding g_bindings[PARAM_COUNT];
+
+}  // namespace
+
+void setUp() {
+    for (int i = 0; i < PARAM_COUNT; ++i) {
+        g_values[i] = PARAM_DEFS[i].def;
+        g_bindings[i] = {PARAM_DEFS[i].id, &g_values[i]};
+    }
+}
+void tearDown() {}
+
+void test_complete_only_when_all_bound() {
+    TEST_ASSERT_FALSE(ParamTable(g_bindings, PARAM_COUNT - 1).complete());
+    TEST_ASSERT_TRUE(ParamTable(g_bindings, PARAM_COUNT).complete());
+}
+
+void test_set_clamps_and_rounds() {
+    ParamTable t(g_bindings, PARAM_COUNT);
+    float applied;
+    TEST_ASSERT_EQUAL_UINT8(ESPNOW_PARAM_STATUS_CLAMPED, t.set(PARAM_ID_PUMP_KP, 100.0f, &applied));
+    TEST_ASSERT_EQUAL_FLOAT(PARAM_DEFS[PARAM_INDEX_PUMP_KP].max, applied);
+    TEST_ASSERT_EQUAL_FLOAT(applied, g_values[PARAM_INDEX_PUMP_KP]);
+    TEST_ASSERT_EQUAL_UINT8(ESPNOW_PARAM_STATUS_OK,
+                            t.set(PARAM_ID_PUMP_START_CLAMP_MS, 1234.6f, &applied));
+    TEST_ASSERT_EQUAL_FLOAT(1235.0f, applied);
+}
+
+void test_set_rejects_unknown_and_nan() {
+    ParamTable t(g_bindings, PARAM_COUNT);
+    float applied;
+    TEST_ASSERT_EQUAL_UINT8(ESPNOW_PARAM_STATUS_UNKNOWN, t.set(999, 1.0f, &applied));
+    TEST_ASSERT_EQUAL_UINT8(ESPNOW_PARAM_STATUS_INVALID, t.set(PARAM_ID_PUMP_KI, NAN, &applied));
+    TEST_ASSERT_EQUAL_FLOAT(PARAM_DEFS[PARAM_INDEX_PUMP_KI].def, applied);
+}
+
+void test_changes_reported_once() {
+    ParamTable t(g_bindings, PARAM_COUNT);
+    EspNowParamValue out[PARAM_COUNT];
+    TEST_ASSERT_EQUAL_UINT32(0, t.takeChanges(out, PARAM_COUNT));
+
+    const uint16_t ids[] = {PARAM_ID_BREW_SETPOINT, PARAM_ID_PUCK_EASE};
+    t.subscribe(ids, 2);
+    TEST_ASSERT_EQUAL_UINT32(2, t.takeChanges(out, PARAM_COUNT));
+    TEST_ASSERT_EQUAL_UINT32(0, t.takeChanges(out, PARAM_COUNT));
+
+    // Unsubscribed parameters are not reported, whoever changed them.
+    g_values[PARAM_INDEX_BREW_SETPOINT] = 93.0f;
+    g_values[PARAM_INDEX_PUMP_KD] = 3.0f;
+    TEST_ASSERT_EQUAL_UINT32(1, t.takeChanges(out, PARAM_COUNT));
+    TEST_ASSERT_EQUAL_UINT16(PARAM_ID_BREW_SETPOINT, out[0].id);
+    TEST_ASSERT_EQUAL_FLOAT(93.0f, out[0].value);
+
+    // A set() answers for itself and is not reported again.
+    float applied;
+    t.set(PARAM_ID_PUCK_EASE, 2.0f, &applied);
+    TEST_ASSERT_EQUAL_UINT32(0, t.takeChanges(out, PARAM_COUNT));
+
+    t.subscribe(ids, 0);
+    TEST_ASSERT_EQUAL_UINT32(PARAM_COUNT, t.takeChanges(out, PARAM_COUNT));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_complete_only_when_all_bound);
+    RUN_TEST(test_set_clamps_and_rounds);
+    RUN_TEST(test_set_rejects_unknown_and_nan);
+    RUN_TEST(test_changes_reported_once);
+    return UNITY_END();
+}
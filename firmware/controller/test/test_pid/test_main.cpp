@@ -0,0 +1,201 @@
+#include <unity.h>
+
+#include "fixed_point.h"
+#include "pid.h"
+
+using namespace gag;
+
+namespace {
+
+// Same switches as the loops in gagguino.cpp.
+struct HeaterConfig {
+    static constexpr float OUT_MIN = 0.0f, OUT_MAX = 100.0f;
+    static constexpr bool DERIVATIVE_FILTER = true, CONDITIONAL_INTEGRATION = true,
+                          SETPOINT_WEIGHTING = false, BUMPLESS = true, RESET_I_AT_SETPOINT = true,
+                          P_BELOW_SETPOINT_ONLY = true;
+};
+struct PumpConfig {
+    static constexpr float OUT_MIN = 0.0f, OUT_MAX = 100.0f;
+    static constexpr bool DERIVATIVE_FILTER = true, CONDITIONAL_INTEGRATION = true,
+                          SETPOINT_WEIGHTING = false, BUMPLESS = false, RESET_I_AT_SETPOINT = true,
+                          P_BELOW_SETPOINT_ONLY = false;
+};
+using HeaterPid = Pid<float, HeaterConfig>;
+using PumpPid = Pid<float, PumpConfig>;
+using HeaterPidQ = Pid<Q16_16, HeaterConfig>;
+
+const HeaterPid::Gains HEATER_GAINS = {8.0f, 0.4f, 17.0f, 25.0f, 0.8f, 1.0f};
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_reset_has_no_derivative_kick() {
+    HeaterPid pid(HEATER_GAINS);
+    TEST_ASSERT_FALSE(pid.primed());
+    pid.reset(60.0f);
+    TEST_ASSERT_TRUE(pid.primed());
+    pid.step(61.0f, 60.0f, 0.25f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, pid.terms().d);
+    TEST_ASSERT_EQUAL_FLOAT(8.0f, pid.terms().p);
+}
+
+void test_output_is_clamped() {
+    HeaterPid pid(HEATER_GAINS);
+    pid.reset(20.0f);
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, pid.step(93.0f, 20.0f, 0.25f));
+    PumpPid pump({10.0f, 0.0f, 0.0f, 10.0f, 0.1f, 1.0f});
+    pump.reset(9.0f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, pump.step(1.0f, 9.0f, 0.1f));
+}
+
+void test_saturation_stops_integration() {
+    HeaterPid pid(HEATER_GAINS);
+    pid.reset(20.0f);
+    for (int i = 0; i < 100; ++i) pid.step(93.0f, 20.0f, 0.25f);
+    // P alone saturates the output, so the integral never grew.
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, pid.integral());
+}
+
+void test_integral_guard_limits_i_term() {
+    HeaterPid pid({0.0f, 1.0f, 0.0f, 5.0f, 0.8f, 1.0f});
+    pid.reset(90.0f);
+    for (int i = 0; i < 100; ++i) pid.step(93.0f, 90.0f, 0.25f);
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, pid.terms().i);
+}
+
+void test_integral_restarts_at_setpoint() {
+    HeaterPid pid({0.0f, 1.0f, 0.0f, 50.0f, 0.8f, 1.0f});
+    pid.reset(90.0f);
+    pid.step(93.0f, 90.0f, 1.0f);
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, pid.integral());
+    pid.step(93.0f, 93.5f, 1.0f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, pid.integral());
+}
+
+void test_p_below_setpoint_only() {
+    HeaterPid heater({2.0f, 0.0f, 0.0f, 10.0f, 0.8f, 1.0f});
+    heater.reset(95.0f);
+    heater.step(93.0f, 95.0f, 0.25f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, heater.terms().p);
+
+    PumpPid pump({2.0f, 0.0f, 0.0f, 10.0f, 0.1f, 1.0f});
+    pump.reset(10.0f);
+    pump.step(9.0f, 10.0f, 0.1f);
+    TEST_ASSERT_EQUAL_FLOAT(-2.0f, pump.terms().p);
+}
+
+void test_bumpless_gain_change_keeps_i_term() {
+    HeaterPid pid({0.0f, 0.5f, 0.0f, 50.0f, 0.8f, 1.0f});
+    pid.reset(90.0f);
+    pid.step(93.0f, 90.0f, 1.0f);
+    float before = pid.terms().i;
+    HeaterPid::Gains g = pid.gains();
+    g.ki = 2.0f;
+    pid.setGains(g);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, before, g.ki * pid.integral());
+}
+
+void test_release_forgets_state() {
+    HeaterPid pid({0.0f, 1.0f, 0.0f, 50.0f, 0.8f, 1.0f});
+    pid.reset(90.0f);
+    pid.step(93.0f, 90.0f, 1.0f);
+    pid.release();
+    TEST_ASSERT_FALSE(pid.primed());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, pid.integral());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, pid.terms().out);
+}
+
+void test_preload_sets_i_term_without_kick() {
+    HeaterPid pid({10.0f, 0.2f, 30.0f, 40.0f, 0.8f, 1.0f});
+    pid.reset(93.0f);
+    pid.step(93.5f, 93.0f, 0.25f);
+    // Switch to a steam regime measured on another sensor.
+    pid.preload(120.0f, 25.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 25.0f, 0.2f * pid.integral());
+    pid.step(121.0f, 120.0f, 0.25f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, pid.terms().d);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 25.0f, pid.terms().i);
+    // The guard still bounds a preload.
+    pid.preload(120.0f, 80.0f);
+    pid.step(121.0f, 120.0f, 0.25f);
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, pid.terms().i);
+}
+
+void test_preload_from_above_setpoint_waits_for_positive_error() {
+    HeaterPid pid({10.0f, 0.2f, 30.0f, 40.0f, 0.8f, 1.0f});
+    // Steam back to brew: the boiler is far above the brew setpoint.
+    pid.preload(150.0f, 12.0f);
+    pid.step(92.0f, 149.5f, 0.25f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, pid.terms().i);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 12.0f, 0.2f * pid.integral());
+    for (float pv = 149.0f; pv > 92.0f; pv -= 0.5f) pid.step(92.0f, pv, 0.25f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 12.0f, 0.2f * pid.integral());
+    // Once below the setpoint the held duty applies at once.
+    pid.step(92.0f, 91.5f, 0.25f);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 12.0f, pid.terms().i);
+    // Past that, a return above the setpoint resets the integral as before.
+    pid.step(92.0f, 92.5f, 0.25f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, pid.integral());
+}
+
+void test_derivative_filter_settles() {
+    HeaterPid pid({0.0f, 0.0f, 10.0f, 0.0f, 1.0f, 1.0f});
+    pid.reset(90.0f);
+    // A step in the measurement is spread over the filter time constant.
+    pid.step(95.0f, 91.0f, 0.25f);
+    float first = pid.terms().d;
+    TEST_ASSERT_TRUE(first < 0.0f);
+    TEST_ASSERT_TRUE(first > -40.0f);
+    for (int i = 0; i < 100; ++i) pid.step(95.0f, 91.0f, 0.25f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, pid.terms().d);
+}
+
+void test_non_positive_dt_keeps_output() {
+    HeaterPid pid(HEATER_GAINS);
+    pid.reset(90.0f);
+    float out = pid.step(93.0f, 90.0f, 0.25f);
+    float integral = pid.integral();
+    TEST_ASSERT_EQUAL_FLOAT(out, pid.step(93.0f, 80.0f, 0.0f));
+    TEST_ASSERT_EQUAL_FLOAT(out, pid.step(93.0f, 80.0f, -0.25f));
+    TEST_ASSERT_EQUAL_FLOAT(integral, pid.integral());
+    TEST_ASSERT_EQUAL_FLOAT(out, pid.terms().out);
+    // The next real step carries on as if the bad ones never happened.
+    HeaterPid ref(HEATER_GAINS);
+    ref.reset(90.0f);
+    ref.step(93.0f, 90.0f, 0.25f);
+    TEST_ASSERT_EQUAL_FLOAT(ref.step(93.0f, 91.0f, 0.25f), pid.step(93.0f, 91.0f, 0.25f));
+}
+
+void test_non_positive_dt_keeps_output_fixed() {
+    HeaterPidQ pid({Q16_16(8.0f), Q16_16(0.4f), Q16_16(17.0f), Q16_16(25.0f), Q16_16(0.8f),
+                    Q16_16(1.0f)});
+    pid.reset(Q16_16(90.0f));
+    Q16_16 out = pid.step(Q16_16(93.0f), Q16_16(90.0f), Q16_16(0.25f));
+    Q16_16 integral = pid.integral();
+    // Without the guard a zero dt would divide by zero and saturate D.
+    TEST_ASSERT_EQUAL_INT32(out.raw(), pid.step(Q16_16(93.0f), Q16_16(80.0f), Q16_16()).raw());
+    TEST_ASSERT_EQUAL_INT32(out.raw(),
+                            pid.step(Q16_16(93.0f), Q16_16(80.0f), Q16_16(-0.25f)).raw());
+    TEST_ASSERT_EQUAL_INT32(integral.raw(), pid.integral().raw());
+    TEST_ASSERT_EQUAL_INT32(out.raw(), pid.terms().out.raw());
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_reset_has_no_derivative_kick);
+    RUN_TEST(test_output_is_clamped);
+    RUN_TEST(test_saturation_stops_integration);
+    RUN_TEST(test_integral_guard_limits_i_term);
+    RUN_TEST(test_integral_restarts_at_setpoint);
+    RUN_TEST(test_p_below_setpoint_only);
+    RUN_TEST(test_bumpless_gain_change_keeps_i_term);
+    RUN_TEST(test_release_forgets_state);
+    RUN_TEST(test_preload_sets_i_term_without_kick);
+    RUN_TEST(test_preload_from_above_setpoint_waits_for_positive_error);
+    RUN_TEST(test_derivative_filter_settles);
+    RUN_TEST(test_non_positive_dt_keeps_output);
+    RUN_TEST(test_non_positive_dt_keeps_output_fixed);
+    return UNITY_END();
+}
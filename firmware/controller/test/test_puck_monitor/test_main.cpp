@@ -0,0 +1,108 @@
+#include <unity.h>
+
+#include "puck_monitor.h"
+
+using namespace gag;
+
+namespace {
+
+// PUCK_CFG from gagguino.cpp.
+const PuckMonitor::Config CFG = {4.0f, 0.3f, 3.0f, 0.5f, 8.0f, 25.0f, 20.0f, 2.0f};
+
+const uint32_t STEP_MS = 20;  // one pressure sample per mains cycle
+
+// A shot fed to the monitor at the pressure sample rate.
+struct Shot {
+    PuckMonitor puck{CFG};
+    uint32_t nowMs = 1000;
+    float volumeMl = 0.0f;
+    uint32_t firstEventMs = 0;
+
+    Shot() { puck.reset(nowMs, volumeMl); }
+
+    void run(uint32_t durationMs, float bar, float flowStart, float flowEnd) {
+        uint32_t steps = durationMs / STEP_MS;
+        for (uint32_t i = 0; i < steps; ++i) {
+            float flow = flowStart + (flowEnd - flowStart) * i / steps;
+            nowMs += STEP_MS;
+            volumeMl += flow * STEP_MS / 1000.0f;
+            if (puck.update(nowMs, bar, volumeMl) && !firstEventMs) firstEventMs = nowMs;
+        }
+    }
+    void run(uint32_t durationMs, float bar, float flow) { run(durationMs, bar, flow, flow); }
+};
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_steady_shot_tracks_resistance() {
+    Shot s;
+    s.run(8000, 9.0f, 2.0f);
+    TEST_ASSERT_TRUE(s.puck.valid());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 4.5f, s.puck.resistance());
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 4.5f, s.puck.baseline());
+    TEST_ASSERT_EQUAL_UINT16(0, s.puck.events());
+}
+
+void test_no_detection_before_arm_delay() {
+    Shot s;
+    s.run(1000, 9.0f, 2.0f);
+    // The puck gives way one second in, long before the arm delay is up.
+    s.run(1800, 6.0f, 4.0f);
+    TEST_ASSERT_TRUE(s.puck.resistance() < 0.6f * s.puck.baseline());
+    TEST_ASSERT_EQUAL_UINT16(0, s.puck.events());
+    // Below the arm pressure nothing is tracked at all.
+    Shot low;
+    low.run(6000, 3.0f, 2.0f);
+    TEST_ASSERT_FALSE(low.puck.valid());
+}
+
+void test_step_drop_trips() {
+    Shot s;
+    s.run(6000, 9.0f, 2.0f);
+    uint32_t channelMs = s.nowMs;
+    s.run(1000, 7.0f, 4.0f);
+    TEST_ASSERT_EQUAL_UINT16(1, s.puck.events());
+    // Caught within a fifth of a second of the channel opening.
+    TEST_ASSERT_TRUE(s.firstEventMs - channelMs <= 200);
+    TEST_ASSERT_TRUE(s.puck.channeling(s.nowMs));
+}
+
+void test_slow_decline_does_not_trip() {
+    Shot s;
+    s.run(6000, 9.0f, 2.0f);
+    // The puck erodes: flow rises 60 % over ten seconds at the same pressure.
+    s.run(10000, 9.0f, 2.0f, 3.2f);
+    TEST_ASSERT_EQUAL_UINT16(0, s.puck.events());
+    TEST_ASSERT_TRUE(s.puck.resistance() < 3.0f);
+}
+
+void test_hold_expiry_rebases_on_new_resistance() {
+    Shot s;
+    s.run(6000, 9.0f, 2.0f);
+    s.run(500, 7.0f, 4.0f);
+    TEST_ASSERT_EQUAL_UINT16(1, s.puck.events());
+    uint32_t untilMs = s.firstEventMs + static_cast<uint32_t>(CFG.holdS * 1000.0f);
+    s.run(untilMs - s.nowMs - STEP_MS, 7.0f, 4.0f);
+    TEST_ASSERT_TRUE(s.puck.channeling(s.nowMs));
+    // The first sample after the hold takes what the puck settled to as the new normal.
+    s.run(STEP_MS, 7.0f, 4.0f);
+    TEST_ASSERT_FALSE(s.puck.channeling(s.nowMs));
+    TEST_ASSERT_EQUAL_FLOAT(s.puck.resistance(), s.puck.baseline());
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 1.75f, s.puck.baseline());
+    // Flowing steadily at the new resistance does not raise another event.
+    s.run(5000, 7.0f, 4.0f);
+    TEST_ASSERT_EQUAL_UINT16(1, s.puck.events());
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_steady_shot_tracks_resistance);
+    RUN_TEST(test_no_detection_before_arm_delay);
+    RUN_TEST(test_step_drop_trips);
+    RUN_TEST(test_slow_decline_does_not_trip);
+    RUN_TEST(test_hold_expiry_rebases_on_new_resistance);
+    return UNITY_END();
+}
@@ -0,0 +1,106 @@
+#include <math.h>
+#include <unity.h>
+
+#include "pump_ramp.h"
+
+using namespace gag;
+
+namespace {
+
+// 50 %/s, 40 % for the first 1.5 s, at most 0.2 s credited, 0.1 s first step.
+const PumpRamp::Config CFG = {50.0f, 40.0f, 1500, 0.2f, 0.1f};
+
+// One pressure-mode update as applyPumpPower() runs it.
+float update(PumpRamp& r, uint32_t nowMs, float requested, float target) {
+    float dt = r.begin(nowMs, requested);
+    float v = r.limit(nowMs, target, dt);
+    r.commit(nowMs, requested, v);
+    return v;
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_first_update_uses_first_dt() {
+    PumpRamp r(CFG);
+    TEST_ASSERT_EQUAL_FLOAT(0.1f, r.begin(1000, 100.0f));
+}
+
+void test_dt_is_clamped() {
+    PumpRamp r(CFG);
+    update(r, 1000, 100.0f, 0.0f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, r.begin(1000, 100.0f));
+    TEST_ASSERT_EQUAL_FLOAT(0.05f, r.begin(1050, 100.0f));
+    TEST_ASSERT_EQUAL_FLOAT(0.2f, r.begin(61000, 100.0f));
+}
+
+void test_rise_is_rate_limited() {
+    PumpRamp r(CFG);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 5.0f, update(r, 1000, 100.0f, 100.0f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 10.0f, update(r, 1100, 100.0f, 100.0f));
+    // A stalled loop gains only maxDtS worth of ramp.
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 20.0f, update(r, 5000, 100.0f, 100.0f));
+    // Falling is not limited.
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 2.0f, update(r, 5100, 100.0f, 2.0f));
+}
+
+void test_start_clamp_holds_then_expires() {
+    PumpRamp r(CFG);
+    float v = 0.0f;
+    uint32_t t = 1000;
+    for (; t < 2400; t += 100) v = update(r, t, 100.0f, 100.0f);
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, v);
+    TEST_ASSERT_TRUE(r.clampArmed());
+    for (; t < 3000; t += 100) v = update(r, t, 100.0f, 100.0f);
+    TEST_ASSERT_FALSE(r.clampArmed());
+    TEST_ASSERT_TRUE(v > 40.0f);
+}
+
+void test_start_clamp_rearms_after_pump_off() {
+    PumpRamp r(CFG);
+    for (uint32_t t = 1000; t < 4000; t += 100) update(r, t, 100.0f, 100.0f);
+    TEST_ASSERT_FALSE(r.clampArmed());
+    update(r, 4000, 0.0f, 0.0f);
+    update(r, 4100, 100.0f, 100.0f);
+    TEST_ASSERT_TRUE(r.clampArmed());
+}
+
+void test_start_clamp_survives_millis_wraparound() {
+    PumpRamp r(CFG);
+    uint32_t t = 0xFFFFFFFFu - 500;
+    float v = 0.0f;
+    for (int i = 0; i < 12; ++i, t += 100) v = update(r, t, 100.0f, 100.0f);
+    // 1.2 s after engaging, across the wrap: still clamped.
+    TEST_ASSERT_TRUE(r.clampArmed());
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, v);
+    TEST_ASSERT_EQUAL_FLOAT(0.1f, r.begin(t, 100.0f));
+}
+
+void test_nan_target_gives_zero() {
+    PumpRamp r(CFG);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, update(r, 1000, 100.0f, NAN));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, r.lastApplied());
+}
+
+void test_disarm_drops_start_clamp() {
+    PumpRamp r(CFG);
+    update(r, 1000, 100.0f, 100.0f);
+    TEST_ASSERT_TRUE(r.clampArmed());
+    r.disarm();
+    TEST_ASSERT_FALSE(r.clampArmed());
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_update_uses_first_dt);
+    RUN_TEST(test_dt_is_clamped);
+    RUN_TEST(test_rise_is_rate_limited);
+    RUN_TEST(test_start_clamp_holds_then_expires);
+    RUN_TEST(test_start_clamp_rearms_after_pump_off);
+    RUN_TEST(test_start_clamp_survives_millis_wraparound);
+    RUN_TEST(test_nan_target_gives_zero);
+    RUN_TEST(test_disarm_drops_start_clamp);
+    return UNITY_END();
+}
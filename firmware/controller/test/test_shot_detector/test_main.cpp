@@ -0,0 +1,75 @@
+#include <unity.h>
+
+#include "shot_detector.h"
+
+using namespace gag;
+
+namespace {
+
+// ZC_MIN, ZC_WAIT and SHOT_RESET from gagguino.cpp.
+const ShotDetector::Config CFG = {4, 2000, 60000};
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_needs_min_zero_crosses() {
+    ShotDetector d(CFG);
+    TEST_ASSERT_FALSE(d.shouldStart(3, 10000, 0));
+    TEST_ASSERT_TRUE(d.shouldStart(4, 10000, 0));
+}
+
+void test_boot_hold() {
+    ShotDetector d(CFG);
+    TEST_ASSERT_FALSE(d.shouldStart(50, 2000, 0));
+    TEST_ASSERT_TRUE(d.shouldStart(50, 2001, 0));
+}
+
+void test_restart_needs_new_zero_crosses() {
+    ShotDetector d(CFG);
+    TEST_ASSERT_TRUE(d.shouldStart(500, 30000, 0));
+    d.stop(500);
+    // The counter never resets, so the old total must not start a new shot.
+    TEST_ASSERT_FALSE(d.shouldStart(500, 100000, 0));
+    TEST_ASSERT_FALSE(d.shouldStart(503, 100000, 0));
+    TEST_ASSERT_TRUE(d.shouldStart(504, 100000, 0));
+}
+
+void test_zero_cross_counter_wraparound() {
+    ShotDetector d(CFG);
+    d.stop(0xFFFFFFFEu);
+    TEST_ASSERT_FALSE(d.shouldStart(0u, 100000, 0));
+    TEST_ASSERT_TRUE(d.shouldStart(2u, 100000, 0));
+}
+
+void test_pump_idle() {
+    ShotDetector d(CFG);
+    TEST_ASSERT_FALSE(d.pumpIdle(70000, 10001));
+    TEST_ASSERT_TRUE(d.pumpIdle(70000, 10000));
+}
+
+void test_pump_idle_across_millis_wraparound() {
+    ShotDetector d(CFG);
+    uint32_t last = 0xFFFFFFFFu - 1000;
+    TEST_ASSERT_FALSE(d.pumpIdle(last + 30000, last));
+    TEST_ASSERT_TRUE(d.pumpIdle(last + 60000, last));
+    TEST_ASSERT_TRUE(d.shouldStart(10, 500, 0xFFFFFFFFu - 5000));
+}
+
+void test_zero_cross_after_now_is_recent() {
+    ShotDetector d(CFG);
+    TEST_ASSERT_FALSE(d.pumpIdle(100000, 100003));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_needs_min_zero_crosses);
+    RUN_TEST(test_boot_hold);
+    RUN_TEST(test_restart_needs_new_zero_crosses);
+    RUN_TEST(test_zero_cross_counter_wraparound);
+    RUN_TEST(test_pump_idle);
+    RUN_TEST(test_pump_idle_across_millis_wraparound);
+    RUN_TEST(test_zero_cross_after_now_is_recent);
+    return UNITY_END();
+}
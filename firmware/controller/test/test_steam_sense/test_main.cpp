@@ -0,0 +1,65 @@
+#include <unity.h>
+
+#include "steam_sense.h"
+
+using namespace gag;
+
+namespace {
+
+// AC_HOLD_MS, ZC_OFF and STEAM_DETECT_MS from gagguino.cpp, in microseconds.
+const SteamSense::Config CFG = {30000, 1000000, 200000};
+
+const int64_t T0 = 10000000;  // 10 s after boot
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_no_ac_no_steam() {
+    SteamSense s(CFG);
+    TEST_ASSERT_FALSE(s.update(T0, false, 0, 0, 0));
+    TEST_ASSERT_FALSE(s.ac());
+}
+
+void test_detects_after_detect_window() {
+    SteamSense s(CFG);
+    // Edges every 10 ms from T0, pump quiet since boot.
+    TEST_ASSERT_FALSE(s.update(T0 + 190000, false, T0 + 190000, T0, 0));
+    TEST_ASSERT_TRUE(s.ac());
+    TEST_ASSERT_TRUE(s.update(T0 + 200000, false, T0 + 200000, T0, 0));
+    TEST_ASSERT_EQUAL_UINT32(200, s.detectMs());
+}
+
+void test_pump_running_blocks_detection() {
+    SteamSense s(CFG);
+    int64_t lastZc = T0 + 500000;
+    TEST_ASSERT_FALSE(s.update(T0 + 900000, false, T0 + 900000, T0, lastZc));
+    // Eligible from lastZc + 1 s; needs 200 ms of AC after that.
+    TEST_ASSERT_FALSE(s.update(T0 + 1600000, false, T0 + 1600000, T0, lastZc));
+    TEST_ASSERT_TRUE(s.update(T0 + 1700000, false, T0 + 1700000, T0, lastZc));
+    TEST_ASSERT_EQUAL_UINT32(1700, s.detectMs());
+}
+
+void test_ac_held_low_counts_without_edges() {
+    SteamSense s(CFG);
+    TEST_ASSERT_TRUE(s.update(T0 + 300000, true, T0, T0, 0));
+}
+
+void test_ac_loss_clears_detection() {
+    SteamSense s(CFG);
+    TEST_ASSERT_TRUE(s.update(T0 + 300000, false, T0 + 300000, T0, 0));
+    // No edge for longer than the hold time.
+    TEST_ASSERT_FALSE(s.update(T0 + 340000, false, T0 + 300000, T0, 0));
+    TEST_ASSERT_FALSE(s.detected());
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_no_ac_no_steam);
+    RUN_TEST(test_detects_after_detect_window);
+    RUN_TEST(test_pump_running_blocks_detection);
+    RUN_TEST(test_ac_held_low_counts_without_edges);
+    RUN_TEST(test_ac_loss_clears_detection);
+    return UNITY_END();
+}
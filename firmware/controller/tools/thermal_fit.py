@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""Identify ThermalObserver parameters from recorded controller traces.
+
+Enable ``thermalTrace`` in src/gagguino.cpp, capture the serial log through a
+cold start, some idle time and a few shots, then run::
+
+    python3 tools/thermal_fit.py capture.log [more.log ...] [--ref probe.csv]
+
+Each ``TRACE,ms,sensorC,heatPct,flowMlS,boilerEstC,brewEstC`` line carries the
+heater duty and flow applied over the period ending at ``ms``. The model in
+thermal_observer.h is simulated open loop over every trace and its boiler node
+fitted to the sensor by Nelder-Mead in log-parameter space.
+
+The sensor only sees the boiler, so the group node is pinned down only through
+its coupling. For a trustworthy brew estimate add ``--ref`` with a CSV of
+``ms,tempC`` rows from a probe in the group or a Scace-style portafilter,
+timestamped on the controller's millis() clock (shift with ``--ref-offset-ms``).
+
+Prints a THERMAL_PARAMS initializer to paste into src/gagguino.cpp. Standard
+library only.
+"""
+
+import argparse
+import math
+import re
+import sys
+
+WATER_J_PER_G_K = 4.186
+MAX_STEP_S = 0.5
+SEGMENT_GAP_MS = 5000
+
+TRACE_RE = re.compile(r"TRACE,(\d+),([-\d.]+),([-\d.]+),([-\d.]+)")
+
+FITTED = ["boilerJK", "groupJK", "boilerGroupWK", "boilerAmbWK", "groupAmbWK"]
+INITIAL = {
+    "boilerJK": 900.0,
+    "groupJK": 350.0,
+    "boilerGroupWK": 2.0,
+    "boilerAmbWK": 0.25,
+    "groupAmbWK": 0.15,
+}
+
+
+def load_traces(paths):
+    """Return a list of segments, each a list of (ms, sensorC, heatPct, flowMlS)."""
+    segments = []
+    for path in paths:
+        cur = []
+        with open(path, errors="replace") as f:
+            for line in f:
+                m = TRACE_RE.search(line)
+                if not m:
+                    continue
+                row = (int(m.group(1)), float(m.group(2)), float(m.group(3)), float(m.group(4)))
+                # A reboot or a dropped stretch of log starts a new segment.
+                if cur and not (0 < row[0] - cur[-1][0] <= SEGMENT_GAP_MS):
+                    segments.append(cur)
+                    cur = []
+                cur.append(row)
+        if cur:
+            segments.append(cur)
+    return [s for s in segments if len(s) > 10]
+
+
+def load_ref(path, offset_ms):
+    rows = []
+    with open(path) as f:
+        for line in f:
+            parts = line.replace(";", ",").split(",")
+            try:
+                rows.append((float(parts[0]) + offset_ms, float(parts[1])))
+            except (ValueError, IndexError):
+                continue  # header or junk
+    rows.sort()
+    return rows
+
+
+def simulate(seg, p, fixed):
+    """Open-loop model over one segment; returns [(ms, boilerC, groupC)]."""
+    tb = tg = seg[0][1]
+    out = [(seg[0][0], tb, tg)]
+    for prev, row in zip(seg, seg[1:]):
+        dt = (row[0] - prev[0]) / 1000.0
+        heat = fixed["heaterW"] * row[2] * 0.01
+        adv = WATER_J_PER_G_K * max(row[3], 0.0)
+        remaining = dt
+        while remaining > 0.0:
+            h = min(remaining, MAX_STEP_S)
+            remaining -= h
+            bg = p["boilerGroupWK"] * (tb - tg)
+            dtb = heat - bg - p["boilerAmbWK"] * (tb - fixed["ambientC"]) \
+                - adv * (tb - fixed["inletC"])
+            dtg = bg - p["groupAmbWK"] * (tg - fixed["ambientC"]) + adv * (tb - tg)
+            tb += dtb / p["boilerJK"] * h
+            tg += dtg / p["groupJK"] * h
+        out.append((row[0], tb, tg))
+    return out
+
+
+def interp(rows, ms):
+    """Linear interpolation in a sorted [(ms, value)] list; None outside it."""
+    lo, hi = 0, len(rows) - 1
+    if not rows or ms < rows[0][0] or ms > rows[hi][0]:
+        return None
+    while hi - lo > 1:
+        mid = (lo + hi) // 2
+        if rows[mid][0] <= ms:
+            lo = mid
+        else:
+            hi = mid
+    (t0, v0), (t1, v1) = rows[lo], rows[hi]
+    return v0 if t1 == t0 else v0 + (v1 - v0) * (ms - t0) / (t1 - t0)
+
+
+def cost(x, segments, ref, ref_weight, fixed):
+    p = {k: math.exp(v) for k, v in zip(FITTED, x)}
+    err = 0.0
+    n = 0
+    for seg in segments:
+        sim = simulate(seg, p, fixed)
+        for (ms, tb, tg), row in zip(sim, seg):
+            if not (math.isfinite(tb) and math.isfinite(tg)):
+                return float("inf")
+            err += (tb - row[1]) ** 2
+            n += 1
+            if ref:
+                r = interp(ref, ms)
+                if r is not None:
+                    err += ref_weight * (tg - r) ** 2
+                    n += ref_weight
+    return err / max(n, 1)
+
+
+def nelder_mead(f, x0, step=0.3, iters=600, tol=1e-7):
+    dim = len(x0)
+    pts = [list(x0)]
+    for i in range(dim):
+        x = list(x0)
+        x[i] += step
+        pts.append(x)
+    vals = [f(x) for x in pts]
+    for _ in range(iters):
+        order = sorted(range(dim + 1), key=lambda i: vals[i])
+        pts = [pts[i] for i in order]
+        vals = [vals[i] for i in order]
+        if abs(vals[-1] - vals[0]) <= tol * (abs(vals[0]) + tol):
+            break
+        centroid = [sum(p[i] for p in pts[:-1]) / dim for i in range(dim)]
+
+        def along(t):
+            return [c + t * (w - c) for c, w in zip(centroid, pts[-1])]
+
+        xr = along(-1.0)
+        fr = f(xr)
+        if fr < vals[0]:
+            xe = along(-2.0)
+            fe = f(xe)
+            pts[-1], vals[-1] = (xe, fe) if fe < fr else (xr, fr)
+        elif fr < vals[-2]:
+            pts[-1], vals[-1] = xr, fr
+        else:
+            xc = along(0.5)
+            fc = f(xc)
+            if fc < vals[-1]:
+                pts[-1], vals[-1] = xc, fc
+            else:
+                for i in range(1, dim + 1):
+                    pts[i] = [b + 0.5 * (v - b) for b, v in zip(pts[0], pts[i])]
+                    vals[i] = f(pts[i])
+    best = min(range(dim + 1), key=lambda i: vals[i])
+    return pts[best], vals[best]
+
+
+def c_float(v):
+    text = f"{v:.4g}"
+    if not any(c in text for c in ".e"):
+        text += ".0"
+    return text + "f"
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    ap.add_argument("logs", nargs="+", help="serial captures containing TRACE lines")
+    ap.add_argument("--ref", help="CSV of ms,tempC from a group/portafilter probe")
+    ap.add_argument("--ref-offset-ms", type=float, default=0.0)
+    ap.add_argument("--ref-weight", type=float, default=4.0,
+                    help="weight of reference samples relative to the boiler sensor")
+    ap.add_argument("--heater-w", type=float, default=1370.0, help="element power at 100 %%")
+    ap.add_argument("--ambient-c", type=float, default=25.0)
+    ap.add_argument("--inlet-c", type=float, default=22.0)
+    ap.add_argument("--gain-boiler", type=float, default=0.2)
+    ap.add_argument("--gain-group", type=float, default=0.05)
+    args = ap.parse_args()
+
+    segments = load_traces(args.logs)
+    if not segments:
+        sys.exit("no TRACE lines found (enable thermalTrace in src/gagguino.cpp)")
+    ref = load_ref(args.ref, args.ref_offset_ms) if args.ref else []
+    fixed = {"heaterW": args.heater_w, "ambientC": args.ambient_c, "inletC": args.inlet_c}
+    rows = sum(len(s) for s in segments)
+    print(f"{len(segments)} segment(s), {rows} samples, {len(ref)} reference samples",
+          file=sys.stderr)
+
+    x0 = [math.log(INITIAL[k]) for k in FITTED]
+    x, mse = nelder_mead(lambda v: cost(v, segments, ref, args.ref_weight, fixed), x0)
+    p = {k: math.exp(v) for k, v in zip(FITTED, x)}
+    print(f"RMS error {math.sqrt(mse):.3f} C", file=sys.stderr)
+    if not ref:
+        print("no reference probe: group node values are weakly constrained", file=sys.stderr)
+
+    values = [
+        (args.heater_w, "heaterW"),
+        (p["boilerJK"], "boilerJK"),
+        (p["groupJK"], "groupJK"),
+        (p["boilerGroupWK"], "boilerGroupWK"),
+        (p["boilerAmbWK"], "boilerAmbWK"),
+        (p["groupAmbWK"], "groupAmbWK"),
+        (args.ambient_c, "ambientC"),
+        (args.inlet_c, "inletC"),
+        (args.gain_boiler, "gainBoiler"),
+        (args.gain_group, "gainGroup"),
+    ]
+    print("constexpr gag::ThermalObserver::Params THERMAL_PARAMS = {")
+    for v, name in values:
+        print(f"    {c_float(v) + ',':<10}// {name}")
+    print("};")
+
+
+if __name__ == "__main__":
+    main()
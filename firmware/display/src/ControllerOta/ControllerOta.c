@@ -0,0 +1,277 @@
+#include "ControllerOta.h"
+
+#include "esp_log.h"
+#include "esp_now.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "Wireless.h"
+#include "espnow_ota.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define OTA_CHUNK_SIZE ESPNOW_OTA_CHUNK_MAX
+#define OTA_WINDOW 8
+#define OTA_POLL_MS 5
+#define OTA_RX_QUEUE_LEN 16
+#define OTA_TASK_STACK 4096
+
+static const char *TAG = "CtrlOTA";
+
+typedef struct
+{
+    uint8_t len;
+    uint8_t data[sizeof(EspNowOtaAck)];
+} OtaReply;
+
+static SemaphoreHandle_t s_lock = NULL;
+static QueueHandle_t s_rx_queue = NULL;
+static TaskHandle_t s_task = NULL;
+static EspNowOtaSender s_sender;
+static FILE *s_image = NULL;
+static uint32_t s_image_pos = 0;
+static bool s_started = false;
+
+static uint32_t now_ms(void) { return (uint32_t)(esp_timer_get_time() / 1000); }
+
+static bool image_read(void *ctx, uint32_t offset, uint8_t *buf, size_t len)
+{
+    (void)ctx;
+    if (!s_image)
+        return false;
+    // Chunks are read sequentially except after a rewind, so avoid needless seeks.
+    if (offset != s_image_pos && fseek(s_image, (long)offset, SEEK_SET) != 0)
+        return false;
+    size_t n = fread(buf, 1, len, s_image);
+    s_image_pos = offset + (uint32_t)n;
+    return n == len;
+}
+
+static bool image_send(void *ctx, const uint8_t *frame, size_t len)
+{
+    (void)ctx;
+    return Wireless_SendToController(frame, len) == ESP_OK;
+}
+
+static void close_image(void)
+{
+    if (s_image)
+    {
+        fclose(s_image);
+        s_image = NULL;
+    }
+}
+
+static void ControllerOta_Task(void *arg)
+{
+    (void)arg;
+    EspNowOtaSenderState last_state = ESPNOW_OTA_SENDER_IDLE;
+    TickType_t wait = portMAX_DELAY;
+    while (1)
+    {
+        OtaReply reply;
+        bool have = xQueueReceive(s_rx_queue, &reply, wait) == pdTRUE;
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        while (have)
+        {
+            if (reply.len)
+                espnow_ota_sender_handle(&s_sender, reply.data, reply.len, now_ms());
+            have = xQueueReceive(s_rx_queue, &reply, 0) == pdTRUE;
+        }
+        espnow_ota_sender_poll(&s_sender, now_ms());
+
+        if (s_sender.state != last_state)
+        {
+            last_state = s_sender.state;
+            if (s_sender.state == ESPNOW_OTA_SENDER_DONE)
+            {
+                ESP_LOGI(TAG, "Controller accepted image (%u bytes, %u B/s, %u resent)", (unsigned)s_sender.imageSize,
+                         (unsigned)espnow_ota_sender_throughput(&s_sender, now_ms()),
+                         (unsigned)s_sender.chunksResent);
+                close_image();
+            }
+            else if (s_sender.state == ESPNOW_OTA_SENDER_FAILED)
+            {
+                ESP_LOGW(TAG, "Controller update failed at %u/%u (status %d)", (unsigned)s_sender.ackedOffset,
+                         (unsigned)s_sender.imageSize, s_sender.status);
+                close_image();
+            }
+            else if (s_sender.state == ESPNOW_OTA_SENDER_STREAM && s_sender.resumeOffset)
+            {
+                ESP_LOGI(TAG, "Controller resumed transfer at %u", (unsigned)s_sender.resumeOffset);
+            }
+        }
+        // Poll for retransmits only while a transfer runs; otherwise sleep until
+        // a reply or the wake-up from ControllerOta_Start().
+        wait = espnow_ota_sender_active(&s_sender) ? pdMS_TO_TICKS(OTA_POLL_MS) : portMAX_DELAY;
+        xSemaphoreGive(s_lock);
+    }
+}
+
+esp_err_t ControllerOta_Init(void)
+{
+    if (s_task)
+        return ESP_OK;
+    s_lock = xSemaphoreCreateMutex();
+    s_rx_queue = xQueueCreate(OTA_RX_QUEUE_LEN, sizeof(OtaReply));
+    if (!s_lock || !s_rx_queue)
+        return ESP_ERR_NO_MEM;
+    memset(&s_sender, 0, sizeof(s_sender));
+    if (xTaskCreate(ControllerOta_Task, "ctrl_ota", OTA_TASK_STACK, NULL, 4, &s_task) != pdPASS)
+        return ESP_ERR_NO_MEM;
+    return ESP_OK;
+}
+
+esp_err_t ControllerOta_Start(const char *path)
+{
+    if (!s_task)
+        return ESP_ERR_INVALID_STATE;
+    if (!path)
+        path = CONTROLLER_OTA_IMAGE_PATH;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (espnow_ota_sender_active(&s_sender))
+    {
+        xSemaphoreGive(s_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    close_image();
+    s_image = fopen(path, "rb");
+    if (!s_image)
+    {
+        xSemaphoreGive(s_lock);
+        ESP_LOGE(TAG, "Cannot open %s", path);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    uint8_t buf[512];
+    uint32_t size = 0;
+    uint32_t crc = 0;
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), s_image)) > 0)
+    {
+        crc = espnow_ota_crc32(crc, buf, n);
+        size += (uint32_t)n;
+    }
+    s_image_pos = size;
+    if (size == 0)
+    {
+        close_image();
+        xSemaphoreGive(s_lock);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    EspNowOtaSenderIo io = {
+        .read = image_read,
+        .send = image_send,
+        .ctx = NULL,
+    };
+    xQueueReset(s_rx_queue);
+    espnow_ota_sender_start(&s_sender, &io, size, crc, OTA_CHUNK_SIZE, OTA_WINDOW, now_ms());
+    s_started = true;
+    // An empty entry wakes the task so it starts polling.
+    OtaReply wake = {0};
+    xQueueSend(s_rx_queue, &wake, 0);
+    xSemaphoreGive(s_lock);
+    ESP_LOGI(TAG, "Updating controller from %s (%u bytes, crc %08x)", path, (unsigned)size, (unsigned)crc);
+    return ESP_OK;
+}
+
+void ControllerOta_Abort(void)
+{
+    if (!s_task)
+        return;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (espnow_ota_sender_active(&s_sender))
+    {
+        espnow_ota_sender_abort(&s_sender, now_ms());
+        ESP_LOGW(TAG, "Controller update aborted at %u", (unsigned)s_sender.ackedOffset);
+    }
+    close_image();
+    xSemaphoreGive(s_lock);
+}
+
+static ControllerOtaState map_state(EspNowOtaSenderState state)
+{
+    switch (state)
+    {
+    case ESPNOW_OTA_SENDER_BEGIN:
+        return CONTROLLER_OTA_STARTING;
+    case ESPNOW_OTA_SENDER_STREAM:
+        return CONTROLLER_OTA_STREAMING;
+    case ESPNOW_OTA_SENDER_END:
+        return CONTROLLER_OTA_VERIFYING;
+    case ESPNOW_OTA_SENDER_DONE:
+        return CONTROLLER_OTA_DONE;
+    case ESPNOW_OTA_SENDER_FAILED:
+        return CONTROLLER_OTA_FAILED;
+    default:
+        return CONTROLLER_OTA_IDLE;
+    }
+}
+
+void ControllerOta_GetStatus(ControllerOtaStatus *out)
+{
+    if (!out)
+        return;
+    memset(out, 0, sizeof(*out));
+    if (!s_task)
+        return;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    uint32_t now = now_ms();
+    out->state = s_started ? map_state(s_sender.state) : CONTROLLER_OTA_IDLE;
+    out->status = s_sender.state == ESPNOW_OTA_SENDER_FAILED ? s_sender.status : 0;
+    out->imageSize = s_sender.imageSize;
+    out->imageCrc = s_sender.imageCrc;
+    out->offset = s_sender.ackedOffset;
+    out->resumeOffset = s_sender.resumeOffset;
+    out->throughputBps = espnow_ota_sender_throughput(&s_sender, now);
+    out->chunksSent = s_sender.chunksSent;
+    out->chunksResent = s_sender.chunksResent;
+    if (s_started)
+        out->elapsedMs = (espnow_ota_sender_active(&s_sender) ? now : s_sender.finishMs) - s_sender.startMs;
+    xSemaphoreGive(s_lock);
+}
+
+bool ControllerOta_IsActive(void)
+{
+    // Single word read; good enough for callers that only gate other traffic.
+    return s_started && espnow_ota_sender_active(&s_sender);
+}
+
+bool ControllerOta_HandleFrame(const uint8_t *data, int len)
+{
+    if (!data || len <= 0 || data[0] < ESPNOW_OTA_BEGIN || data[0] > ESPNOW_OTA_ABORT)
+        return false;
+    if (!s_rx_queue || len > (int)sizeof(((OtaReply *)0)->data))
+        return true;
+    OtaReply reply;
+    reply.len = (uint8_t)len;
+    memcpy(reply.data, data, (size_t)len);
+    xQueueSend(s_rx_queue, &reply, 0);
+    return true;
+}
+
+const char *ControllerOta_StateName(ControllerOtaState state)
+{
+    switch (state)
+    {
+    case CONTROLLER_OTA_STARTING:
+        return "starting";
+    case CONTROLLER_OTA_STREAMING:
+        return "streaming";
+    case CONTROLLER_OTA_VERIFYING:
+        return "verifying";
+    case CONTROLLER_OTA_DONE:
+        return "done";
+    case CONTROLLER_OTA_FAILED:
+        return "failed";
+    default:
+        return "idle";
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Controller firmware images are staged on the SD card; the display's own
+// flash has no room for a second application image next to its OTA slots.
+#define CONTROLLER_OTA_IMAGE_PATH "/sdcard/controller.bin"
+
+typedef enum
+{
+    CONTROLLER_OTA_IDLE = 0,
+    CONTROLLER_OTA_STARTING,
+    CONTROLLER_OTA_STREAMING,
+    CONTROLLER_OTA_VERIFYING,
+    CONTROLLER_OTA_DONE,
+    CONTROLLER_OTA_FAILED,
+} ControllerOtaState;
+
+typedef struct
+{
+    ControllerOtaState state;
+    int status; //!< EspNowOtaStatus of the last failure (0 while running)
+    uint32_t imageSize;
+    uint32_t imageCrc;
+    uint32_t offset;         //!< Bytes acknowledged by the controller
+    uint32_t resumeOffset;   //!< Offset the controller resumed from
+    uint32_t throughputBps;  //!< Average goodput of the current/last session
+    uint32_t chunksSent;
+    uint32_t chunksResent;
+    uint32_t elapsedMs;
+} ControllerOtaStatus;
+
+esp_err_t ControllerOta_Init(void);
+
+/**
+ * @brief Stream the image at @p path (NULL for CONTROLLER_OTA_IMAGE_PATH) to the controller.
+ *
+ * Returns ESP_ERR_INVALID_STATE while a transfer is running, ESP_ERR_NOT_FOUND if
+ * the image cannot be opened.
+ */
+esp_err_t ControllerOta_Start(const char *path);
+void ControllerOta_Abort(void);
+void ControllerOta_GetStatus(ControllerOtaStatus *out);
+bool ControllerOta_IsActive(void);
+
+/**
+ * @brief Offer an ESP-NOW frame from the controller to the updater.
+ *
+ * Safe to call from the Wi-Fi receive callback. Returns true when the frame
+ * belonged to the OTA protocol and must not be processed further.
+ */
+bool ControllerOta_HandleFrame(const uint8_t *data, int len);
+
+const char *ControllerOta_StateName(ControllerOtaState state);
+
+#ifdef __cplusplus
+}
+#endif
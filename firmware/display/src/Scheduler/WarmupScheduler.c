@@ -0,0 +1,518 @@
+#include "WarmupScheduler.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "nvs.h"
+#include "Wireless.h"
+
+#define WARMUP_NAMESPACE "warmup"
+#define WARMUP_CONFIG_KEY "config"
+#define WARMUP_MODEL_KEY "model"
+#define WARMUP_STORE_VERSION (1U)
+
+#define WARMUP_TICK_S 1
+#define WARMUP_TIME_VALID_AFTER 1704067200 // 2024-01-01: clock has been set
+#define WARMUP_READY_BAND_C 0.5f           // boiler within this of the setpoint counts as reached
+#define WARMUP_MARGIN_S 60                 // start this much earlier than the model says
+#define WARMUP_GIVE_UP_S (30 * 60)         // abandon a warm-up this long past its ready time
+#define WARMUP_MIN_LEARN_C 5.0f            // shorter climbs say nothing about the boiler
+#define WARMUP_DEFAULT_OFFSET_S 30.0f      // element and sensor lag before the climb shows
+#define WARMUP_DEFAULT_PER_C 3.5f          // Gaggia Classic, 1370 W: ~4 min from room temperature
+
+static const char *TAG = "Warmup";
+
+typedef struct
+{
+    float deltaC;
+    float seconds;
+} WarmupSample;
+
+// Learned model and lifetime statistics, persisted after every completed cycle.
+typedef struct
+{
+    uint32_t version;
+    uint32_t sampleCount;
+    uint32_t sampleHead;
+    WarmupSample samples[WARMUP_MODEL_SAMPLES];
+    float totalSavedWh;
+    uint32_t cycles;
+    int64_t lastScheduled;
+    int64_t lastPredicted;
+    int64_t lastActual;
+    float lastSavedWh;
+} WarmupModelStore;
+
+typedef struct
+{
+    uint32_t version;
+    WarmupScheduleConfig cfg;
+} WarmupConfigStore;
+
+static const WarmupScheduleConfig CONFIG_DEFAULTS = {
+    .enabled = false,
+    .slotCount = 0,
+    .ecoSetpointC = 0.0f,
+    .ecoLeadMin = 0,
+    .soakMin = 15,
+    .holdMin = 60,
+    .heaterW = 1370.0f,
+    .idleWPerC = 0.55f,
+    .ambientC = 22.0f,
+    .tz = "",
+};
+
+static SemaphoreHandle_t s_mutex = NULL;
+static WarmupScheduleConfig s_cfg;
+static WarmupModelStore s_model;
+static float s_offset_s = WARMUP_DEFAULT_OFFSET_S;
+static float s_per_c = WARMUP_DEFAULT_PER_C;
+
+static WarmupState s_state = WARMUP_STATE_IDLE;
+static time_t s_last_tick = 0;
+static time_t s_last_handled = 0; // newest ready time already served or skipped
+static time_t s_off_since = 0;    // heater last seen going off (0 while it is on)
+static time_t s_ready_at = 0;     // cycle in progress
+static time_t s_eco_since = 0;
+static time_t s_heat_start = 0;
+static time_t s_reached = 0;
+static time_t s_predicted = 0;
+static float s_start_c = 0.0f;
+static time_t s_next_ready = 0;
+static time_t s_planned_start = 0;
+static float s_predicted_warmup_s = 0.0f;
+
+static esp_err_t save_blob(const char *key, const void *data, size_t len)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(WARMUP_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK)
+        return err;
+    err = nvs_set_blob(handle, key, data, len);
+    if (err == ESP_OK)
+        err = nvs_commit(handle);
+    nvs_close(handle);
+    return err;
+}
+
+static bool load_blob(const char *key, void *data, size_t len)
+{
+    nvs_handle_t handle;
+    if (nvs_open(WARMUP_NAMESPACE, NVS_READONLY, &handle) != ESP_OK)
+        return false;
+    size_t size = len;
+    esp_err_t err = nvs_get_blob(handle, key, data, &size);
+    nvs_close(handle);
+    return err == ESP_OK && size == len;
+}
+
+static void apply_timezone(const char *tz)
+{
+    setenv("TZ", (tz && tz[0]) ? tz : "UTC0", 1);
+    tzset();
+}
+
+// Least squares over the stored samples; needs a spread of start temperatures to
+// separate the fixed lag from the per-degree rate, otherwise only the rate is learned.
+static void fit_model(void)
+{
+    s_offset_s = WARMUP_DEFAULT_OFFSET_S;
+    s_per_c = WARMUP_DEFAULT_PER_C;
+    uint32_t n = s_model.sampleCount;
+    if (n == 0)
+        return;
+    float sx = 0.0f, sy = 0.0f, sxx = 0.0f, sxy = 0.0f, min_x = INFINITY, max_x = -INFINITY;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        float x = s_model.samples[i].deltaC;
+        float y = s_model.samples[i].seconds;
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+        min_x = fminf(min_x, x);
+        max_x = fmaxf(max_x, x);
+    }
+    if (n >= 3 && max_x - min_x >= 10.0f)
+    {
+        float den = n * sxx - sx * sx;
+        float per_c = (n * sxy - sx * sy) / den;
+        float offset = (sy - per_c * sx) / n;
+        if (per_c > 0.0f && offset >= 0.0f)
+        {
+            s_per_c = per_c;
+            s_offset_s = offset;
+            return;
+        }
+    }
+    float per_c = (sy - n * s_offset_s) / sx;
+    if (per_c > 0.5f)
+        s_per_c = per_c;
+}
+
+static float predict_warmup_s(float delta_c)
+{
+    return delta_c > 0.0f ? s_offset_s + s_per_c * delta_c : 0.0f;
+}
+
+static float idle_w(float temp_c)
+{
+    float above = temp_c - s_cfg.ambientC;
+    return above > 0.0f ? s_cfg.idleWPerC * above : 0.0f;
+}
+
+// Earliest enabled slot after s_last_handled and not yet past, within a week.
+static time_t next_ready_time(time_t now)
+{
+    time_t best = 0;
+    for (int d = 0; d <= 7; ++d)
+    {
+        time_t day = now + (time_t)d * 86400;
+        struct tm date;
+        localtime_r(&day, &date);
+        for (uint32_t i = 0; i < s_cfg.slotCount; ++i)
+        {
+            const WarmupSlot *slot = &s_cfg.slots[i];
+            if (!slot->enabled || !(slot->days & (1u << date.tm_wday)))
+                continue;
+            struct tm at = date;
+            at.tm_hour = slot->hour;
+            at.tm_min = slot->minute;
+            at.tm_sec = 0;
+            at.tm_isdst = -1;
+            time_t t = mktime(&at);
+            if (t <= now || t <= s_last_handled)
+                continue;
+            if (!best || t < best)
+                best = t;
+        }
+        if (best)
+            break;
+    }
+    return best;
+}
+
+static void format_local(time_t t, char *buf, size_t len)
+{
+    struct tm tm;
+    localtime_r(&t, &tm);
+    strftime(buf, len, "%Y-%m-%dT%H:%M:%S", &tm);
+}
+
+static void release(const char *why)
+{
+    if (s_state == WARMUP_STATE_IDLE)
+        return;
+    ESP_LOGI(TAG, "Releasing heater (%s)", why);
+    MQTT_SetEcoSetpoint(0.0f);
+    s_last_handled = s_ready_at;
+    s_state = WARMUP_STATE_IDLE;
+}
+
+static void begin_eco(time_t now)
+{
+    ESP_LOGI(TAG, "Eco hold at %.0f C", (double)s_cfg.ecoSetpointC);
+    MQTT_SetEcoSetpoint(s_cfg.ecoSetpointC);
+    MQTT_SetHeaterState(true, false);
+    s_eco_since = now;
+    s_state = WARMUP_STATE_ECO;
+}
+
+static void begin_heating(time_t now, float temp_c, float target_c)
+{
+    MQTT_SetEcoSetpoint(0.0f);
+    MQTT_SetHeaterState(true, false);
+    s_start_c = isfinite(temp_c) ? temp_c : s_cfg.ambientC;
+    s_heat_start = now;
+    s_predicted = now + (time_t)(predict_warmup_s(target_c - s_start_c) + s_cfg.soakMin * 60U);
+    s_state = WARMUP_STATE_HEATING;
+    char pred[24];
+    format_local(s_predicted, pred, sizeof pred);
+    ESP_LOGI(TAG, "Heating from %.1f to %.1f C, ready predicted %s", (double)s_start_c, (double)target_c, pred);
+}
+
+static void finish_cycle(time_t now, float target_c)
+{
+    float climb_s = (float)(s_reached - s_heat_start);
+    float delta_c = target_c - s_start_c;
+    if (delta_c >= WARMUP_MIN_LEARN_C)
+    {
+        s_model.samples[s_model.sampleHead] = (WarmupSample){delta_c, climb_s};
+        s_model.sampleHead = (s_model.sampleHead + 1) % WARMUP_MODEL_SAMPLES;
+        if (s_model.sampleCount < WARMUP_MODEL_SAMPLES)
+            s_model.sampleCount++;
+        fit_model();
+    }
+
+    // Baseline: holding brew temperature from when the heater went off until ready.
+    time_t off_since = s_off_since ? s_off_since : (s_eco_since ? s_eco_since : s_heat_start);
+    float baseline_wh = idle_w(target_c) * (float)(now - off_since) / 3600.0f;
+    float used_wh = s_cfg.heaterW * climb_s / 3600.0f + idle_w(target_c) * (float)(now - s_reached) / 3600.0f;
+    if (s_eco_since)
+        used_wh += idle_w(s_cfg.ecoSetpointC) * (float)(s_heat_start - s_eco_since) / 3600.0f;
+    float saved_wh = baseline_wh - used_wh;
+
+    s_model.lastScheduled = s_ready_at;
+    s_model.lastPredicted = s_predicted;
+    s_model.lastActual = now;
+    s_model.lastSavedWh = saved_wh;
+    s_model.totalSavedWh += saved_wh;
+    s_model.cycles++;
+    s_model.version = WARMUP_STORE_VERSION;
+    esp_err_t err = save_blob(WARMUP_MODEL_KEY, &s_model, sizeof(s_model));
+    if (err != ESP_OK)
+        ESP_LOGW(TAG, "Failed to save model: %s", esp_err_to_name(err));
+
+    char sched[24], pred[24], actual[24];
+    format_local(s_ready_at, sched, sizeof sched);
+    format_local(s_predicted, pred, sizeof pred);
+    format_local(now, actual, sizeof actual);
+    ESP_LOGI(TAG, "Ready %s (scheduled %s, predicted %s), climb %.0f s for %.1f C, saved %.1f Wh", actual, sched,
+             pred, (double)climb_s, (double)delta_c, (double)saved_wh);
+
+    char json[384];
+    int n = snprintf(json, sizeof json,
+                     "{\"scheduled\":\"%s\",\"predicted\":\"%s\",\"actual\":\"%s\",\"error_s\":%ld,\"late_s\":%ld,"
+                     "\"warmup_s\":%.0f,\"start_c\":%.1f,\"saved_wh\":%.1f,\"total_saved_wh\":%.1f,\"cycles\":%u}",
+                     sched, pred, actual, (long)(now - s_predicted), (long)(now - s_ready_at), (double)climb_s,
+                     (double)s_start_c, (double)saved_wh, (double)s_model.totalSavedWh, (unsigned)s_model.cycles);
+    if (n > 0 && n < (int)sizeof json)
+        Wireless_PublishWarmupReport(json);
+
+    s_state = WARMUP_STATE_READY;
+}
+
+static void tick_locked(time_t now)
+{
+    bool heater = MQTT_GetHeaterState();
+    float temp_c = MQTT_GetCurrentTemp();
+    float target_c = MQTT_GetBrewSetpoint();
+
+    if (s_state == WARMUP_STATE_IDLE)
+    {
+        if (!heater && !s_off_since)
+            s_off_since = now;
+        else if (heater)
+            s_off_since = 0;
+    }
+    else if (!heater)
+    {
+        // Switched off from the UI or Home Assistant: the user overrides the schedule.
+        release("heater switched off");
+        s_off_since = now;
+        return;
+    }
+
+    float expected_start_c = s_cfg.ecoSetpointC > 0.0f && s_cfg.ecoLeadMin ? s_cfg.ecoSetpointC
+                             : isfinite(temp_c)                            ? temp_c
+                                                                           : s_cfg.ambientC;
+    switch (s_state)
+    {
+    case WARMUP_STATE_IDLE:
+    {
+        s_next_ready = next_ready_time(now);
+        if (!s_next_ready)
+            break;
+        s_predicted_warmup_s = predict_warmup_s(target_c - expected_start_c);
+        s_planned_start =
+            s_next_ready - (time_t)(s_predicted_warmup_s + s_cfg.soakMin * 60U) - WARMUP_MARGIN_S;
+        if (heater)
+            break; // already on by hand; leave it alone
+        s_ready_at = s_next_ready;
+        s_eco_since = 0;
+        if (now >= s_planned_start)
+            begin_heating(now, temp_c, target_c);
+        else if (s_cfg.ecoSetpointC > 0.0f && s_cfg.ecoLeadMin &&
+                 now >= s_planned_start - (time_t)s_cfg.ecoLeadMin * 60)
+            begin_eco(now);
+        break;
+    }
+    case WARMUP_STATE_ECO:
+        if (now >= s_planned_start)
+            begin_heating(now, temp_c, target_c);
+        break;
+    case WARMUP_STATE_HEATING:
+        if (isfinite(temp_c) && temp_c >= target_c - WARMUP_READY_BAND_C)
+        {
+            s_reached = now;
+            s_state = WARMUP_STATE_SOAKING;
+        }
+        else if (now > s_ready_at + WARMUP_GIVE_UP_S)
+        {
+            ESP_LOGW(TAG, "Boiler never reached %.1f C, giving up", (double)target_c);
+            MQTT_SetHeaterState(false, false);
+            release("warm-up failed");
+        }
+        break;
+    case WARMUP_STATE_SOAKING:
+        if (now >= s_reached + (time_t)s_cfg.soakMin * 60)
+            finish_cycle(now, target_c);
+        break;
+    case WARMUP_STATE_READY:
+    {
+        time_t from = s_model.lastActual > s_ready_at ? (time_t)s_model.lastActual : s_ready_at;
+        if (now >= from + (time_t)s_cfg.holdMin * 60)
+        {
+            ESP_LOGI(TAG, "Unused after %u min, heater off", (unsigned)s_cfg.holdMin);
+            MQTT_SetHeaterState(false, false);
+            release("hold expired");
+            s_off_since = now;
+        }
+        break;
+    }
+    }
+}
+
+esp_err_t WarmupScheduler_Init(void)
+{
+    if (s_mutex)
+        return ESP_OK;
+    s_mutex = xSemaphoreCreateMutex();
+    if (!s_mutex)
+        return ESP_ERR_NO_MEM;
+
+    WarmupConfigStore stored;
+    if (load_blob(WARMUP_CONFIG_KEY, &stored, sizeof(stored)) && stored.version == WARMUP_STORE_VERSION)
+        s_cfg = stored.cfg;
+    else
+        s_cfg = CONFIG_DEFAULTS;
+    s_cfg.tz[sizeof(s_cfg.tz) - 1] = '\0';
+    if (!load_blob(WARMUP_MODEL_KEY, &s_model, sizeof(s_model)) || s_model.version != WARMUP_STORE_VERSION ||
+        s_model.sampleCount > WARMUP_MODEL_SAMPLES || s_model.sampleHead >= WARMUP_MODEL_SAMPLES)
+    {
+        memset(&s_model, 0, sizeof(s_model));
+        s_model.version = WARMUP_STORE_VERSION;
+    }
+    fit_model();
+    apply_timezone(s_cfg.tz);
+    ESP_LOGI(TAG, "%s, %u slot(s), model %.0f s + %.2f s/C from %u sample(s)", s_cfg.enabled ? "Enabled" : "Disabled",
+             (unsigned)s_cfg.slotCount, (double)s_offset_s, (double)s_per_c, (unsigned)s_model.sampleCount);
+    return ESP_OK;
+}
+
+esp_err_t WarmupScheduler_GetConfig(WarmupScheduleConfig *out)
+{
+    if (!out)
+        return ESP_ERR_INVALID_ARG;
+    if (!s_mutex)
+        return ESP_ERR_INVALID_STATE;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    *out = s_cfg;
+    xSemaphoreGive(s_mutex);
+    return ESP_OK;
+}
+
+esp_err_t WarmupScheduler_SetConfig(const WarmupScheduleConfig *cfg)
+{
+    if (!cfg || cfg->slotCount > WARMUP_SCHEDULER_MAX_SLOTS)
+        return ESP_ERR_INVALID_ARG;
+    for (uint32_t i = 0; i < cfg->slotCount; ++i)
+    {
+        const WarmupSlot *slot = &cfg->slots[i];
+        if (slot->hour > 23 || slot->minute > 59 || (slot->days & ~0x7Fu))
+            return ESP_ERR_INVALID_ARG;
+    }
+    if (cfg->ecoSetpointC != 0.0f && (cfg->ecoSetpointC < 50.0f || cfg->ecoSetpointC > 87.0f))
+        return ESP_ERR_INVALID_ARG;
+    if (cfg->ecoLeadMin > 720 || cfg->soakMin > 120 || cfg->holdMin > 720)
+        return ESP_ERR_INVALID_ARG;
+    if (!(cfg->heaterW >= 100.0f && cfg->heaterW <= 3000.0f) || !(cfg->idleWPerC >= 0.0f && cfg->idleWPerC <= 5.0f) ||
+        !(cfg->ambientC >= -10.0f && cfg->ambientC <= 45.0f))
+        return ESP_ERR_INVALID_ARG;
+    if (strnlen(cfg->tz, sizeof(cfg->tz)) >= sizeof(cfg->tz))
+        return ESP_ERR_INVALID_ARG;
+    if (!s_mutex)
+        return ESP_ERR_INVALID_STATE;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_cfg = *cfg;
+    apply_timezone(s_cfg.tz);
+    if (!s_cfg.enabled)
+        release("schedule disabled");
+    WarmupConfigStore stored = {.version = WARMUP_STORE_VERSION, .cfg = s_cfg};
+    esp_err_t err = save_blob(WARMUP_CONFIG_KEY, &stored, sizeof(stored));
+    xSemaphoreGive(s_mutex);
+    if (err != ESP_OK)
+        ESP_LOGE(TAG, "Failed to save schedule: %s", esp_err_to_name(err));
+    return err;
+}
+
+void WarmupScheduler_GetStatus(WarmupSchedulerStatus *out)
+{
+    if (!out || !s_mutex)
+        return;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    *out = (WarmupSchedulerStatus){
+        .state = s_state,
+        .nextReady = s_state == WARMUP_STATE_IDLE ? s_next_ready : s_ready_at,
+        .plannedStart = s_planned_start,
+        .predictedWarmupS = s_predicted_warmup_s,
+        .modelOffsetS = s_offset_s,
+        .modelPerC = s_per_c,
+        .modelSamples = s_model.sampleCount,
+        .lastScheduled = (time_t)s_model.lastScheduled,
+        .lastPredicted = (time_t)s_model.lastPredicted,
+        .lastActual = (time_t)s_model.lastActual,
+        .lastSavedWh = s_model.lastSavedWh,
+        .totalSavedWh = s_model.totalSavedWh,
+        .cycles = s_model.cycles,
+    };
+    xSemaphoreGive(s_mutex);
+}
+
+const char *WarmupScheduler_StateName(WarmupState state)
+{
+    switch (state)
+    {
+    case WARMUP_STATE_IDLE:
+        return "idle";
+    case WARMUP_STATE_ECO:
+        return "eco";
+    case WARMUP_STATE_HEATING:
+        return "heating";
+    case WARMUP_STATE_SOAKING:
+        return "soaking";
+    case WARMUP_STATE_READY:
+        return "ready";
+    }
+    return "unknown";
+}
+
+void WarmupScheduler_Tick(void)
+{
+    if (!s_mutex)
+        return;
+    time_t now = time(NULL);
+    if (now - s_last_tick < WARMUP_TICK_S)
+        return;
+    s_last_tick = now;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (s_cfg.enabled && now >= WARMUP_TIME_VALID_AFTER)
+        tick_locked(now);
+    else
+        s_next_ready = 0;
+    xSemaphoreGive(s_mutex);
+}
+
+void WarmupScheduler_NotifyActivity(void)
+{
+    if (!s_mutex)
+        return;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    release("user activity");
+    xSemaphoreGive(s_mutex);
+}
+
+bool WarmupScheduler_IsActive(void)
+{
+    if (!s_mutex)
+        return false;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    bool active = s_state != WARMUP_STATE_IDLE;
+    xSemaphoreGive(s_mutex);
+    return active;
+}
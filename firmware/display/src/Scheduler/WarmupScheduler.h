@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WARMUP_SCHEDULER_MAX_SLOTS 8U
+#define WARMUP_SCHEDULER_TZ_MAX_LEN 48U
+#define WARMUP_MODEL_SAMPLES 8U
+
+// One weekly ready-by time. days: bit 0 = Sunday ... bit 6 = Saturday (local time).
+typedef struct
+{
+    uint8_t days;
+    uint8_t hour;
+    uint8_t minute;
+    bool enabled;
+} WarmupSlot;
+
+typedef struct
+{
+    bool enabled;
+    uint32_t slotCount;
+    WarmupSlot slots[WARMUP_SCHEDULER_MAX_SLOTS];
+    float ecoSetpointC;  // hold temperature before warm-up; 0 = heater off until warm-up
+    uint32_t ecoLeadMin; // eco hold starts this long before the planned warm-up start
+    uint32_t soakMin;    // time at brew temperature for the group to heat through
+    uint32_t holdMin;    // stay hot this long after the ready time if unused, then off
+    float heaterW;       // element power, for the warm-up energy estimate
+    float idleWPerC;     // holding power per degC above ambient
+    float ambientC;
+    char tz[WARMUP_SCHEDULER_TZ_MAX_LEN]; // POSIX TZ, e.g. "CET-1CEST,M3.5.0,M10.5.0/3"
+} WarmupScheduleConfig;
+
+typedef enum
+{
+    WARMUP_STATE_IDLE = 0, // not driving the heater
+    WARMUP_STATE_ECO,      // heater on at the eco setpoint
+    WARMUP_STATE_HEATING,  // heading for the brew setpoint
+    WARMUP_STATE_SOAKING,  // boiler at temperature, group still heating
+    WARMUP_STATE_READY,    // ready; held until holdMin after the ready time
+} WarmupState;
+
+typedef struct
+{
+    WarmupState state;
+    time_t nextReady;       // next scheduled ready time (UTC), 0 if none
+    time_t plannedStart;    // when heating to brew temperature will start
+    float predictedWarmupS; // boiler warm-up from the expected start temperature, excl. soak
+    float modelOffsetS;     // warm-up model: seconds = offset + perC * (target - start)
+    float modelPerC;
+    uint32_t modelSamples;
+    time_t lastScheduled;   // last completed cycle: scheduled ready time...
+    time_t lastPredicted;   // ...predicted ready time when heating started...
+    time_t lastActual;      // ...and when it actually became ready
+    float lastSavedWh;      // versus holding brew temperature over the same period
+    float totalSavedWh;
+    uint32_t cycles;
+} WarmupSchedulerStatus;
+
+esp_err_t WarmupScheduler_Init(void);
+esp_err_t WarmupScheduler_GetConfig(WarmupScheduleConfig *out);
+esp_err_t WarmupScheduler_SetConfig(const WarmupScheduleConfig *cfg);
+void WarmupScheduler_GetStatus(WarmupSchedulerStatus *out);
+const char *WarmupScheduler_StateName(WarmupState state);
+
+// Drive the state machine; call from the main loop (internally limited to 1 Hz).
+void WarmupScheduler_Tick(void);
+// Touch or pump activity: the user has taken over, so the scheduler lets go of the heater.
+void WarmupScheduler_NotifyActivity(void);
+// True while the scheduler holds the heater on; standby must not switch it off.
+bool WarmupScheduler_IsActive(void);
+
+#ifdef __cplusplus
+}
+#endif
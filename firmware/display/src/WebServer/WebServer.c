@@ -11,6 +11,11 @@
 #include "nvs.h"
 #include "cJSON.h"
 #include "BrewProfileStore.h"
+#include "ControllerOta.h"
+#include "espnow_ota.h"
+#include "param_registry.h"
+#include "Wireless.h"
+#include "WarmupScheduler.h"
 
 static const char *TAG = "WebServer";
 
@@ -1214,6 +1219,765 @@ static esp_err_t handle_delete_profile(httpd_req_t *req)
     return err;
 }
 
+#define CONTROLLER_OTA_UPLOAD_TMP "/sdcard/controller.tmp"
+
+static esp_err_t handle_post_controller_firmware(httpd_req_t *req)
+{
+    if (ControllerOta_IsActive())
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Controller update in progress");
+    if (req->content_len == 0)
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Empty image");
+    FILE *f = fopen(CONTROLLER_OTA_UPLOAD_TMP, "wb");
+    if (!f)
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "SD card not available");
+
+    // Stream to the card in small pieces; images are far larger than free heap.
+    char buf[1024];
+    size_t remaining = req->content_len;
+    uint32_t crc = 0;
+    while (remaining > 0)
+    {
+        int ret = httpd_req_recv(req, buf, remaining < sizeof(buf) ? remaining : sizeof(buf));
+        if (ret <= 0)
+        {
+            if (ret == HTTPD_SOCK_ERR_TIMEOUT)
+                continue;
+            fclose(f);
+            remove(CONTROLLER_OTA_UPLOAD_TMP);
+            return ESP_FAIL;
+        }
+        if (fwrite(buf, 1, (size_t)ret, f) != (size_t)ret)
+        {
+            fclose(f);
+            remove(CONTROLLER_OTA_UPLOAD_TMP);
+            return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "SD write failed");
+        }
+        crc = espnow_ota_crc32(crc, buf, (size_t)ret);
+        remaining -= (size_t)ret;
+    }
+    fclose(f);
+    remove(CONTROLLER_OTA_IMAGE_PATH);
+    if (rename(CONTROLLER_OTA_UPLOAD_TMP, CONTROLLER_OTA_IMAGE_PATH) != 0)
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to store image");
+    ESP_LOGI(TAG, "Stored controller image (%u bytes, crc %08x)", (unsigned)req->content_len, (unsigned)crc);
+
+    cJSON *response = cJSON_CreateObject();
+    if (!response)
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+    cJSON_AddStringToObject(response, "status", "stored");
+    cJSON_AddNumberToObject(response, "size", (double)req->content_len);
+    char crc_str[9];
+    snprintf(crc_str, sizeof(crc_str), "%08x", (unsigned)crc);
+    cJSON_AddStringToObject(response, "crc", crc_str);
+    esp_err_t err = send_json_response(req, response);
+    cJSON_Delete(response);
+    return err;
+}
+
+static esp_err_t handle_get_controller_ota(httpd_req_t *req)
+{
+    ControllerOtaStatus status;
+    ControllerOta_GetStatus(&status);
+    cJSON *response = cJSON_CreateObject();
+    if (!response)
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+    cJSON_AddStringToObject(response, "state", ControllerOta_StateName(status.state));
+    cJSON_AddNumberToObject(response, "status", status.status);
+    cJSON_AddNumberToObject(response, "size", status.imageSize);
+    cJSON_AddNumberToObject(response, "offset", status.offset);
+    cJSON_AddNumberToObject(response, "resumeOffset", status.resumeOffset);
+    cJSON_AddNumberToObject(response, "throughputBps", status.throughputBps);
+    cJSON_AddNumberToObject(response, "chunksSent", status.chunksSent);
+    cJSON_AddNumberToObject(response, "chunksResent", status.chunksResent);
+    cJSON_AddNumberToObject(response, "elapsedMs", status.elapsedMs);
+    esp_err_t err = send_json_response(req, response);
+    cJSON_Delete(response);
+    return err;
+}
+
+static esp_err_t handle_post_controller_ota(httpd_req_t *req)
+{
+    esp_err_t err = ControllerOta_Start(NULL);
+    if (err == ESP_ERR_INVALID_STATE)
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Controller update in progress");
+    if (err == ESP_ERR_NOT_FOUND)
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No controller image on SD card");
+    if (err != ESP_OK)
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to start update");
+    return handle_get_controller_ota(req);
+}
+
+static esp_err_t handle_delete_controller_ota(httpd_req_t *req)
+{
+    ControllerOta_Abort();
+    return handle_get_controller_ota(req);
+}
+
+static const char *const CAL_TARGET_NAMES[] = {"flow", "pressure"};
+static const char *const CAL_STATE_NAMES[] = {"idle", "running", "done", "failed"};
+static const char *const CAL_ACTION_NAMES[] = {"status", "start", "finish", "cancel", "reset"};
+
+static int lookup_name(const char *const *names, size_t count, const char *value)
+{
+    if (!value)
+        return -1;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (strcasecmp(names[i], value) == 0)
+            return (int)i;
+    }
+    return -1;
+}
+
+static cJSON *cal_report_to_json(const EspNowCalReport *rpt)
+{
+    cJSON *obj = cJSON_CreateObject();
+    if (!obj)
+        return NULL;
+    cJSON_AddStringToObject(obj, "state",
+                            rpt->state < sizeof(CAL_STATE_NAMES) / sizeof(CAL_STATE_NAMES[0])
+                                ? CAL_STATE_NAMES[rpt->state]
+                                : "unknown");
+    cJSON_AddNumberToObject(obj, "runs", rpt->runs);
+    cJSON_AddNumberToObject(obj, "samples", rpt->samples);
+    cJSON_AddNumberToObject(obj, "reference", rpt->reference);
+    cJSON_AddNumberToObject(obj, "measured", rpt->measured);
+    cJSON_AddNumberToObject(obj, "errorPct", rpt->errorPct);
+    cJSON_AddNumberToObject(obj, "residualPct", rpt->residualPct);
+    cJSON *curve = cJSON_AddArrayToObject(obj, "curve");
+    for (int i = 0; curve && i < ESPNOW_CAL_POINTS; ++i)
+    {
+        cJSON *point = cJSON_CreateObject();
+        if (!point)
+            break;
+        cJSON_AddNumberToObject(point, "x", rpt->x[i]);
+        cJSON_AddNumberToObject(point, "y", rpt->y[i]);
+        cJSON_AddItemToArray(curve, point);
+    }
+    return obj;
+}
+
+static esp_err_t handle_get_calibration(httpd_req_t *req)
+{
+    cJSON *response = cJSON_CreateObject();
+    if (!response)
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+    for (size_t t = 0; t < sizeof(CAL_TARGET_NAMES) / sizeof(CAL_TARGET_NAMES[0]); ++t)
+    {
+        EspNowCalReport rpt;
+        if (Wireless_GetCalReport((uint8_t)t, &rpt))
+            cJSON_AddItemToObject(response, CAL_TARGET_NAMES[t], cal_report_to_json(&rpt));
+        else
+            cJSON_AddNullToObject(response, CAL_TARGET_NAMES[t]);
+    }
+    esp_err_t err = send_json_response(req, response);
+    cJSON_Delete(response);
+    return err;
+}
+
+static const char *const ENERGY_STATE_NAMES[ESPNOW_ENERGY_STATES] = {"idle", "shot", "steam"};
+
+static esp_err_t handle_get_energy(httpd_req_t *req)
+{
+    EspNowEnergy e;
+    if (!Wireless_GetEnergy(&e))
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No energy report from the controller yet");
+    cJSON *response = cJSON_CreateObject();
+    if (!response)
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+
+    double total_wh = 0.0;
+    cJSON *states = cJSON_AddObjectToObject(response, "states");
+    for (int i = 0; i < ESPNOW_ENERGY_STATES; ++i)
+    {
+        double wh = e.heaterOnS[i] * (double)e.elementW / 3600.0;
+        total_wh += wh;
+        cJSON *state = states ? cJSON_AddObjectToObject(states, ENERGY_STATE_NAMES[i]) : NULL;
+        if (!state)
+            continue;
+        cJSON_AddNumberToObject(state, "timeS", e.stateS[i]);
+        cJSON_AddNumberToObject(state, "heaterOnS", e.heaterOnS[i]);
+        cJSON_AddNumberToObject(state, "wh", wh);
+        cJSON_AddNumberToObject(state, "dutyPct", e.stateS[i] ? 100.0 * e.heaterOnS[i] / e.stateS[i] : 0.0);
+    }
+    cJSON_AddNumberToObject(response, "totalWh", total_wh);
+    cJSON_AddNumberToObject(response, "elementW", e.elementW);
+    cJSON_AddNumberToObject(response, "dutyPct", e.dutyPct);
+    cJSON_AddNumberToObject(response, "pumpOnS", e.pumpOnS);
+    cJSON_AddNumberToObject(response, "heaterCycles", e.heaterCycles);
+    cJSON_AddNumberToObject(response, "pumpCycles", e.pumpCycles);
+    cJSON_AddNumberToObject(response, "shots", e.shots);
+    cJSON_AddNumberToObject(response, "boots", e.boots);
+    esp_err_t err = send_json_response(req, response);
+    cJSON_Delete(response);
+    return err;
+}
+
+// Indexed by EspNowLoopStage
+static const char *const LOOP_STAGE_NAMES[ESPNOW_LOOP_STAGE_COUNT] = {
+    "other", "link", "shot", "pid", "pwm", "pressure", "flow", "steam", "analytics", "cal", "params", "ota",
+    "telemetry", "log",
+};
+
+// Indexed by EspNowLoopHotSection
+static const char *const LOOP_HOT_NAMES[ESPNOW_LOOP_HOT_SECTIONS] = {"pid", "pressure", "flow"};
+
+static const char *loop_stage_name(uint8_t stage)
+{
+    return stage < ESPNOW_LOOP_STAGE_COUNT ? LOOP_STAGE_NAMES[stage] : "unknown";
+}
+
+static esp_err_t handle_get_loop(httpd_req_t *req)
+{
+    EspNowLoopStats st;
+    if (!Wireless_GetLoopStats(&st))
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No loop report from the controller yet");
+    cJSON *response = cJSON_CreateObject();
+    if (!response)
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+
+    cJSON_AddNumberToObject(response, "deadlineUs", st.deadlineUs);
+    cJSON_AddNumberToObject(response, "tripUs", st.tripUs);
+    cJSON_AddNumberToObject(response, "ticks", st.ticks);
+    cJSON_AddNumberToObject(response, "worstTickUs", st.worstTickUs);
+    cJSON_AddNumberToObject(response, "overruns", st.overruns);
+    cJSON_AddNumberToObject(response, "trips", st.trips);
+    cJSON_AddStringToObject(response, "lastOverrunStage", loop_stage_name(st.lastOverrunStage));
+    cJSON_AddStringToObject(response, "lastTripStage", loop_stage_name(st.lastTripStage));
+    cJSON_AddBoolToObject(response, "watchdogReset", (st.flags & ESPNOW_LOOP_FLAG_WDT_RESET) != 0);
+    cJSON *stages = cJSON_AddObjectToObject(response, "stages");
+    for (int i = 0; stages && i < ESPNOW_LOOP_STAGE_COUNT; ++i)
+    {
+        cJSON *stage = cJSON_AddObjectToObject(stages, LOOP_STAGE_NAMES[i]);
+        if (!stage)
+            break;
+        cJSON_AddNumberToObject(stage, "maxUs", st.stageMaxUs[i]);
+        cJSON_AddNumberToObject(stage, "overruns", st.stageOverruns[i]);
+    }
+    cJSON *hot = cJSON_AddObjectToObject(response, "hotPath");
+    if (hot)
+    {
+        double mhz = st.cpuMhz ? st.cpuMhz : 240.0;
+        cJSON_AddBoolToObject(hot, "iram", (st.flags & ESPNOW_LOOP_FLAG_IRAM) != 0);
+        cJSON_AddNumberToObject(hot, "cpuMhz", st.cpuMhz);
+        cJSON_AddNumberToObject(hot, "controlCore", st.controlCore);
+        for (int i = 0; i < ESPNOW_LOOP_HOT_SECTIONS; ++i)
+        {
+            cJSON *sec = cJSON_AddObjectToObject(hot, LOOP_HOT_NAMES[i]);
+            if (!sec)
+                break;
+            cJSON_AddNumberToObject(sec, "minUs", st.hotMinCycles[i] / mhz);
+            cJSON_AddNumberToObject(sec, "maxUs", st.hotMaxCycles[i] / mhz);
+            cJSON_AddNumberToObject(sec, "meanUs", st.hotMeanCycles[i] / mhz);
+            cJSON_AddNumberToObject(sec, "jitterUs", (st.hotMaxCycles[i] - st.hotMinCycles[i]) / mhz);
+        }
+    }
+    esp_err_t err = send_json_response(req, response);
+    cJSON_Delete(response);
+    return err;
+}
+
+// Indexed by EspNowStatsChannel
+static const char *const STATS_CHANNEL_NAMES[ESPNOW_STATS_CHANNELS] = {"tempC", "pressureBar", "pumpPct", "heaterPct"};
+
+// Min/max/mean of every sample in the last telemetry window, per channel.
+static esp_err_t handle_get_telemetry(httpd_req_t *req)
+{
+    EspNowTelemetryStats st;
+    if (!Wireless_GetTelemetryStats(&st))
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No telemetry window from the controller yet");
+    cJSON *response = cJSON_CreateObject();
+    if (!response)
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+
+    cJSON_AddNumberToObject(response, "windowMs", st.windowMs);
+    for (int i = 0; i < ESPNOW_STATS_CHANNELS; ++i)
+    {
+        cJSON *ch = cJSON_AddObjectToObject(response, STATS_CHANNEL_NAMES[i]);
+        if (!ch)
+            break;
+        cJSON_AddNumberToObject(ch, "min", st.stats[i].min);
+        cJSON_AddNumberToObject(ch, "max", st.stats[i].max);
+        cJSON_AddNumberToObject(ch, "mean", st.stats[i].mean);
+        cJSON_AddNumberToObject(ch, "last", st.stats[i].last);
+        cJSON_AddNumberToObject(ch, "count", st.stats[i].count);
+    }
+    esp_err_t err = send_json_response(req, response);
+    cJSON_Delete(response);
+    return err;
+}
+
+// Indexed by esp_reset_reason_t as reported by the controller.
+static const char *const RESET_REASON_NAMES[] = {
+    "unknown", "poweron", "external", "software", "panic", "int_wdt", "task_wdt", "wdt", "deepsleep",
+    "brownout", "sdio",
+};
+
+static const char *reset_reason_name(uint8_t reason)
+{
+    size_t n_reasons = sizeof(RESET_REASON_NAMES) / sizeof(RESET_REASON_NAMES[0]);
+    return reason < n_reasons ? RESET_REASON_NAMES[reason] : "other";
+}
+
+// Counters are since the controller booted; gauges are as of the report.
+static esp_err_t handle_get_health(httpd_req_t *req)
+{
+    EspNowHealth h;
+    int8_t rssi = 0;
+    if (!Wireless_GetHealth(&h, &rssi))
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No health report from the controller yet");
+    cJSON *response = cJSON_CreateObject();
+    if (!response)
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+
+    cJSON_AddNumberToObject(response, "uptimeS", h.uptimeS);
+    cJSON_AddStringToObject(response, "resetReason", reset_reason_name(h.resetReason));
+    cJSON_AddNumberToObject(response, "boots", h.boots);
+    cJSON_AddNumberToObject(response, "loopHz", h.loopHz);
+    cJSON *heap = cJSON_AddObjectToObject(response, "heap");
+    if (heap)
+    {
+        cJSON_AddNumberToObject(heap, "free", h.freeHeap);
+        cJSON_AddNumberToObject(heap, "minFree", h.minFreeHeap);
+        cJSON_AddNumberToObject(heap, "maxAlloc", h.maxAllocHeap);
+        cJSON_AddNumberToObject(heap, "loopStackFree", h.loopStackFree);
+    }
+    cJSON *isr = cJSON_AddObjectToObject(response, "interrupts");
+    if (isr)
+    {
+        cJSON_AddNumberToObject(isr, "zeroCross", h.zcIsrs);
+        cJSON_AddNumberToObject(isr, "flow", h.flowIsrs);
+        cJSON_AddNumberToObject(isr, "acSense", h.acIsrs);
+        cJSON_AddNumberToObject(isr, "phaseCyclesDropped", h.phaseCyclesDropped);
+    }
+    cJSON *link = cJSON_AddObjectToObject(response, "espnow");
+    if (link)
+    {
+        cJSON_AddNumberToObject(link, "channel", h.channel);
+        cJSON_AddNumberToObject(link, "rssi", rssi);
+        cJSON_AddNumberToObject(link, "sendOk", h.sendOk);
+        cJSON_AddNumberToObject(link, "sendNoAck", h.sendNoAck);
+        cJSON_AddNumberToObject(link, "sendErrors", h.sendErrors);
+        cJSON_AddNumberToObject(link, "recvFrames", h.recvFrames);
+    }
+    cJSON_AddNumberToObject(response, "logDropped", h.logDropped);
+    esp_err_t err = send_json_response(req, response);
+    cJSON_Delete(response);
+    return err;
+}
+
+static const char *const FLIGHT_FLAG_NAMES[8] = {
+    "heaterOn", "heaterEnabled", "shot", "steam", "pressureMode", "linked", "overrun", "trip",
+};
+
+// Columns, oldest first; tMs is relative to the last sample. Missing samples are skipped.
+static esp_err_t handle_get_flightrecord(httpd_req_t *req)
+{
+    WirelessFlightRecord *rec = malloc(sizeof(*rec));
+    if (!rec)
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+    if (!Wireless_GetFlightRecord(rec))
+    {
+        free(rec);
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No flight record from the controller");
+    }
+    cJSON *response = cJSON_CreateObject();
+    if (!response)
+    {
+        free(rec);
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+    }
+
+    cJSON_AddNumberToObject(response, "recordId", rec->recordId);
+    cJSON_AddStringToObject(response, "resetReason", reset_reason_name(rec->resetReason));
+    cJSON_AddStringToObject(response, "endStage", loop_stage_name(rec->endStage));
+    cJSON_AddNumberToObject(response, "samplePeriodMs", rec->samplePeriodMs);
+    cJSON_AddNumberToObject(response, "total", rec->total);
+    cJSON_AddNumberToObject(response, "received", rec->received);
+    cJSON_AddBoolToObject(response, "complete", rec->received == rec->total);
+    cJSON *bits = cJSON_AddObjectToObject(response, "flagBits");
+    for (int b = 0; bits && b < 8; ++b)
+        cJSON_AddNumberToObject(bits, FLIGHT_FLAG_NAMES[b], 1 << b);
+
+    cJSON *samples = cJSON_AddObjectToObject(response, "samples");
+    cJSON *t = samples ? cJSON_AddArrayToObject(samples, "tMs") : NULL;
+    cJSON *temp = samples ? cJSON_AddArrayToObject(samples, "tempC") : NULL;
+    cJSON *set = samples ? cJSON_AddArrayToObject(samples, "setC") : NULL;
+    cJSON *bar = samples ? cJSON_AddArrayToObject(samples, "bar") : NULL;
+    cJSON *heat = samples ? cJSON_AddArrayToObject(samples, "heatPct") : NULL;
+    cJSON *pump = samples ? cJSON_AddArrayToObject(samples, "pumpPct") : NULL;
+    cJSON *flags = samples ? cJSON_AddArrayToObject(samples, "flags") : NULL;
+    cJSON *pass = samples ? cJSON_AddArrayToObject(samples, "worstPassMs") : NULL;
+    cJSON *stage = samples ? cJSON_AddArrayToObject(samples, "worstStage") : NULL;
+    if (!t || !temp || !set || !bar || !heat || !pump || !flags || !pass || !stage)
+    {
+        cJSON_Delete(response);
+        free(rec);
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+    }
+    uint32_t last_ms = 0;
+    for (int i = 0; i < rec->total; ++i)
+        if (rec->have[i] && rec->samples[i].ms > last_ms)
+            last_ms = rec->samples[i].ms;
+    for (int i = 0; i < rec->total; ++i)
+    {
+        const EspNowFlightSample *sm = &rec->samples[i];
+        if (!rec->have[i])
+            continue;
+        cJSON_AddItemToArray(t, cJSON_CreateNumber((double)sm->ms - (double)last_ms));
+        cJSON_AddItemToArray(temp, cJSON_CreateNumber(sm->tempC100 / 100.0));
+        cJSON_AddItemToArray(set, cJSON_CreateNumber(sm->setC10 / 10.0));
+        cJSON_AddItemToArray(bar, cJSON_CreateNumber(sm->pressBar100 / 100.0));
+        cJSON_AddItemToArray(heat, cJSON_CreateNumber(sm->heatPct));
+        cJSON_AddItemToArray(pump, cJSON_CreateNumber(sm->pumpPct));
+        cJSON_AddItemToArray(flags, cJSON_CreateNumber(sm->flags));
+        cJSON_AddItemToArray(pass, cJSON_CreateNumber(sm->worstPass100us / 10.0));
+        cJSON_AddItemToArray(stage, cJSON_CreateString(loop_stage_name(sm->worstStage)));
+    }
+    free(rec);
+    esp_err_t err = send_json_response(req, response);
+    cJSON_Delete(response);
+    return err;
+}
+
+// Body: {"target":"flow|pressure","action":"start|finish|cancel|reset|status","reference":36.5,"unit":"g"}
+// Flow references are the dispensed volume (mL) or mass (g); pressure references are bar.
+static esp_err_t handle_post_calibration(httpd_req_t *req)
+{
+    char *body = NULL;
+    esp_err_t err = read_request_body(req, &body);
+    if (err != ESP_OK)
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid body");
+    cJSON *root = cJSON_Parse(body);
+    free(body);
+    if (!root)
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+
+    cJSON *target_item = cJSON_GetObjectItemCaseSensitive(root, "target");
+    cJSON *action_item = cJSON_GetObjectItemCaseSensitive(root, "action");
+    cJSON *reference_item = cJSON_GetObjectItemCaseSensitive(root, "reference");
+    cJSON *unit_item = cJSON_GetObjectItemCaseSensitive(root, "unit");
+    int target = lookup_name(CAL_TARGET_NAMES, sizeof(CAL_TARGET_NAMES) / sizeof(CAL_TARGET_NAMES[0]),
+                             cJSON_IsString(target_item) ? target_item->valuestring : NULL);
+    int action = lookup_name(CAL_ACTION_NAMES, sizeof(CAL_ACTION_NAMES) / sizeof(CAL_ACTION_NAMES[0]),
+                             cJSON_IsString(action_item) ? action_item->valuestring : NULL);
+    float reference = cJSON_IsNumber(reference_item) ? (float)reference_item->valuedouble : 0.0f;
+    uint8_t unit = ESPNOW_CAL_UNIT_ML;
+    if (cJSON_IsString(unit_item) && strcasecmp(unit_item->valuestring, "g") == 0)
+        unit = ESPNOW_CAL_UNIT_GRAM;
+    cJSON_Delete(root);
+
+    if (target < 0 || action < 0)
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Unknown target or action");
+    if (action == ESPNOW_CAL_ACTION_FINISH && target == ESPNOW_CAL_TARGET_FLOW && !(reference > 0.0f))
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "reference must be positive");
+    err = Wireless_SendCalCommand((uint8_t)target, (uint8_t)action, unit, reference);
+    if (err != ESP_OK)
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Controller not linked");
+
+    // The controller's report arrives asynchronously; poll GET for the result.
+    cJSON *response = cJSON_CreateObject();
+    if (!response)
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+    cJSON_AddStringToObject(response, "status", "sent");
+    err = send_json_response(req, response);
+    cJSON_Delete(response);
+    return err;
+}
+
+static const char *const PARAM_STATUS_NAMES[] = {"ok", "clamped", "unknown", "invalid"};
+
+// Registry parameters with their ranges and the controller's last reported
+// value (null until reported; missing values are requested again).
+static esp_err_t handle_get_params(httpd_req_t *req)
+{
+    cJSON *response = cJSON_CreateObject();
+    cJSON *list = response ? cJSON_AddArrayToObject(response, "params") : NULL;
+    if (!list)
+    {
+        cJSON_Delete(response);
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+    }
+    size_t n_status = sizeof(PARAM_STATUS_NAMES) / sizeof(PARAM_STATUS_NAMES[0]);
+    bool missing = false;
+    for (int i = 0; i < PARAM_COUNT; ++i)
+    {
+        const ParamDef *def = &PARAM_DEFS[i];
+        cJSON *p = cJSON_CreateObject();
+        if (!p)
+            break;
+        cJSON_AddItemToArray(list, p);
+        cJSON_AddNumberToObject(p, "id", def->id);
+        cJSON_AddStringToObject(p, "key", def->key);
+        cJSON_AddStringToObject(p, "type", def->type == PARAM_TYPE_UINT ? "uint" : "float");
+        cJSON_AddNumberToObject(p, "min", def->min);
+        cJSON_AddNumberToObject(p, "max", def->max);
+        cJSON_AddNumberToObject(p, "default", def->def);
+        cJSON_AddStringToObject(p, "unit", def->unit);
+        float value;
+        uint8_t status;
+        if (Wireless_GetParam(def->id, &value, &status))
+        {
+            cJSON_AddNumberToObject(p, "value", value);
+            cJSON_AddStringToObject(p, "status", status < n_status ? PARAM_STATUS_NAMES[status] : "other");
+        }
+        else
+        {
+            cJSON_AddNullToObject(p, "value");
+            missing = true;
+        }
+    }
+    if (missing)
+        Wireless_SendParamGet(NULL, 0);
+    esp_err_t err = send_json_response(req, response);
+    cJSON_Delete(response);
+    return err;
+}
+
+// Body: {"pumpKp":4.5,"pumpRampRate":30} with any registry keys. The controller
+// clamps each value to its range; poll GET for the values it applied.
+static esp_err_t handle_post_params(httpd_req_t *req)
+{
+    char *body = NULL;
+    esp_err_t err = read_request_body(req, &body);
+    if (err != ESP_OK)
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid body");
+    cJSON *root = cJSON_Parse(body);
+    free(body);
+    if (!cJSON_IsObject(root))
+    {
+        cJSON_Delete(root);
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+    }
+
+    EspNowParamValue values[ESPNOW_PARAM_MAX_ENTRIES];
+    uint8_t count = 0;
+    const cJSON *item;
+    cJSON_ArrayForEach(item, root)
+    {
+        int idx = param_index_by_key(item->string);
+        if (idx < 0 || !cJSON_IsNumber(item) || count == ESPNOW_PARAM_MAX_ENTRIES)
+        {
+            cJSON_Delete(root);
+            return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Unknown parameter or non-numeric value");
+        }
+        values[count++] = (EspNowParamValue){
+            .id = PARAM_DEFS[idx].id,
+            .value = (float)item->valuedouble,
+        };
+    }
+    cJSON_Delete(root);
+    if (count == 0)
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "No parameters");
+
+    err = Wireless_SendParamSet(values, count);
+    if (err != ESP_OK)
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Controller not linked");
+
+    cJSON *response = cJSON_CreateObject();
+    if (!response)
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+    cJSON_AddStringToObject(response, "status", "sent");
+    cJSON_AddNumberToObject(response, "count", count);
+    err = send_json_response(req, response);
+    cJSON_Delete(response);
+    return err;
+}
+
+static const char *const DAY_NAMES[] = {"sun", "mon", "tue", "wed", "thu", "fri", "sat"};
+
+static void add_local_time(cJSON *obj, const char *name, time_t t)
+{
+    if (!t)
+    {
+        cJSON_AddNullToObject(obj, name);
+        return;
+    }
+    struct tm tm;
+    char buf[24];
+    localtime_r(&t, &tm);
+    strftime(buf, sizeof buf, "%Y-%m-%dT%H:%M:%S", &tm);
+    cJSON_AddStringToObject(obj, name, buf);
+}
+
+static esp_err_t send_schedule(httpd_req_t *req)
+{
+    WarmupScheduleConfig cfg;
+    WarmupSchedulerStatus st;
+    if (WarmupScheduler_GetConfig(&cfg) != ESP_OK)
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Scheduler unavailable");
+    WarmupScheduler_GetStatus(&st);
+
+    cJSON *response = cJSON_CreateObject();
+    if (!response)
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+    cJSON_AddBoolToObject(response, "enabled", cfg.enabled);
+    cJSON *slots = cJSON_AddArrayToObject(response, "slots");
+    for (uint32_t i = 0; slots && i < cfg.slotCount; ++i)
+    {
+        cJSON *slot = cJSON_CreateObject();
+        if (!slot)
+            break;
+        cJSON *days = cJSON_AddArrayToObject(slot, "days");
+        for (int d = 0; days && d < 7; ++d)
+        {
+            if (cfg.slots[i].days & (1u << d))
+                cJSON_AddItemToArray(days, cJSON_CreateString(DAY_NAMES[d]));
+        }
+        char hhmm[8];
+        snprintf(hhmm, sizeof hhmm, "%02u:%02u", cfg.slots[i].hour % 24u, cfg.slots[i].minute % 60u);
+        cJSON_AddStringToObject(slot, "time", hhmm);
+        cJSON_AddBoolToObject(slot, "enabled", cfg.slots[i].enabled);
+        cJSON_AddItemToArray(slots, slot);
+    }
+    cJSON_AddNumberToObject(response, "ecoSetpoint", cfg.ecoSetpointC);
+    cJSON_AddNumberToObject(response, "ecoLeadMin", cfg.ecoLeadMin);
+    cJSON_AddNumberToObject(response, "soakMin", cfg.soakMin);
+    cJSON_AddNumberToObject(response, "holdMin", cfg.holdMin);
+    cJSON_AddNumberToObject(response, "heaterW", cfg.heaterW);
+    cJSON_AddNumberToObject(response, "idleWPerC", cfg.idleWPerC);
+    cJSON_AddNumberToObject(response, "ambientC", cfg.ambientC);
+    cJSON_AddStringToObject(response, "tz", cfg.tz);
+
+    cJSON *status = cJSON_AddObjectToObject(response, "status");
+    if (status)
+    {
+        cJSON_AddStringToObject(status, "state", WarmupScheduler_StateName(st.state));
+        add_local_time(status, "nextReady", st.nextReady);
+        add_local_time(status, "plannedStart", st.nextReady ? st.plannedStart : 0);
+        cJSON_AddNumberToObject(status, "predictedWarmupS", st.predictedWarmupS);
+        cJSON_AddNumberToObject(status, "modelOffsetS", st.modelOffsetS);
+        cJSON_AddNumberToObject(status, "modelSecPerC", st.modelPerC);
+        cJSON_AddNumberToObject(status, "modelSamples", st.modelSamples);
+        add_local_time(status, "lastScheduled", st.lastScheduled);
+        add_local_time(status, "lastPredicted", st.lastPredicted);
+        add_local_time(status, "lastActual", st.lastActual);
+        if (st.lastActual)
+            cJSON_AddNumberToObject(status, "lastErrorS", (double)(st.lastActual - st.lastPredicted));
+        cJSON_AddNumberToObject(status, "lastSavedWh", st.lastSavedWh);
+        cJSON_AddNumberToObject(status, "totalSavedWh", st.totalSavedWh);
+        cJSON_AddNumberToObject(status, "cycles", st.cycles);
+    }
+    esp_err_t err = send_json_response(req, response);
+    cJSON_Delete(response);
+    return err;
+}
+
+static esp_err_t handle_get_schedule(httpd_req_t *req)
+{
+    return send_schedule(req);
+}
+
+static bool parse_schedule_slot(const cJSON *item, WarmupSlot *out)
+{
+    if (!cJSON_IsObject(item))
+        return false;
+    const cJSON *days = cJSON_GetObjectItemCaseSensitive(item, "days");
+    const cJSON *time_item = cJSON_GetObjectItemCaseSensitive(item, "time");
+    const cJSON *enabled = cJSON_GetObjectItemCaseSensitive(item, "enabled");
+    unsigned hour = 0, minute = 0;
+    if (!cJSON_IsString(time_item) || sscanf(time_item->valuestring, "%u:%u", &hour, &minute) != 2)
+        return false;
+    memset(out, 0, sizeof(*out));
+    out->hour = (uint8_t)(hour > 255 ? 255 : hour);
+    out->minute = (uint8_t)(minute > 255 ? 255 : minute);
+    out->enabled = !cJSON_IsBool(enabled) || cJSON_IsTrue(enabled);
+    if (!cJSON_IsArray(days))
+        return false;
+    const cJSON *day = NULL;
+    cJSON_ArrayForEach(day, days)
+    {
+        int d = lookup_name(DAY_NAMES, 7, cJSON_IsString(day) ? day->valuestring : NULL);
+        if (d < 0)
+            return false;
+        out->days |= (uint8_t)(1u << d);
+    }
+    return true;
+}
+
+static void read_float_field(const cJSON *root, const char *name, float *out)
+{
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(root, name);
+    if (cJSON_IsNumber(item))
+        *out = (float)item->valuedouble;
+}
+
+static void read_u32_field(const cJSON *root, const char *name, uint32_t *out)
+{
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(root, name);
+    if (cJSON_IsNumber(item) && item->valuedouble >= 0)
+        *out = (uint32_t)item->valuedouble;
+}
+
+// Body: any subset of the GET fields except "status"; "slots" replaces the whole list.
+// {"enabled":true,"slots":[{"days":["mon","tue"],"time":"07:00"}],"ecoSetpoint":70,"ecoLeadMin":60}
+static esp_err_t handle_put_schedule(httpd_req_t *req)
+{
+    char *body = NULL;
+    esp_err_t err = read_request_body(req, &body);
+    if (err != ESP_OK)
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid body");
+    cJSON *root = cJSON_Parse(body);
+    free(body);
+    if (!cJSON_IsObject(root))
+    {
+        cJSON_Delete(root);
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+    }
+
+    WarmupScheduleConfig cfg;
+    if (WarmupScheduler_GetConfig(&cfg) != ESP_OK)
+    {
+        cJSON_Delete(root);
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Scheduler unavailable");
+    }
+    const cJSON *enabled = cJSON_GetObjectItemCaseSensitive(root, "enabled");
+    if (cJSON_IsBool(enabled))
+        cfg.enabled = cJSON_IsTrue(enabled);
+    const cJSON *slots = cJSON_GetObjectItemCaseSensitive(root, "slots");
+    if (slots)
+    {
+        if (!cJSON_IsArray(slots) || cJSON_GetArraySize(slots) > (int)WARMUP_SCHEDULER_MAX_SLOTS)
+        {
+            cJSON_Delete(root);
+            return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "slots must be an array of up to 8 entries");
+        }
+        cfg.slotCount = 0;
+        const cJSON *slot = NULL;
+        cJSON_ArrayForEach(slot, slots)
+        {
+            if (!parse_schedule_slot(slot, &cfg.slots[cfg.slotCount]))
+            {
+                cJSON_Delete(root);
+                return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST,
+                                           "slot needs \"days\" (sun..sat) and \"time\" (HH:MM)");
+            }
+            cfg.slotCount++;
+        }
+    }
+    read_float_field(root, "ecoSetpoint", &cfg.ecoSetpointC);
+    read_u32_field(root, "ecoLeadMin", &cfg.ecoLeadMin);
+    read_u32_field(root, "soakMin", &cfg.soakMin);
+    read_u32_field(root, "holdMin", &cfg.holdMin);
+    read_float_field(root, "heaterW", &cfg.heaterW);
+    read_float_field(root, "idleWPerC", &cfg.idleWPerC);
+    read_float_field(root, "ambientC", &cfg.ambientC);
+    const cJSON *tz = cJSON_GetObjectItemCaseSensitive(root, "tz");
+    bool tz_ok = true;
+    if (cJSON_IsString(tz))
+        tz_ok = strlcpy(cfg.tz, tz->valuestring, sizeof(cfg.tz)) < sizeof(cfg.tz);
+    cJSON_Delete(root);
+    if (!tz_ok)
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "tz too long");
+
+    err = WarmupScheduler_SetConfig(&cfg);
+    if (err == ESP_ERR_INVALID_ARG)
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Value out of range");
+    if (err != ESP_OK)
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to save schedule");
+    return send_schedule(req);
+}
+
 esp_err_t WebServer_Init(void)
 {
     if (s_initialized)
@@ -1237,6 +2001,7 @@ esp_err_t WebServer_Start(void)
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.lru_purge_enable = true;
     config.uri_match_fn = httpd_uri_match_wildcard;
+    config.max_uri_handlers = 24;
     esp_err_t err = httpd_start(&s_server, &config);
     if (err != ESP_OK)
     {
@@ -1288,11 +2053,116 @@ esp_err_t WebServer_Start(void)
     };
     httpd_register_uri_handler(s_server, &root_uri);
     httpd_register_uri_handler(s_server, &index_uri);
+    httpd_uri_t controller_fw_post = {
+        .uri = "/api/controller/firmware",
+        .method = HTTP_POST,
+        .handler = handle_post_controller_firmware,
+        .user_ctx = NULL,
+    };
+    httpd_uri_t controller_ota_get = {
+        .uri = "/api/controller/ota",
+        .method = HTTP_GET,
+        .handler = handle_get_controller_ota,
+        .user_ctx = NULL,
+    };
+    httpd_uri_t controller_ota_post = {
+        .uri = "/api/controller/ota",
+        .method = HTTP_POST,
+        .handler = handle_post_controller_ota,
+        .user_ctx = NULL,
+    };
+    httpd_uri_t controller_ota_delete = {
+        .uri = "/api/controller/ota",
+        .method = HTTP_DELETE,
+        .handler = handle_delete_controller_ota,
+        .user_ctx = NULL,
+    };
+    httpd_uri_t calibration_get = {
+        .uri = "/api/controller/calibration",
+        .method = HTTP_GET,
+        .handler = handle_get_calibration,
+        .user_ctx = NULL,
+    };
+    httpd_uri_t calibration_post = {
+        .uri = "/api/controller/calibration",
+        .method = HTTP_POST,
+        .handler = handle_post_calibration,
+        .user_ctx = NULL,
+    };
+    httpd_uri_t energy_get = {
+        .uri = "/api/controller/energy",
+        .method = HTTP_GET,
+        .handler = handle_get_energy,
+        .user_ctx = NULL,
+    };
+    httpd_uri_t loop_get = {
+        .uri = "/api/controller/loop",
+        .method = HTTP_GET,
+        .handler = handle_get_loop,
+        .user_ctx = NULL,
+    };
     httpd_register_uri_handler(s_server, &profiles_get);
     httpd_register_uri_handler(s_server, &profiles_post);
     httpd_register_uri_handler(s_server, &profiles_active_put);
     httpd_register_uri_handler(s_server, &profiles_put);
     httpd_register_uri_handler(s_server, &profiles_delete);
+    httpd_register_uri_handler(s_server, &controller_fw_post);
+    httpd_register_uri_handler(s_server, &controller_ota_get);
+    httpd_register_uri_handler(s_server, &controller_ota_post);
+    httpd_register_uri_handler(s_server, &controller_ota_delete);
+    httpd_register_uri_handler(s_server, &calibration_get);
+    httpd_register_uri_handler(s_server, &calibration_post);
+    httpd_register_uri_handler(s_server, &energy_get);
+    httpd_register_uri_handler(s_server, &loop_get);
+    httpd_uri_t telemetry_get = {
+        .uri = "/api/controller/telemetry",
+        .method = HTTP_GET,
+        .handler = handle_get_telemetry,
+        .user_ctx = NULL,
+    };
+    httpd_register_uri_handler(s_server, &telemetry_get);
+    httpd_uri_t health_get = {
+        .uri = "/api/controller/health",
+        .method = HTTP_GET,
+        .handler = handle_get_health,
+        .user_ctx = NULL,
+    };
+    httpd_register_uri_handler(s_server, &health_get);
+    httpd_uri_t flightrecord_get = {
+        .uri = "/api/controller/flightrecord",
+        .method = HTTP_GET,
+        .handler = handle_get_flightrecord,
+        .user_ctx = NULL,
+    };
+    httpd_register_uri_handler(s_server, &flightrecord_get);
+    httpd_uri_t params_get = {
+        .uri = "/api/controller/params",
+        .method = HTTP_GET,
+        .handler = handle_get_params,
+        .user_ctx = NULL,
+    };
+    httpd_uri_t params_post = {
+        .uri = "/api/controller/params",
+        .method = HTTP_POST,
+        .handler = handle_post_params,
+        .user_ctx = NULL,
+    };
+    httpd_register_uri_handler(s_server, &params_get);
+    httpd_register_uri_handler(s_server, &params_post);
+    httpd_uri_t schedule_get = {
+        .uri = "/api/schedule",
+        .method = HTTP_GET,
+        .handler = handle_get_schedule,
+        .user_ctx = NULL,
+    };
+    httpd_uri_t schedule_put = {
+        .uri = "/api/schedule",
+        .method = HTTP_PUT,
+        .handler = handle_put_schedule,
+        .user_ctx = NULL,
+    };
+    httpd_register_uri_handler(s_server, &schedule_get);
+    httpd_register_uri_handler(s_server, &schedule_put);
     ESP_LOGI(TAG, "HTTP server started");
     return ESP_OK;
 }
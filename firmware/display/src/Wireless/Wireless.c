@@ -6,6 +6,8 @@
 #include "esp_sntp.h"
 #include "esp_wifi.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/queue.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
 #include "freertos/timers.h"
@@ -14,8 +16,10 @@
 #include "secrets.h"
 #include "mqtt_topics.h"
 #include "espnow_protocol.h"
+#include "param_registry.h"
 #include "version.h"
 #include "WebServer.h"
+#include "ControllerOta.h"
 
 #include <math.h>
 #include <stdbool.h>
@@ -23,10 +27,16 @@
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
+#include <sys/time.h>
 #include <time.h>
 
 #define ESPNOW_TIMEOUT_MS 5000
 #define ESPNOW_PING_PERIOD_MS 1000
+#define ENERGY_PUBLISH_PERIOD_MS 60000
+// Control changes closer together than this go out as one packet.
+#define CONTROL_COALESCE_MS 30
+// Longest the wireless task sleeps without an event (MQTT start retries).
+#define WIRELESS_IDLE_MS 1000
 
 static const char *TAG_WIFI = "WiFi";
 static const char *TAG_MQTT = "MQTT";
@@ -47,6 +57,18 @@ static char TOPIC_SHOT[128];
 static char TOPIC_SHOT_TIME[128];
 static char TOPIC_ZC_COUNT_STATE[128];
 static char TOPIC_AC_COUNT_STATE[128];
+static char TOPIC_STEAM_LATENCY_STATE[128];
+static char TOPIC_SHOT_SUMMARY_STATE[128];
+static char TOPIC_WARMUP_STATE[128];
+static char TOPIC_ENERGY_STATE[128];
+static char TOPIC_HEATER_DUTY_STATE[128];
+static char TOPIC_LOOP_OVERRUNS_STATE[128];
+static char TOPIC_LOOP_TRIPS_STATE[128];
+static char TOPIC_LOOP_WORST_STATE[128];
+static char TOPIC_TELEMETRY_WINDOW_STATE[128];
+static char TOPIC_HEALTH_STATE[128];
+static char TOPIC_HEATER_MODES_STATE[128];
+static char TOPIC_CHANNELING_STATE[128];
 static char TOPIC_PULSE_COUNT_STATE[128];
 static char TOPIC_BREW_STATE[128];
 static char TOPIC_BREW_SET_CMD[128];
@@ -91,6 +113,27 @@ static inline void build_topics(void)
     snprintf(TOPIC_SHOT_TIME, sizeof TOPIC_SHOT_TIME, "%s/%s/shot_time/state", GAG_TOPIC_ROOT, GAGGIA_ID);
     snprintf(TOPIC_ZC_COUNT_STATE, sizeof TOPIC_ZC_COUNT_STATE, "%s/%s/zc_count/state", GAG_TOPIC_ROOT, GAGGIA_ID);
     snprintf(TOPIC_AC_COUNT_STATE, sizeof TOPIC_AC_COUNT_STATE, "%s/%s/ac_count/state", GAG_TOPIC_ROOT, GAGGIA_ID);
+    snprintf(TOPIC_STEAM_LATENCY_STATE, sizeof TOPIC_STEAM_LATENCY_STATE, "%s/%s/steam_latency/state", GAG_TOPIC_ROOT,
+             GAGGIA_ID);
+    snprintf(TOPIC_SHOT_SUMMARY_STATE, sizeof TOPIC_SHOT_SUMMARY_STATE, "%s/%s/shot_summary/state", GAG_TOPIC_ROOT,
+             GAGGIA_ID);
+    snprintf(TOPIC_WARMUP_STATE, sizeof TOPIC_WARMUP_STATE, "%s/%s/warmup/state", GAG_TOPIC_ROOT, GAGGIA_ID);
+    snprintf(TOPIC_ENERGY_STATE, sizeof TOPIC_ENERGY_STATE, "%s/%s/energy/state", GAG_TOPIC_ROOT, GAGGIA_ID);
+    snprintf(TOPIC_HEATER_DUTY_STATE, sizeof TOPIC_HEATER_DUTY_STATE, "%s/%s/heater_duty/state", GAG_TOPIC_ROOT,
+             GAGGIA_ID);
+    snprintf(TOPIC_LOOP_OVERRUNS_STATE, sizeof TOPIC_LOOP_OVERRUNS_STATE, "%s/%s/loop_overruns/state", GAG_TOPIC_ROOT,
+             GAGGIA_ID);
+    snprintf(TOPIC_LOOP_TRIPS_STATE, sizeof TOPIC_LOOP_TRIPS_STATE, "%s/%s/loop_trips/state", GAG_TOPIC_ROOT,
+             GAGGIA_ID);
+    snprintf(TOPIC_LOOP_WORST_STATE, sizeof TOPIC_LOOP_WORST_STATE, "%s/%s/loop_worst/state", GAG_TOPIC_ROOT,
+             GAGGIA_ID);
+    snprintf(TOPIC_TELEMETRY_WINDOW_STATE, sizeof TOPIC_TELEMETRY_WINDOW_STATE, "%s/%s/telemetry_window/state",
+             GAG_TOPIC_ROOT, GAGGIA_ID);
+    snprintf(TOPIC_HEALTH_STATE, sizeof TOPIC_HEALTH_STATE, "%s/%s/health/state", GAG_TOPIC_ROOT, GAGGIA_ID);
+    snprintf(TOPIC_HEATER_MODES_STATE, sizeof TOPIC_HEATER_MODES_STATE, "%s/%s/heater_modes/state", GAG_TOPIC_ROOT,
+             GAGGIA_ID);
+    snprintf(TOPIC_CHANNELING_STATE, sizeof TOPIC_CHANNELING_STATE, "%s/%s/channeling/state", GAG_TOPIC_ROOT,
+             GAGGIA_ID);
     snprintf(TOPIC_PULSE_COUNT_STATE, sizeof TOPIC_PULSE_COUNT_STATE, "%s/%s/pulse_count/state", GAG_TOPIC_ROOT, GAGGIA_ID);
     snprintf(TOPIC_BREW_STATE, sizeof TOPIC_BREW_STATE, "%s/%s/brew_setpoint/state", GAG_TOPIC_ROOT, GAGGIA_ID);
     snprintf(TOPIC_BREW_SET_CMD, sizeof TOPIC_BREW_SET_CMD, "%s/%s/brew_setpoint/set", GAG_TOPIC_ROOT, GAGGIA_ID);
@@ -150,6 +193,7 @@ typedef struct
     float pressureSetpoint;
     uint8_t pumpMode;
     bool pumpPressureMode;
+    float ecoSetpoint; // warm-up scheduler hold replacing the brew setpoint, 0 = off
 } ControlState;
 
 static const ControlState CONTROL_DEFAULTS = {
@@ -166,6 +210,7 @@ static const ControlState CONTROL_DEFAULTS = {
     .pressureSetpoint = 9.0f,
     .pumpMode = ESPNOW_PUMP_MODE_NORMAL,
     .pumpPressureMode = false,
+    .ecoSetpoint = 0.0f,
 };
 
 static ControlState s_control;
@@ -211,6 +256,10 @@ static char s_pub_zc_count[16];
 static bool s_pub_zc_count_valid = false;
 static char s_pub_ac_count[16];
 static bool s_pub_ac_count_valid = false;
+static char s_pub_steam_latency[16];
+static bool s_pub_steam_latency_valid = false;
+static bool s_pub_channeling = false;
+static bool s_pub_channeling_valid = false;
 static char s_pub_pulse_count[16];
 static bool s_pub_pulse_count_valid = false;
 static char s_pub_brew_setpoint[32];
@@ -227,6 +276,17 @@ static bool s_pub_steam = false;
 static bool s_pub_steam_valid = false;
 static bool s_pub_pump_pressure_mode = false;
 static bool s_pub_pump_pressure_mode_valid = false;
+static char s_pub_heater_duty[32];
+static bool s_pub_heater_duty_valid = false;
+static char s_pub_energy[512];
+static bool s_pub_energy_valid = false;
+static TickType_t s_pub_energy_tick = 0;
+static char s_pub_loop_overruns[16];
+static bool s_pub_loop_overruns_valid = false;
+static char s_pub_loop_trips[16];
+static bool s_pub_loop_trips_valid = false;
+static char s_pub_loop_worst[32];
+static bool s_pub_loop_worst_valid = false;
 
 typedef enum
 {
@@ -279,12 +339,86 @@ static bool s_control_dirty = false;
 
 static esp_now_peer_info_t s_broadcast_peer = {0};
 static esp_now_peer_info_t s_controller_peer = {0};
+static EspNowCalReport s_cal_report[ESPNOW_CAL_TARGET_PRESSURE + 1];
+static bool s_cal_report_valid[ESPNOW_CAL_TARGET_PRESSURE + 1];
+static EspNowEnergy s_energy;
+static bool s_energy_valid = false;
+static EspNowLoopStats s_loop_stats;
+static bool s_loop_stats_valid = false;
+static EspNowTelemetryStats s_telemetry_stats;
+static bool s_telemetry_stats_valid = false;
+static EspNowHealth s_health;
+static bool s_health_valid = false;
+// Signal strength of the last frame from the controller (dBm), 0 before the first.
+static int8_t s_controller_rssi = 0;
+static WirelessFlightRecord s_flight;
+static bool s_flight_valid = false;
+// Registry parameters as last reported by the controller, indexed like PARAM_DEFS.
+static float s_params[PARAM_COUNT];
+static uint8_t s_param_status[PARAM_COUNT];
+static bool s_param_valid[PARAM_COUNT];
+static uint8_t s_param_seq = 0;
+static uint8_t s_param_subscribe_seq = 0;
+static bool s_param_subscribed = false; // the controller answered our subscribe
+static volatile bool s_param_subscribe_req = false;
+static volatile bool s_param_sync_req = false;
 static bool s_controller_peer_valid = false;
 
 static TimerHandle_t s_espnow_timer = NULL;
 static TimerHandle_t s_espnow_ping_timer = NULL;
-static volatile bool s_espnow_timeout_req = false;
-static volatile bool s_espnow_ping_req = false;
+
+// Work for Wireless_Task, raised by the timers, the ESP-NOW receive path and the setters.
+#define WIRELESS_EVT_TIMEOUT (1u << 0) // no packets within ESPNOW_TIMEOUT_MS
+#define WIRELESS_EVT_PING (1u << 1)    // handshake/keepalive due
+#define WIRELESS_EVT_CONTROL (1u << 2) // s_control_dirty set
+#define WIRELESS_EVT_PARAMS (1u << 3)  // parameter subscribe or sync requested
+#define WIRELESS_EVT_MQTT (1u << 4)    // Wi-Fi up, MQTT may start
+#define WIRELESS_EVT_ALL (WIRELESS_EVT_TIMEOUT | WIRELESS_EVT_PING | WIRELESS_EVT_CONTROL | WIRELESS_EVT_PARAMS | WIRELESS_EVT_MQTT)
+static EventGroupHandle_t s_wireless_events = NULL;
+
+// Latest controller report of each kind for Mqtt_PublishTask: a length-1
+// queue written with xQueueOverwrite plus a bit saying it was refreshed. The
+// receive callback never waits on the broker, and a report the publisher has
+// not reached yet is replaced by the newer one.
+#define MQTT_PUB_SENSOR (1u << 0)
+#define MQTT_PUB_HEALTH (1u << 1)
+#define MQTT_PUB_ENERGY (1u << 2)
+#define MQTT_PUB_LOOP_STATS (1u << 3)
+#define MQTT_PUB_TELEMETRY (1u << 4)
+#define MQTT_PUB_SHOT_SUMMARY (1u << 5)
+#define MQTT_PUB_HEATER_MODES (1u << 6)
+#define MQTT_PUB_ALL (MQTT_PUB_SENSOR | MQTT_PUB_HEALTH | MQTT_PUB_ENERGY | MQTT_PUB_LOOP_STATS | \
+                      MQTT_PUB_TELEMETRY | MQTT_PUB_SHOT_SUMMARY | MQTT_PUB_HEATER_MODES)
+static EventGroupHandle_t s_pub_events = NULL;
+static QueueHandle_t s_sensor_slot = NULL;
+static QueueHandle_t s_health_slot = NULL;
+static QueueHandle_t s_energy_slot = NULL;
+static QueueHandle_t s_loop_stats_slot = NULL;
+static QueueHandle_t s_telemetry_slot = NULL;
+static QueueHandle_t s_shot_summary_slot = NULL;
+static QueueHandle_t s_heater_modes_slot = NULL;
+
+static QueueHandle_t pub_slot_create(UBaseType_t size)
+{
+    QueueHandle_t slot = xQueueCreate(1, size);
+    ESP_ERROR_CHECK(slot ? ESP_OK : ESP_ERR_NO_MEM);
+    return slot;
+}
+
+static void pub_slot_offer(QueueHandle_t slot, EventBits_t bit, const void *msg)
+{
+    if (!slot || !s_pub_events)
+        return;
+    xQueueOverwrite(slot, msg);
+    xEventGroupSetBits(s_pub_events, bit);
+}
+
+static void wireless_notify(EventBits_t bits)
+{
+    // Before Wireless_Init the task's first pass picks up whatever flag was set.
+    if (s_wireless_events)
+        xEventGroupSetBits(s_wireless_events, bits);
+}
 
 static const uint8_t s_broadcast_addr[ESP_NOW_ETH_ALEN] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
 
@@ -407,6 +541,7 @@ static uint8_t apply_steam_request(bool steam)
 // Forward declarations
 // -----------------------------------------------------------------------------
 static bool publish_control_state(void);
+esp_err_t Wireless_SendToController(const uint8_t *data, size_t len);
 static void schedule_control_send(void);
 static void send_control_packet(void);
 static void ensure_espnow_started(void);
@@ -414,6 +549,7 @@ static void stop_espnow(void);
 static void espnow_timeout_cb(TimerHandle_t xTimer);
 static void espnow_ping_cb(TimerHandle_t xTimer);
 static void Wireless_Task(void *arg);
+static void Mqtt_PublishTask(void *arg);
 static void espnow_recv_cb(const esp_now_recv_info_t *info, const uint8_t *data, int data_len);
 static void start_mdns_service(void);
 static void stop_mdns_service(void);
@@ -486,6 +622,7 @@ static void on_ip_event(void *arg, esp_event_base_t base, int32_t id, void *data
         ip_event_got_ip_t *event = (ip_event_got_ip_t *)data;
         ESP_LOGI(TAG_WIFI, "Got IP: %d.%d.%d.%d", IP2STR(&event->ip_info.ip));
         s_wifi_ready = true;
+        wireless_notify(WIRELESS_EVT_MQTT);
         esp_err_t err = WebServer_Start();
         if (err != ESP_OK)
         {
@@ -578,8 +715,22 @@ void Wireless_Init(void)
     }
     ESP_ERROR_CHECK(ret);
 
+    s_wireless_events = xEventGroupCreate();
+    ESP_ERROR_CHECK(s_wireless_events ? ESP_OK : ESP_ERR_NO_MEM);
+    s_sensor_slot = pub_slot_create(sizeof(EspNowPacket));
+    s_health_slot = pub_slot_create(sizeof(EspNowHealth));
+    s_energy_slot = pub_slot_create(sizeof(EspNowEnergy));
+    s_loop_stats_slot = pub_slot_create(sizeof(EspNowLoopStats));
+    s_telemetry_slot = pub_slot_create(sizeof(EspNowTelemetryStats));
+    s_shot_summary_slot = pub_slot_create(sizeof(EspNowShotSummary));
+    s_heater_modes_slot = pub_slot_create(sizeof(EspNowHeaterModes));
+    s_pub_events = xEventGroupCreate();
+    ESP_ERROR_CHECK(s_pub_events ? ESP_OK : ESP_ERR_NO_MEM);
     xTaskCreatePinnedToCore(WIFI_Init, "wifi", 4096, NULL, 3, NULL, 0);
     xTaskCreatePinnedToCore(Wireless_Task, "wireless", 4096, NULL, 3, NULL, 0);
+    // Below the wireless task, so a slow broker never holds up control packets.
+    // The stack covers the largest JSON report plus the MQTT client's publish path.
+    xTaskCreatePinnedToCore(Mqtt_PublishTask, "mqtt_pub", 6144, NULL, 2, NULL, 0);
 }
 
 // -----------------------------------------------------------------------------
@@ -683,6 +834,31 @@ static void publish_bool_topic_if_changed(const char *topic, bool value, bool *l
     *valid = true;
 }
 
+// Last warm-up report, held until it reaches the broker: the overnight cycle
+// usually finishes while standby has MQTT stopped.
+static char s_warmup_report[384];
+static bool s_warmup_report_pending = false;
+static portMUX_TYPE s_warmup_report_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void publish_pending_warmup_report(void)
+{
+    char json[sizeof s_warmup_report];
+    taskENTER_CRITICAL(&s_warmup_report_lock);
+    bool pending = s_warmup_report_pending;
+    if (pending)
+        memcpy(json, s_warmup_report, sizeof json);
+    taskEXIT_CRITICAL(&s_warmup_report_lock);
+    if (!pending || !s_mqtt || !s_mqtt_connected)
+        return;
+    if (esp_mqtt_client_publish(s_mqtt, TOPIC_WARMUP_STATE, json, 0, 1, true) < 0)
+        return;
+    taskENTER_CRITICAL(&s_warmup_report_lock);
+    // A newer report that arrived meanwhile stays pending.
+    if (strcmp(json, s_warmup_report) == 0)
+        s_warmup_report_pending = false;
+    taskEXIT_CRITICAL(&s_warmup_report_lock);
+}
+
 static void reset_sensor_publish_cache(void)
 {
     s_pub_curtemp_valid = false;
@@ -693,6 +869,8 @@ static void reset_sensor_publish_cache(void)
     s_pub_shot_time_valid = false;
     s_pub_zc_count_valid = false;
     s_pub_ac_count_valid = false;
+    s_pub_steam_latency_valid = false;
+    s_pub_channeling_valid = false;
     s_pub_pulse_count_valid = false;
     s_pub_brew_setpoint_valid = false;
     s_pub_steam_setpoint_valid = false;
@@ -701,6 +879,11 @@ static void reset_sensor_publish_cache(void)
     s_pub_heater_valid = false;
     s_pub_steam_valid = false;
     s_pub_pump_pressure_mode_valid = false;
+    s_pub_heater_duty_valid = false;
+    s_pub_energy_valid = false;
+    s_pub_loop_overruns_valid = false;
+    s_pub_loop_trips_valid = false;
+    s_pub_loop_worst_valid = false;
 }
 
 #if defined(MQTT_STATUS) && defined(GAGGIA_ID)
@@ -717,6 +900,20 @@ static bool s_shot_time_discovery_published = false;
 static bool s_shot_legacy_discovery_published = false;
 static bool s_zc_count_discovery_published = false;
 static bool s_ac_count_discovery_published = false;
+static bool s_steam_latency_discovery_published = false;
+static bool s_shot_summary_discovery_published = false;
+static bool s_warmup_discovery_published = false;
+static bool s_energy_discovery_published = false;
+static bool s_heater_duty_discovery_published = false;
+static bool s_loop_overruns_discovery_published = false;
+static bool s_loop_trips_discovery_published = false;
+static bool s_loop_worst_discovery_published = false;
+static bool s_telemetry_window_discovery_published = false;
+static bool s_health_heap_discovery_published = false;
+static bool s_health_rssi_discovery_published = false;
+static bool s_steam_ready_discovery_published = false;
+static bool s_brew_recovery_discovery_published = false;
+static bool s_channeling_discovery_published = false;
 static bool s_pulse_count_discovery_published = false;
 static bool s_pid_p_discovery_published = false;
 static bool s_pid_i_discovery_published = false;
@@ -920,6 +1117,47 @@ static bool publish_switch_discovery(const char *name, const char *suffix, const
     return false;
 }
 
+// Sensor whose state is one field of a JSON document; every field becomes an attribute.
+static void publish_json_sensor_discovery(const char *name, const char *suffix, const char *state_topic,
+                                          const char *value_field, const char *dev_class, const char *state_class,
+                                          const char *unit, const char *icon, bool *flag)
+{
+    if (!s_mqtt || *flag)
+        return;
+
+    char dev_id[64];
+    snprintf(dev_id, sizeof dev_id, "%s-%s", GAG_TOPIC_ROOT, GAGGIA_ID);
+
+    char topic[128];
+    snprintf(topic, sizeof topic, "homeassistant/sensor/%s_%s/config", dev_id, suffix);
+
+    char payload[640];
+    int written = snprintf(payload, sizeof payload,
+                           "{\"name\":\"%s\",\"uniq_id\":\"%s_%s\",\"stat_t\":\"%s\","\
+                           "\"val_tpl\":\"{{ value_json.%s }}\",\"json_attr_t\":\"%s\","\
+                           "\"dev_cla\":\"%s\",\"stat_cla\":\"%s\",\"unit_of_meas\":\"%s\",\"icon\":\"%s\","\
+                           "\"avty_t\":\"%s\",\"pl_avail\":\"online\",\"pl_not_avail\":\"offline\","\
+                           "\"dev\":{\"identifiers\":[\"%s\"],\"name\":\"Gaggia Classic\",\"manufacturer\":\"Custom\","\
+                           "\"model\":\"Gagguino\",\"sw_version\":\"%s\"}}",
+                           name, dev_id, suffix, state_topic, value_field, state_topic, dev_class, state_class, unit, icon,
+                           MQTT_STATUS, dev_id, VERSION);
+    if (written <= 0 || written >= (int)sizeof(payload))
+    {
+        ESP_LOGW(TAG_MQTT, "%s discovery payload truncated", name);
+        return;
+    }
+    int res = esp_mqtt_client_publish(s_mqtt, topic, payload, 0, 1, true);
+    if (res >= 0)
+    {
+        *flag = true;
+        ESP_LOGI(TAG_MQTT, "Published %s discovery", name);
+    }
+    else
+    {
+        ESP_LOGW(TAG_MQTT, "Failed to publish %s discovery: %d", name, res);
+    }
+}
+
 static void publish_pid_discovery(void)
 {
     publish_number_discovery("PID P", "pid_p", TOPIC_PIDP_CMD, TOPIC_PIDP_STATE, 0.0f, 100.0f, 0.1f, "",
@@ -977,6 +1215,37 @@ static void publish_all_discovery(void)
                              "mdi:counter", &s_pulse_count_discovery_published);
     publish_sensor_discovery("Steam AC Count", "ac_count", TOPIC_AC_COUNT_STATE, "", "measurement", "count", "mdi:flash",
                              &s_ac_count_discovery_published);
+    publish_sensor_discovery("Steam Detect Latency", "steam_latency", TOPIC_STEAM_LATENCY_STATE, "duration",
+                             "measurement", "ms", "mdi:timer-outline", &s_steam_latency_discovery_published);
+    publish_sensor_discovery("Channeling", "channeling", TOPIC_CHANNELING_STATE, "", "", "", "mdi:water-alert",
+                             &s_channeling_discovery_published);
+    publish_json_sensor_discovery("Last Shot", "shot_summary", TOPIC_SHOT_SUMMARY_STATE, "duration_s", "duration",
+                                  "measurement", "s", "mdi:coffee", &s_shot_summary_discovery_published);
+    publish_json_sensor_discovery("Last Warm-up", "warmup", TOPIC_WARMUP_STATE, "error_s", "duration", "measurement",
+                                  "s", "mdi:alarm", &s_warmup_discovery_published);
+    publish_json_sensor_discovery("Heater Energy", "energy", TOPIC_ENERGY_STATE, "total_wh", "energy",
+                                  "total_increasing", "Wh", "mdi:lightning-bolt", &s_energy_discovery_published);
+    publish_sensor_discovery("Heater Duty", "heater_duty", TOPIC_HEATER_DUTY_STATE, "", "measurement", "%",
+                             "mdi:radiator", &s_heater_duty_discovery_published);
+    publish_sensor_discovery("Control Loop Overruns", "loop_overruns", TOPIC_LOOP_OVERRUNS_STATE, "", "total_increasing",
+                             "", "mdi:timer-alert-outline", &s_loop_overruns_discovery_published);
+    publish_sensor_discovery("Control Loop Trips", "loop_trips", TOPIC_LOOP_TRIPS_STATE, "", "total_increasing", "",
+                             "mdi:shield-alert-outline", &s_loop_trips_discovery_published);
+    publish_sensor_discovery("Control Loop Worst Pass", "loop_worst", TOPIC_LOOP_WORST_STATE, "duration",
+                             "measurement", "ms", "mdi:timer-outline", &s_loop_worst_discovery_published);
+    publish_json_sensor_discovery("Peak Pressure", "telemetry_window", TOPIC_TELEMETRY_WINDOW_STATE, "pressure_max",
+                                  "pressure", "measurement", "bar", "mdi:gauge",
+                                  &s_telemetry_window_discovery_published);
+    publish_json_sensor_discovery("Controller Free Heap", "health_heap", TOPIC_HEALTH_STATE, "free_heap", "data_size",
+                                  "measurement", "B", "mdi:memory", &s_health_heap_discovery_published);
+    publish_json_sensor_discovery("Controller Signal", "health_rssi", TOPIC_HEALTH_STATE, "rssi", "signal_strength",
+                                  "measurement", "dBm", "mdi:wifi", &s_health_rssi_discovery_published);
+    publish_json_sensor_discovery("Steam Ready Time", "steam_ready", TOPIC_HEATER_MODES_STATE, "steam_ready_s",
+                                  "duration", "measurement", "s", "mdi:kettle-steam",
+                                  &s_steam_ready_discovery_published);
+    publish_json_sensor_discovery("Brew Recovery Time", "brew_recovery", TOPIC_HEATER_MODES_STATE, "brew_recovery_s",
+                                  "duration", "measurement", "s", "mdi:coffee-maker",
+                                  &s_brew_recovery_discovery_published);
     publish_pid_discovery();
 }
 
@@ -995,6 +1264,20 @@ static void reset_discovery_flags(void)
     s_shot_legacy_discovery_published = false;
     s_zc_count_discovery_published = false;
     s_ac_count_discovery_published = false;
+    s_steam_latency_discovery_published = false;
+    s_shot_summary_discovery_published = false;
+    s_warmup_discovery_published = false;
+    s_energy_discovery_published = false;
+    s_heater_duty_discovery_published = false;
+    s_loop_overruns_discovery_published = false;
+    s_loop_trips_discovery_published = false;
+    s_loop_worst_discovery_published = false;
+    s_telemetry_window_discovery_published = false;
+    s_health_heap_discovery_published = false;
+    s_health_rssi_discovery_published = false;
+    s_steam_ready_discovery_published = false;
+    s_brew_recovery_discovery_published = false;
+    s_channeling_discovery_published = false;
     s_pulse_count_discovery_published = false;
     s_pid_p_discovery_published = false;
     s_pid_i_discovery_published = false;
@@ -1079,6 +1362,7 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
         {
             s_control_publish_pending = false;
         }
+        publish_pending_warmup_report();
         break;
     case MQTT_EVENT_DISCONNECTED:
         ESP_LOGW(TAG_MQTT, "Disconnected");
@@ -1621,7 +1905,7 @@ static void ensure_espnow_started(void)
     s_use_espnow = false;
     s_controller_peer_valid = false;
     s_espnow_last_rx = 0;
-    s_espnow_ping_req = true; // send handshake immediately
+    wireless_notify(WIRELESS_EVT_PING); // send handshake immediately
     ESP_LOGI(TAG_ESPNOW, "Initialised on channel %u", (unsigned)s_sta_channel);
 }
 
@@ -1638,19 +1922,20 @@ static void stop_espnow(void)
     s_espnow_handshake = false;
     s_use_espnow = false;
     s_controller_peer_valid = false;
+    s_param_subscribed = false;
     ESP_LOGW(TAG_ESPNOW, "Stopped");
 }
 
 static void espnow_timeout_cb(TimerHandle_t xTimer)
 {
     (void)xTimer;
-    s_espnow_timeout_req = true;
+    wireless_notify(WIRELESS_EVT_TIMEOUT);
 }
 
 static void espnow_ping_cb(TimerHandle_t xTimer)
 {
     (void)xTimer;
-    s_espnow_ping_req = true;
+    wireless_notify(WIRELESS_EVT_PING);
 }
 
 static void update_controller_peer(const uint8_t *addr)
@@ -1690,6 +1975,31 @@ static void send_sensor_ack(const uint8_t *dest)
     esp_now_send(dest, &ack, 1);
 }
 
+// Earliest UTC second accepted as a real (NTP-set) wall clock: 2024-01-01.
+#define TIME_VALID_AFTER_S 1704067200LL
+
+static int64_t utc_now_us(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+static void send_time_response(const uint8_t *dest, const EspNowTimeRequest *req, int64_t rx_us)
+{
+    if (!s_espnow_active || !dest)
+        return;
+    EspNowTimeResponse resp = {
+        .type = ESPNOW_TIME_RESPONSE,
+        .seq = req->seq,
+        .flags = rx_us >= TIME_VALID_AFTER_S * 1000000LL ? ESPNOW_TIME_FLAG_VALID : 0,
+        .originUs = req->originUs,
+        .receiveUs = rx_us,
+    };
+    resp.transmitUs = utc_now_us();
+    esp_now_send(dest, (const uint8_t *)&resp, sizeof(resp));
+}
+
 static void send_control_packet(void)
 {
     if (!s_espnow_active || !s_use_espnow)
@@ -1705,7 +2015,7 @@ static void send_control_packet(void)
         .type = ESPNOW_CONTROL_PACKET,
         .flags = 0,
         .pumpMode = s_control.pumpMode,
-        .reserved = 0,
+        .ecoSetpointC = s_control.ecoSetpoint > 0.0f ? (uint8_t)lroundf(s_control.ecoSetpoint) : 0,
         .revision = revision,
         .brewSetpointC = s_control.brewSetpoint,
         .steamSetpointC = s_control.steamSetpoint,
@@ -1734,19 +2044,231 @@ static void send_control_packet(void)
         s_control_dirty = false;
         ESP_LOGI(TAG_ESPNOW,
                  "Control sent rev %u: heater=%d steam=%d brew=%.1f steamSet=%.1f pidP=%.2f pidI=%.2f "
-                 "pidGuard=%.2f pidD=%.2f dTau=%0.2f pump=%.1f mode=%u pressSet=%.1f pressMode=%d",
+                 "pidGuard=%.2f pidD=%.2f dTau=%0.2f pump=%.1f mode=%u pressSet=%.1f pressMode=%d eco=%.0f",
                  (unsigned)revision, s_control.heater, s_control.steam,
                  (double)s_control.brewSetpoint, (double)s_control.steamSetpoint,
                  (double)s_control.pidP, (double)s_control.pidI, (double)s_control.pidGuard,
                  (double)s_control.pidD, (double)s_control.dTau, (double)s_control.pumpPower,
                  (unsigned)s_control.pumpMode, (double)s_control.pressureSetpoint,
-                 s_control.pumpPressureMode ? 1 : 0);
+                 s_control.pumpPressureMode ? 1 : 0, (double)s_control.ecoSetpoint);
     }
 }
 
+esp_err_t Wireless_SendToController(const uint8_t *data, size_t len)
+{
+    if (!s_espnow_active || !s_controller_peer_valid)
+        return ESP_ERR_INVALID_STATE;
+    return esp_now_send(s_controller_peer.peer_addr, data, len);
+}
+
+esp_err_t Wireless_SendCalCommand(uint8_t target, uint8_t action, uint8_t unit, float reference)
+{
+    EspNowCalCommand cmd = {
+        .type = ESPNOW_CAL_COMMAND,
+        .target = target,
+        .action = action,
+        .unit = unit,
+        .reference = reference,
+    };
+    return Wireless_SendToController((const uint8_t *)&cmd, sizeof(cmd));
+}
+
+bool Wireless_GetCalReport(uint8_t target, EspNowCalReport *out)
+{
+    if (!out || target > ESPNOW_CAL_TARGET_PRESSURE || !s_cal_report_valid[target])
+        return false;
+    memcpy(out, &s_cal_report[target], sizeof(*out));
+    return true;
+}
+
+bool Wireless_GetEnergy(EspNowEnergy *out)
+{
+    if (!out || !s_energy_valid)
+        return false;
+    memcpy(out, &s_energy, sizeof(*out));
+    return true;
+}
+
+bool Wireless_GetHealth(EspNowHealth *out, int8_t *rssi)
+{
+    if (!out || !s_health_valid)
+        return false;
+    memcpy(out, &s_health, sizeof(*out));
+    if (rssi)
+        *rssi = s_controller_rssi;
+    return true;
+}
+
+bool Wireless_GetTelemetryStats(EspNowTelemetryStats *out)
+{
+    if (!out || !s_telemetry_stats_valid)
+        return false;
+    memcpy(out, &s_telemetry_stats, sizeof(*out));
+    return true;
+}
+
+bool Wireless_GetLoopStats(EspNowLoopStats *out)
+{
+    if (!out || !s_loop_stats_valid)
+        return false;
+    memcpy(out, &s_loop_stats, sizeof(*out));
+    return true;
+}
+
+bool Wireless_GetFlightRecord(WirelessFlightRecord *out)
+{
+    if (!out || !s_flight_valid)
+        return false;
+    memcpy(out, &s_flight, sizeof(*out));
+    return true;
+}
+
+static uint8_t next_param_seq(void)
+{
+    if (++s_param_seq == 0)
+        s_param_seq = 1;
+    return s_param_seq;
+}
+
+esp_err_t Wireless_SendParamSet(const EspNowParamValue *values, uint8_t count)
+{
+    if (!values || count == 0 || count > ESPNOW_PARAM_MAX_ENTRIES)
+        return ESP_ERR_INVALID_ARG;
+    EspNowParamValues req = {
+        .type = ESPNOW_PARAM_SET,
+        .seq = next_param_seq(),
+        .count = count,
+    };
+    memcpy(req.values, values, count * sizeof(values[0]));
+    return Wireless_SendToController((const uint8_t *)&req, ESPNOW_PARAM_VALUES_LEN(count));
+}
+
+static esp_err_t send_param_ids(uint8_t type, const uint16_t *ids, uint8_t count, uint8_t *seq)
+{
+    if (count > ESPNOW_PARAM_MAX_ENTRIES || (count && !ids))
+        return ESP_ERR_INVALID_ARG;
+    EspNowParamIds req = {
+        .type = type,
+        .seq = next_param_seq(),
+        .count = count,
+    };
+    for (uint8_t i = 0; i < count; ++i)
+        req.ids[i] = ids[i];
+    if (seq)
+        *seq = req.seq;
+    return Wireless_SendToController((const uint8_t *)&req, ESPNOW_PARAM_IDS_LEN(count));
+}
+
+esp_err_t Wireless_SendParamGet(const uint16_t *ids, uint8_t count)
+{
+    return send_param_ids(ESPNOW_PARAM_GET, ids, count, NULL);
+}
+
+bool Wireless_GetParam(uint16_t id, float *value, uint8_t *status)
+{
+    int idx = param_index(id);
+    if (idx < 0 || !s_param_valid[idx])
+        return false;
+    if (value)
+        *value = s_params[idx];
+    if (status)
+        *status = s_param_status[idx];
+    return true;
+}
+
+static void handle_param_report(const EspNowParamValues *rpt)
+{
+    for (int i = 0; i < rpt->count; ++i)
+    {
+        const EspNowParamValue *v = &rpt->values[i];
+        int idx = param_index(v->id);
+        if (idx < 0)
+            continue;
+        if (v->status == ESPNOW_PARAM_STATUS_UNKNOWN)
+        {
+            ESP_LOGW(TAG_ESPNOW, "Controller does not know parameter %s", PARAM_DEFS[idx].key);
+            continue;
+        }
+        s_params[idx] = v->value;
+        s_param_status[idx] = v->status;
+        s_param_valid[idx] = true;
+    }
+    if (rpt->seq && rpt->seq == s_param_subscribe_seq)
+        s_param_subscribed = true;
+    s_param_sync_req = true;
+    wireless_notify(WIRELESS_EVT_PARAMS);
+}
+
+// Mirror reported parameters that the control packet also carries, so the next
+// control packet does not undo a change made through the registry.
+static void sync_control_from_params(void)
+{
+    if (s_control_dirty)
+        return;
+    struct
+    {
+        ParamIndex idx;
+        float *field;
+    } mirrored[] = {
+        {PARAM_INDEX_BREW_SETPOINT, &s_control.brewSetpoint},
+        {PARAM_INDEX_STEAM_SETPOINT, &s_control.steamSetpoint},
+        {PARAM_INDEX_HEATER_KP, &s_control.pidP},
+        {PARAM_INDEX_HEATER_KI, &s_control.pidI},
+        {PARAM_INDEX_HEATER_KD, &s_control.pidD},
+        {PARAM_INDEX_HEATER_I_GUARD, &s_control.pidGuard},
+        {PARAM_INDEX_HEATER_DTAU, &s_control.dTau},
+        {PARAM_INDEX_PUMP_POWER, &s_control.pumpPower},
+        {PARAM_INDEX_PRESSURE_SETPOINT, &s_control.pressureSetpoint},
+    };
+    bool changed = false;
+    for (size_t i = 0; i < sizeof(mirrored) / sizeof(mirrored[0]); ++i)
+    {
+        int idx = mirrored[i].idx;
+        if (!s_param_valid[idx] || float_equals(s_params[idx], *mirrored[i].field, CONTROL_PID_TOLERANCE))
+            continue;
+        *mirrored[i].field = s_params[idx];
+        changed = true;
+    }
+    if (changed)
+        s_control_publish_pending = !publish_control_state();
+}
+
+static void handle_flight_chunk(const EspNowFlightChunk *c)
+{
+    if (c->total > ESPNOW_FLIGHT_MAX_SAMPLES || c->count > ESPNOW_FLIGHT_CHUNK_SAMPLES ||
+        c->first + c->count > c->total)
+        return;
+    if (!s_flight_valid || c->recordId != s_flight.recordId || c->total != s_flight.total)
+    {
+        memset(&s_flight, 0, sizeof(s_flight));
+        s_flight.recordId = c->recordId;
+        s_flight.resetReason = c->resetReason;
+        s_flight.endStage = c->endStage;
+        s_flight.samplePeriodMs = c->samplePeriodMs;
+        s_flight.total = c->total;
+        s_flight_valid = true;
+    }
+    bool was_complete = s_flight.received == s_flight.total;
+    for (int i = 0; i < c->count; ++i)
+    {
+        int idx = c->first + i;
+        s_flight.samples[idx] = c->samples[i];
+        if (!s_flight.have[idx])
+        {
+            s_flight.have[idx] = true;
+            s_flight.received++;
+        }
+    }
+    if (!was_complete && s_flight.received == s_flight.total)
+        ESP_LOGW(TAG_ESPNOW, "Controller flight record %u: %u samples before reset (reason %u, stage %u)",
+                 (unsigned)s_flight.recordId, (unsigned)s_flight.total, s_flight.resetReason,
+                 s_flight.endStage);
+}
+
 static void schedule_control_send(void)
 {
     s_control_dirty = true;
+    wireless_notify(WIRELESS_EVT_CONTROL);
 }
 
 static void publish_sensor_to_mqtt(const EspNowPacket *pkt)
@@ -1784,12 +2306,255 @@ static void publish_sensor_to_mqtt(const EspNowPacket *pkt)
                            &s_pub_pulse_count_valid);
     publish_u32_if_changed(TOPIC_AC_COUNT_STATE, pkt->acCount, s_pub_ac_count, sizeof(s_pub_ac_count),
                            &s_pub_ac_count_valid);
+    publish_u32_if_changed(TOPIC_STEAM_LATENCY_STATE, pkt->steamDetectMs, s_pub_steam_latency,
+                           sizeof(s_pub_steam_latency), &s_pub_steam_latency_valid);
+    publish_bool_topic_if_changed(TOPIC_CHANNELING_STATE, (pkt->puckFlags & ESPNOW_PUCK_FLAG_CHANNELING) != 0,
+                                  &s_pub_channeling, &s_pub_channeling_valid);
+}
+
+static void publish_shot_summary(const EspNowShotSummary *sum)
+{
+    static bool s_have_shot_id = false;
+    static uint16_t s_last_shot_id = 0;
+    // The controller repeats each summary; publish it once.
+    if (s_have_shot_id && sum->shotId == s_last_shot_id)
+        return;
+    s_have_shot_id = true;
+    s_last_shot_id = sum->shotId;
+
+    ESP_LOGI(TAG_ESPNOW, "Shot %u: %.1f s, %.1f mL, peak %.1f bar%s", sum->shotId, sum->durationMs / 1000.0f,
+             sum->volumeMl, sum->peakBar, (sum->flags & ESPNOW_SHOT_FLAG_CHANNELING) ? ", channeling" : "");
+    if (!s_mqtt)
+        return;
+
+    char buf[448];
+    int n = snprintf(buf, sizeof buf,
+                     "{\"shot_id\":%u,\"duration_s\":%.1f,\"volume_ml\":%.1f,\"preinfusion_s\":%.1f,"
+                     "\"preinfusion_ml\":%.1f,\"first_drip_s\":%.1f,\"peak_bar\":%.2f,\"mean_bar\":%.2f,"
+                     "\"mean_flow_ml_s\":%.2f,\"temp_dev_cs\":%.1f,\"max_temp_dev_c\":%.2f,"
+                     "\"pump_energy_j\":%.0f,\"channel_events\":%u,\"mean_resistance\":%.2f,"
+                     "\"mean_brew_c\":%.1f}",
+                     sum->shotId, sum->durationMs / 1000.0f, sum->volumeMl, sum->preinfusionMs / 1000.0f,
+                     sum->preinfusionMl, sum->firstDripMs / 1000.0f, sum->peakBar, sum->meanBar,
+                     sum->meanFlowMlS, sum->tempDevCs, sum->maxTempDevC, sum->pumpEnergyJ,
+                     (unsigned)sum->channelEvents, sum->meanResistance, sum->meanBrewC);
+    if (n > 0 && n < (int)sizeof buf)
+        esp_mqtt_client_publish(s_mqtt, TOPIC_SHOT_SUMMARY_STATE, buf, 0, 1, true);
+}
+
+static void publish_heater_modes(const EspNowHeaterModes *m)
+{
+    static bool s_have_seq = false;
+    static uint16_t s_last_seq = 0;
+    // The controller repeats each report; publish it once.
+    if (s_have_seq && m->seq == s_last_seq)
+        return;
+    s_have_seq = true;
+    s_last_seq = m->seq;
+
+    ESP_LOGI(TAG_ESPNOW, "Heater: steam ready %.1f s, brew recovery %.1f s, holding %.1f/%.1f %%",
+             m->steamReadyMs / 1000.0f, m->brewRecoveryMs / 1000.0f, m->brewHoldPct, m->steamHoldPct);
+    if (!s_mqtt)
+        return;
+
+    char buf[256];
+    int n = snprintf(buf, sizeof buf,
+                     "{\"mode\":\"%s\",\"steam_ready_s\":%.1f,\"steam_start_c\":%.1f,\"brew_recovery_s\":%.1f,"
+                     "\"brew_start_c\":%.1f,\"brew_hold_pct\":%.1f,\"steam_hold_pct\":%.1f}",
+                     m->mode ? "steam" : "brew", m->steamReadyMs / 1000.0f, m->steamStartC,
+                     m->brewRecoveryMs / 1000.0f, m->brewStartC, m->brewHoldPct, m->steamHoldPct);
+    if (n > 0 && n < (int)sizeof buf)
+        esp_mqtt_client_publish(s_mqtt, TOPIC_HEATER_MODES_STATE, buf, 0, 1, true);
+}
+
+static void publish_energy(const EspNowEnergy *e)
+{
+    if (!s_mqtt_connected)
+        return;
+    publish_float_if_changed(TOPIC_HEATER_DUTY_STATE, e->dutyPct, 0, s_pub_heater_duty, sizeof(s_pub_heater_duty),
+                             &s_pub_heater_duty_valid);
+
+    // Lifetime totals move every few seconds while heating; once a minute is plenty.
+    TickType_t now = xTaskGetTickCount();
+    if (s_pub_energy_valid && (now - s_pub_energy_tick) < pdMS_TO_TICKS(ENERGY_PUBLISH_PERIOD_MS))
+        return;
+
+    float wh[ESPNOW_ENERGY_STATES];
+    float total_wh = 0.0f;
+    for (int i = 0; i < ESPNOW_ENERGY_STATES; ++i)
+    {
+        wh[i] = e->heaterOnS[i] * (float)e->elementW / 3600.0f;
+        total_wh += wh[i];
+    }
+    // Standing loss: average heater power needed to hold brew temperature.
+    float idle_w = e->stateS[ESPNOW_ENERGY_STATE_IDLE]
+                       ? wh[ESPNOW_ENERGY_STATE_IDLE] * 3600.0f / e->stateS[ESPNOW_ENERGY_STATE_IDLE]
+                       : 0.0f;
+    char buf[sizeof s_pub_energy];
+    int n = snprintf(buf, sizeof buf,
+                     "{\"total_wh\":%.1f,\"idle_wh\":%.1f,\"shot_wh\":%.1f,\"steam_wh\":%.1f,"
+                     "\"idle_s\":%u,\"shot_s\":%u,\"steam_s\":%u,\"heater_on_s\":%u,\"idle_w\":%.1f,"
+                     "\"pump_on_s\":%u,\"heater_cycles\":%u,\"pump_cycles\":%u,\"shots\":%u,\"boots\":%u,"
+                     "\"element_w\":%u}",
+                     total_wh, wh[ESPNOW_ENERGY_STATE_IDLE], wh[ESPNOW_ENERGY_STATE_SHOT],
+                     wh[ESPNOW_ENERGY_STATE_STEAM], (unsigned)e->stateS[ESPNOW_ENERGY_STATE_IDLE],
+                     (unsigned)e->stateS[ESPNOW_ENERGY_STATE_SHOT], (unsigned)e->stateS[ESPNOW_ENERGY_STATE_STEAM],
+                     (unsigned)(e->heaterOnS[0] + e->heaterOnS[1] + e->heaterOnS[2]), idle_w,
+                     (unsigned)e->pumpOnS, (unsigned)e->heaterCycles, (unsigned)e->pumpCycles,
+                     (unsigned)e->shots, (unsigned)e->boots, (unsigned)e->elementW);
+    if (n <= 0 || n >= (int)sizeof buf)
+        return;
+    if (s_pub_energy_valid && strcmp(buf, s_pub_energy) == 0)
+        return;
+    esp_mqtt_client_publish(s_mqtt, TOPIC_ENERGY_STATE, buf, 0, 1, true);
+    strcpy(s_pub_energy, buf);
+    s_pub_energy_valid = true;
+    s_pub_energy_tick = now;
+}
+
+static void publish_loop_stats(const EspNowLoopStats *st)
+{
+    if (!s_mqtt_connected)
+        return;
+    publish_u32_if_changed(TOPIC_LOOP_OVERRUNS_STATE, st->overruns, s_pub_loop_overruns,
+                           sizeof(s_pub_loop_overruns), &s_pub_loop_overruns_valid);
+    publish_u32_if_changed(TOPIC_LOOP_TRIPS_STATE, st->trips, s_pub_loop_trips, sizeof(s_pub_loop_trips),
+                           &s_pub_loop_trips_valid);
+    publish_float_if_changed(TOPIC_LOOP_WORST_STATE, st->worstTickUs / 1000.0f, 1, s_pub_loop_worst,
+                             sizeof(s_pub_loop_worst), &s_pub_loop_worst_valid);
+}
+
+static void publish_telemetry_stats(const EspNowTelemetryStats *m)
+{
+    if (!s_mqtt_connected)
+        return;
+    // Field prefixes, indexed by EspNowStatsChannel.
+    static const char *const names[ESPNOW_STATS_CHANNELS] = {"temp", "pressure", "pump", "heater"};
+    char buf[640];
+    int n = snprintf(buf, sizeof buf, "{\"window_ms\":%u", (unsigned)m->windowMs);
+    for (int i = 0; i < ESPNOW_STATS_CHANNELS && n > 0 && n < (int)sizeof buf; ++i)
+    {
+        const EspNowChannelStats *c = &m->stats[i];
+        n += snprintf(buf + n, sizeof buf - n,
+                      ",\"%s_min\":%.2f,\"%s_max\":%.2f,\"%s_mean\":%.2f,\"%s_last\":%.2f,\"%s_n\":%u",
+                      names[i], c->min, names[i], c->max, names[i], c->mean, names[i], c->last, names[i],
+                      (unsigned)c->count);
+    }
+    if (n <= 0 || n + 1 >= (int)sizeof buf)
+        return;
+    strcat(buf, "}");
+    // A new window every telemetry interval; nothing worth retaining.
+    esp_mqtt_client_publish(s_mqtt, TOPIC_TELEMETRY_WINDOW_STATE, buf, 0, 0, false);
+}
+
+static void publish_health(const EspNowHealth *h)
+{
+    if (!s_mqtt_connected)
+        return;
+    char buf[512];
+    int n = snprintf(buf, sizeof buf,
+                     "{\"uptime_s\":%u,\"reset_reason\":%u,\"boots\":%u,\"channel\":%u,\"rssi\":%d,"
+                     "\"loop_hz\":%.1f,\"free_heap\":%u,\"min_free_heap\":%u,\"max_alloc_heap\":%u,"
+                     "\"loop_stack_free\":%u,\"zc_isrs\":%u,\"flow_isrs\":%u,\"ac_isrs\":%u,"
+                     "\"phase_dropped\":%u,\"send_ok\":%u,\"send_no_ack\":%u,\"send_errors\":%u,"
+                     "\"recv_frames\":%u,\"log_dropped\":%u}",
+                     (unsigned)h->uptimeS, h->resetReason, (unsigned)h->boots, h->channel, s_controller_rssi,
+                     h->loopHz, (unsigned)h->freeHeap, (unsigned)h->minFreeHeap, (unsigned)h->maxAllocHeap,
+                     (unsigned)h->loopStackFree, (unsigned)h->zcIsrs, (unsigned)h->flowIsrs, (unsigned)h->acIsrs,
+                     (unsigned)h->phaseCyclesDropped, (unsigned)h->sendOk, (unsigned)h->sendNoAck,
+                     (unsigned)h->sendErrors, (unsigned)h->recvFrames, (unsigned)h->logDropped);
+    if (n > 0 && n < (int)sizeof buf)
+        esp_mqtt_client_publish(s_mqtt, TOPIC_HEALTH_STATE, buf, 0, 1, true);
+}
+
+static void handle_health(const EspNowHealth *h)
+{
+    // Uptime going backwards means the controller rebooted since the last report.
+    if (s_health_valid && h->uptimeS < s_health.uptimeS)
+        ESP_LOGW(TAG_ESPNOW, "Controller restarted (reset reason %u, boot %u)", h->resetReason, (unsigned)h->boots);
+    memcpy(&s_health, h, sizeof(s_health));
+    s_health_valid = true;
+    pub_slot_offer(s_health_slot, MQTT_PUB_HEALTH, h);
 }
 
 static void espnow_recv_cb(const esp_now_recv_info_t *info, const uint8_t *data, int data_len)
 {
+    int64_t rx_us = utc_now_us();
     if (data_len <= 0 || !data)
         return;
+    // Only the controller talks to us; its frames give the link's signal strength.
+    if (info && info->rx_ctrl)
+        s_controller_rssi = (int8_t)info->rx_ctrl->rssi;
+    if (data_len == sizeof(EspNowHealth) && data[0] == ESPNOW_HEALTH)
+    {
+        EspNowHealth h;
+        memcpy(&h, data, sizeof(h));
+        handle_health(&h);
+        s_espnow_last_rx = time(NULL);
+        return;
+    }
+    if (data_len == sizeof(EspNowShotSummary) && data[0] == ESPNOW_SHOT_SUMMARY)
+    {
+        pub_slot_offer(s_shot_summary_slot, MQTT_PUB_SHOT_SUMMARY, data);
+        s_espnow_last_rx = time(NULL);
+        return;
+    }
+    if (data_len == sizeof(EspNowHeaterModes) && data[0] == ESPNOW_HEATER_MODES)
+    {
+        pub_slot_offer(s_heater_modes_slot, MQTT_PUB_HEATER_MODES, data);
+        s_espnow_last_rx = time(NULL);
+        return;
+    }
+    if (data_len == sizeof(EspNowEnergy) && data[0] == ESPNOW_ENERGY)
+    {
+        memcpy(&s_energy, data, sizeof(s_energy));
+        s_energy_valid = true;
+        pub_slot_offer(s_energy_slot, MQTT_PUB_ENERGY, data);
+        s_espnow_last_rx = time(NULL);
+        return;
+    }
+    if (data_len == sizeof(EspNowLoopStats) && data[0] == ESPNOW_LOOP_STATS)
+    {
+        const EspNowLoopStats *st = (const EspNowLoopStats *)data;
+        if (s_loop_stats_valid && st->trips != s_loop_stats.trips)
+            ESP_LOGW(TAG_ESPNOW, "Controller loop stalled in stage %u (%u trips)", st->lastTripStage,
+                     (unsigned)st->trips);
+        memcpy(&s_loop_stats, st, sizeof(s_loop_stats));
+        s_loop_stats_valid = true;
+        pub_slot_offer(s_loop_stats_slot, MQTT_PUB_LOOP_STATS, data);
+        s_espnow_last_rx = time(NULL);
+        return;
+    }
+    if (data_len == sizeof(EspNowTelemetryStats) && data[0] == ESPNOW_TELEMETRY_STATS)
+    {
+        memcpy(&s_telemetry_stats, data, sizeof(s_telemetry_stats));
+        s_telemetry_stats_valid = true;
+        pub_slot_offer(s_telemetry_slot, MQTT_PUB_TELEMETRY, data);
+        s_espnow_last_rx = time(NULL);
+        return;
+    }
+    if (data_len == sizeof(EspNowFlightChunk) && data[0] == ESPNOW_FLIGHT_CHUNK)
+    {
+        EspNowFlightChunk chunk;
+        memcpy(&chunk, data, sizeof(chunk));
+        handle_flight_chunk(&chunk);
+        s_espnow_last_rx = time(NULL);
+        return;
+    }
+    if (data_len == sizeof(EspNowTimeRequest) && data[0] == ESPNOW_TIME_REQUEST)
+    {
+        EspNowTimeRequest req;
+        memcpy(&req, data, sizeof(req));
+        if (info)
+            send_time_response(info->src_addr, &req, rx_us);
+        s_espnow_last_rx = time(NULL);
+        return;
+    }
+    if (ControllerOta_HandleFrame(data, data_len))
+    {
+        s_espnow_last_rx = time(NULL);
+        return;
+    }
     if (data[0] == ESPNOW_HANDSHAKE_ACK)
     {
         if (info)
@@ -1801,10 +2566,18 @@ static void espnow_recv_cb(const esp_now_recv_info_t *info, const uint8_t *data,
         s_espnow_last_rx = time(NULL);
         if (s_espnow_timer)
             xTimerReset(s_espnow_timer, 0);
-        if (s_control_revision == 0 && !s_control_dirty)
+        if (s_control_revision == 0 || s_control_dirty)
         {
+            // First packet, or changes made while the link was down.
             schedule_control_send();
         }
+        bool held = data_len >= 3 && (data[2] & ESPNOW_HANDSHAKE_FLAG_PARAMS);
+        if (!s_param_subscribed || (data_len >= 3 && !held))
+        {
+            s_param_subscribed = false;
+            s_param_subscribe_req = true;
+            wireless_notify(WIRELESS_EVT_PARAMS);
+        }
         return;
     }
 
@@ -1827,7 +2600,7 @@ static void espnow_recv_cb(const esp_now_recv_info_t *info, const uint8_t *data,
         s_zc_count = pkt->zcCount;
         s_pulse_count = pkt->pulseCount;
         s_ac_count = pkt->acCount;
-        publish_sensor_to_mqtt(pkt);
+        pub_slot_offer(s_sensor_slot, MQTT_PUB_SENSOR, pkt);
         if (info)
         {
             update_controller_peer(info->src_addr);
@@ -1841,6 +2614,29 @@ static void espnow_recv_cb(const esp_now_recv_info_t *info, const uint8_t *data,
         return;
     }
 
+    if (data_len >= ESPNOW_PARAM_HEADER_LEN && data[0] == ESPNOW_PARAM_REPORT)
+    {
+        EspNowParamValues rpt;
+        if (data_len > (int)sizeof(rpt) || data[2] > ESPNOW_PARAM_MAX_ENTRIES ||
+            data_len != ESPNOW_PARAM_VALUES_LEN(data[2]))
+            return;
+        memcpy(&rpt, data, data_len);
+        handle_param_report(&rpt);
+        s_espnow_last_rx = time(NULL);
+        return;
+    }
+
+    if (data_len == sizeof(EspNowCalReport) && data[0] == ESPNOW_CAL_REPORT)
+    {
+        const EspNowCalReport *rpt = (const EspNowCalReport *)data;
+        if (rpt->target <= ESPNOW_CAL_TARGET_PRESSURE)
+        {
+            memcpy(&s_cal_report[rpt->target], rpt, sizeof(*rpt));
+            s_cal_report_valid[rpt->target] = true;
+        }
+        return;
+    }
+
     if (data[0] == ESPNOW_SENSOR_ACK)
     {
         // Controller acknowledged telemetry acknowledgement; nothing to do.
@@ -1851,25 +2647,30 @@ static void espnow_recv_cb(const esp_now_recv_info_t *info, const uint8_t *data,
 static void Wireless_Task(void *arg)
 {
     (void)arg;
-    const TickType_t delay = pdMS_TO_TICKS(50);
+    TickType_t wait = 0;
+    TickType_t last_control = 0;
+    bool control_sent = false;
     while (1)
     {
+        // Timeout and ping bits are one-shot; the others only wake the task
+        // and the state flags below say what is still outstanding.
+        EventBits_t bits = xEventGroupWaitBits(s_wireless_events, WIRELESS_EVT_ALL, pdTRUE, pdFALSE, wait);
+        wait = pdMS_TO_TICKS(WIRELESS_IDLE_MS);
+
         if (s_wifi_ready && !s_mqtt && s_mqtt_enabled)
         {
             MQTT_Start();
         }
 
-        if (s_espnow_timeout_req)
+        if (bits & WIRELESS_EVT_TIMEOUT)
         {
-            s_espnow_timeout_req = false;
             ESP_LOGW(TAG_ESPNOW, "Timeout waiting for packets");
             stop_espnow();
             ensure_espnow_started();
         }
 
-        if (s_espnow_ping_req)
+        if (bits & WIRELESS_EVT_PING)
         {
-            s_espnow_ping_req = false;
             if (!s_espnow_handshake)
             {
                 send_handshake_request();
@@ -1883,10 +2684,75 @@ static void Wireless_Task(void *arg)
 
         if (s_use_espnow && s_control_dirty)
         {
-            send_control_packet();
+            // The first change goes out at once; changes that follow within
+            // CONTROL_COALESCE_MS wait for the window to close and then go out
+            // as one packet carrying the latest state. A failed send stays
+            // dirty and is retried the same way.
+            TickType_t now = xTaskGetTickCount();
+            TickType_t window = pdMS_TO_TICKS(CONTROL_COALESCE_MS);
+            TickType_t since = now - last_control;
+            if (control_sent && since < window)
+            {
+                wait = window - since;
+            }
+            else
+            {
+                send_control_packet();
+                last_control = now;
+                control_sent = true;
+                if (s_control_dirty)
+                    wait = window;
+            }
+        }
+
+        if (s_param_subscribe_req && s_use_espnow && s_controller_peer_valid)
+        {
+            s_param_subscribe_req = false;
+            // Every parameter; the controller answers with their current values.
+            if (send_param_ids(ESPNOW_PARAM_SUBSCRIBE, NULL, 0, &s_param_subscribe_seq) != ESP_OK)
+                ESP_LOGW(TAG_ESPNOW, "Parameter subscribe failed");
         }
 
-        vTaskDelay(delay);
+        if (s_param_sync_req)
+        {
+            s_param_sync_req = false;
+            sync_control_from_params();
+        }
+    }
+}
+
+static void Mqtt_PublishTask(void *arg)
+{
+    (void)arg;
+    // One buffer is enough: each report is published before the next is taken.
+    union
+    {
+        EspNowPacket pkt;
+        EspNowHealth health;
+        EspNowEnergy energy;
+        EspNowLoopStats loop_stats;
+        EspNowTelemetryStats telemetry;
+        EspNowShotSummary shot_summary;
+        EspNowHeaterModes heater_modes;
+    } msg;
+    while (1)
+    {
+        // A slot can be empty when its bit was raised again after it was read.
+        EventBits_t bits = xEventGroupWaitBits(s_pub_events, MQTT_PUB_ALL, pdTRUE, pdFALSE, portMAX_DELAY);
+        if ((bits & MQTT_PUB_SENSOR) && xQueueReceive(s_sensor_slot, &msg, 0) == pdTRUE)
+            publish_sensor_to_mqtt(&msg.pkt);
+        if ((bits & MQTT_PUB_SHOT_SUMMARY) && xQueueReceive(s_shot_summary_slot, &msg, 0) == pdTRUE)
+            publish_shot_summary(&msg.shot_summary);
+        if ((bits & MQTT_PUB_HEATER_MODES) && xQueueReceive(s_heater_modes_slot, &msg, 0) == pdTRUE)
+            publish_heater_modes(&msg.heater_modes);
+        if ((bits & MQTT_PUB_TELEMETRY) && xQueueReceive(s_telemetry_slot, &msg, 0) == pdTRUE)
+            publish_telemetry_stats(&msg.telemetry);
+        if ((bits & MQTT_PUB_ENERGY) && xQueueReceive(s_energy_slot, &msg, 0) == pdTRUE)
+            publish_energy(&msg.energy);
+        if ((bits & MQTT_PUB_LOOP_STATS) && xQueueReceive(s_loop_stats_slot, &msg, 0) == pdTRUE)
+            publish_loop_stats(&msg.loop_stats);
+        if ((bits & MQTT_PUB_HEALTH) && xQueueReceive(s_health_slot, &msg, 0) == pdTRUE)
+            publish_health(&msg.health);
     }
 }
 
@@ -1932,6 +2798,7 @@ uint32_t MQTT_GetZcCount(void) { return s_zc_count; }
 uint32_t MQTT_GetPulseCount(void) { return s_pulse_count; }
 uint32_t MQTT_GetAcCount(void) { return s_ac_count; }
 bool MQTT_GetHeaterState(void) { return s_heater; }
+float MQTT_GetBrewSetpoint(void) { return s_control.brewSetpoint; }
 
 void MQTT_SetHeaterState(bool heater, bool force_publish)
 {
@@ -1998,6 +2865,29 @@ void MQTT_SetPumpPower(float power)
     handle_control_change();
 }
 
+void MQTT_SetEcoSetpoint(float setpoint)
+{
+    if (!(setpoint > 0.0f))
+        setpoint = 0.0f;
+    if (float_equals(setpoint, s_control.ecoSetpoint, CONTROL_TEMP_TOLERANCE))
+        return;
+    s_control.ecoSetpoint = setpoint;
+    log_control_float("eco_setpoint", setpoint, 0);
+    handle_control_change();
+}
+
+void Wireless_PublishWarmupReport(const char *json)
+{
+    if (!json || strlen(json) >= sizeof s_warmup_report)
+        return;
+    taskENTER_CRITICAL(&s_warmup_report_lock);
+    strcpy(s_warmup_report, json);
+    s_warmup_report_pending = true;
+    taskEXIT_CRITICAL(&s_warmup_report_lock);
+    // Sent now if MQTT is up, otherwise (retained) on the next connect.
+    publish_pending_warmup_report();
+}
+
 bool Wireless_UsingEspNow(void) { return s_use_espnow; }
 bool Wireless_IsMQTTConnected(void) { return s_mqtt_connected; }
 bool Wireless_IsWiFiConnected(void) { return s_wifi_ready; }
@@ -9,6 +9,7 @@
 #include <string.h> // For memcpy
 
 #include "mqtt_client.h"
+#include "espnow_protocol.h"
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -31,12 +32,19 @@ uint32_t MQTT_GetZcCount(void);
 uint32_t MQTT_GetPulseCount(void);
 uint32_t MQTT_GetAcCount(void);
 bool MQTT_GetHeaterState(void);
+float MQTT_GetBrewSetpoint(void);
 void MQTT_SetHeaterState(bool state, bool force_publish);
 bool MQTT_GetSteamState(void);
 void MQTT_SetSteamState(bool state);
 void MQTT_SetPumpPressureMode(bool enabled);
 void MQTT_SetPressureSetpoint(float pressure);
 void MQTT_SetPumpPower(float power);
+// Eco hold for the warm-up scheduler: the controller tracks this instead of the brew
+// setpoint until cleared with 0. Not published or retained.
+void MQTT_SetEcoSetpoint(float setpoint);
+// Retained JSON report of the last scheduled warm-up (warmup/state); held and
+// published on the next MQTT connect when standby has MQTT stopped.
+void Wireless_PublishWarmupReport(const char *json);
 
 void Wireless_SetStandbyMode(bool standby);
 
@@ -45,3 +53,40 @@ bool Wireless_IsMQTTConnected(void);
 bool Wireless_IsWiFiConnected(void);
 bool Wireless_ControllerStillSendingEspNow(void);
 bool Wireless_IsEspNowActive(void);
+// Send a raw ESP-NOW frame to the linked controller (ESP_ERR_INVALID_STATE when unlinked).
+esp_err_t Wireless_SendToController(const uint8_t *data, size_t len);
+// Sensor calibration (EspNowCalTarget/Action/Unit values); reports arrive asynchronously.
+esp_err_t Wireless_SendCalCommand(uint8_t target, uint8_t action, uint8_t unit, float reference);
+bool Wireless_GetCalReport(uint8_t target, EspNowCalReport *out);
+// Latest lifetime heater/pump counters from the controller; false until the first report.
+bool Wireless_GetEnergy(EspNowEnergy *out);
+// Latest control-loop timing report from the controller; false until the first report.
+bool Wireless_GetLoopStats(EspNowLoopStats *out);
+// Per-channel statistics of the last telemetry window; false until the first report.
+bool Wireless_GetTelemetryStats(EspNowTelemetryStats *out);
+// Latest controller health report and the signal strength (dBm) of the controller's
+// last frame; false until the first report.
+bool Wireless_GetHealth(EspNowHealth *out, int8_t *rssi);
+// Registry parameters (param_registry.h). The display subscribes to every parameter
+// once linked; the cache read by Wireless_GetParam follows the controller's reports of
+// the values it applied. A set goes out at once (count <= ESPNOW_PARAM_MAX_ENTRIES);
+// a get of count 0 asks for every parameter.
+esp_err_t Wireless_SendParamSet(const EspNowParamValue *values, uint8_t count);
+esp_err_t Wireless_SendParamGet(const uint16_t *ids, uint8_t count);
+// Last reported value of @p id and the EspNowParamStatus of that report; false until reported.
+bool Wireless_GetParam(uint16_t id, float *value, uint8_t *status);
+// Control samples the controller kept across its last reset, oldest first. Chunks
+// arrive after each link-up; received < total while some are still missing.
+typedef struct
+{
+    uint32_t recordId; // boot number of the recorded run
+    uint8_t resetReason;
+    uint8_t endStage;
+    uint16_t samplePeriodMs;
+    uint16_t total;
+    uint16_t received;
+    EspNowFlightSample samples[ESPNOW_FLIGHT_MAX_SAMPLES];
+    bool have[ESPNOW_FLIGHT_MAX_SAMPLES]; // samples[i] has arrived
+} WirelessFlightRecord;
+// False until the first chunk of a record has arrived.
+bool Wireless_GetFlightRecord(WirelessFlightRecord *out);
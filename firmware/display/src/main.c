@@ -43,7 +43,9 @@ static int log_vprintf(const char *fmt, va_list args)
 #include "LVGL_UI.h"
 #include "Wireless.h"
 #include "WebServer.h"
+#include "ControllerOta.h"
 #include "Battery.h"
+#include "WarmupScheduler.h"
 
 // Track interaction and machine activity for LCD backlight control.
 // g_last_touch_tick is updated by the touch driver whenever the screen is
@@ -83,6 +85,11 @@ void app_main(void)
     vTaskDelay(pdMS_TO_TICKS(boot_delay_ms));
 
     Wireless_Init(); // Configure Wi-Fi/BLE modules
+    esp_err_t sched_err = WarmupScheduler_Init(); // after Wireless_Init has brought up NVS
+    if (sched_err != ESP_OK)
+    {
+        ESP_LOGE("WARMUP", "Warm-up scheduler init failed: %s", esp_err_to_name(sched_err));
+    }
     esp_err_t web_err = WebServer_Init();
     if (web_err != ESP_OK)
     {
@@ -93,11 +100,17 @@ void app_main(void)
     LCD_Init();   // Prepare LCD display
     Touch_Init(); // Initialize touch controller
     SD_Init();    // Mount SD card
+    esp_err_t ota_err = ControllerOta_Init(); // Controller updates stream from the SD card
+    if (ota_err != ESP_OK)
+    {
+        ESP_LOGE("OTA", "Controller OTA init failed: %s", esp_err_to_name(ota_err));
+    }
     LVGL_Init();  // Initialize graphics library
                   /********************* Demo *********************/
     Lvgl_Example1();
 
-    // Ensure the heater is active on startup.
+    // Ensure the heater is active on startup; standby and the warm-up scheduler
+    // take it from there.
     MQTT_SetHeaterState(true, true);
 
     // Alternative demos:
@@ -114,6 +127,7 @@ void app_main(void)
     last_heater_on_tick = start_tick;
     last_zc_change_tick = start_tick;
     last_zc_count = MQTT_GetZcCount();
+    TickType_t seen_touch_tick = g_last_touch_tick;
 
     while (1)
     {
@@ -136,13 +150,22 @@ void app_main(void)
             last_zc_change_tick = now;
         }
 
+        // Someone is using the machine: a scheduled warm-up hands the heater over.
+        if (zc_changed || g_last_touch_tick != seen_touch_tick)
+        {
+            seen_touch_tick = g_last_touch_tick;
+            WarmupScheduler_NotifyActivity();
+        }
+        WarmupScheduler_Tick();
+
         bool touch_inactive = (now - g_last_touch_tick) >= LCD_INACTIVITY_TIMEOUT;
         bool heater_inactive = !heater_on && (now - last_heater_on_tick) >= LCD_INACTIVITY_TIMEOUT;
         bool zc_inactive = (now - last_zc_change_tick) >= LCD_INACTIVITY_TIMEOUT;
 
         if (!standby_mode)
         {
-            if (touch_inactive && (heater_inactive || zc_inactive))
+            // Standby switches the heater off, so it waits while the scheduler holds it.
+            if (touch_inactive && (heater_inactive || zc_inactive) && !WarmupScheduler_IsActive())
             {
                 LVGL_EnterStandby();
                 Wireless_SetStandbyMode(true);
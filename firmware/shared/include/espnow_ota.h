@@ -0,0 +1,496 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "espnow_protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Transport-agnostic state machines for streaming a controller image over
+// ESP-NOW. The display owns an EspNowOtaSender and the controller an
+// EspNowOtaReceiver; both talk through small I/O tables so the same code runs
+// on the radios and against a host loopback transport.
+//
+// Flow control is go-back-N: the sender keeps at most `window` chunks beyond
+// the last acknowledged offset in flight and rewinds to that offset whenever
+// the receiver reports a CRC/ordering error or acknowledgements stop arriving.
+
+#define ESPNOW_OTA_TIMEOUT_MS 500U  // no progress for this long -> retransmit
+#define ESPNOW_OTA_MAX_RETRIES 20U  // consecutive timeouts before giving up
+#define ESPNOW_OTA_STATUS_TIMEOUT 9     // sender-local status, never sent on air
+#define ESPNOW_OTA_STATUS_READ_ERROR 10 // sender-local: io.read() failed on the image source
+
+/**\brief CRC-32 (IEEE 802.3, reflected). Pass 0 to start, or a previous result to continue. */
+static inline uint32_t espnow_ota_crc32(uint32_t crc, const void *data, size_t len)
+{
+    static const uint32_t table[16] = {
+        0x00000000U, 0x1DB71064U, 0x3B6E20C8U, 0x26D930ACU, 0x76DC4190U, 0x6B6B51F4U,
+        0x4DB26158U, 0x5005713CU, 0xEDB88320U, 0xF00F9344U, 0xD6D6A3E8U, 0xCB61B38CU,
+        0x9B64C2B0U, 0x86D3D2D4U, 0xA00AE278U, 0xBDBDF21CU,
+    };
+    const uint8_t *p = (const uint8_t *)data;
+    crc = ~crc;
+    while (len--)
+    {
+        crc = table[(crc ^ *p) & 0x0FU] ^ (crc >> 4);
+        crc = table[(crc ^ (uint32_t)(*p >> 4)) & 0x0FU] ^ (crc >> 4);
+        ++p;
+    }
+    return ~crc;
+}
+
+// -----------------------------------------------------------------------------
+// Sender (display side)
+// -----------------------------------------------------------------------------
+typedef enum
+{
+    ESPNOW_OTA_SENDER_IDLE = 0,
+    ESPNOW_OTA_SENDER_BEGIN,  //!< Waiting for the receiver to accept the image
+    ESPNOW_OTA_SENDER_STREAM, //!< Streaming chunks
+    ESPNOW_OTA_SENDER_END,    //!< All bytes acknowledged, waiting for the verdict
+    ESPNOW_OTA_SENDER_DONE,   //!< Receiver verified and accepted the image
+    ESPNOW_OTA_SENDER_FAILED, //!< See EspNowOtaSender::status
+} EspNowOtaSenderState;
+
+typedef struct
+{
+    //!< Copy len image bytes starting at offset into buf. Return false on read error.
+    bool (*read)(void *ctx, uint32_t offset, uint8_t *buf, size_t len);
+    //!< Transmit one frame. Return false when congested; the frame is retried later.
+    bool (*send)(void *ctx, const uint8_t *frame, size_t len);
+    void *ctx;
+} EspNowOtaSenderIo;
+
+typedef struct
+{
+    EspNowOtaSenderIo io;
+    EspNowOtaSenderState state;
+    int status; //!< EspNowOtaStatus, ESPNOW_OTA_STATUS_TIMEOUT or ESPNOW_OTA_STATUS_READ_ERROR
+    uint32_t imageSize;
+    uint32_t imageCrc;
+    uint16_t chunkSize;
+    uint8_t window;
+    uint8_t retries;
+    uint32_t ackedOffset;  //!< Bytes committed by the receiver
+    uint32_t nextOffset;   //!< Next byte to transmit
+    uint32_t resumeOffset; //!< Offset the receiver resumed from
+    uint32_t rewoundAt;    //!< ackedOffset + 1 of the last error-driven rewind (0 = none)
+    uint32_t startMs;
+    uint32_t finishMs;
+    uint32_t lastProgressMs;
+    uint32_t chunksSent;
+    uint32_t chunksResent;
+} EspNowOtaSender;
+
+static inline void espnow_ota_sender_fail(EspNowOtaSender *s, int status, uint32_t nowMs)
+{
+    s->state = ESPNOW_OTA_SENDER_FAILED;
+    s->status = status;
+    s->finishMs = nowMs;
+}
+
+static inline void espnow_ota_sender_send_control(EspNowOtaSender *s, uint8_t type)
+{
+    if (type == ESPNOW_OTA_BEGIN)
+    {
+        EspNowOtaBegin msg;
+        msg.type = ESPNOW_OTA_BEGIN;
+        msg.window = s->window;
+        msg.chunkSize = s->chunkSize;
+        msg.imageSize = s->imageSize;
+        msg.imageCrc = s->imageCrc;
+        s->io.send(s->io.ctx, (const uint8_t *)&msg, sizeof(msg));
+        return;
+    }
+    EspNowOtaEnd msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = type;
+    msg.imageSize = s->imageSize;
+    msg.imageCrc = s->imageCrc;
+    s->io.send(s->io.ctx, (const uint8_t *)&msg, sizeof(msg));
+}
+
+/**\brief Begin a transfer of an image already available through io->read. */
+static inline void espnow_ota_sender_start(EspNowOtaSender *s, const EspNowOtaSenderIo *io, uint32_t imageSize,
+                                           uint32_t imageCrc, uint16_t chunkSize, uint8_t window, uint32_t nowMs)
+{
+    memset(s, 0, sizeof(*s));
+    s->io = *io;
+    s->imageSize = imageSize;
+    s->imageCrc = imageCrc;
+    s->chunkSize = (chunkSize == 0 || chunkSize > ESPNOW_OTA_CHUNK_MAX) ? ESPNOW_OTA_CHUNK_MAX : chunkSize;
+    s->window = window ? window : 1;
+    s->startMs = nowMs;
+    s->lastProgressMs = nowMs;
+    s->state = ESPNOW_OTA_SENDER_BEGIN;
+    s->status = ESPNOW_OTA_STATUS_OK;
+    espnow_ota_sender_send_control(s, ESPNOW_OTA_BEGIN);
+}
+
+/**\brief Cancel the transfer and tell the receiver to discard its session. */
+static inline void espnow_ota_sender_abort(EspNowOtaSender *s, uint32_t nowMs)
+{
+    if (s->state == ESPNOW_OTA_SENDER_IDLE || s->state == ESPNOW_OTA_SENDER_DONE ||
+        s->state == ESPNOW_OTA_SENDER_FAILED)
+        return;
+    espnow_ota_sender_send_control(s, ESPNOW_OTA_ABORT);
+    espnow_ota_sender_fail(s, ESPNOW_OTA_STATUS_ABORTED, nowMs);
+}
+
+static inline bool espnow_ota_sender_active(const EspNowOtaSender *s)
+{
+    return s->state == ESPNOW_OTA_SENDER_BEGIN || s->state == ESPNOW_OTA_SENDER_STREAM ||
+           s->state == ESPNOW_OTA_SENDER_END;
+}
+
+static inline void espnow_ota_sender_rewind(EspNowOtaSender *s)
+{
+    if (s->nextOffset > s->ackedOffset)
+    {
+        s->chunksResent += (s->nextOffset - s->ackedOffset + s->chunkSize - 1U) / s->chunkSize;
+        s->nextOffset = s->ackedOffset;
+    }
+}
+
+/**\brief Feed a frame received from the controller. Returns true if it was an OTA reply. */
+static inline bool espnow_ota_sender_handle(EspNowOtaSender *s, const uint8_t *data, size_t len, uint32_t nowMs)
+{
+    if (!data || len < sizeof(EspNowOtaAck))
+        return false;
+    uint8_t type = data[0];
+    if (type != ESPNOW_OTA_BEGIN_ACK && type != ESPNOW_OTA_ACK && type != ESPNOW_OTA_RESULT)
+        return false;
+    EspNowOtaAck ack;
+    memcpy(&ack, data, sizeof(ack));
+    if (!espnow_ota_sender_active(s))
+        return true;
+    // Chunks carry no image id, so a receiver without a session answers them with imageCrc 0.
+    if (ack.imageCrc != s->imageCrc && ack.status != ESPNOW_OTA_STATUS_NO_SESSION)
+        return true;
+
+    if (type == ESPNOW_OTA_RESULT)
+    {
+        if (ack.status == ESPNOW_OTA_STATUS_OK)
+        {
+            s->ackedOffset = s->imageSize;
+            s->state = ESPNOW_OTA_SENDER_DONE;
+            s->status = ESPNOW_OTA_STATUS_OK;
+            s->finishMs = nowMs;
+        }
+        else if (ack.status == ESPNOW_OTA_STATUS_NO_SESSION)
+        {
+            // Receiver lost its session (e.g. rebooted); renegotiate and resume.
+            s->state = ESPNOW_OTA_SENDER_BEGIN;
+            s->lastProgressMs = nowMs;
+            espnow_ota_sender_send_control(s, ESPNOW_OTA_BEGIN);
+        }
+        else
+        {
+            espnow_ota_sender_fail(s, ack.status, nowMs);
+        }
+        return true;
+    }
+
+    if (type == ESPNOW_OTA_BEGIN_ACK)
+    {
+        if (s->state != ESPNOW_OTA_SENDER_BEGIN)
+            return true;
+        if (ack.status != ESPNOW_OTA_STATUS_OK || ack.offset > s->imageSize)
+        {
+            espnow_ota_sender_fail(s, ack.status != ESPNOW_OTA_STATUS_OK ? (int)ack.status
+                                                                         : (int)ESPNOW_OTA_STATUS_VERIFY_FAILED,
+                                   nowMs);
+            return true;
+        }
+        s->ackedOffset = ack.offset;
+        s->nextOffset = ack.offset;
+        s->resumeOffset = ack.offset;
+        s->retries = 0;
+        s->lastProgressMs = nowMs;
+        s->state = ESPNOW_OTA_SENDER_STREAM;
+        return true;
+    }
+
+    // ESPNOW_OTA_ACK
+    switch (ack.status)
+    {
+    case ESPNOW_OTA_STATUS_OK:
+    case ESPNOW_OTA_STATUS_CRC_ERROR:
+    case ESPNOW_OTA_STATUS_OUT_OF_ORDER:
+        if (ack.offset > s->ackedOffset && ack.offset <= s->imageSize)
+        {
+            s->ackedOffset = ack.offset;
+            s->retries = 0;
+            s->lastProgressMs = nowMs;
+        }
+        if (s->nextOffset < s->ackedOffset)
+            s->nextOffset = s->ackedOffset;
+        // Frames already in flight behind a gap all report the same error; rewind
+        // once per ack offset and leave further losses to the timeout.
+        if (ack.status != ESPNOW_OTA_STATUS_OK && s->rewoundAt != s->ackedOffset + 1U)
+        {
+            s->rewoundAt = s->ackedOffset + 1U;
+            espnow_ota_sender_rewind(s);
+            if (s->state == ESPNOW_OTA_SENDER_END)
+                s->state = ESPNOW_OTA_SENDER_STREAM;
+        }
+        break;
+    case ESPNOW_OTA_STATUS_NO_SESSION:
+        s->state = ESPNOW_OTA_SENDER_BEGIN;
+        s->lastProgressMs = nowMs;
+        espnow_ota_sender_send_control(s, ESPNOW_OTA_BEGIN);
+        break;
+    default:
+        espnow_ota_sender_fail(s, ack.status, nowMs);
+        break;
+    }
+    return true;
+}
+
+/**\brief Drive retransmission and fill the window. Call often (every few ms) while active. */
+static inline void espnow_ota_sender_poll(EspNowOtaSender *s, uint32_t nowMs)
+{
+    if (!espnow_ota_sender_active(s))
+        return;
+
+    if ((uint32_t)(nowMs - s->lastProgressMs) >= ESPNOW_OTA_TIMEOUT_MS)
+    {
+        if (++s->retries > ESPNOW_OTA_MAX_RETRIES)
+        {
+            espnow_ota_sender_fail(s, ESPNOW_OTA_STATUS_TIMEOUT, nowMs);
+            return;
+        }
+        s->lastProgressMs = nowMs;
+        if (s->state == ESPNOW_OTA_SENDER_BEGIN)
+        {
+            espnow_ota_sender_send_control(s, ESPNOW_OTA_BEGIN);
+            return;
+        }
+        if (s->state == ESPNOW_OTA_SENDER_END)
+        {
+            espnow_ota_sender_send_control(s, ESPNOW_OTA_END);
+            return;
+        }
+        espnow_ota_sender_rewind(s);
+    }
+
+    if (s->state != ESPNOW_OTA_SENDER_STREAM)
+        return;
+
+    if (s->ackedOffset >= s->imageSize)
+    {
+        s->state = ESPNOW_OTA_SENDER_END;
+        s->lastProgressMs = nowMs;
+        espnow_ota_sender_send_control(s, ESPNOW_OTA_END);
+        return;
+    }
+
+    const uint32_t windowBytes = (uint32_t)s->window * s->chunkSize;
+    uint8_t frame[sizeof(EspNowOtaChunkHeader) + ESPNOW_OTA_CHUNK_MAX];
+    while (s->nextOffset < s->imageSize && (s->nextOffset - s->ackedOffset) < windowBytes)
+    {
+        uint32_t remaining = s->imageSize - s->nextOffset;
+        uint16_t length = remaining < s->chunkSize ? (uint16_t)remaining : s->chunkSize;
+        uint8_t *payload = frame + sizeof(EspNowOtaChunkHeader);
+        if (!s->io.read(s->io.ctx, s->nextOffset, payload, length))
+        {
+            // Our own storage failed, not the controller's flash.
+            espnow_ota_sender_send_control(s, ESPNOW_OTA_ABORT);
+            espnow_ota_sender_fail(s, ESPNOW_OTA_STATUS_READ_ERROR, nowMs);
+            return;
+        }
+        EspNowOtaChunkHeader hdr;
+        hdr.type = ESPNOW_OTA_CHUNK;
+        hdr.reserved = 0;
+        hdr.length = length;
+        hdr.offset = s->nextOffset;
+        hdr.crc = espnow_ota_crc32(0, payload, length);
+        memcpy(frame, &hdr, sizeof(hdr));
+        if (!s->io.send(s->io.ctx, frame, sizeof(hdr) + length))
+            break;
+        s->nextOffset += length;
+        s->chunksSent++;
+    }
+}
+
+/**\brief Average goodput in bytes per second since the transfer started. */
+static inline uint32_t espnow_ota_sender_throughput(const EspNowOtaSender *s, uint32_t nowMs)
+{
+    uint32_t end = espnow_ota_sender_active(s) ? nowMs : s->finishMs;
+    uint32_t elapsed = end - s->startMs;
+    if (elapsed == 0 || s->ackedOffset <= s->resumeOffset)
+        return 0;
+    return (uint32_t)(((uint64_t)(s->ackedOffset - s->resumeOffset) * 1000U) / elapsed);
+}
+
+// -----------------------------------------------------------------------------
+// Receiver (controller side)
+// -----------------------------------------------------------------------------
+typedef struct
+{
+    //!< Prepare storage for an image. Set *resume to the bytes already committed
+    //!< for this exact image (0 for a fresh transfer).
+    EspNowOtaStatus (*begin)(void *ctx, uint32_t imageSize, uint32_t imageCrc, uint32_t *resume);
+    //!< Commit len bytes at offset. Offsets arrive strictly in order.
+    EspNowOtaStatus (*write)(void *ctx, uint32_t offset, const uint8_t *data, size_t len);
+    //!< Verify the complete image and make it bootable.
+    EspNowOtaStatus (*finish)(void *ctx, uint32_t imageSize, uint32_t imageCrc);
+    //!< Discard the session.
+    void (*abort)(void *ctx);
+    bool (*send)(void *ctx, const uint8_t *frame, size_t len);
+    void *ctx;
+} EspNowOtaReceiverIo;
+
+typedef struct
+{
+    EspNowOtaReceiverIo io;
+    bool active;
+    bool finished;
+    uint8_t result; //!< EspNowOtaStatus of the last finished session
+    uint32_t imageSize;
+    uint32_t imageCrc;
+    uint32_t offset; //!< Contiguous bytes committed
+    uint32_t chunksRejected;
+} EspNowOtaReceiver;
+
+static inline void espnow_ota_receiver_init(EspNowOtaReceiver *r, const EspNowOtaReceiverIo *io)
+{
+    memset(r, 0, sizeof(*r));
+    r->io = *io;
+}
+
+static inline void espnow_ota_receiver_reply(EspNowOtaReceiver *r, uint8_t type, uint8_t status, uint32_t imageCrc)
+{
+    EspNowOtaAck ack;
+    memset(&ack, 0, sizeof(ack));
+    ack.type = type;
+    ack.status = status;
+    ack.offset = r->offset;
+    ack.imageCrc = imageCrc;
+    r->io.send(r->io.ctx, (const uint8_t *)&ack, sizeof(ack));
+}
+
+/**\brief Feed a frame received from the display. Returns true if it was an OTA message. */
+static inline bool espnow_ota_receiver_handle(EspNowOtaReceiver *r, const uint8_t *data, size_t len)
+{
+    if (!data || len == 0)
+        return false;
+
+    switch (data[0])
+    {
+    case ESPNOW_OTA_BEGIN:
+    {
+        if (len < sizeof(EspNowOtaBegin))
+            return true;
+        EspNowOtaBegin msg;
+        memcpy(&msg, data, sizeof(msg));
+        if (r->active && msg.imageSize == r->imageSize && msg.imageCrc == r->imageCrc)
+        {
+            espnow_ota_receiver_reply(r, ESPNOW_OTA_BEGIN_ACK, ESPNOW_OTA_STATUS_OK, r->imageCrc);
+            return true;
+        }
+        if (r->active)
+            r->io.abort(r->io.ctx);
+        r->active = false;
+        r->finished = false;
+        r->offset = 0;
+        uint32_t resume = 0;
+        EspNowOtaStatus status = r->io.begin(r->io.ctx, msg.imageSize, msg.imageCrc, &resume);
+        if (status == ESPNOW_OTA_STATUS_OK)
+        {
+            r->active = true;
+            r->imageSize = msg.imageSize;
+            r->imageCrc = msg.imageCrc;
+            r->offset = resume <= msg.imageSize ? resume : 0;
+        }
+        espnow_ota_receiver_reply(r, ESPNOW_OTA_BEGIN_ACK, status, msg.imageCrc);
+        return true;
+    }
+    case ESPNOW_OTA_CHUNK:
+    {
+        if (len < sizeof(EspNowOtaChunkHeader))
+            return true;
+        EspNowOtaChunkHeader hdr;
+        memcpy(&hdr, data, sizeof(hdr));
+        if (!r->active)
+        {
+            espnow_ota_receiver_reply(r, ESPNOW_OTA_ACK, ESPNOW_OTA_STATUS_NO_SESSION, 0);
+            return true;
+        }
+        const uint8_t *payload = data + sizeof(hdr);
+        if (hdr.length == 0 || hdr.length > ESPNOW_OTA_CHUNK_MAX || len != sizeof(hdr) + hdr.length ||
+            espnow_ota_crc32(0, payload, hdr.length) != hdr.crc)
+        {
+            r->chunksRejected++;
+            espnow_ota_receiver_reply(r, ESPNOW_OTA_ACK, ESPNOW_OTA_STATUS_CRC_ERROR, r->imageCrc);
+            return true;
+        }
+        if (hdr.offset != r->offset)
+        {
+            // Duplicates are re-acknowledged; gaps ask the sender to rewind.
+            uint8_t status = hdr.offset < r->offset ? (uint8_t)ESPNOW_OTA_STATUS_OK
+                                                    : (uint8_t)ESPNOW_OTA_STATUS_OUT_OF_ORDER;
+            if (status != ESPNOW_OTA_STATUS_OK)
+                r->chunksRejected++;
+            espnow_ota_receiver_reply(r, ESPNOW_OTA_ACK, status, r->imageCrc);
+            return true;
+        }
+        if ((uint64_t)hdr.offset + hdr.length > r->imageSize)
+        {
+            espnow_ota_receiver_reply(r, ESPNOW_OTA_ACK, ESPNOW_OTA_STATUS_TOO_LARGE, r->imageCrc);
+            return true;
+        }
+        EspNowOtaStatus status = r->io.write(r->io.ctx, hdr.offset, payload, hdr.length);
+        if (status == ESPNOW_OTA_STATUS_OK)
+            r->offset += hdr.length;
+        espnow_ota_receiver_reply(r, ESPNOW_OTA_ACK, status, r->imageCrc);
+        return true;
+    }
+    case ESPNOW_OTA_END:
+    {
+        if (len < sizeof(EspNowOtaEnd))
+            return true;
+        EspNowOtaEnd msg;
+        memcpy(&msg, data, sizeof(msg));
+        if (!r->active)
+        {
+            // A lost result is re-sent; otherwise the sender must start over.
+            uint8_t status = (r->finished && msg.imageCrc == r->imageCrc) ? r->result
+                                                                           : (uint8_t)ESPNOW_OTA_STATUS_NO_SESSION;
+            espnow_ota_receiver_reply(r, ESPNOW_OTA_RESULT, status, msg.imageCrc);
+            return true;
+        }
+        if (msg.imageCrc != r->imageCrc || msg.imageSize != r->imageSize)
+        {
+            espnow_ota_receiver_reply(r, ESPNOW_OTA_RESULT, ESPNOW_OTA_STATUS_NO_SESSION, msg.imageCrc);
+            return true;
+        }
+        if (r->offset != r->imageSize)
+        {
+            espnow_ota_receiver_reply(r, ESPNOW_OTA_ACK, ESPNOW_OTA_STATUS_OUT_OF_ORDER, r->imageCrc);
+            return true;
+        }
+        r->active = false;
+        r->finished = true;
+        r->result = (uint8_t)r->io.finish(r->io.ctx, r->imageSize, r->imageCrc);
+        espnow_ota_receiver_reply(r, ESPNOW_OTA_RESULT, r->result, r->imageCrc);
+        return true;
+    }
+    case ESPNOW_OTA_ABORT:
+        if (r->active)
+            r->io.abort(r->io.ctx);
+        r->active = false;
+        return true;
+    default:
+        return false;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -11,9 +11,14 @@
 
 // Handshake acknowledgement sent by the controller back to the display. The
 // second byte contains the controller's view of the active channel so the
-// display can detect mismatches and re-negotiate.
+// display can detect mismatches and re-negotiate. The third byte, when
+// present, is a bitmask of ESPNOW_HANDSHAKE_FLAG_*.
 #define ESPNOW_HANDSHAKE_ACK 0x55
 
+// Controller holds a parameter subscription (ESPNOW_PARAM_SUBSCRIBE); when
+// clear after a controller reboot or link loss, the display subscribes again.
+#define ESPNOW_HANDSHAKE_FLAG_PARAMS 0x01
+
 // Sent by the display after successfully processing a sensor packet.
 #define ESPNOW_SENSOR_ACK 0x5A
 
@@ -25,6 +30,114 @@
 #define ESPNOW_CONTROL_FLAG_STEAM 0x02
 #define ESPNOW_CONTROL_FLAG_PUMP_PRESSURE 0x04
 
+// Controller firmware update relayed by the display. The display streams an
+// image in CRC-protected chunks; the controller acknowledges the highest
+// contiguous offset it has committed to flash. See espnow_ota.h for the
+// sender/receiver state machines.
+#define ESPNOW_OTA_BEGIN 0xE0     // display -> controller: announce image
+#define ESPNOW_OTA_BEGIN_ACK 0xE1 // controller -> display: accept + resume offset
+#define ESPNOW_OTA_CHUNK 0xE2     // display -> controller: image data
+#define ESPNOW_OTA_ACK 0xE3       // controller -> display: cumulative progress
+#define ESPNOW_OTA_END 0xE4       // display -> controller: all data sent, verify
+#define ESPNOW_OTA_RESULT 0xE5    // controller -> display: final verdict
+#define ESPNOW_OTA_ABORT 0xE6     // either direction: cancel the session
+
+// Sensor calibration: the display starts/finishes a guided run, the
+// controller answers every command with its current table and run statistics.
+#define ESPNOW_CAL_COMMAND 0xC8 // display -> controller: EspNowCalCommand
+#define ESPNOW_CAL_REPORT 0xC9  // controller -> display: EspNowCalReport
+
+// Wall-clock time served by the display (which has Wi-Fi/NTP) to the
+// controller. NTP-style four-timestamp exchange: the controller stamps its
+// monotonic clock on send (t1) and receive (t4), the display stamps its UTC
+// clock on receive (t2) and send (t3), giving offset and round-trip time.
+#define ESPNOW_TIME_REQUEST 0xD0  // controller -> display: EspNowTimeRequest
+#define ESPNOW_TIME_RESPONSE 0xD1 // display -> controller: EspNowTimeResponse
+
+// Bit flags embedded in EspNowTimeResponse::flags.
+#define ESPNOW_TIME_FLAG_VALID 0x01 // display clock is NTP-synchronised
+
+// Bit flags embedded in EspNowPacket::puckFlags.
+#define ESPNOW_PUCK_FLAG_VALID 0x01      // puck resistance is being tracked
+#define ESPNOW_PUCK_FLAG_CHANNELING 0x02 // a channeling event is being held
+
+// Condensed statistics of a finished shot, sent a few times after the pump
+// stops (the display de-duplicates on shotId).
+#define ESPNOW_SHOT_SUMMARY 0xD4 // controller -> display: EspNowShotSummary
+
+// Bit flags embedded in EspNowShotSummary::flags.
+#define ESPNOW_SHOT_FLAG_CHANNELING 0x01 // at least one channeling event
+
+// Lifetime heater/pump usage counters, sent every few seconds. Persisted by
+// the controller, so the totals survive reboots.
+#define ESPNOW_ENERGY 0xD5 // controller -> display: EspNowEnergy
+
+// Control-loop timing: per-stage worst case, deadline overruns and
+// supervisor trips (stalls that forced the heater and pump off).
+#define ESPNOW_LOOP_STATS 0xD6 // controller -> display: EspNowLoopStats
+
+// Bit flags embedded in EspNowLoopStats::flags.
+#define ESPNOW_LOOP_FLAG_WDT_RESET 0x01 // the last reset was a watchdog reset
+#define ESPNOW_LOOP_FLAG_IRAM 0x02      // hot control path built into IRAM
+
+// Stage slots carried in EspNowLoopStats.
+#define ESPNOW_LOOP_STAGES 16
+
+// Flight recorder: the last few seconds of control state before the previous
+// reset, kept in RTC memory and sent in chunks after each link-up.
+#define ESPNOW_FLIGHT_CHUNK 0xD7 // controller -> display: EspNowFlightChunk
+
+// Samples per flight record and per chunk.
+#define ESPNOW_FLIGHT_MAX_SAMPLES 128
+#define ESPNOW_FLIGHT_CHUNK_SAMPLES 12
+
+// Bit flags embedded in EspNowFlightSample::flags.
+#define ESPNOW_FLIGHT_FLAG_HEATER_ON 0x01      // SSR on at the sample
+#define ESPNOW_FLIGHT_FLAG_HEATER_ENABLED 0x02
+#define ESPNOW_FLIGHT_FLAG_SHOT 0x04
+#define ESPNOW_FLIGHT_FLAG_STEAM 0x08
+#define ESPNOW_FLIGHT_FLAG_PRESSURE_MODE 0x10
+#define ESPNOW_FLIGHT_FLAG_LINKED 0x20         // display link up
+#define ESPNOW_FLIGHT_FLAG_OVERRUN 0x40        // a pass since the last sample overran
+#define ESPNOW_FLIGHT_FLAG_TRIP 0x80           // the supervisor tripped since the last sample
+
+// Per-channel min/max/mean/last of every sample the controller took since the
+// previous telemetry packet, sent right after it. The packet itself carries
+// snapshots and misses anything shorter than the send interval.
+#define ESPNOW_TELEMETRY_STATS 0xD8 // controller -> display: EspNowTelemetryStats
+
+// Controller health: uptime, reset cause, loop rate, heap, interrupt counts and
+// ESP-NOW link counters, sent every few seconds.
+#define ESPNOW_HEALTH 0xD9 // controller -> display: EspNowHealth
+
+// Heater mode transitions: steam-ready and brew-recovery times plus the
+// learned holding duty per mode. Sent a few times after each completed
+// transition (the display de-duplicates on seq).
+#define ESPNOW_HEATER_MODES 0xDA // controller -> display: EspNowHeaterModes
+
+// Parameter registry access (ids and ranges in param_registry.h). Frames are
+// variable length: a 4-byte header followed by count entries, so a set carries
+// only the parameters that changed. The controller answers every get and set
+// with a report of the values it applied (seq echoed) and, once subscribed,
+// pushes a report (seq 0) whenever a subscribed parameter changes.
+#define ESPNOW_PARAM_GET 0xC4       // display -> controller: EspNowParamIds
+#define ESPNOW_PARAM_SUBSCRIBE 0xC5 // display -> controller: EspNowParamIds
+#define ESPNOW_PARAM_SET 0xC6       // display -> controller: EspNowParamValues
+#define ESPNOW_PARAM_REPORT 0xC7    // controller -> display: EspNowParamValues
+
+// Entries per parameter frame, and frame length for a given count.
+#define ESPNOW_PARAM_MAX_ENTRIES 24
+#define ESPNOW_PARAM_HEADER_LEN 4
+#define ESPNOW_PARAM_IDS_LEN(count) (ESPNOW_PARAM_HEADER_LEN + 2 * (count))
+#define ESPNOW_PARAM_VALUES_LEN(count) (ESPNOW_PARAM_HEADER_LEN + 8 * (count))
+
+// Breakpoints per calibration curve carried in EspNowCalReport.
+#define ESPNOW_CAL_POINTS 6
+
+// Largest image payload carried by a single ESPNOW_OTA_CHUNK. Keeps the whole
+// frame comfortably below the 250 byte ESP-NOW limit.
+#define ESPNOW_OTA_CHUNK_MAX 200
+
 // Pump operating modes understood by the controller. The display always sends
 // one of these values in EspNowControlPacket::pumpMode.
 typedef enum
@@ -51,14 +164,15 @@ typedef struct __attribute__((packed)) EspNowPacket
     float brewSetpointC;       //!< Brew temperature setpoint in °C
     float pressureSetpointBar; //!< Target brew pressure in bar
     uint8_t pumpPressureMode;  //!< 1 if pressure limiting mode is active
-    uint8_t reserved[3];       //!< Reserved for future use / alignment
+    uint8_t puckFlags;         //!< Bitmask of ESPNOW_PUCK_FLAG_*
+    uint16_t steamDetectMs;    //!< Steam switch-on to detection latency of the last entry (ms)
     float pumpPowerPercent;    //!< Current pump power output in percent
     float pidPTerm;            //!< Proportional contribution of the temperature PID
     float pidITerm;            //!< Integral contribution of the temperature PID
     float pidDTerm;            //!< Derivative contribution of the temperature PID
     uint32_t zcCount;          //!< Zero-cross count since boot
     uint32_t pulseCount;       //!< Flow meter pulse count since boot
-    uint32_t acCount;          //!< AC sense count accumulated while steaming
+    uint32_t acCount;          //!< AC sense edges in the current AC run
 } EspNowPacket;
 
 // Control payload mirrored between Home Assistant, the display and the
@@ -68,7 +182,7 @@ typedef struct __attribute__((packed)) EspNowControlPacket
     uint8_t type;      //!< Constant ESPNOW_CONTROL_PACKET
     uint8_t flags;     //!< Bitmask of ESPNOW_CONTROL_FLAG_*
     uint8_t pumpMode;  //!< EspNowPumpMode value
-    uint8_t reserved;  //!< Reserved for future use / alignment
+    uint8_t ecoSetpointC; //!< Eco hold in whole degC replacing the brew setpoint; 0 = off
     uint32_t revision; //!< Monotonic revision to detect stale commands
     float brewSetpointC;
     float steamSetpointC;
@@ -81,11 +195,394 @@ typedef struct __attribute__((packed)) EspNowControlPacket
     float pressureSetpointBar;
 } EspNowControlPacket;
 
+// Sensors that can be calibrated through ESPNOW_CAL_COMMAND.
+typedef enum
+{
+    ESPNOW_CAL_TARGET_FLOW = 0,     //!< Flow meter: x = pulse rate (Hz), y = mL per pulse
+    ESPNOW_CAL_TARGET_PRESSURE = 1, //!< Pressure transducer: x = ADC mV, y = bar
+} EspNowCalTarget;
+
+typedef enum
+{
+    ESPNOW_CAL_ACTION_STATUS = 0, //!< Report only
+    ESPNOW_CAL_ACTION_START = 1,  //!< Begin collecting a run
+    ESPNOW_CAL_ACTION_FINISH = 2, //!< End the run against EspNowCalCommand::reference
+    ESPNOW_CAL_ACTION_CANCEL = 3, //!< Discard the running run
+    ESPNOW_CAL_ACTION_RESET = 4,  //!< Restore the factory curve and forget past runs
+} EspNowCalAction;
+
+typedef enum
+{
+    ESPNOW_CAL_UNIT_ML = 0,   //!< Reference is a volume in mL
+    ESPNOW_CAL_UNIT_GRAM = 1, //!< Reference is a mass of water in g
+} EspNowCalUnit;
+
+typedef enum
+{
+    ESPNOW_CAL_STATE_IDLE = 0,
+    ESPNOW_CAL_STATE_RUNNING = 1,
+    ESPNOW_CAL_STATE_DONE = 2,   //!< Last run was fitted into the curve
+    ESPNOW_CAL_STATE_FAILED = 3, //!< Last run was rejected (too short / implausible)
+} EspNowCalState;
+
+typedef struct __attribute__((packed)) EspNowCalCommand
+{
+    uint8_t type;    //!< Constant ESPNOW_CAL_COMMAND
+    uint8_t target;  //!< EspNowCalTarget
+    uint8_t action;  //!< EspNowCalAction
+    uint8_t unit;    //!< EspNowCalUnit of reference
+    float reference; //!< Measured reference for ESPNOW_CAL_ACTION_FINISH
+} EspNowCalCommand;
+
+typedef struct __attribute__((packed)) EspNowCalReport
+{
+    uint8_t type;      //!< Constant ESPNOW_CAL_REPORT
+    uint8_t target;    //!< EspNowCalTarget
+    uint8_t state;     //!< EspNowCalState
+    uint8_t runs;      //!< Runs contributing to the current fit
+    float reference;   //!< Reference of the last run (mL)
+    float measured;    //!< Sensor reading of the last run before the fit
+    float errorPct;    //!< (measured - reference) / reference of the last run
+    float residualPct; //!< RMS error over all contributing runs after the fit
+    uint32_t samples;  //!< Pulses/samples in the current or last run
+    float x[ESPNOW_CAL_POINTS]; //!< Curve breakpoints
+    float y[ESPNOW_CAL_POINTS]; //!< Curve values at the breakpoints
+} EspNowCalReport;
+
+typedef struct __attribute__((packed)) EspNowTimeRequest
+{
+    uint8_t type;        //!< Constant ESPNOW_TIME_REQUEST
+    uint8_t seq;         //!< Echoed in the response
+    uint8_t reserved[6]; //!< Reserved for future use / alignment
+    uint64_t originUs;   //!< t1: controller monotonic clock at send (us)
+} EspNowTimeRequest;
+
+typedef struct __attribute__((packed)) EspNowTimeResponse
+{
+    uint8_t type;        //!< Constant ESPNOW_TIME_RESPONSE
+    uint8_t seq;         //!< EspNowTimeRequest::seq
+    uint8_t flags;       //!< Bitmask of ESPNOW_TIME_FLAG_*
+    uint8_t reserved[5]; //!< Reserved for future use / alignment
+    uint64_t originUs;   //!< t1 echoed from the request
+    int64_t receiveUs;   //!< t2: display UTC at request receipt (us since epoch)
+    int64_t transmitUs;  //!< t3: display UTC at response send (us since epoch)
+} EspNowTimeResponse;
+
+typedef struct __attribute__((packed)) EspNowShotSummary
+{
+    uint8_t type;           //!< Constant ESPNOW_SHOT_SUMMARY
+    uint8_t flags;          //!< Bitmask of ESPNOW_SHOT_FLAG_*
+    uint16_t shotId;        //!< Increments per shot since boot
+    uint32_t durationMs;    //!< Shot start to last pump activity
+    uint32_t preinfusionMs; //!< Until pressure crossed the pre-infusion threshold
+    uint32_t firstDripMs;   //!< Estimated from pumped volume; 0 if not reached
+    float volumeMl;         //!< Total pumped volume
+    float preinfusionMl;    //!< Volume pumped during pre-infusion
+    float peakBar;
+    float meanBar;          //!< Time-weighted mean pressure
+    float meanFlowMlS;
+    float tempDevCs;        //!< Integral of |T - setpoint| (degC * s)
+    float maxTempDevC;
+    float pumpEnergyJ;      //!< Estimated pump electrical energy
+    uint16_t channelEvents; //!< Channeling events detected during the shot
+    uint16_t reserved;      //!< Reserved for future use / alignment
+    float meanResistance;   //!< Mean puck resistance, bar / (mL/s); 0 if never tracked
+    float meanBrewC;        //!< Mean estimated brew-water temperature; 0 if no estimate
+} EspNowShotSummary;
+
+// Machine states the energy counters are split by (EspNowEnergy indices).
+typedef enum
+{
+    ESPNOW_ENERGY_STATE_IDLE = 0,  //!< Heater enabled, holding temperature
+    ESPNOW_ENERGY_STATE_SHOT = 1,  //!< Shot in progress
+    ESPNOW_ENERGY_STATE_STEAM = 2, //!< Steam mode
+    ESPNOW_ENERGY_STATES = 3,
+} EspNowEnergyState;
+
+// Heater time is the SSR on-time; energy is heaterOnS * elementW. State time
+// only accrues while the heater is enabled, so heaterOnS / stateS is the
+// duty cycle needed to hold each state.
+typedef struct __attribute__((packed)) EspNowEnergy
+{
+    uint8_t type;                             //!< Constant ESPNOW_ENERGY
+    uint8_t reserved;                         //!< Reserved for future use / alignment
+    uint16_t elementW;                        //!< Heater element rating used for energy
+    uint32_t stateS[ESPNOW_ENERGY_STATES];    //!< Time spent in each state
+    uint32_t heaterOnS[ESPNOW_ENERGY_STATES]; //!< Heater on-time in each state
+    uint32_t pumpOnS;                         //!< Pump running time
+    uint32_t heaterCycles;                    //!< Heater off -> on switches
+    uint32_t pumpCycles;                      //!< Pump starts
+    uint32_t shots;                           //!< Shots pulled
+    uint32_t boots;                           //!< Controller boots
+    float dutyPct;                            //!< Heater duty over roughly the last minute
+} EspNowEnergy;
+
+// Control-loop stages, in loop() order. OTHER covers the time between stages.
+typedef enum
+{
+    ESPNOW_LOOP_STAGE_OTHER = 0,
+    ESPNOW_LOOP_STAGE_LINK = 1,        //!< Display timeout check
+    ESPNOW_LOOP_STAGE_SHOT = 2,        //!< Shot start/stop detection
+    ESPNOW_LOOP_STAGE_PID = 3,         //!< Temperature read + heater PID
+    ESPNOW_LOOP_STAGE_PWM = 4,         //!< Heater output
+    ESPNOW_LOOP_STAGE_PRESSURE = 5,    //!< Pressure read + pump output
+    ESPNOW_LOOP_STAGE_FLOW = 6,        //!< Pre-flow and volume
+    ESPNOW_LOOP_STAGE_STEAM = 7,       //!< Steam flag
+    ESPNOW_LOOP_STAGE_ANALYTICS = 8,   //!< Shot analytics + energy metering
+    ESPNOW_LOOP_STAGE_CAL = 9,         //!< Calibration commands/reports
+    ESPNOW_LOOP_STAGE_PARAMS = 10,     //!< Parameter persistence (NVS)
+    ESPNOW_LOOP_STAGE_OTA = 11,        //!< OTA receiver
+    ESPNOW_LOOP_STAGE_TELEMETRY = 12,  //!< ESP-NOW sends
+    ESPNOW_LOOP_STAGE_LOG = 13,        //!< Serial diagnostics
+    ESPNOW_LOOP_STAGE_COUNT = 14,
+} EspNowLoopStage;
+
+// Hot-path sections timed in CPU cycles in EspNowLoopStats.
+typedef enum
+{
+    ESPNOW_LOOP_HOT_PID = 0,      //!< Heater PID step
+    ESPNOW_LOOP_HOT_PRESSURE = 1, //!< Pressure conversion and pump output
+    ESPNOW_LOOP_HOT_FLOW = 2,     //!< Flow pulses to volume
+    ESPNOW_LOOP_HOT_SECTIONS = 3,
+} EspNowLoopHotSection;
+
+// Times are since the controller booted.
+typedef struct __attribute__((packed)) EspNowLoopStats
+{
+    uint8_t type;                               //!< Constant ESPNOW_LOOP_STATS
+    uint8_t flags;                              //!< Bitmask of ESPNOW_LOOP_FLAG_*
+    uint8_t lastOverrunStage;                   //!< EspNowLoopStage of the last overrun
+    uint8_t lastTripStage;                      //!< EspNowLoopStage the loop was stuck in
+    uint32_t deadlineUs;                        //!< Per-pass deadline
+    uint32_t tripUs;                            //!< Stall time that trips the supervisor
+    uint32_t ticks;                             //!< Loop passes
+    uint32_t overruns;                          //!< Passes over the deadline
+    uint32_t trips;                             //!< Supervisor trips
+    uint32_t worstTickUs;                       //!< Longest pass
+    uint32_t stageMaxUs[ESPNOW_LOOP_STAGES];    //!< Longest time in each stage
+    uint16_t stageOverruns[ESPNOW_LOOP_STAGES]; //!< Overruns charged to each stage
+    uint32_t hotMinCycles[ESPNOW_LOOP_HOT_SECTIONS];  //!< Fastest run of each hot section
+    uint32_t hotMaxCycles[ESPNOW_LOOP_HOT_SECTIONS];  //!< Slowest run of each hot section
+    uint32_t hotMeanCycles[ESPNOW_LOOP_HOT_SECTIONS]; //!< Mean run of each hot section
+    uint16_t cpuMhz;                            //!< CPU clock, to convert cycles to time
+    uint8_t controlCore;                        //!< Core the control loop runs on
+    uint8_t reserved;
+} EspNowLoopStats;
+
+// Channels carried in EspNowTelemetryStats.
+typedef enum
+{
+    ESPNOW_STATS_TEMP = 0,         //!< Boiler temperature (°C), every PID pass
+    ESPNOW_STATS_PRESSURE = 1,     //!< Brew pressure (bar), every pressure sample
+    ESPNOW_STATS_PUMP_POWER = 2,   //!< Pump output (%), every pressure sample
+    ESPNOW_STATS_HEATER_POWER = 3, //!< Heater duty (%), every PID pass
+    ESPNOW_STATS_CHANNELS = 4,
+} EspNowStatsChannel;
+
+// Statistics of one channel over a window; min, max and mean are 0 when count is 0.
+typedef struct __attribute__((packed)) EspNowChannelStats
+{
+    float min;
+    float max;
+    float mean;
+    float last;        //!< Most recent sample, possibly from before the window
+    uint16_t count;    //!< Samples in the window (saturates)
+    uint16_t reserved; //!< Reserved for future use / alignment
+} EspNowChannelStats;
+
+typedef struct __attribute__((packed)) EspNowTelemetryStats
+{
+    uint8_t type;                                    //!< Constant ESPNOW_TELEMETRY_STATS
+    uint8_t channels;                                //!< ESPNOW_STATS_CHANNELS
+    uint16_t reserved;                               //!< Reserved for future use / alignment
+    uint32_t windowMs;                               //!< Time covered by this report
+    EspNowChannelStats stats[ESPNOW_STATS_CHANNELS]; //!< Indexed by EspNowStatsChannel
+} EspNowTelemetryStats;
+
+// Counters run since the controller booted; the display derives rates.
+typedef struct __attribute__((packed)) EspNowHealth
+{
+    uint8_t type;                //!< Constant ESPNOW_HEALTH
+    uint8_t resetReason;         //!< esp_reset_reason_t of this boot
+    uint8_t channel;             //!< Wi-Fi channel ESP-NOW runs on
+    uint8_t reserved;            //!< Reserved for future use / alignment
+    uint32_t uptimeS;            //!< Time since boot
+    uint32_t boots;              //!< Controller boots (persisted)
+    float loopHz;                //!< Control-loop passes per second since the last report
+    uint32_t freeHeap;           //!< Free heap now (bytes)
+    uint32_t minFreeHeap;        //!< Lowest free heap since boot (bytes)
+    uint32_t maxAllocHeap;       //!< Largest allocatable block (bytes)
+    uint32_t loopStackFree;      //!< Least free stack the loop task has had (bytes)
+    uint32_t zcIsrs;             //!< Zero-cross interrupts
+    uint32_t flowIsrs;           //!< Flow meter interrupts, including debounced ones
+    uint32_t acIsrs;             //!< Steam AC sense interrupts
+    uint32_t phaseCyclesDropped; //!< Mains cycles the pressure sampler could not use
+    uint32_t sendOk;             //!< Unicast frames the display acknowledged
+    uint32_t sendNoAck;          //!< Unicast frames sent without an acknowledgement
+    uint32_t sendErrors;         //!< Frames the ESP-NOW driver refused (queue full, no peer)
+    uint32_t recvFrames;         //!< Frames received from the display
+    uint32_t logDropped;         //!< Serial log lines dropped because the queue was full
+} EspNowHealth;
+
+typedef struct __attribute__((packed)) EspNowHeaterModes
+{
+    uint8_t type;            //!< Constant ESPNOW_HEATER_MODES
+    uint8_t mode;            //!< Heater mode now: 0 = brew, 1 = steam
+    uint16_t seq;            //!< Increments per completed transition since boot
+    uint32_t steamReadyMs;   //!< Last steam entry to steam setpoint; 0 until measured
+    uint32_t brewRecoveryMs; //!< Last steam exit back to brew setpoint; 0 until measured
+    float steamStartC;       //!< Boiler temperature the last steam-ready run started from
+    float brewStartC;        //!< Boiler temperature the last brew recovery started from
+    float brewHoldPct;       //!< Learned heater duty holding the brew setpoint
+    float steamHoldPct;      //!< Learned heater duty holding the steam setpoint
+} EspNowHeaterModes;
+
+// One flight recorder sample. Times are since the recorded run booted.
+typedef struct __attribute__((packed)) EspNowFlightSample
+{
+    uint32_t ms;
+    int16_t tempC100;        //!< Boiler temperature (0.01 degC)
+    int16_t setC10;          //!< Active setpoint (0.1 degC)
+    int16_t pressBar100;     //!< Pressure (0.01 bar)
+    uint8_t heatPct;         //!< Heater PID output
+    uint8_t pumpPct;         //!< Applied pump power
+    uint8_t flags;           //!< Bitmask of ESPNOW_FLIGHT_FLAG_*
+    uint8_t worstStage;      //!< EspNowLoopStage of the slowest stage in worstPass100us
+    uint16_t worstPass100us; //!< Longest loop pass since the last sample (0.1 ms)
+} EspNowFlightSample;
+
+typedef struct __attribute__((packed)) EspNowFlightChunk
+{
+    uint8_t type;            //!< Constant ESPNOW_FLIGHT_CHUNK
+    uint8_t resetReason;     //!< esp_reset_reason_t that ended the recorded run
+    uint8_t endStage;        //!< EspNowLoopStage the recorded run was in when it ended
+    uint8_t count;           //!< Valid entries in samples
+    uint32_t recordId;       //!< Boot number of the recorded run
+    uint16_t first;          //!< Index of samples[0] in the record, oldest first
+    uint16_t total;          //!< Samples in the whole record
+    uint16_t samplePeriodMs;
+    uint16_t reserved;
+    EspNowFlightSample samples[ESPNOW_FLIGHT_CHUNK_SAMPLES];
+} EspNowFlightChunk;
+
+// Per-entry result carried in EspNowParamValue::status of a report.
+typedef enum
+{
+    ESPNOW_PARAM_STATUS_OK = 0,
+    ESPNOW_PARAM_STATUS_CLAMPED = 1, //!< Out of range; the nearest limit was applied
+    ESPNOW_PARAM_STATUS_UNKNOWN = 2, //!< No parameter with this id
+    ESPNOW_PARAM_STATUS_INVALID = 3, //!< Not a number; nothing changed
+} EspNowParamStatus;
+
+typedef struct __attribute__((packed)) EspNowParamValue
+{
+    uint16_t id;      //!< ParamId
+    uint8_t status;   //!< EspNowParamStatus in reports; 0 in sets
+    uint8_t reserved;
+    float value;      //!< Requested (set) or applied (report) value
+} EspNowParamValue;
+
+typedef struct __attribute__((packed)) EspNowParamIds
+{
+    uint8_t type;  //!< ESPNOW_PARAM_GET or ESPNOW_PARAM_SUBSCRIBE
+    uint8_t seq;   //!< Echoed in the report, non-zero
+    uint8_t count; //!< Valid entries in ids; 0 = every parameter
+    uint8_t reserved;
+    uint16_t ids[ESPNOW_PARAM_MAX_ENTRIES];
+} EspNowParamIds;
+
+// A subscribe replaces the previous subscription and is answered with the
+// current value of every subscribed parameter. Subscriptions end with the link.
+typedef struct __attribute__((packed)) EspNowParamValues
+{
+    uint8_t type;  //!< ESPNOW_PARAM_SET or ESPNOW_PARAM_REPORT
+    uint8_t seq;   //!< Set: non-zero; report: seq of the request answered, 0 = change push
+    uint8_t count; //!< Valid entries in values
+    uint8_t reserved;
+    EspNowParamValue values[ESPNOW_PARAM_MAX_ENTRIES];
+} EspNowParamValues;
+
+// Status codes carried by OTA acknowledgements and results.
+typedef enum
+{
+    ESPNOW_OTA_STATUS_OK = 0,
+    ESPNOW_OTA_STATUS_CRC_ERROR = 1,     //!< Chunk CRC mismatch, resend from ack offset
+    ESPNOW_OTA_STATUS_OUT_OF_ORDER = 2,  //!< Chunk offset ahead of ack offset
+    ESPNOW_OTA_STATUS_WRITE_ERROR = 3,   //!< Flash erase/write failed
+    ESPNOW_OTA_STATUS_NO_SESSION = 4,    //!< Chunk/end received without a begin
+    ESPNOW_OTA_STATUS_VERIFY_FAILED = 5, //!< Image CRC or app header invalid
+    ESPNOW_OTA_STATUS_TOO_LARGE = 6,     //!< Image exceeds the OTA partition
+    ESPNOW_OTA_STATUS_ABORTED = 7,       //!< Session cancelled by the peer
+    ESPNOW_OTA_STATUS_BUSY = 8,          //!< Receiver cannot update right now (e.g. mid-shot)
+} EspNowOtaStatus;
+
+// Announces an image. The (imageSize, imageCrc) pair identifies the image so
+// an interrupted transfer can resume from the receiver's committed offset.
+typedef struct __attribute__((packed)) EspNowOtaBegin
+{
+    uint8_t type;       //!< Constant ESPNOW_OTA_BEGIN
+    uint8_t window;     //!< Max chunks in flight before an ack is required
+    uint16_t chunkSize; //!< Payload bytes per chunk (<= ESPNOW_OTA_CHUNK_MAX)
+    uint32_t imageSize; //!< Total image length in bytes
+    uint32_t imageCrc;  //!< CRC-32 of the complete image
+} EspNowOtaBegin;
+
+// Reply to begin/chunk/end messages. offset is the number of contiguous bytes
+// the receiver has committed; the sender resumes transmission from there.
+typedef struct __attribute__((packed)) EspNowOtaAck
+{
+    uint8_t type;      //!< ESPNOW_OTA_BEGIN_ACK, ESPNOW_OTA_ACK or ESPNOW_OTA_RESULT
+    uint8_t status;    //!< EspNowOtaStatus value
+    uint8_t reserved[2];
+    uint32_t offset;   //!< Committed byte count
+    uint32_t imageCrc; //!< Echo of the session image CRC
+} EspNowOtaAck;
+
+// Header preceding the image bytes of an ESPNOW_OTA_CHUNK frame. The frame is
+// sizeof(EspNowOtaChunkHeader) + length bytes long.
+typedef struct __attribute__((packed)) EspNowOtaChunkHeader
+{
+    uint8_t type;    //!< Constant ESPNOW_OTA_CHUNK
+    uint8_t reserved;
+    uint16_t length; //!< Payload bytes following the header
+    uint32_t offset; //!< Image offset of the first payload byte
+    uint32_t crc;    //!< CRC-32 of the payload bytes
+} EspNowOtaChunkHeader;
+
+// Sent once every byte has been acknowledged, and as ESPNOW_OTA_ABORT to cancel.
+typedef struct __attribute__((packed)) EspNowOtaEnd
+{
+    uint8_t type;       //!< ESPNOW_OTA_END or ESPNOW_OTA_ABORT
+    uint8_t reserved[3];
+    uint32_t imageSize;
+    uint32_t imageCrc;
+} EspNowOtaEnd;
+
 // Expected packed structure sizes so both firmware images agree on layout.
 enum
 {
     ESPNOW_PACKET_SIZE = 67,
     ESPNOW_CONTROL_PACKET_SIZE = 44,
+    ESPNOW_OTA_BEGIN_SIZE = 12,
+    ESPNOW_OTA_ACK_SIZE = 12,
+    ESPNOW_OTA_CHUNK_HEADER_SIZE = 12,
+    ESPNOW_OTA_END_SIZE = 12,
+    ESPNOW_CAL_COMMAND_SIZE = 8,
+    ESPNOW_CAL_REPORT_SIZE = 72,
+    ESPNOW_TIME_REQUEST_SIZE = 16,
+    ESPNOW_TIME_RESPONSE_SIZE = 32,
+    ESPNOW_SHOT_SUMMARY_SIZE = 60,
+    ESPNOW_ENERGY_SIZE = 52,
+    ESPNOW_LOOP_STATS_SIZE = 164,
+    ESPNOW_FLIGHT_SAMPLE_SIZE = 16,
+    ESPNOW_FLIGHT_CHUNK_SIZE = 208,
+    ESPNOW_CHANNEL_STATS_SIZE = 20,
+    ESPNOW_TELEMETRY_STATS_SIZE = 88,
+    ESPNOW_HEALTH_SIZE = 68,
+    ESPNOW_HEATER_MODES_SIZE = 28,
+    ESPNOW_PARAM_VALUE_SIZE = 8,
+    ESPNOW_PARAM_IDS_SIZE = 52,
+    ESPNOW_PARAM_VALUES_SIZE = 196,
 };
 
 #ifdef __cplusplus
@@ -93,8 +590,72 @@ static_assert(sizeof(EspNowPacket) == ESPNOW_PACKET_SIZE,
               "EspNowPacket size mismatch - check shared espnow_protocol.h");
 static_assert(sizeof(EspNowControlPacket) == ESPNOW_CONTROL_PACKET_SIZE,
               "EspNowControlPacket size mismatch - check shared espnow_protocol.h");
+static_assert(sizeof(EspNowOtaBegin) == ESPNOW_OTA_BEGIN_SIZE,
+              "EspNowOtaBegin size mismatch - check shared espnow_protocol.h");
+static_assert(sizeof(EspNowOtaAck) == ESPNOW_OTA_ACK_SIZE,
+              "EspNowOtaAck size mismatch - check shared espnow_protocol.h");
+static_assert(sizeof(EspNowOtaChunkHeader) == ESPNOW_OTA_CHUNK_HEADER_SIZE,
+              "EspNowOtaChunkHeader size mismatch - check shared espnow_protocol.h");
+static_assert(sizeof(EspNowOtaEnd) == ESPNOW_OTA_END_SIZE,
+              "EspNowOtaEnd size mismatch - check shared espnow_protocol.h");
+static_assert(sizeof(EspNowCalCommand) == ESPNOW_CAL_COMMAND_SIZE,
+              "EspNowCalCommand size mismatch - check shared espnow_protocol.h");
+static_assert(sizeof(EspNowCalReport) == ESPNOW_CAL_REPORT_SIZE,
+              "EspNowCalReport size mismatch - check shared espnow_protocol.h");
+static_assert(sizeof(EspNowTimeRequest) == ESPNOW_TIME_REQUEST_SIZE,
+              "EspNowTimeRequest size mismatch - check shared espnow_protocol.h");
+static_assert(sizeof(EspNowTimeResponse) == ESPNOW_TIME_RESPONSE_SIZE,
+              "EspNowTimeResponse size mismatch - check shared espnow_protocol.h");
+static_assert(sizeof(EspNowShotSummary) == ESPNOW_SHOT_SUMMARY_SIZE,
+              "EspNowShotSummary size mismatch - check shared espnow_protocol.h");
+static_assert(sizeof(EspNowEnergy) == ESPNOW_ENERGY_SIZE,
+              "EspNowEnergy size mismatch - check shared espnow_protocol.h");
+static_assert(sizeof(EspNowLoopStats) == ESPNOW_LOOP_STATS_SIZE,
+              "EspNowLoopStats size mismatch - check shared espnow_protocol.h");
+static_assert(sizeof(EspNowFlightSample) == ESPNOW_FLIGHT_SAMPLE_SIZE,
+              "EspNowFlightSample size mismatch - check shared espnow_protocol.h");
+static_assert(sizeof(EspNowFlightChunk) == ESPNOW_FLIGHT_CHUNK_SIZE,
+              "EspNowFlightChunk size mismatch - check shared espnow_protocol.h");
+static_assert(sizeof(EspNowChannelStats) == ESPNOW_CHANNEL_STATS_SIZE,
+              "EspNowChannelStats size mismatch - check shared espnow_protocol.h");
+static_assert(sizeof(EspNowTelemetryStats) == ESPNOW_TELEMETRY_STATS_SIZE,
+              "EspNowTelemetryStats size mismatch - check shared espnow_protocol.h");
+static_assert(sizeof(EspNowHealth) == ESPNOW_HEALTH_SIZE,
+              "EspNowHealth size mismatch - check shared espnow_protocol.h");
+static_assert(sizeof(EspNowHeaterModes) == ESPNOW_HEATER_MODES_SIZE,
+              "EspNowHeaterModes size mismatch - check shared espnow_protocol.h");
+static_assert(sizeof(EspNowParamValue) == ESPNOW_PARAM_VALUE_SIZE,
+              "EspNowParamValue size mismatch - check shared espnow_protocol.h");
+static_assert(sizeof(EspNowParamIds) == ESPNOW_PARAM_IDS_SIZE,
+              "EspNowParamIds size mismatch - check shared espnow_protocol.h");
+static_assert(sizeof(EspNowParamValues) == ESPNOW_PARAM_VALUES_SIZE,
+              "EspNowParamValues size mismatch - check shared espnow_protocol.h");
 #else
 typedef char espnow_packet_size_mismatch[(sizeof(EspNowPacket) == ESPNOW_PACKET_SIZE) ? 1 : -1];
 typedef char espnow_control_packet_size_mismatch[
     (sizeof(EspNowControlPacket) == ESPNOW_CONTROL_PACKET_SIZE) ? 1 : -1];
+typedef char espnow_ota_begin_size_mismatch[(sizeof(EspNowOtaBegin) == ESPNOW_OTA_BEGIN_SIZE) ? 1 : -1];
+typedef char espnow_ota_ack_size_mismatch[(sizeof(EspNowOtaAck) == ESPNOW_OTA_ACK_SIZE) ? 1 : -1];
+typedef char espnow_ota_chunk_header_size_mismatch[
+    (sizeof(EspNowOtaChunkHeader) == ESPNOW_OTA_CHUNK_HEADER_SIZE) ? 1 : -1];
+typedef char espnow_ota_end_size_mismatch[(sizeof(EspNowOtaEnd) == ESPNOW_OTA_END_SIZE) ? 1 : -1];
+typedef char espnow_cal_command_size_mismatch[(sizeof(EspNowCalCommand) == ESPNOW_CAL_COMMAND_SIZE) ? 1 : -1];
+typedef char espnow_cal_report_size_mismatch[(sizeof(EspNowCalReport) == ESPNOW_CAL_REPORT_SIZE) ? 1 : -1];
+typedef char espnow_time_request_size_mismatch[(sizeof(EspNowTimeRequest) == ESPNOW_TIME_REQUEST_SIZE) ? 1 : -1];
+typedef char espnow_time_response_size_mismatch[
+    (sizeof(EspNowTimeResponse) == ESPNOW_TIME_RESPONSE_SIZE) ? 1 : -1];
+typedef char espnow_shot_summary_size_mismatch[(sizeof(EspNowShotSummary) == ESPNOW_SHOT_SUMMARY_SIZE) ? 1 : -1];
+typedef char espnow_energy_size_mismatch[(sizeof(EspNowEnergy) == ESPNOW_ENERGY_SIZE) ? 1 : -1];
+typedef char espnow_loop_stats_size_mismatch[(sizeof(EspNowLoopStats) == ESPNOW_LOOP_STATS_SIZE) ? 1 : -1];
+typedef char espnow_flight_sample_size_mismatch[(sizeof(EspNowFlightSample) == ESPNOW_FLIGHT_SAMPLE_SIZE) ? 1 : -1];
+typedef char espnow_flight_chunk_size_mismatch[(sizeof(EspNowFlightChunk) == ESPNOW_FLIGHT_CHUNK_SIZE) ? 1 : -1];
+typedef char espnow_channel_stats_size_mismatch[(sizeof(EspNowChannelStats) == ESPNOW_CHANNEL_STATS_SIZE) ? 1 : -1];
+typedef char espnow_telemetry_stats_size_mismatch[
+    (sizeof(EspNowTelemetryStats) == ESPNOW_TELEMETRY_STATS_SIZE) ? 1 : -1];
+typedef char espnow_health_size_mismatch[(sizeof(EspNowHealth) == ESPNOW_HEALTH_SIZE) ? 1 : -1];
+typedef char espnow_heater_modes_size_mismatch[
+    (sizeof(EspNowHeaterModes) == ESPNOW_HEATER_MODES_SIZE) ? 1 : -1];
+typedef char espnow_param_value_size_mismatch[(sizeof(EspNowParamValue) == ESPNOW_PARAM_VALUE_SIZE) ? 1 : -1];
+typedef char espnow_param_ids_size_mismatch[(sizeof(EspNowParamIds) == ESPNOW_PARAM_IDS_SIZE) ? 1 : -1];
+typedef char espnow_param_values_size_mismatch[(sizeof(EspNowParamValues) == ESPNOW_PARAM_VALUES_SIZE) ? 1 : -1];
 #endif
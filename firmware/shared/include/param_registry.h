@@ -0,0 +1,112 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// Runtime-tunable controller parameters, declared once for both firmware
+// images. The controller binds each entry to the variable it controls; the
+// display reads, writes and subscribes to them by id over ESP-NOW
+// (ESPNOW_PARAM_* in espnow_protocol.h).
+//
+// Ids are wire identifiers: never renumber or reuse one. To retire a
+// parameter, delete its line. Values always travel as float; PARAM_TYPE_UINT
+// values are whole numbers and are rounded when set.
+
+typedef enum
+{
+    PARAM_TYPE_FLOAT = 0,
+    PARAM_TYPE_UINT = 1,
+} ParamType;
+
+// X(id, NAME, key, type, min, max, default, unit)
+#define PARAM_TABLE(X)                                                                             \
+    X(1, BREW_SETPOINT, "brewSetpoint", PARAM_TYPE_FLOAT, 87.0f, 97.0f, 92.0f, "C")                \
+    X(2, STEAM_SETPOINT, "steamSetpoint", PARAM_TYPE_FLOAT, 145.0f, 155.0f, 152.0f, "C")           \
+    X(3, HEATER_KP, "heaterKp", PARAM_TYPE_FLOAT, 0.0f, 100.0f, 8.0f, "")                          \
+    X(4, HEATER_KI, "heaterKi", PARAM_TYPE_FLOAT, 0.0f, 2.0f, 0.4f, "")                            \
+    X(5, HEATER_KD, "heaterKd", PARAM_TYPE_FLOAT, 0.0f, 500.0f, 17.0f, "")                         \
+    X(6, HEATER_I_GUARD, "heaterIGuard", PARAM_TYPE_FLOAT, 0.0f, 100.0f, 25.0f, "%")               \
+    X(7, HEATER_DTAU, "heaterDTau", PARAM_TYPE_FLOAT, 0.0f, 2.0f, 0.8f, "s")                       \
+    X(8, STEAM_KP, "steamKp", PARAM_TYPE_FLOAT, 0.0f, 100.0f, 10.0f, "")                           \
+    X(9, STEAM_KI, "steamKi", PARAM_TYPE_FLOAT, 0.0f, 2.0f, 0.2f, "")                              \
+    X(10, STEAM_KD, "steamKd", PARAM_TYPE_FLOAT, 0.0f, 500.0f, 30.0f, "")                          \
+    X(11, STEAM_I_GUARD, "steamIGuard", PARAM_TYPE_FLOAT, 0.0f, 100.0f, 40.0f, "%")                \
+    X(12, STEAM_DTAU, "steamDTau", PARAM_TYPE_FLOAT, 0.0f, 2.0f, 0.8f, "s")                        \
+    X(16, PUMP_POWER, "pumpPower", PARAM_TYPE_FLOAT, 0.0f, 100.0f, 95.0f, "%")                     \
+    X(17, PRESSURE_SETPOINT, "pressureSetpoint", PARAM_TYPE_FLOAT, 0.0f, 12.0f, 9.0f, "bar")       \
+    X(18, PUMP_KP, "pumpKp", PARAM_TYPE_FLOAT, 0.0f, 50.0f, 5.0f, "")                              \
+    X(19, PUMP_KI, "pumpKi", PARAM_TYPE_FLOAT, 0.0f, 20.0f, 1.0f, "")                              \
+    X(20, PUMP_KD, "pumpKd", PARAM_TYPE_FLOAT, 0.0f, 100.0f, 10.0f, "")                            \
+    X(21, PUMP_I_GUARD, "pumpIGuard", PARAM_TYPE_FLOAT, 0.0f, 100.0f, 25.0f, "")                   \
+    X(22, PUMP_DTAU, "pumpDTau", PARAM_TYPE_FLOAT, 0.05f, 5.0f, 0.8f, "s")                         \
+    X(23, PUMP_OUTPUT_SCALE, "pumpOutputScale", PARAM_TYPE_FLOAT, 0.0f, 2.0f, 0.6f, "")            \
+    X(24, PUMP_OUTPUT_OFFSET, "pumpOutputOffset", PARAM_TYPE_FLOAT, 0.0f, 100.0f, 35.0f, "%")      \
+    X(25, PUMP_RAMP_RATE, "pumpRampRate", PARAM_TYPE_FLOAT, 1.0f, 500.0f, 20.0f, "%/s")            \
+    X(26, PUMP_START_CLAMP, "pumpStartClamp", PARAM_TYPE_FLOAT, 0.0f, 100.0f, 40.0f, "%")          \
+    X(27, PUMP_START_CLAMP_MS, "pumpStartClampMs", PARAM_TYPE_UINT, 0.0f, 5000.0f, 1000.0f, "ms")  \
+    X(28, PUCK_EASE, "puckEase", PARAM_TYPE_FLOAT, 0.0f, 3.0f, 1.5f, "bar")                        \
+    X(29, HEATER_ELEMENT_W, "heaterElementW", PARAM_TYPE_UINT, 500.0f, 3000.0f, 1370.0f, "W")
+
+// Wire ids.
+typedef enum
+{
+#define PARAM_ID_ENUM(id, name, key, type, lo, hi, def, unit) PARAM_ID_##name = id,
+    PARAM_TABLE(PARAM_ID_ENUM)
+#undef PARAM_ID_ENUM
+} ParamId;
+
+// Positions in PARAM_DEFS.
+typedef enum
+{
+#define PARAM_INDEX_ENUM(id, name, key, type, lo, hi, def, unit) PARAM_INDEX_##name,
+    PARAM_TABLE(PARAM_INDEX_ENUM)
+#undef PARAM_INDEX_ENUM
+    PARAM_COUNT
+} ParamIndex;
+
+typedef struct
+{
+    uint16_t id;     //!< ParamId
+    uint8_t type;    //!< ParamType
+    const char *key; //!< Stable name used by the web API
+    float min;
+    float max;
+    float def;
+    const char *unit;
+} ParamDef;
+
+// Constant expressions in C++, so the controller derives its compile-time
+// defaults and limits from the same table.
+#ifdef __cplusplus
+#define PARAM_DEFS_QUALIFIER constexpr
+#else
+#define PARAM_DEFS_QUALIFIER const
+#endif
+
+static PARAM_DEFS_QUALIFIER ParamDef PARAM_DEFS[PARAM_COUNT] = {
+#define PARAM_DEF_ENTRY(id, name, key, type, lo, hi, def, unit) {id, type, key, lo, hi, def, unit},
+    PARAM_TABLE(PARAM_DEF_ENTRY)
+#undef PARAM_DEF_ENTRY
+};
+
+// Index of @p id in PARAM_DEFS, or -1 when no parameter has that id.
+static inline int param_index(uint16_t id)
+{
+    for (int i = 0; i < PARAM_COUNT; ++i)
+    {
+        if (PARAM_DEFS[i].id == id)
+            return i;
+    }
+    return -1;
+}
+
+// Index of the parameter called @p key, or -1.
+static inline int param_index_by_key(const char *key)
+{
+    for (int i = 0; i < PARAM_COUNT; ++i)
+    {
+        if (strcmp(PARAM_DEFS[i].key, key) == 0)
+            return i;
+    }
+    return -1;
+}